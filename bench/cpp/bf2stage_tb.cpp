@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bf2stage_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the bf2stage.v subfile of the radix-2^2 FFT
+//		(fftgen -R 22).  This file may be run autonomously.  If so,
+//	the last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test bf2stage.v, built with its default parameters.  Built with
+//	-DPREROTATE=1, it instead tests the Vbf2prerot model sw/Makefile
+//	verilates with PREROTATE set, as the decimation in time (-t) FFT uses.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+#ifndef	PREROTATE
+#define	PREROTATE	0
+#endif
+
+#if	PREROTATE
+#include "Vbf2prerot.h"
+typedef	Vbf2prerot	TSTCLASS;
+#else
+#include "Vbf2stage.h"
+typedef	Vbf2stage	TSTCLASS;
+#endif
+
+// These need to match the default parameters of bf2stage.v
+#define	IWIDTH	16
+#define	OWIDTH	(IWIDTH+1)
+#define	LGSPAN	3
+#define	SHIFT	0
+#define	ROTATE	1
+
+#define	SPAN	(1<<LGSPAN)	// Half the span of the stage
+#define	FRAMELEN	(2*SPAN)
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+class	BF2STAGE_TB {
+public:
+	TSTCLASS	*m_stage;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	BF2STAGE_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_stage = new TSTCLASS;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_stage->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_stage->i_clk = 1;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_stage->i_ce)&&(nkce>0)) {
+			m_stage->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_stage->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_stage->i_ce    = 0;
+		m_stage->i_sync  = 0;
+		m_stage->i_data  = 0;
+		m_stage->i_reset = 1;
+		tick();
+		m_stage->i_reset = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	// expected -- what the stage should produce for output k
+	// {{{
+	// Outputs come out a frame at a time.  The first SPAN outputs of a
+	// frame are the sums, x[n] + x[n+SPAN], and the last SPAN outputs are
+	// the differences, x[n] - x[n+SPAN].  With ROTATE, the second half of
+	// those differences are multiplied by -j--or, with PREROTATE, the
+	// second half of the x[n+SPAN] are, before the butterfly.
+	unsigned long	expected(int k) {
+		int	base = k & (-FRAMELEN), n = k & (SPAN-1);
+		long	ar, ai, br, bi, rv, iv;
+
+		ar = sbits(m_in[(base+n)&LOGMSK] >> IWIDTH, IWIDTH);
+		ai = sbits(m_in[(base+n)&LOGMSK], IWIDTH);
+		br = sbits(m_in[(base+n+SPAN)&LOGMSK] >> IWIDTH, IWIDTH);
+		bi = sbits(m_in[(base+n+SPAN)&LOGMSK], IWIDTH);
+
+		if ((ROTATE)&&(PREROTATE)&&(n >= SPAN/2)) {
+			// x[n+SPAN] * -j = bi - j br
+			rv = (0 == (k & SPAN)) ? (ar + bi) : (ar - bi);
+			iv = (0 == (k & SPAN)) ? (ai - br) : (ai + br);
+		} else if (0 == (k & SPAN)) {
+			rv = ar + br;
+			iv = ai + bi;
+		} else if ((ROTATE)&&(n >= SPAN/2)) {
+			rv = ai - bi;
+			iv = br - ar;
+		} else {
+			rv = ar - br;
+			iv = ai - bi;
+		}
+
+		rv = convround(rv, IWIDTH+1, OWIDTH, SHIFT);
+		iv = convround(iv, IWIDTH+1, OWIDTH, SHIFT);
+
+		return (ubits(rv, OWIDTH) << OWIDTH) | ubits(iv, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_stage->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 4*FRAMELEN) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_stage->o_sync != ((m_oaddr & (FRAMELEN-1)) == 0)) {
+			printf("BAD O-SYNC, k = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((m_oaddr & (-FRAMELEN)) + (m_oaddr & (SPAN-1)) + SPAN
+				>= m_iaddr) {
+			printf("OUTPUT %d PRODUCED BEFORE ITS INPUTS WERE GIVEN\n",
+				m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((unsigned long)m_stage->o_data != expected(m_oaddr)) {
+			printf("FAIL: k = %d, O_DATA = %0*lx(sut) != %0*lx(exp)\n",
+				m_oaddr, (2*OWIDTH+3)/4,
+				(unsigned long)m_stage->o_data,
+				(2*OWIDTH+3)/4, expected(m_oaddr));
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		m_stage->i_ce   = 1;
+		m_stage->i_sync = ((m_iaddr & (FRAMELEN-1)) == 0);
+		m_stage->i_data = ubits(data, 2*IWIDTH);
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*IWIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: ISYNC=%d, IN = %08lx, OUT =%09lx, SYNC=%d\n",
+				m_iaddr-1, m_stage->i_sync,
+				(unsigned long)m_stage->i_data,
+				(unsigned long)m_stage->o_data,
+				m_stage->o_sync);
+
+		check_results();
+	}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+
+	void	random_test(void) {
+		test(sbits(rand(), IWIDTH), sbits(rand(), IWIDTH));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	BF2STAGE_TB	*tb = new BF2STAGE_TB;
+	const	int	MAXV = (1<<(IWIDTH-1))-1, MINV = -(1<<(IWIDTH-1));
+
+	// tb->opentrace("bf2stage.vcd");
+	tb->reset();
+
+	// An impulse walking through every position of a frame
+	for(int k=0; k<FRAMELEN; k++)
+		for(int n=0; n<FRAMELEN; n++)
+			tb->test((n==k) ? 1024 : 0, (n==k) ? -512 : 0);
+
+	// The extremes, to check that nothing overflows
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test(MAXV, MAXV);
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test(MINV, MINV);
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test((n < SPAN) ? MAXV : MINV, (n < SPAN) ? MINV : MAXV);
+
+	for(int k=0; k<64*FRAMELEN; k++)
+		tb->random_test();
+
+	// Flush the last frames through
+	for(int k=0; k<2*FRAMELEN; k++)
+		tb->test(0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -0,0 +1,341 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bfpscale_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the bfpscale.v subfile of the block floating
+//		point FFT (fftgen -B).  This file may be run autonomously.  If
+//	so, the last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test bfpscale.v, built with its default parameters.  Each sample must
+//	come out one sample later, scaled by the peak of the frame before it
+//	(and saturated, if that wasn't enough), together with an exponent one
+//	more than the exponent that came in if its frame was halved.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vbfpscale.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of bfpscale.v
+#define	IWIDTH	17
+#define	OWIDTH	(IWIDTH-1)
+#define	LGSIZE	10
+#define	EWIDTH	4
+
+#define	FRAMELEN	(1<<LGSIZE)
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+class	BFPSCALE_TB {
+public:
+	Vbfpscale	*m_stage;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	BFPSCALE_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_stage = new Vbfpscale;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_stage->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_stage->i_clk = 1;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_stage->i_ce)&&(nkce>0)) {
+			m_stage->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_stage->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_stage->i_ce    = 0;
+		m_stage->i_sync  = 0;
+		m_stage->i_data  = 0;
+		m_stage->i_exp   = 0;
+		m_stage->i_reset = 1;
+		tick();
+		m_stage->i_reset = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	// iexp -- the exponent of frame f coming in, made up by the test
+	int	iexp(int f) {
+		return (3*f+1) & 7;
+	}
+
+	// needs_top -- true if any sample of the frame starting at base needs
+	// the top bit
+	bool	needs_top(int base) {
+		for(int n=0; n<FRAMELEN; n++) {
+			unsigned long	v = m_in[(base+n)&LOGMSK];
+			long		vr, vi;
+
+			vr = sbits(v >> IWIDTH, IWIDTH);
+			vi = sbits(v, IWIDTH);
+			if ((vr != sbits(vr, IWIDTH-1))||(vi != sbits(vi, IWIDTH-1)))
+				return true;
+		} return false;
+	}
+
+	// halved -- true if the frame starting at base should be halved: the
+	// first frame always, and every other one if the frame before it
+	// needed the top bit
+	bool	halved(int base) {
+		if (base == 0)
+			return true;
+		return needs_top(base - FRAMELEN);
+	}
+
+	// sat -- drop the top bit of v, saturating it if it needs that bit
+	long	sat(long v) {
+		const long	mx = (1l<<(OWIDTH-1))-1;
+
+		if (v > mx)
+			return mx;
+		else if (v < -mx-1)
+			return -mx-1;
+		return v;
+	}
+
+	// expected -- what the stage should produce for output k
+	// {{{
+	unsigned long	expected(int k) {
+		int	base = k & (-FRAMELEN);
+		long	vr, vi;
+
+		vr = sbits(m_in[k&LOGMSK] >> IWIDTH, IWIDTH);
+		vi = sbits(m_in[k&LOGMSK], IWIDTH);
+
+		if (halved(base)) {
+			vr = convround(vr, IWIDTH, OWIDTH, 0);
+			vi = convround(vi, IWIDTH, OWIDTH, 0);
+		} else {
+			vr = sat(vr);
+			vi = sat(vi);
+		}
+
+		return (ubits(vr, OWIDTH) << OWIDTH) | ubits(vi, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_stage->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 1) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_stage->o_sync != ((m_oaddr & (FRAMELEN-1)) == 0)) {
+			printf("BAD O-SYNC, k = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		// Every sample leaves on the clock after it arrives
+		if (m_oaddr != m_iaddr-1) {
+			printf("OUTPUT %d PRODUCED WITH INPUT %d\n",
+				m_oaddr, m_iaddr-1);
+			exit(EXIT_FAILURE);
+		}
+
+		if (m_stage->o_sync) {
+			int	f = m_oaddr / FRAMELEN, oexp;
+
+			oexp = (m_stage->o_exp >> ((f&3)*EWIDTH))
+					& ((1<<EWIDTH)-1);
+			if (oexp != iexp(f) + (halved(m_oaddr) ? 1:0)) {
+				printf("FAIL: FRAME %d, O_EXP = %d != %d\n",
+					f, oexp,
+					iexp(f) + (halved(m_oaddr) ? 1:0));
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		if ((unsigned long)m_stage->o_data != expected(m_oaddr)) {
+			printf("FAIL: k = %d, O_DATA = %0*lx(sut) != %0*lx(exp)\n",
+				m_oaddr, (2*OWIDTH+3)/4,
+				(unsigned long)m_stage->o_data,
+				(2*OWIDTH+3)/4, expected(m_oaddr));
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		int	f = m_iaddr / FRAMELEN;
+
+		m_stage->i_ce   = 1;
+		m_stage->i_sync = (m_iaddr == 0);
+		m_stage->i_data = ubits(data, 2*IWIDTH);
+		// The exponents of the last four frames come in together,
+		// indexed by frame number
+		m_stage->i_exp  = 0;
+		for(int k=0; k<4; k++) {
+			int	g = (f & -4) + k;
+
+			if (g > f)
+				g -= 4;
+			m_stage->i_exp |= (iexp(g<0 ? 0:g) & ((1<<EWIDTH)-1))
+						<< (k*EWIDTH);
+		}
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*IWIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: ISYNC=%d, IN = %09lx, OUT =%08lx, SYNC=%d\n",
+				m_iaddr-1, m_stage->i_sync,
+				(unsigned long)m_stage->i_data,
+				(unsigned long)m_stage->o_data,
+				m_stage->o_sync);
+
+		check_results();
+	}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+
+	// A frame of random data, of the given number of bits
+	void	random_frame(const int bits) {
+		for(int n=0; n<FRAMELEN; n++)
+			test(sbits(rand(), bits), sbits(rand(), bits));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	BFPSCALE_TB	*tb = new BFPSCALE_TB;
+	const	int	MAXV = (1<<(IWIDTH-1))-1, MINV = -(1<<(IWIDTH-1));
+
+	// tb->opentrace("bfpscale.vcd");
+	tb->reset();
+
+	// Quiet frames, loud frames, and quiet frames again, so that every
+	// change of scale is checked in both directions.  A loud frame
+	// following a quiet one isn't halved, and so saturates.
+	tb->random_frame(IWIDTH-1);
+	tb->random_frame(IWIDTH);
+	tb->random_frame(IWIDTH-2);
+	tb->random_frame(IWIDTH-1);
+	tb->random_frame(IWIDTH);
+	tb->random_frame(IWIDTH);
+
+	// A quiet frame, but for one sample needing the top bit--first on
+	// the real axis, and then on the imaginary one
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test((n == FRAMELEN-1) ? MAXV : 0, 0);
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test(0, (n == 3) ? MINV : 0);
+	// A frame just short of needing it
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test((n&1) ? MAXV/2 : MINV/2, (n&2) ? MAXV/2 : MINV/2);
+
+	for(int k=0; k<16; k++)
+		tb->random_frame(IWIDTH-1 + (rand()&1));
+
+	// A quiet frame, and then one saturating at both extremes
+	tb->random_frame(IWIDTH-2);
+	for(int n=0; n<FRAMELEN; n++)
+		tb->test((n&1) ? MAXV : MINV, (n&2) ? MINV : MAXV);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -45,10 +45,18 @@
 
 #include "verilated.h"
 #include "verilated_vcd_c.h"
-#include "Vbutterfly.h"
 #include "twoc.h"
 #include "fftsize.h"
 
+#ifdef	BYPASS
+// The same butterfly, built with OPT_BYPASS set
+#include "Vbypassbfly.h"
+typedef	Vbypassbfly	TSTCLASS;
+#else
+#include "Vbutterfly.h"
+typedef	Vbutterfly	TSTCLASS;
+#endif
+
 #ifdef	NEW_VERILATOR
 #define	VVAR(A)	butterfly__DOT__ ## A
 #else
@@ -64,7 +72,7 @@ bool	gbl_debug = false;
 
 class	BFLY_TB {
 public:
-	Vbutterfly	*m_bfly;
+	TSTCLASS	*m_bfly;
 	VerilatedVcdC	*m_trace;
 	unsigned long	m_left[64], m_right[64];
 	bool		m_aux[64];
@@ -75,7 +83,7 @@ public:
 	BFLY_TB(void) {
 		Verilated::traceEverOn(true);
 		m_trace = NULL;
-		m_bfly = new Vbutterfly;
+		m_bfly = new TSTCLASS;
 		m_addr = 0;
 		m_syncd = 0;
 		m_tickcount = 0;
@@ -430,6 +438,38 @@ int	main(int argc, char **argv, char **envp) {
 		bfly->test(n,k, cof, lft, rht, aux);
 	}
 
+	// The trivial twiddle factors, +/-1 and +/-j, both back to back and
+	// between nontrivial ones.  A butterfly built with OPT_BYPASS routes
+	// these around its multiply, holding the multiply's inputs, so the
+	// nontrivial coefficients following them check that hold as well.
+	for(int k=0; k<TESTSZ; k++) {
+		const long	one = 1l << (CWIDTH-2);
+		const long	triv[4][2] = {
+				{ one, 0 }, { -one, 0 }, { 0, -one }, { 0, one } };
+		unsigned long	lft, rht, cof;
+		long		rc, ic;
+
+		if ((k % 3) != 2) {
+			rc = triv[(k/3+k)&3][0];
+			ic = triv[(k/3+k)&3][1];
+		} else {
+			rc = sbits(rand(), CWIDTH);
+			ic = sbits(rand(), CWIDTH);
+		}
+
+		cof = (ubits(rc, CWIDTH) << CWIDTH) | ubits(ic, CWIDTH);
+		lft = ubits(((long)rand() << 16) ^ rand(), 2*IWIDTH);
+		rht = ubits(((long)rand() << 16) ^ rand(), 2*IWIDTH);
+		// Include the most negative inputs, whose differences are the
+		// widest
+		if ((k&15) == 5)
+			lft = (1ul << (2*IWIDTH-1)) | (1ul << (IWIDTH-1));
+		if ((k&15) == 6)
+			rht = (1ul << (2*IWIDTH-1)) | (1ul << (IWIDTH-1));
+
+		bfly->test(1,k, cof, lft, rht, (k==0));
+	}
+
 	int	k = TESTSZ;
 	// Exhaustively test
 #if (4*IWIDTH+2*CWIDTH <= 24)
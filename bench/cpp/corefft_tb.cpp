@@ -0,0 +1,558 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	corefft_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for a whole FFT core, built by fftgen with one,
+//		four, or eight complex samples (or, for -r, two real samples)
+//	per clock, checking it against a DFT computed here.  Where fft_tb
+//	only records the results of the default core, this bench fails if any
+//	frame comes out wrong, and so it can be used to check the other
+//	architectures fftgen builds, including a variable size (-z) core at
+//	every size it can run, and the exponents of a block floating point
+//	(-B) core.  The core under test is given by the header fftgen -a wrote
+//	for it, FFTSIZE_H (fftsize.h by default), and the Vfftmain found in
+//	the include path.  This file may be run autonomously.  If so, the
+//	last line output will either read "SUCCESS" on success, or some other
+//	failure message otherwise.
+//
+//	Every frame is compared against a double precision DFT, after finding
+//	the best fitting scale between the two.  The frame passes if the
+//	residual is at least MIN_SQNR dB below the signal.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfftmain.h"
+#include "twoc.h"
+
+#ifdef	FFTSIZE_H
+#include FFTSIZE_H
+#else
+#include "fftsize.h"
+#endif
+
+#ifdef	DBLCLKFFT
+#error	"corefft_tb cannot check the two sample per clock (-2) FFT"
+#endif
+
+#ifdef	FFT_LANES
+#define	LANES	FFT_LANES	// Sample words per clock
+#else
+#define	LANES	1
+#endif
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)	// Words per frame, in and out
+#ifdef	RLFFT
+#define	DFTLEN	(2*FFTLEN)	// Two real samples per word
+#else
+#define	DFTLEN	FFTLEN
+#endif
+
+#ifdef	FFT_VARIABLE_SIZE
+#define	MIN_LGSIZE	4	// The smallest size a -z core will run
+#else
+#define	MIN_LGSIZE	LGWIDTH
+#endif
+
+#define	NFRAMES	24
+#ifdef	FFT_BFP
+// A block floating point core scales each frame by the peaks of the frame
+// before it, and so would saturate any frame louder than the one before.
+// Every frame is therefore given twice, and only the second copy checked.
+#define	NCOPIES	2
+#else
+#define	NCOPIES	1
+#endif
+#define	MIN_SQNR	40.0	// dB
+
+const	bool	gbl_debug = false;
+
+unsigned long bitrev(const int nbits, const unsigned long vl) {
+	unsigned long	r = 0;
+	unsigned long	val = vl;
+
+	for(int k=0; k<nbits; k++) {
+		r<<= 1;
+		r |= (val & 1);
+		val >>= 1;
+	}
+
+	return r;
+}
+
+class	COREFFT_TB {
+public:
+	Vfftmain	*m_fft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[NCOPIES*NFRAMES*FFTLEN], m_out[FFTLEN];
+	double		m_cos[DFTLEN], m_sin[DFTLEN];
+	int		m_iaddr, m_oaddr, m_nframes;
+	int		m_lgsize, m_len, m_dftlen;
+#ifdef	FFT_BFP
+	// The exponent of the frame coming out, and the scale of the first
+	// frame--that every other frame, after its exponent, should match
+	int		m_exp;
+	double		m_bfpscale;
+	// The frame being gathered, to then be given NCOPIES times
+	unsigned long	m_frame[FFTLEN];
+	int		m_nfill;
+#endif
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	COREFFT_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_fft = new Vfftmain;
+		m_iaddr = m_oaddr = m_nframes = 0;
+		m_lgsize = LGWIDTH;
+		m_len = FFTLEN;
+		m_dftlen = DFTLEN;
+#ifdef	FFT_BFP
+		m_exp = 0;
+		m_bfpscale = 0.0;
+		m_nfill = 0;
+#endif
+		m_syncd = false;
+		m_tickcount = 0;
+
+		for(int k=0; k<DFTLEN; k++) {
+			m_cos[k] = cos(2.0 * M_PI * k / DFTLEN);
+			m_sin[k] = sin(2.0 * M_PI * k / DFTLEN);
+		}
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_fft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_fft->i_clk = 1;
+		m_fft->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_fft->i_ce)&&(nkce>0)) {
+			m_fft->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_fft->i_ce = 1;
+		}
+	}
+
+	// reset
+	// {{{
+	// A variable size (-z) core captures its size on reset, so this is
+	// also where we choose the size of the frames that follow
+	// setlane, getlane
+	// {{{
+	// A core taking several samples per clock (-4 or -8) packs them into
+	// one wide port, sample zero on top.  Lane k starts (LANES-1-k) words
+	// up from the bottom.
+#ifdef	FFT_LANES
+	void	setlane(const int k, const unsigned long v) {
+		int	base = (LANES-1-k)*2*IWIDTH;
+
+		for(int b=0; b<2*IWIDTH; b++) {
+			int		bit = base + b;
+			unsigned	msk = 1u << (bit & 31);
+
+			if ((v >> b) & 1)
+				m_fft->i_sample[bit >> 5] |= msk;
+			else
+				m_fft->i_sample[bit >> 5] &= ~msk;
+		}
+	}
+
+	unsigned long	getlane(const int k) {
+		int		base = (LANES-1-k)*2*OWIDTH;
+		unsigned long	v = 0;
+
+		for(int b=0; b<2*OWIDTH; b++) {
+			int	bit = base + b;
+
+			if ((m_fft->o_result[bit >> 5] >> (bit & 31)) & 1)
+				v |= (1ul << b);
+		}
+
+		return v;
+	}
+#else
+	void	setlane(const int k, const unsigned long v) {
+		m_fft->i_sample = v;
+	}
+
+	unsigned long	getlane(const int k) {
+		return (unsigned long)m_fft->o_result;
+	}
+#endif
+	// }}}
+
+	void	reset(const int lgsize = LGWIDTH) {
+		m_lgsize = lgsize;
+		m_len = 1<<lgsize;
+		m_dftlen = m_len * (DFTLEN/FFTLEN);
+
+		m_fft->i_ce     = 0;
+		for(int k=0; k<LANES; k++)
+			setlane(k, 0);
+#ifdef	FFT_VARIABLE_SIZE
+		m_fft->i_lgsize = lgsize;
+#endif
+		m_fft->i_reset  = 1;
+		tick();
+		m_fft->i_reset  = 0;
+		tick();
+
+		m_iaddr = m_oaddr = m_nframes = 0;
+#ifdef	FFT_BFP
+		m_nfill = 0;
+#endif
+		m_syncd = false;
+	}
+	// }}}
+
+	// checkframe
+	// {{{
+	// Compares the last frame out of the core against the DFT of the
+	// frame that went in.
+	void	checkframe(int frame) {
+		double	xr[DFTLEN], xi[DFTLEN];
+		double	Xr[FFTLEN+1], Xi[FFTLEN+1], Yr[FFTLEN+1], Yi[FFTLEN+1];
+		double	num = 0.0, den = 0.0, scale, sig, err = 0.0;
+		double	sqnr;
+		int	nbins;
+
+		// The frame that went in, in natural order
+		for(int n=0; n<m_len; n++) {
+			unsigned long	v = m_in[frame*m_len + n];
+			int		idx = n;
+#ifdef	FFT_DIT
+			// A decimation in time core takes its inputs in bit
+			// reversed order
+			idx = bitrev(m_lgsize, n);
+#endif
+#ifdef	RLFFT
+			// Two real samples per word, the even one on top
+			xr[2*idx  ] = (double)sbits(v >> IWIDTH, IWIDTH);
+			xr[2*idx+1] = (double)sbits(v, IWIDTH);
+			xi[2*idx  ] = xi[2*idx+1] = 0.0;
+#else
+			xr[idx] = (double)sbits(v >> IWIDTH, IWIDTH);
+			xi[idx] = (double)sbits(v, IWIDTH);
+#endif
+		}
+
+		// What came out.  A real FFT produces only X[0] ... X[N/2],
+		// with X[N/2] packed into the imaginary half of X[0]
+		for(int k=0; k<m_len; k++) {
+			int	odx = k;
+
+#ifdef	FFT_SKIPS_BIT_REVERSE
+			odx = bitrev(m_lgsize, k);
+#endif
+			Yr[k] = (double)sbits(m_out[odx] >> OWIDTH, OWIDTH);
+			Yi[k] = (double)sbits(m_out[odx], OWIDTH);
+#ifdef	FFT_BFP
+			// Undo the block floating point scaling
+			Yr[k] = ldexp(Yr[k], m_exp);
+			Yi[k] = ldexp(Yi[k], m_exp);
+#endif
+		}
+#ifdef	RLFFT
+		nbins = m_len+1;
+		Yr[m_len] = Yi[0];
+		Yi[m_len] = Yi[0] = 0.0;
+#else
+		nbins = m_len;
+#endif
+
+		// The DFT of what went in, X[k]
+		for(int k=0; k<nbins; k++) {
+			Xr[k] = Xi[k] = 0.0;
+			for(int n=0; n<m_dftlen; n++) {
+				int	ph = ((n*k) & (m_dftlen-1))
+						* (DFTLEN / m_dftlen);
+
+				// X[k] += x[n] * exp(-j 2pi nk/N)
+				Xr[k] += xr[n] * m_cos[ph] + xi[n] * m_sin[ph];
+				Xi[k] += xi[n] * m_cos[ph] - xr[n] * m_sin[ph];
+			}
+
+			num += Xr[k] * Yr[k] + Xi[k] * Yi[k];
+			den += Xr[k] * Xr[k] + Xi[k] * Xi[k];
+		}
+
+		// The FFT scales its result by some power of two.  Find the best
+		// fitting scale, and then measure how far we are from it
+		scale = (den > 0.0) ? (num / den) : 0.0;
+		sig = scale * scale * den;
+		for(int k=0; k<nbins; k++) {
+			double	er = Yr[k] - scale * Xr[k],
+				ei = Yi[k] - scale * Xi[k];
+
+			err += er * er + ei * ei;
+		}
+
+		if (den == 0.0) {
+			// An all zero input must produce an all zero output
+			if (err != 0.0) {
+				printf("FRAME %2d: NON-ZERO OUTPUT FROM A ZERO INPUT\n",
+					frame);
+				exit(EXIT_FAILURE);
+			}
+			printf("FRAME %2d: ZERO\n", frame);
+			return;
+		}
+
+		sqnr = (err > 0.0) ? 10.0 * log10(sig / err) : 999.0;
+		printf("FRAME %2d: SCALE = %12.6f, SQNR = %6.1f dB\n",
+			frame, scale, sqnr);
+
+		if ((scale <= 0.0)||(sqnr < MIN_SQNR)) {
+			printf("FRAME %2d FAILS: the result is out of bounds from the DFT\n", frame);
+			exit(EXIT_FAILURE);
+		}
+
+#ifdef	FFT_BFP
+		// Once its exponent has been applied, every frame should have
+		// the same scale.  A wrong exponent would be off by a factor
+		// of two.
+		printf("FRAME %2d: EXPONENT = %d\n", frame, m_exp);
+		if (m_bfpscale == 0.0)
+			m_bfpscale = scale;
+		else if (fabs(scale - m_bfpscale) > 0.1 * m_bfpscale) {
+			printf("FRAME %2d FAILS: its exponent doesn't match its scale\n", frame);
+			exit(EXIT_FAILURE);
+		}
+#endif
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_fft->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 4*m_len + 4*LANES*FFT_LATENCY) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_fft->o_sync != (m_oaddr == 0)) {
+			printf("BAD O-SYNC, frame %d, k = %d\n", m_nframes, m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+#ifdef	FFT_BFP
+		if (m_oaddr == 0)
+			m_exp = m_fft->o_exponent;
+#endif
+
+		for(int k=0; k<LANES; k++) {
+			m_out[m_oaddr++] = getlane(k);
+			if (m_oaddr >= m_len) {
+				if ((m_nframes < NCOPIES*NFRAMES)
+					&&(m_nframes % NCOPIES == NCOPIES-1))
+					checkframe(m_nframes);
+				m_nframes++;
+				m_oaddr = 0;
+			}
+		}
+	}
+
+	// step
+	// {{{
+	// Queue up one sample word, and step the core once every LANES words
+	void	step(unsigned long data) {
+		setlane(m_iaddr % LANES, ubits(data, 2*IWIDTH));
+		if (m_iaddr < NCOPIES * NFRAMES * m_len)
+			m_in[m_iaddr] = ubits(data, 2*IWIDTH);
+		m_iaddr++;
+		if (m_iaddr % LANES)
+			return;
+
+		m_fft->i_ce = 1;
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%5d: IN = %0*lx, OUT = %0*lx, SYNC=%d\n",
+				m_iaddr-1, (2*IWIDTH+3)/4, data,
+				(2*OWIDTH+3)/4, getlane(LANES-1),
+				m_fft->o_sync);
+
+		check_results();
+	}
+	// }}}
+
+	// test
+	// {{{
+	// Give the core one sample word, or (for -B) gather a frame of them
+	// to be given NCOPIES times
+	void	test(unsigned long data) {
+#ifdef	FFT_BFP
+		m_frame[m_nfill++] = data;
+		if (m_nfill < m_len)
+			return;
+		m_nfill = 0;
+		for(int c=0; c<NCOPIES; c++)
+			for(int n=0; n<m_len; n++)
+				step(m_frame[n]);
+#else
+		step(data);
+#endif
+	}
+	// }}}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	COREFFT_TB	*tb = new COREFFT_TB;
+	const	int	AMP = (1<<(IWIDTH-2));
+	int		frame = 0;
+
+	// tb->opentrace("corefft.vcd");
+
+	// Every size the core can run: only the one, unless it was built
+	// with -z
+	for(int lgsize = MIN_LGSIZE; lgsize <= LGWIDTH; lgsize++) {
+		const	int	len = 1<<lgsize;
+
+		printf("FFT SIZE: %d words per frame\n", len);
+		tb->reset(lgsize);
+
+		// Frame 0: An impulse
+		for(int n=0; n<len; n++)
+			tb->test((n == 0) ? AMP : 0, 0);
+		// Frame 1: An impulse somewhere else, on the imaginary axis
+		for(int n=0; n<len; n++)
+			tb->test(0, (n == 3) ? -AMP : 0);
+		// Frame 2: A constant
+		for(int n=0; n<len; n++)
+			tb->test(AMP/len, AMP/len);
+		frame = 3;
+
+		// Frames 3-10: Tones, in between bins and not
+		for(; frame<11; frame++) {
+			double	bin = (frame-3) * 2.25 + 1;
+
+			for(int n=0; n<len; n++) {
+				double	W = 2.0 * M_PI * bin * n / len;
+				tb->test((int)(AMP * cos(W)), (int)(AMP * sin(W)));
+			}
+		}
+
+#ifdef	FFT_BFP
+		// Frames 11-12: A quiet frame, followed by a full scale one,
+		// which must be scaled down by more
+		for(int n=0; n<len; n++) {
+			double	W = 2.0 * M_PI * 5.0 * n / len;
+			tb->test((int)(AMP/16 * cos(W)), (int)(AMP/16 * sin(W)));
+		}
+		for(int n=0; n<len; n++) {
+			double	W = 2.0 * M_PI * 3.0 * n / len;
+			tb->test((int)((2*AMP-1) * cos(W)),
+				(int)((2*AMP-1) * sin(W)));
+		}
+		frame = 13;
+#endif
+
+		// The rest: Random noise
+		for(; frame<NFRAMES; frame++)
+			for(int n=0; n<len; n++)
+				tb->test(sbits(rand(), IWIDTH-2),
+					sbits(rand(), IWIDTH-2));
+
+		// Zeros, until every frame has come out
+		while(tb->m_nframes < NCOPIES*NFRAMES) {
+			tb->test(0, 0);
+			if (tb->m_iaddr > (NCOPIES*NFRAMES+4)*len
+					+ 4*LANES*FFT_LATENCY) {
+				printf("ONLY %d FRAMES CAME OUT\n",
+					tb->m_nframes);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -0,0 +1,274 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	crossbfly_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the crossbfly.v subfile of the four and eight
+//		samples per clock FFTs (fftgen -4 or -8), the butterfly that
+//	combines two lanes on the same clock.  This file may be run
+//	autonomously.  If so, the last line output will either read "SUCCESS"
+//	on success, or some other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test crossbfly.v.  Since its default twiddle factor of one would never
+//	exercise the multiply, sw/Makefile verilates it with a twiddle factor
+//	of exp(-j pi/4) instead.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vcrossbfly.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of crossbfly.v, save for the
+// twiddle factor, which needs to match the one given to verilator
+#define	IWIDTH	16
+#define	CWIDTH	20
+#define	OWIDTH	(IWIDTH+1)
+#define	SHIFT	0
+#define	COEF_R	185364
+#define	COEF_I	-185364
+
+#define	LATENCY	3	// Clock enables, from input to output
+#define	LOGLEN	64
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+class	CROSSBFLY_TB {
+public:
+	Vcrossbfly	*m_bfly;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_left[LOGLEN], m_right[LOGLEN];
+	int		m_aux[LOGLEN];
+	int		m_addr;
+	uint64_t	m_tickcount;
+
+	CROSSBFLY_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_bfly = new Vcrossbfly;
+		m_addr = 0;
+		m_tickcount = 0;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_bfly->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_bfly->i_clk = 0;
+		m_bfly->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_bfly->i_clk = 1;
+		m_bfly->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_bfly->i_clk = 0;
+		m_bfly->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_bfly->i_ce)&&(nkce>0)) {
+			m_bfly->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_bfly->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_bfly->i_ce    = 0;
+		m_bfly->i_left  = 0;
+		m_bfly->i_right = 0;
+		m_bfly->i_aux   = 0;
+		m_bfly->i_reset = 1;
+		tick();
+		m_bfly->i_reset = 0;
+		tick();
+
+		m_addr = 0;
+	}
+
+	// expected
+	// {{{
+	// The left output is the sum of the two inputs, the right their
+	// difference times the twiddle factor.  Both are rounded from
+	// IWIDTH+CWIDTH+2 bits, with the sum scaled up to match the product.
+	void	expected(int k, unsigned long &left, unsigned long &right) {
+		long	lr, li, rr, ri, sr, si, dr, di, pr, pi;
+
+		lr = sbits(m_left[k&LOGMSK] >> IWIDTH, IWIDTH);
+		li = sbits(m_left[k&LOGMSK], IWIDTH);
+		rr = sbits(m_right[k&LOGMSK] >> IWIDTH, IWIDTH);
+		ri = sbits(m_right[k&LOGMSK], IWIDTH);
+
+		sr = (lr + rr) << (CWIDTH-2);
+		si = (li + ri) << (CWIDTH-2);
+		dr = lr - rr;
+		di = li - ri;
+		pr = dr * COEF_R - di * COEF_I;
+		pi = dr * COEF_I + di * COEF_R;
+
+		sr = convround(sr, IWIDTH+CWIDTH+2, OWIDTH, SHIFT+3);
+		si = convround(si, IWIDTH+CWIDTH+2, OWIDTH, SHIFT+3);
+		pr = convround(pr, IWIDTH+CWIDTH+2, OWIDTH, SHIFT+3);
+		pi = convround(pi, IWIDTH+CWIDTH+2, OWIDTH, SHIFT+3);
+
+		left  = (ubits(sr, OWIDTH) << OWIDTH) | ubits(si, OWIDTH);
+		right = (ubits(pr, OWIDTH) << OWIDTH) | ubits(pi, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		unsigned long	left, right;
+		int		k = m_addr - LATENCY;
+
+		if (k < 0)
+			return;
+
+		if (m_bfly->o_aux != m_aux[k&LOGMSK]) {
+			printf("FAIL: k = %d, O_AUX = %d != %d\n", k,
+				m_bfly->o_aux, m_aux[k&LOGMSK]);
+			exit(EXIT_FAILURE);
+		}
+
+		expected(k, left, right);
+		if (((unsigned long)m_bfly->o_left != left)
+				||((unsigned long)m_bfly->o_right != right)) {
+			printf("FAIL: k = %d, O_LEFT/RIGHT = %0*lx,%0*lx(sut) != %0*lx,%0*lx(exp)\n",
+				k,
+				(2*OWIDTH+3)/4, (unsigned long)m_bfly->o_left,
+				(2*OWIDTH+3)/4, (unsigned long)m_bfly->o_right,
+				(2*OWIDTH+3)/4, left,
+				(2*OWIDTH+3)/4, right);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	void	test(int lr, int li, int rr, int ri, int aux) {
+		m_bfly->i_ce    = 1;
+		m_bfly->i_left  = (ubits(lr, IWIDTH) << IWIDTH) | ubits(li, IWIDTH);
+		m_bfly->i_right = (ubits(rr, IWIDTH) << IWIDTH) | ubits(ri, IWIDTH);
+		m_bfly->i_aux   = aux;
+		m_left[m_addr&LOGMSK]  = m_bfly->i_left;
+		m_right[m_addr&LOGMSK] = m_bfly->i_right;
+		m_aux[m_addr&LOGMSK]   = aux;
+		m_addr++;
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: IN = %08x,%08x, OUT = %09lx,%09lx, AUX=%d\n",
+				m_addr-1, (unsigned)m_bfly->i_left,
+				(unsigned)m_bfly->i_right,
+				(unsigned long)m_bfly->o_left,
+				(unsigned long)m_bfly->o_right,
+				m_bfly->o_aux);
+
+		check_results();
+	}
+
+	void	random_test(void) {
+		// Keep the inputs to half scale, as they would be within an
+		// FFT, so the product can't overflow
+		test(sbits(rand(), IWIDTH-1), sbits(rand(), IWIDTH-1),
+			sbits(rand(), IWIDTH-1), sbits(rand(), IWIDTH-1),
+			rand()&1);
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	CROSSBFLY_TB	*tb = new CROSSBFLY_TB;
+	const	int	HALF = (1<<(IWIDTH-2));
+
+	// tb->opentrace("crossbfly.vcd");
+	tb->reset();
+
+	// Impulses into either side, on either axis
+	tb->test(HALF, 0, 0, 0, 1);
+	tb->test(0, HALF, 0, 0, 0);
+	tb->test(0, 0, HALF, 0, 0);
+	tb->test(0, 0, 0, HALF, 0);
+	tb->test(0, 0, 0, -HALF, 1);
+	tb->test(-HALF, 0, 0, 0, 0);
+
+	// The half scale extremes
+	tb->test( HALF-1,  HALF-1, -HALF, -HALF, 0);
+	tb->test(-HALF, -HALF,  HALF-1,  HALF-1, 1);
+	tb->test( HALF-1, -HALF, -HALF,  HALF-1, 0);
+
+	// Ones, to check the rounding
+	for(int k=0; k<16; k++)
+		tb->test(k&1, (k>>1)&1, -((k>>2)&1), -((k>>3)&1), 0);
+
+	for(int k=0; k<4096; k++)
+		tb->random_test();
+
+	// Flush the last results through
+	for(int k=0; k<LATENCY; k++)
+		tb->test(0, 0, 0, 0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
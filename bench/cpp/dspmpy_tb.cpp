@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dspmpy_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the dspmpy.v subfile of the FFT, the
+//		hardware multiply tiled across DSPs that fftgen --dsp builds.
+//	This file may be run autonomously.  If so, the last line output will
+//	either read "SUCCESS" on success, or some other failure message
+//	otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test dspmpy.v, built with its default parameters--those of an 18x18
+//	DSP.  Built with -DDSPTILE, it instead tests the Vdsptile model
+//	sw/Makefile verilates for a 10x7 DSP, padded out to twelve clocks.
+//	Tiling the same multiply across such a small DSP takes eight tiles,
+//	with the DSP turned around, and so checks every corner of the tiling.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "twoc.h"
+
+// These need to match the default parameters of dspmpy.v, or those
+// sw/Makefile gives the Vdsptile model
+#define	IAW	21
+#define	IBW	18
+#ifdef	DSPTILE
+#include "Vdsptile.h"
+typedef	Vdsptile	TSTCLASS;
+#define	DSPAW	10
+#define	DSPBW	7
+#define	DELAY	12
+#else
+#include "Vdspmpy.h"
+typedef	Vdspmpy		TSTCLASS;
+#define	DSPAW	18
+#define	DSPBW	18
+#define	DELAY	0
+#endif
+
+// The number of tiles, counted as dspmpy.v counts them
+#define	NSA	((IAW-2)/(DSPAW-1)+1)
+#define	NSB	((IBW-2)/(DSPBW-1)+1)
+#define	NXA	((IAW-2)/(DSPBW-1)+1)
+#define	NXB	((IBW-2)/(DSPAW-1)+1)
+#define	NT	((NXA*NXB < NSA*NSB) ? (NXA*NXB) : (NSA*NSB))
+// The clocks from i_a and i_b to o_r
+#define	LATENCY	((DELAY > NT+1) ? DELAY : (NT+1))
+#define	OW	(IAW+IBW)
+
+class	DSPMPY_TB {
+public:
+	TSTCLASS	*m_mpy;
+	VerilatedVcdC	*m_trace;
+	long		m_vals[32];
+	int		m_addr;
+	uint64_t	m_tickcount;
+
+	DSPMPY_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_mpy = new TSTCLASS;
+		m_tickcount = 0;
+
+		for(int i=0; i<32; i++)
+			m_vals[i] = 0;
+		m_addr = 0;
+	}
+
+	~DSPMPY_TB(void) {
+		closetrace();
+		delete m_mpy;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_mpy->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_mpy->i_clk = 0;
+		m_mpy->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_mpy->i_clk = 1;
+		m_mpy->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_mpy->i_clk = 0;
+		m_mpy->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	// cetick
+	// {{{
+	// dspmpy.v only ever moves on i_ce, so idle clocks between them
+	// shouldn't change a thing
+	void	cetick(void) {
+		tick();
+		if (rand()&1) {
+			m_mpy->i_ce = 0;
+			tick();
+			m_mpy->i_ce = 1;
+		}
+	}
+	// }}}
+
+	void	reset(void) {
+		m_mpy->i_ce = 1;
+		m_mpy->i_a  = 0;
+		m_mpy->i_b  = 0;
+
+		for(int k=0; k<2*LATENCY; k++)
+			cetick();
+		m_addr = 0;
+	}
+
+	void	test(const long ia, const long ib) {
+		long	a, b, out;
+
+		a = sbits(ia, IAW);
+		b = sbits(ib, IBW);
+		m_mpy->i_ce = 1;
+		m_mpy->i_a  = ubits(a, IAW);
+		m_mpy->i_b  = ubits(b, IBW);
+
+		m_vals[m_addr&31] = a * b;
+
+		cetick();
+		m_addr++;
+
+		out = sbits(m_mpy->o_r, OW);
+		if ((m_addr >= LATENCY)
+				&&(out != m_vals[(m_addr-LATENCY)&31])) {
+			printf("k=%4d: %0*lx * %0*lx = %0*lx(exp) != %0*lx(sut)\n",
+				m_addr-LATENCY,
+				(IAW+3)/4, ubits(a, IAW),
+				(IBW+3)/4, ubits(b, IBW),
+				(OW+3)/4, ubits(m_vals[(m_addr-LATENCY)&31], OW),
+				(OW+3)/4, ubits(out, OW));
+			printf("WRONG ANSWER\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	DSPMPY_TB	*tb = new DSPMPY_TB;
+	const long	MAXA = (1l<<(IAW-1))-1, MINA = -(1l<<(IAW-1)),
+			MAXB = (1l<<(IBW-1))-1, MINB = -(1l<<(IBW-1));
+
+	printf("%d tiles, %d clocks\n", NT, LATENCY);
+
+	// tb->opentrace("dspmpy.vcd");
+	tb->reset();
+
+	// The extremes of each input, including the sign bit, against
+	// each other
+	tb->test(MAXA, MAXB);
+	tb->test(MAXA, MINB);
+	tb->test(MINA, MAXB);
+	tb->test(MINA, MINB);
+	tb->test(-1, -1);
+	tb->test(-1, MINB);
+	tb->test(MINA, -1);
+
+	// Every bit of one input, against every bit of the other, so that
+	// each tile gets a turn
+	for(int a=0; a<IAW; a++)
+	for(int b=0; b<IBW; b++) {
+		tb->test(1l<<a, 1l<<b);
+		tb->test(-(1l<<a), 1l<<b);
+		tb->test(1l<<a, -(1l<<b));
+		tb->test((1l<<a)-1, -(1l<<b)+1);
+	}
+
+	for(int k=0; k<(1<<16); k++)
+		tb->test(rand(), rand());
+
+	// Flush the last products through
+	for(int k=0; k<LATENCY; k++)
+		tb->test(0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -15,6 +15,19 @@
 //	test fftstage.v.  Also, you'll need to place a copy of the cmem_*2048
 //	hex file into the directory where you run this test bench.
 //
+//	Built with -DTWIDGEN, it instead tests the Vtwidgen model sw/Makefile
+//	verilates with OPT_TWIDGEN set (fftgen -g), building its twiddle
+//	factors from a coarse and a fine table.  The test bench then writes
+//	both tables itself, and checks the stage against a bit exact model of
+//	the generator--after first checking that model against the ideal
+//	twiddle factors.
+//
+//	Built with -DQTRWAVE, it tests the Vqtrwave model, the first stage of
+//	a core built with fftgen -q, which rebuilds its twiddle factors from
+//	a quarter wave cosine table.  The test bench again writes that table
+//	itself, and checks the stage against each twiddle factor folded out
+//	of it--after first checking those against the ideal.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -45,16 +58,38 @@
 ////////////////////////////////////////////////////////////////////////////////
 //
 // }}}
-#include "Vfftstage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "twoc.h"
 #include "fftsize.h"
 
+#ifdef	TWIDGEN
+#include "Vtwidgen.h"
+typedef	Vtwidgen	TSTCLASS;
+#elif	defined(QTRWAVE)
+#include "Vqtrwave.h"
+typedef	Vqtrwave	TSTCLASS;
+#else
+#include "Vfftstage.h"
+typedef	Vfftstage	TSTCLASS;
+#endif
+
 
 #ifdef	ROOT_VERILATOR
 
+#ifdef	TWIDGEN
+#include "Vtwidgen___024root.h"
+#elif	defined(QTRWAVE)
+#include "Vqtrwave___024root.h"
+#else
 #include "Vfftstage___024root.h"
+#endif
 
 #define	VVAR(A)	rootp->fftstage__DOT_ ## A
 
@@ -93,6 +128,18 @@
 
 #define	SPANLEN		(1<<LGSPAN)
 #define	SPANMASK	(SPANLEN-1)
+
+#ifdef	TWIDGEN
+// These need to match the default parameters of fftstage.v, save COEFFILE,
+// which sw/Makefile sets so as not to overwrite the default core's table
+#define	LGFINE		(LGSPAN/2)
+#define	GWIDTH		(CWIDTH+2)
+#define	COEFFILE	"cmem_c2048.hex"
+#define	FINEFILE	"cmem_f2048.hex"
+#elif	defined(QTRWAVE)
+// This matches the default COEFFILE of the -q fftstage.v
+#define	COEFFILE	"cmem_q2048.hex"
+#endif
 #define	DBLSPANLEN	(1<<(LGSPAN+4))
 #define	DBLSPANMASK	(DBLSPANLEN-1)
 
@@ -100,9 +147,12 @@ const	bool	gbl_debug = false;
 
 class	FFTSTAGE_TB {
 public:
-	Vfftstage	*m_ftstage;
+	TSTCLASS	*m_ftstage;
 	VerilatedVcdC	*m_trace;
 	long		m_iaddr;
+#if	defined(TWIDGEN) || defined(QTRWAVE)
+	long		m_coef[SPANLEN];
+#endif
 	long		m_vals[SPANLEN], m_out[DBLSPANLEN];
 	bool		m_syncd, m_ib_syncd, m_ob_syncd, m_input_sync;
 	int		m_offset, m_ib_offset, m_ob_offset;
@@ -110,7 +160,13 @@ public:
 
 	FFTSTAGE_TB(void) {
 		Verilated::traceEverOn(true);
-		m_ftstage = new Vfftstage;
+#ifdef	TWIDGEN
+		// The tables must be written before the stage reads them
+		gen_tables();
+#elif	defined(QTRWAVE)
+		gen_qtrwave();
+#endif
+		m_ftstage = new TSTCLASS;
 		m_syncd = false;
 		m_input_sync = false;
 		m_ib_syncd   = false;
@@ -121,6 +177,139 @@ public:
 assert(OWIDTH == IWIDTH+1);
 	}
 
+#ifdef	TWIDGEN
+	// gen_table
+	// {{{
+	// Writes count twiddle factors, W^(stride*i), of GWIDTH bits each, to
+	// fname, returning them in re[] and im[]
+	void	gen_table(const char *fname, int stride, int count,
+				long *re, long *im) {
+		FILE	*fp;
+
+		unlink(fname);
+		fp = fopen(fname, "w");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not write %s\n", fname);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int k=0; k<count; k++) {
+			double	W = -M_PI * (double)(stride * k) / SPANLEN;
+
+			re[k] = llround((1l<<(GWIDTH-2)) * cos(W));
+			im[k] = llround((1l<<(GWIDTH-2)) * sin(W));
+
+			fprintf(fp, "%0*lx\n", (2*GWIDTH+3)/4,
+				(ubits(re[k], GWIDTH) << GWIDTH)
+				| ubits(im[k], GWIDTH));
+		}
+
+		fclose(fp);
+	}
+	// }}}
+
+	// gen_tables
+	// {{{
+	// Writes the coarse and fine tables, and then builds each twiddle
+	// factor from them exactly as the generator does: multiplying the
+	// two, and rounding the product back to CWIDTH bits.  Every one of
+	// these must be within two LSBs of the ideal twiddle factor.
+	void	gen_tables(void) {
+		const	int	shift = 2*GWIDTH-CWIDTH-2;
+		long	cr[SPANLEN>>LGFINE], ci[SPANLEN>>LGFINE],
+			fr[1<<LGFINE], fi[1<<LGFINE];
+
+		gen_table(COEFFILE, 1<<LGFINE, SPANLEN>>LGFINE, cr, ci);
+		gen_table(FINEFILE, 1, 1<<LGFINE, fr, fi);
+
+		for(int k=0; k<SPANLEN; k++) {
+			int	c = k >> LGFINE, f = k & ((1<<LGFINE)-1);
+			long	sr, si;
+			double	W = -M_PI * (double)k / SPANLEN, er, ei;
+
+			sr = cr[c] * fr[f] - ci[c] * fi[f] + (1l<<(shift-1));
+			si = cr[c] * fi[f] + ci[c] * fr[f] + (1l<<(shift-1));
+			sr >>= shift;
+			si >>= shift;
+
+			er = sr - (1l<<(CWIDTH-2)) * cos(W);
+			ei = si - (1l<<(CWIDTH-2)) * sin(W);
+			if (sqrt(er*er + ei*ei) > 2.0) {
+				printf("FAIL: TWIDDLE %d IS OFF BY %.2f LSBs\n",
+					k, sqrt(er*er + ei*ei));
+				exit(EXIT_FAILURE);
+			}
+
+			m_coef[k] = (ubits(sr, CWIDTH) << CWIDTH)
+					| ubits(si, CWIDTH);
+		}
+	}
+	// }}}
+#elif	defined(QTRWAVE)
+	// gen_qtrwave
+	// {{{
+	// Writes cos(2 pi j / 2^(LGSPAN+1)), for the quarter wave j < SPANLEN/2,
+	// as unsigned CWIDTH-1 bit values.  Each twiddle factor is then folded
+	// out of this table as the stage does: the cosine from entry j, and the
+	// sine from entry SPANLEN/2-j, with the second quarter rotated by -j.
+	// Every one of these must be within an LSB of the ideal.
+	void	gen_qtrwave(void) {
+		const	int	QTRLEN = SPANLEN/2;
+		long	qtr[SPANLEN/2];
+		FILE	*fp;
+
+		unlink(COEFFILE);
+		fp = fopen(COEFFILE, "w");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not write %s\n", COEFFILE);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int j=0; j<QTRLEN; j++) {
+			qtr[j] = llround((1l<<(CWIDTH-2))
+					* cos(M_PI * (double)j / SPANLEN));
+			fprintf(fp, "%0*lx\n", (CWIDTH-1+3)/4, qtr[j]);
+		}
+
+		fclose(fp);
+
+		for(int k=0; k<SPANLEN; k++) {
+			int	j = k & (QTRLEN-1);
+			long	wc, ws, cr, ci;
+			double	W = -M_PI * (double)k / SPANLEN, er, ei;
+
+			wc = qtr[j];
+			ws = (j == 0) ? 0 : qtr[QTRLEN-j];
+			if (k < QTRLEN) {
+				cr =  wc; ci = -ws;
+			} else {
+				cr = -ws; ci = -wc;
+			}
+
+			er = cr - (1l<<(CWIDTH-2)) * cos(W);
+			ei = ci - (1l<<(CWIDTH-2)) * sin(W);
+			if ((fabs(er) > 1.0)||(fabs(ei) > 1.0)) {
+				printf("FAIL: TWIDDLE %d IS OFF BY (%.2f,%.2f) LSBs\n",
+					k, er, ei);
+				exit(EXIT_FAILURE);
+			}
+
+			m_coef[k] = (ubits(cr, CWIDTH) << CWIDTH)
+					| ubits(ci, CWIDTH);
+		}
+	}
+	// }}}
+#endif
+
+	// coef -- the twiddle factor for address k of the span
+	long	coef(int k) {
+#if	defined(TWIDGEN) || defined(QTRWAVE)
+		return m_coef[k & SPANMASK];
+#else
+		return m_ftstage->cmem[k & SPANMASK];
+#endif
+	}
+
 	void	opentrace(const char *vcdname) {
 		if (!m_trace) {
 			m_trace = new VerilatedVcdC;
@@ -280,7 +469,7 @@ assert(OWIDTH == IWIDTH+1);
 			m_iaddr = 0;
 		}
 
-		cv = m_ftstage->cmem[m_iaddr & SPANMASK];
+		cv = coef(m_iaddr);
 		bc = m_iaddr & (1<<LGSPAN);
 		if (!bc)
 			m_vals[m_iaddr & (SPANMASK)] = i_data;
@@ -309,7 +498,7 @@ assert(OWIDTH == IWIDTH+1);
 			unsigned long	ib_av, ib_bv, ib_cv;
 			ib_av = m_vals[ib_addr&SPANMASK];
 			ib_bv = i_data; // m_vals[(m_iaddr-m_ib_offset+(1<<(LGSPAN-1)))&(SPANMASK)];
-			ib_cv = m_ftstage->cmem[(m_iaddr-m_ib_offset)&(SPANMASK)];
+			ib_cv = coef(m_iaddr-m_ib_offset);
 
 			assert(m_ftstage->ib_a == ib_av);
 			assert(m_ftstage->ib_b == ib_bv);
@@ -343,9 +532,7 @@ assert(OWIDTH == IWIDTH+1);
 			(long)m_ftstage->o_data,
 
 			m_ftstage->iaddr&FFTMASK,
-			(long)(ubits(m_ftstage->cmem[
-				m_ftstage->iaddr&(SPANMASK)],
-				2*CWIDTH)),
+			(long)(ubits(coef(m_ftstage->iaddr), 2*CWIDTH)),
 			(long)m_out[raddr]);
 
 		unsigned long	oba, obb;
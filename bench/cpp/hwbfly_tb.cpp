@@ -10,7 +10,11 @@
 //	other failure message otherwise.
 //
 //	This file depends upon verilator to both compile, run, and therefore
-//	test hwbfly.v
+//	test hwbfly.v.  Built with -DFOURMPY, it instead tests the Vhwbfly4
+//	model sw/Makefile verilates from the hwbfly.v of an fftgen --dsp
+//	core, for a 17x17 DSP.  Its third multiply would then take twice the
+//	DSPs of the others, so the butterfly forms its complex product from
+//	four multiplies instead.
 //
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
@@ -45,13 +49,24 @@
 
 #include "verilated.h"
 #include "verilated_vcd_c.h"
-#include "Vhwbfly.h"
 #include "twoc.h"
 #include "fftsize.h"
 
+#ifdef	FOURMPY
+#include "Vhwbfly4.h"
+typedef	Vhwbfly4	TSTCLASS;
+#else
+#include "Vhwbfly.h"
+typedef	Vhwbfly		TSTCLASS;
+#endif
+
 #ifdef	ROOT_VERILATOR
 
+#ifdef	FOURMPY
+#include "Vhwbfly4___024root.h"
+#else
 #include "Vhwbfly___024root.h"
+#endif
 
 #define	VVAR(A)	rootp->hwbfly__DOT_ ## A
 
@@ -67,7 +82,7 @@
 
 class	HWBFLY_TB {
 public:
-	Vhwbfly		*m_bfly;
+	TSTCLASS	*m_bfly;
 	VerilatedVcdC	*m_trace;
 	unsigned long	m_left[64], m_right[64];
 	bool		m_aux[64];
@@ -78,7 +93,7 @@ public:
 	HWBFLY_TB(void) {
 		Verilated::traceEverOn(true);
 		m_trace = NULL;
-		m_bfly = new Vhwbfly;
+		m_bfly = new TSTCLASS;
 		m_addr = 0;
 		m_syncd = 0;
 		m_tickcount = 0;
@@ -196,7 +211,9 @@ public:
 			m_bfly->o_left,
 			m_bfly->o_right,
 			m_bfly->o_aux);
-#if (FFT_CKPCE == 1)
+#if	defined(FOURMPY)
+		// The four multiply form has no rp_one, rp_two, or rp_three
+#elif (FFT_CKPCE == 1)
 		printf(", p1 = 0x%08lx p2 = 0x%08lx, p3 = 0x%08lx",
 #define	rp_one		VVAR(_CKPCE_ONE__DOT__rp_one)
 #define	rp_two		VVAR(_CKPCE_ONE__DOT__rp_two)
@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	lanebrev_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the bit reversal stage of the four and eight
+//		samples per clock FFTs (fftgen -4 or -8).  This file may be
+//	run autonomously.  If so, the last line output will either read
+//	"SUCCESS" on success, or some other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test that bitreverse.v, built with its default parameters and renamed
+//	Vlanebrev so as not to collide with the single lane bitreverse.  The
+//	NLANES samples of each clock are taken to be consecutive, sample zero
+//	in the high order bits, and the whole frame is then bit reversed.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vlanebrev.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of bitreverse.v
+#define	LGSIZE	6
+#define	WIDTH	24
+#define	LGLANES	2
+
+#define	NLANES	(1<<LGLANES)
+#define	FRAMELEN	(1<<LGSIZE)	// Samples per frame
+
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+unsigned long	bitrev(const int nbits, const unsigned long vl) {
+	unsigned long	r = 0;
+	unsigned long	val = vl;
+
+	for(int k=0; k<nbits; k++) {
+		r <<= 1;
+		r |= (val & 1);
+		val >>= 1;
+	}
+
+	return r;
+}
+
+class	LANEBREV_TB {
+public:
+	Vlanebrev	*m_brev;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	LANEBREV_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_brev = new Vlanebrev;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_brev->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_brev->i_clk = 0;
+		m_brev->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_brev->i_clk = 1;
+		m_brev->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_brev->i_clk = 0;
+		m_brev->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_brev->i_ce)&&(nkce>0)) {
+			m_brev->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_brev->i_ce = 1;
+		}
+	}
+
+	// setlane, getlane
+	// {{{
+	// The lanes are packed into one wide port, lane zero on top.  Lane k
+	// starts (NLANES-1-k)*2*WIDTH bits up from the bottom.
+	void	setlane(const int k, const unsigned long v) {
+		int	base = (NLANES-1-k)*2*WIDTH;
+
+		for(int b=0; b<2*WIDTH; b++) {
+			int		bit = base + b;
+			unsigned	msk = 1u << (bit & 31);
+
+			if ((v >> b) & 1)
+				m_brev->i_in[bit >> 5] |= msk;
+			else
+				m_brev->i_in[bit >> 5] &= ~msk;
+		}
+	}
+
+	unsigned long	getlane(const int k) {
+		int		base = (NLANES-1-k)*2*WIDTH;
+		unsigned long	v = 0;
+
+		for(int b=0; b<2*WIDTH; b++) {
+			int	bit = base + b;
+
+			if ((m_brev->o_out[bit >> 5] >> (bit & 31)) & 1)
+				v |= (1ul << b);
+		}
+
+		return v;
+	}
+	// }}}
+
+	void	reset(void) {
+		m_brev->i_ce     = 0;
+		for(int k=0; k<NLANES; k++)
+			setlane(k, 0);
+		m_brev->i_reset  = 1;
+		tick();
+		m_brev->i_reset  = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	void	check_results(void) {
+		// The first output comes one frame after the first input,
+		// when the first frame has been fully written
+		if ((!m_syncd)&&(m_brev->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			if (m_iaddr != FRAMELEN + NLANES) {
+				printf("FAIL: FIRST SYNC AFTER %d INPUTS, NOT %d\n",
+					m_iaddr, FRAMELEN + NLANES);
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > FRAMELEN + NLANES) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_brev->o_sync != ((m_oaddr & (FRAMELEN-1)) == 0)) {
+			printf("BAD O-SYNC, k = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int k=0; k<NLANES; k++) {
+			unsigned long	exp;
+
+			exp = m_in[((m_oaddr & (-FRAMELEN))
+				+ bitrev(LGSIZE, m_oaddr & (FRAMELEN-1)))&LOGMSK];
+			if (getlane(k) != exp) {
+				printf("FAIL: k = %d, LANE %d = %012lx(sut) != %012lx(exp)\n",
+					m_oaddr, k, getlane(k), exp);
+				exit(EXIT_FAILURE);
+			}
+
+			m_oaddr++;
+		}
+	}
+
+	void	test(const unsigned long *data) {
+		m_brev->i_ce = 1;
+		for(int k=0; k<NLANES; k++) {
+			setlane(k, ubits(data[k], 2*WIDTH));
+			m_in[(m_iaddr++)&LOGMSK] = ubits(data[k], 2*WIDTH);
+		}
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: IN = %012lx..., OUT = %012lx..., SYNC=%d\n",
+				m_iaddr-NLANES, m_in[(m_iaddr-NLANES)&LOGMSK],
+				getlane(0), m_brev->o_sync);
+
+		check_results();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	LANEBREV_TB	*tb = new LANEBREV_TB;
+
+	// tb->opentrace("lanebrev.vcd");
+	tb->reset();
+
+	// A counter, so any failure is easy to read, then random data
+	for(int k=0; k<4*FRAMELEN; k+=NLANES) {
+		unsigned long	data[NLANES];
+
+		for(int n=0; n<NLANES; n++)
+			data[n] = k+n;
+		tb->test(data);
+	}
+
+	for(int k=0; k<64*FRAMELEN; k+=NLANES) {
+		unsigned long	data[NLANES];
+
+		for(int n=0; n<NLANES; n++)
+			data[n] = ((unsigned long)rand() << WIDTH) ^ rand();
+		tb->test(data);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
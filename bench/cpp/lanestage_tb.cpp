@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	lanestage_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the lanestage.v subfile of the four and eight
+//		samples per clock FFTs (fftgen -4 or -8), the stage that
+//	pairs consecutive samples within a lane.  This file may be run
+//	autonomously.  If so, the last line output will either read "SUCCESS"
+//	on success, or some other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test lanestage.v.  As with crossbfly_tb, sw/Makefile verilates it with
+//	a twiddle factor other than its default of one: -j.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vlanestage.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of lanestage.v, save for the
+// twiddle factor, which needs to match the one given to verilator
+#define	IWIDTH	16
+#define	CWIDTH	20
+#define	OWIDTH	(IWIDTH+1)
+#define	SHIFT	0
+#define	COEF_R	0
+#define	COEF_I	(-(1<<(CWIDTH-2)))
+
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+class	LANESTAGE_TB {
+public:
+	Vlanestage	*m_stage;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	LANESTAGE_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_stage = new Vlanestage;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_stage->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_stage->i_clk = 1;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_stage->i_ce)&&(nkce>0)) {
+			m_stage->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_stage->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_stage->i_ce    = 0;
+		m_stage->i_sync  = 0;
+		m_stage->i_data  = 0;
+		m_stage->i_reset = 1;
+		tick();
+		m_stage->i_reset = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	// expected -- what the stage should produce for output k
+	// {{{
+	// Outputs come out in pairs, from pairs of inputs.  The first of each
+	// is the sum of the two inputs, the second their difference times
+	// the twiddle factor.
+	unsigned long	expected(int k) {
+		int	base = k & -2;
+		long	ar, ai, br, bi, rv, iv;
+
+		ar = sbits(m_in[(base  )&LOGMSK] >> IWIDTH, IWIDTH);
+		ai = sbits(m_in[(base  )&LOGMSK], IWIDTH);
+		br = sbits(m_in[(base+1)&LOGMSK] >> IWIDTH, IWIDTH);
+		bi = sbits(m_in[(base+1)&LOGMSK], IWIDTH);
+
+		if (0 == (k & 1)) {
+			rv = (ar + br) << (CWIDTH-2);
+			iv = (ai + bi) << (CWIDTH-2);
+		} else {
+			rv = (ar - br) * COEF_R - (ai - bi) * COEF_I;
+			iv = (ar - br) * COEF_I + (ai - bi) * COEF_R;
+		}
+
+		rv = convround(rv, IWIDTH+CWIDTH+2, OWIDTH, SHIFT+3);
+		iv = convround(iv, IWIDTH+CWIDTH+2, OWIDTH, SHIFT+3);
+
+		return (ubits(rv, OWIDTH) << OWIDTH) | ubits(iv, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_stage->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 16) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		// A lane stage's frame is a single pair, so o_sync marks the
+		// start of every pair
+		if (m_stage->o_sync != ((m_oaddr & 1) == 0)) {
+			printf("BAD O-SYNC, k = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((m_oaddr | 1) >= m_iaddr) {
+			printf("OUTPUT %d PRODUCED BEFORE ITS INPUTS WERE GIVEN\n",
+				m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((unsigned long)m_stage->o_data != expected(m_oaddr)) {
+			printf("FAIL: k = %d, O_DATA = %0*lx(sut) != %0*lx(exp)\n",
+				m_oaddr, (2*OWIDTH+3)/4,
+				(unsigned long)m_stage->o_data,
+				(2*OWIDTH+3)/4, expected(m_oaddr));
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		m_stage->i_ce   = 1;
+		m_stage->i_sync = (m_iaddr == 0);
+		m_stage->i_data = ubits(data, 2*IWIDTH);
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*IWIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: ISYNC=%d, IN = %08lx, OUT =%09lx, SYNC=%d\n",
+				m_iaddr-1, m_stage->i_sync,
+				(unsigned long)m_stage->i_data,
+				(unsigned long)m_stage->o_data,
+				m_stage->o_sync);
+
+		check_results();
+	}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+
+	void	random_test(void) {
+		// Keep the inputs to half scale, as they would be within an
+		// FFT, so the product can't overflow
+		test(sbits(rand(), IWIDTH-1), sbits(rand(), IWIDTH-1));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	LANESTAGE_TB	*tb = new LANESTAGE_TB;
+	const	int	HALF = (1<<(IWIDTH-2));
+
+	// tb->opentrace("lanestage.vcd");
+	tb->reset();
+
+	// Impulses, into either half of a pair, on either axis
+	for(int k=0; k<8; k++) {
+		int	v = (k&4) ? -HALF : HALF;
+
+		tb->test(((k&3)==0) ? v : 0, ((k&3)==1) ? v : 0);
+		tb->test(((k&3)==2) ? v : 0, ((k&3)==3) ? v : 0);
+	}
+
+	// The half scale extremes
+	tb->test( HALF-1,  HALF-1);
+	tb->test(-HALF, -HALF);
+	tb->test(-HALF,  HALF-1);
+	tb->test( HALF-1, -HALF);
+
+	// Ones, to check the rounding
+	for(int k=0; k<16; k++) {
+		tb->test(k&1, -((k>>1)&1));
+		tb->test((k>>2)&1, -((k>>3)&1));
+	}
+
+	for(int k=0; k<4096; k++)
+		tb->random_test();
+
+	// Flush the last pairs through
+	for(int k=0; k<8; k++)
+		tb->test(0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -10,7 +10,8 @@
 //	some other failure message otherwise.
 //
 //	This file depends upon verilator to both compile, run, and therefore
-//	test shiftaddmpy.v
+//	test shiftaddmpy.v.  Built with -DBOOTHMPY, it instead tests the
+//	radix-4 Booth multiply, boothmpy.v, of fftgen --softmpy booth.
 //
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
@@ -51,12 +52,29 @@ typedef	Vshiftaddmpy	Vmpy;
 #define	AW	TST_SHIFTADDMPY_AW
 #define	BW	TST_SHIFTADDMPY_BW
 #define	DELAY	(TST_SHIFTADDMPY_AW+2)
+#elif	defined(BOOTHMPY)
+#include "Vboothmpy.h"
+typedef	Vboothmpy	Vmpy;
+// These need to match the default parameters of boothmpy.v
+#define	AW	TST_LONGBIMPY_AW
+#define	BW	TST_LONGBIMPY_BW
+// One clock per Booth digit of the narrower input
+#define	DELAY	((((AW<BW)?AW:BW)+1)/2)
+#else
+#ifdef	MPYCLASS
+// A longbimpy verilated by sw/Makefile with ROWS=MPYROWS and
+// OUTREGS=MPYOUTREGS, under a prefix of its own, MPYCLASS, declared in MPY_H
+#include MPY_H
+typedef	MPYCLASS	Vmpy;
 #else
 #include "Vlongbimpy.h"
 typedef	Vlongbimpy	Vmpy;
+#define	MPYROWS		TST_LONGBIMPY_ROWS
+#define	MPYOUTREGS	TST_LONGBIMPY_OUTREGS
+#endif
 #define	AW	TST_LONGBIMPY_AW
 #define	BW	TST_LONGBIMPY_BW
-#define	DELAY	((AW/2)+(AW&1)+2)
+#define	DELAY	(((AW/2)+(AW&1)+MPYROWS-1)/MPYROWS + 2 + MPYOUTREGS)
 #endif
 
 #include "twoc.h"
@@ -0,0 +1,345 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	realstage_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the realstage.v subfile of the real FFT
+//		(fftgen -r).  This file may be run autonomously.  If so, the
+//	last line output will either read "SUCCESS" on success, or some other
+//	failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test realstage.v, built with its default parameters.  It writes the
+//	coefficient file realstage.v reads, cmem_rl2048.hex, itself.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vrealstage.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of realstage.v
+#define	IWIDTH	16
+#define	CWIDTH	20
+#define	OWIDTH	(IWIDTH+1)
+#define	LGSIZE	10
+#define	COEFFILE	"cmem_rl2048.hex"
+
+// The butterfly within works on one more bit than the input, and produces
+// one more bit than that
+#define	BIWIDTH	(IWIDTH+1)
+#define	BOWIDTH	(IWIDTH+2)
+
+#define	NZ	(1<<LGSIZE)	// The size of the complex FFT, N/2
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+unsigned long bitrev(const int nbits, const unsigned long vl) {
+	unsigned long	r = 0;
+	unsigned long	val = vl;
+
+	for(int k=0; k<nbits; k++) {
+		r<<= 1;
+		r |= (val & 1);
+		val >>= 1;
+	}
+
+	return r;
+}
+
+class	REALSTAGE_TB {
+public:
+	Vrealstage	*m_stage;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	long		m_coef_r[NZ], m_coef_i[NZ];
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	REALSTAGE_TB(void) {
+		// The coefficients must be in place before the design reads
+		// them
+		gen_coefs();
+
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_stage = new Vrealstage;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	// gen_coefs
+	// {{{
+	// The coefficients -j W_N^k, k = 0 ... N/2-1, as fftgen's
+	// gen_realcoeffs() would produce them
+	void	gen_coefs(void) {
+		FILE	*fp;
+
+		unlink(COEFFILE);
+		fp = fopen(COEFFILE, "w");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not write %s\n", COEFFILE);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int k=0; k<NZ; k++) {
+			double	W = -2.0 * M_PI * k / (2*NZ) - M_PI / 2.0;
+
+			m_coef_r[k] = llround((1l<<(CWIDTH-2)) * cos(W));
+			m_coef_i[k] = llround((1l<<(CWIDTH-2)) * sin(W));
+
+			fprintf(fp, "%0*lx\n", (2*CWIDTH+3)/4,
+				(ubits(m_coef_r[k], CWIDTH) << CWIDTH)
+				| ubits(m_coef_i[k], CWIDTH));
+		}
+
+		fclose(fp);
+	}
+	// }}}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_stage->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_stage->i_clk = 1;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_stage->i_ce)&&(nkce>0)) {
+			m_stage->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_stage->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_stage->i_ce    = 0;
+		m_stage->i_in    = 0;
+		m_stage->i_reset = 1;
+		tick();
+		m_stage->i_reset = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	// Z[k] of a frame, whose values arrive in bit reversed order
+	long	zr(int base, int k) {
+		return sbits(m_in[(base + bitrev(LGSIZE, k))&LOGMSK] >> IWIDTH,
+				IWIDTH);
+	}
+
+	long	zi(int base, int k) {
+		return sbits(m_in[(base + bitrev(LGSIZE, k))&LOGMSK], IWIDTH);
+	}
+
+	// expected -- X[k] = 1/2 [(Z[k]+Z*[N/2-k]) + (-j W^k)(Z[k]-Z*[N/2-k])]
+	// {{{
+	// Calculated bit for bit as the stage calculates it.  When k == 0,
+	// X[N/2] is returned in the imaginary half of X[0].
+	unsigned long	expected(int n) {
+		int	base = n & (-NZ), k = n & (NZ-1);
+		long	ar, ai, br, bi;
+		long	lr, li, dr, di, pr, pi, sr, si;
+
+		ar =  zr(base, k);
+		ai =  zi(base, k);
+		br =  zr(base, (NZ-k)&(NZ-1));
+		bi = -zi(base, (NZ-k)&(NZ-1));
+
+		// The butterfly: the sum, and the product of the difference
+		lr = ar + br;
+		li = ai + bi;
+		dr = ar - br;
+		di = ai - bi;
+
+		pr = dr * m_coef_r[k] - di * m_coef_i[k];
+		pi = dr * m_coef_i[k] + di * m_coef_r[k];
+
+		lr = convround(lr << (CWIDTH-2), CWIDTH+BIWIDTH+3, BOWIDTH, 4);
+		li = convround(li << (CWIDTH-2), CWIDTH+BIWIDTH+3, BOWIDTH, 4);
+		pr = convround(pr, CWIDTH+BIWIDTH+3, BOWIDTH, 4);
+		pi = convround(pi, CWIDTH+BIWIDTH+3, BOWIDTH, 4);
+
+		// Add the two halves, and divide by two
+		sr = lr + pr;
+		if (k == 0)
+			si = lr - pr;
+		else
+			si = li + pi;
+
+		sr = convround(sr, IWIDTH+3, OWIDTH, 1);
+		si = convround(si, IWIDTH+3, OWIDTH, 1);
+
+		return (ubits(sr, OWIDTH) << OWIDTH) | ubits(si, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_stage->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 3*NZ) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_stage->o_sync != ((m_oaddr & (NZ-1)) == 0)) {
+			printf("BAD O-SYNC, n = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((m_oaddr & (-NZ)) + NZ > m_iaddr) {
+			printf("OUTPUT %d PRODUCED BEFORE ITS FRAME WAS GIVEN\n",
+				m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((unsigned long)m_stage->o_out != expected(m_oaddr)) {
+			printf("FAIL: n = %d, O_OUT = %0*lx(sut) != %0*lx(exp)\n",
+				m_oaddr, (2*OWIDTH+3)/4,
+				(unsigned long)m_stage->o_out,
+				(2*OWIDTH+3)/4, expected(m_oaddr));
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		m_stage->i_ce = 1;
+		m_stage->i_in = ubits(data, 2*IWIDTH);
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*IWIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%5d: IN = %08lx, OUT =%09lx, SYNC=%d\n",
+				m_iaddr-1, (unsigned long)m_stage->i_in,
+				(unsigned long)m_stage->o_out,
+				m_stage->o_sync);
+
+		check_results();
+	}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+
+	void	random_test(void) {
+		test(sbits(rand(), IWIDTH), sbits(rand(), IWIDTH));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	REALSTAGE_TB	*tb = new REALSTAGE_TB;
+	const	int	AMP = (1<<(IWIDTH-2));
+	const	int	MAXV = (1<<(IWIDTH-1))-1, MINV = -(1<<(IWIDTH-1));
+
+	// tb->opentrace("realstage.vcd");
+	tb->reset();
+
+	// An impulse, at Z[0] and then at Z[1]
+	for(int n=0; n<NZ; n++)
+		tb->test((n == 0) ? AMP : 0, (n == 0) ? -AMP : 0);
+	for(int n=0; n<NZ; n++)
+		tb->test((n == NZ/2) ? AMP : 0, 0);
+
+	// The extremes, to check that nothing overflows
+	for(int n=0; n<NZ; n++)
+		tb->test(MAXV, MINV);
+	for(int n=0; n<NZ; n++)
+		tb->test(MINV, MAXV);
+
+	for(int k=0; k<8*NZ; k++)
+		tb->random_test();
+
+	// Flush the last frame through
+	for(int k=0; k<2*NZ; k++)
+		tb->test(0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	twidrom_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the twidrom.v subfile of the shared twiddle
+//		ROM FFT (fftgen -C).  This file may be run autonomously.  If
+//	so, the last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test twidrom.v, built with its default parameters.  Built with
+//	-DCKPCE=3, it instead tests the Vtwidrom3 model sw/Makefile verilates
+//	with CKPCE=3 and five stages, where each read port takes turns serving
+//	two of them.  The test bench writes the coefficient file twidrom.v
+//	reads, cmem_1024.hex, itself.
+//
+//	Built with -DROMTWID, it tests the Vromtwid model instead: the
+//	twidrom.v of a core built with fftgen -C --cmem rom, verilated as that
+//	core's first stage uses it.  Its coefficients are compiled in, from
+//	coefrom.vh, so there's no file to write, but they must still match
+//	those this test bench would've written.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "twoc.h"
+
+#ifndef	CKPCE
+#define	CKPCE	1
+#endif
+
+#if	CKPCE > 2
+#include "Vtwidrom3.h"
+typedef	Vtwidrom3	TSTCLASS;
+#define	NSTAGES	5
+#elif	defined(ROMTWID)
+#include "Vromtwid.h"
+typedef	Vromtwid	TSTCLASS;
+#define	NSTAGES	2
+#else
+#include "Vtwidrom.h"
+typedef	Vtwidrom	TSTCLASS;
+#define	NSTAGES	2
+#endif
+
+#ifdef	ROMTWID
+// These need to match the parameters sw/Makefile gives twidrom.v
+#define	CWIDTH	19
+#define	LGSPAN	7
+#define	COEFFILE	"cmem_256.hex"
+#else
+// These need to match the default parameters of twidrom.v
+#define	CWIDTH	20
+#define	LGSPAN	9
+#define	COEFFILE	"cmem_1024.hex"
+#endif
+
+#define	NCOEFS	(1<<LGSPAN)
+
+const	bool	gbl_debug = false;
+
+class	TWIDROM_TB {
+public:
+	TSTCLASS	*m_rom;
+	VerilatedVcdC	*m_trace;
+	long		m_coef_r[NCOEFS], m_coef_i[NCOEFS];
+	unsigned	m_addr[NSTAGES];
+	uint64_t	m_tickcount;
+
+	TWIDROM_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		// The coefficients must be written before the ROM reads them,
+		// unless they're compiled in
+		gen_coefs();
+		m_rom = new TSTCLASS;
+		for(int k=0; k<NSTAGES; k++)
+			m_addr[k] = 0;
+		m_tickcount = 0;
+	}
+
+	// gen_coefs
+	// {{{
+	// The twiddle factors of a 2^(LGSPAN+1) point stage, as fftgen's
+	// gen_coeffs() would produce them
+	void	gen_coefs(void) {
+		FILE	*fp = NULL;
+
+#ifndef	ROMTWID
+		unlink(COEFFILE);
+		fp = fopen(COEFFILE, "w");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not write %s\n", COEFFILE);
+			exit(EXIT_FAILURE);
+		}
+#endif
+
+		for(int k=0; k<NCOEFS; k++) {
+			double	W = -M_PI * (double)k / NCOEFS;
+
+			m_coef_r[k] = llround((1l<<(CWIDTH-2)) * cos(W));
+			m_coef_i[k] = llround((1l<<(CWIDTH-2)) * sin(W));
+
+			if (fp)
+				fprintf(fp, "%0*lx\n", (2*CWIDTH+3)/4,
+					(ubits(m_coef_r[k], CWIDTH) << CWIDTH)
+					| ubits(m_coef_i[k], CWIDTH));
+		}
+
+		if (fp)
+			fclose(fp);
+	}
+	// }}}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_rom->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_rom->i_clk = 0;
+		m_rom->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_rom->i_clk = 1;
+		m_rom->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_rom->i_clk = 0;
+		m_rom->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	// cetick
+	// {{{
+	// An i_ce, followed by at least the CKPCE-1 idle clocks twidrom.v
+	// depends upon.  The addresses are held across all of them, just as
+	// fftstage holds them until its next i_ce.
+	void	cetick(void) {
+		int	nkce;
+
+		m_rom->i_ce = 1;
+		tick();
+		m_rom->i_ce = 0;
+
+		nkce = (rand()&1) + CKPCE-1;
+		for(int kce = 0; kce < nkce; kce++)
+			tick();
+	}
+	// }}}
+
+	// getcoef
+	// {{{
+	// The coefficient the ROM is returning to stage k.  Stage zero's is
+	// at the bottom of o_coef.
+	unsigned long	getcoef(const int k) {
+		int		base = k*2*CWIDTH;
+		unsigned long	v = 0;
+
+		for(int b=0; b<2*CWIDTH; b++) {
+			int	bit = base + b;
+
+			if ((m_rom->o_coef[bit >> 5] >> (bit & 31)) & 1)
+				v |= (1ul << b);
+		}
+
+		return v;
+	}
+	// }}}
+
+	// expected -- the coefficient stage k should have been given
+	unsigned long	expected(const int k) {
+		unsigned	a = m_addr[k];
+
+		return (ubits(m_coef_r[a], CWIDTH) << CWIDTH)
+			| ubits(m_coef_i[a], CWIDTH);
+	}
+
+	void	check_results(void) {
+		for(int k=0; k<NSTAGES; k++) {
+			if (getcoef(k) != expected(k)) {
+				printf("FAIL: STAGE %d, ADDR %03x, O_COEF = %0*lx(sut) != %0*lx(exp)\n",
+					k, m_addr[k],
+					(2*CWIDTH+3)/4, getcoef(k),
+					(2*CWIDTH+3)/4, expected(k));
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	// test
+	// {{{
+	// Ask for a new coefficient for every stage, and then check that
+	// each has its coefficient before its next i_ce
+	void	test(const unsigned *addr) {
+		unsigned long	a = 0;
+
+		for(int k=NSTAGES-1; k>=0; k--) {
+			m_addr[k] = addr[k] & (NCOEFS-1);
+			a = (a << LGSPAN) | m_addr[k];
+		}
+		m_rom->i_addr = a;
+
+		cetick();
+
+		if (gbl_debug) {
+			printf("ADDR = %0*lx, COEF =", (NSTAGES*LGSPAN+3)/4, a);
+			for(int k=0; k<NSTAGES; k++)
+				printf(" %0*lx", (2*CWIDTH+3)/4, getcoef(k));
+			printf("\n");
+		}
+
+		check_results();
+	}
+	// }}}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	TWIDROM_TB	*tb = new TWIDROM_TB;
+	unsigned	addr[NSTAGES];
+
+	// tb->opentrace("twidrom.vcd");
+
+	// Each stage walking through the table as an fftstage would, stage
+	// k reading every 2^k'th entry
+	for(int n=0; n<2*NCOEFS; n++) {
+		for(int k=0; k<NSTAGES; k++)
+			addr[k] = n << k;
+		tb->test(addr);
+	}
+
+	// Every stage on every entry, while the others read elsewhere
+	for(int k=0; k<NSTAGES; k++)
+		for(int n=0; n<NCOEFS; n++) {
+			for(int j=0; j<NSTAGES; j++)
+				addr[j] = (j == k) ? n : (NCOEFS-1-n);
+			tb->test(addr);
+		}
+
+	for(int n=0; n<16*NCOEFS; n++) {
+		for(int k=0; k<NSTAGES; k++)
+			addr[k] = rand();
+		tb->test(addr);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -0,0 +1,312 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	twidstage_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the twidstage.v subfile of the radix-2^2 and
+//		2^3 FFTs (fftgen -R 22, or -R 23).  This file may be run
+//	autonomously.  If so, the last line output will either read "SUCCESS"
+//	on success, or some other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test twidstage.v, built with its default parameters.  It writes the
+//	coefficient file twidstage.v reads, cmem_r4_64.hex, itself.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vtwidstage.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of twidstage.v
+#define	IWIDTH	16
+#define	CWIDTH	20
+#define	OWIDTH	IWIDTH
+#define	SHIFT	1
+#define	LGWIDTH	6
+#define	COEFFILE	"cmem_r4_64.hex"
+
+// The radix of the group of stages before us, 2^GROUP
+#define	GROUP	2
+
+#define	NCOEFS	(1<<LGWIDTH)
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+class	TWIDSTAGE_TB {
+public:
+	Vtwidstage	*m_stage;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	long		m_coef_r[NCOEFS], m_coef_i[NCOEFS];
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	TWIDSTAGE_TB(void) {
+		// The coefficients must be in place before the design reads
+		// them
+		gen_coefs();
+
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_stage = new Vtwidstage;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	// gen_coefs
+	// {{{
+	// The twiddle factors following a group of 2^GROUP stages, as fftgen's
+	// gen_twiddles() would produce them: within each of the 2^GROUP blocks
+	// of NCOEFS/2^GROUP values, coefficient n of block b rotates by
+	// W^(n*bitrev(b)).
+	void	gen_coefs(void) {
+		const	int	q = NCOEFS >> GROUP;
+		FILE	*fp;
+
+		unlink(COEFFILE);
+		fp = fopen(COEFFILE, "w");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not write %s\n", COEFFILE);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int k=0; k<NCOEFS; k++) {
+			int	blk = k / q, rev = 0;
+			double	W;
+
+			for(int b=0; b<GROUP; b++)
+				if (blk & (1<<b))
+					rev |= 1<<(GROUP-1-b);
+			W = -2.0 * M_PI * (double)((k % q) * rev) / NCOEFS;
+
+			m_coef_r[k] = llround((1l<<(CWIDTH-2)) * cos(W));
+			m_coef_i[k] = llround((1l<<(CWIDTH-2)) * sin(W));
+
+			fprintf(fp, "%0*lx\n", (2*CWIDTH+3)/4,
+				(ubits(m_coef_r[k], CWIDTH) << CWIDTH)
+				| ubits(m_coef_i[k], CWIDTH));
+		}
+
+		fclose(fp);
+	}
+	// }}}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_stage->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_stage->i_clk = 1;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_stage->i_ce)&&(nkce>0)) {
+			m_stage->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_stage->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_stage->i_ce    = 0;
+		m_stage->i_sync  = 0;
+		m_stage->i_data  = 0;
+		m_stage->i_reset = 1;
+		tick();
+		m_stage->i_reset = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	// expected -- y[k] = x[k] * c[k], rounded as the butterfly rounds
+	// {{{
+	unsigned long	expected(int k) {
+		long	xr, xi, cr, ci, pr, pi;
+
+		xr = sbits(m_in[k&LOGMSK] >> IWIDTH, IWIDTH);
+		xi = sbits(m_in[k&LOGMSK], IWIDTH);
+		cr = m_coef_r[k & (NCOEFS-1)];
+		ci = m_coef_i[k & (NCOEFS-1)];
+
+		pr = xr * cr - xi * ci;
+		pi = xr * ci + xi * cr;
+
+		pr = convround(pr, CWIDTH+IWIDTH+3, OWIDTH, SHIFT+4);
+		pi = convround(pi, CWIDTH+IWIDTH+3, OWIDTH, SHIFT+4);
+
+		return (ubits(pr, OWIDTH) << OWIDTH) | ubits(pi, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_stage->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 4*NCOEFS) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_stage->o_sync != ((m_oaddr & (NCOEFS-1)) == 0)) {
+			printf("BAD O-SYNC, k = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if (m_oaddr >= m_iaddr) {
+			printf("OUTPUT %d PRODUCED BEFORE ITS INPUT WAS GIVEN\n",
+				m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((unsigned long)m_stage->o_data != expected(m_oaddr)) {
+			printf("FAIL: k = %d, O_DATA = %0*lx(sut) != %0*lx(exp)\n",
+				m_oaddr, (2*OWIDTH+3)/4,
+				(unsigned long)m_stage->o_data,
+				(2*OWIDTH+3)/4, expected(m_oaddr));
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		m_stage->i_ce   = 1;
+		// Only the first sample is marked.  The stage should keep
+		// track of every frame thereafter on its own.
+		m_stage->i_sync = (m_iaddr == 0);
+		m_stage->i_data = ubits(data, 2*IWIDTH);
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*IWIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: ISYNC=%d, IN = %08lx, OUT =%08lx, SYNC=%d\n",
+				m_iaddr-1, m_stage->i_sync,
+				(unsigned long)m_stage->i_data,
+				(unsigned long)m_stage->o_data,
+				m_stage->o_sync);
+
+		check_results();
+	}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+
+	void	random_test(void) {
+		test(sbits(rand(), IWIDTH), sbits(rand(), IWIDTH));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	TWIDSTAGE_TB	*tb = new TWIDSTAGE_TB;
+	const	int	AMP = (1<<(IWIDTH-2));
+
+	// tb->opentrace("twidstage.vcd");
+	tb->reset();
+
+	// A constant, to read out every twiddle factor
+	for(int k=0; k<NCOEFS; k++)
+		tb->test(AMP, 0);
+	for(int k=0; k<NCOEFS; k++)
+		tb->test(0, -AMP);
+
+	// A tone, at the rate of the twiddles
+	for(int k=0; k<4*NCOEFS; k++) {
+		double	W = 2.0 * M_PI * k * 5 / NCOEFS;
+		tb->test((int)(AMP * cos(W)), (int)(AMP * sin(W)));
+	}
+
+	for(int k=0; k<64*NCOEFS; k++)
+		tb->random_test();
+
+	// Flush the last outputs through
+	for(int k=0; k<NCOEFS; k++)
+		tb->test(0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -98,4 +98,16 @@ unsigned long	rndbits(const long val, const int bits_in, const int bits_out) {
 	} return r;
 }
 
-
+// convround -- the result of convround #(iw,ow,shift), as a signed value
+// {{{
+// Drops the top shift bits of an iw bit value, and then rounds the rest
+// to ow bits, rounding halfway values to the nearest even number.  Like the
+// Verilog, any overflow of the rounded result wraps.
+long	convround(const long val, const int iw, const int ow, const int shift) {
+	if (iw == ow)
+		return sbits(val, ow);
+	else if (iw-shift <= ow)
+		return sbits(val, iw-shift);
+	return sbits(rndbits(val, iw-shift, ow), ow);
+}
+// }}}
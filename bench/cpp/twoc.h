@@ -43,6 +43,8 @@
 extern	long	sbits(const long val, const int bits);
 extern	unsigned long	ubits(const long val, const int bits);
 extern	unsigned long	rndbits(const long val, const int bi, const int bo);
+extern	long	convround(const long val, const int iw, const int ow,
+			const int shift);
 
 #endif
 
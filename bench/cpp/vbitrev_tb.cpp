@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	vbitrev_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the variable size bit reversal stage, the
+//		bitreverse.v fftgen builds for a -z core.  This file may be
+//	run autonomously.  If so, the last line output will either read
+//	"SUCCESS" on success, or some other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test that bitreverse.v, built with its default parameters and renamed
+//	Vvbitrev so as not to collide with the fixed size bitreverse.  Every
+//	size from 2 up to 2^LGSIZE is checked, each following a reset.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vvbitrev.h"
+#include "twoc.h"
+#include "fftsize.h"
+
+// These need to match the default parameters of bitreverse.v
+#define	LGSIZE	5
+#define	WIDTH	24
+
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+unsigned long	bitrev(const int nbits, const unsigned long vl) {
+	unsigned long	r = 0;
+	unsigned long	val = vl;
+
+	for(int k=0; k<nbits; k++) {
+		r <<= 1;
+		r |= (val & 1);
+		val >>= 1;
+	}
+
+	return r;
+}
+
+class	VBITREV_TB {
+public:
+	Vvbitrev	*m_brev;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	int		m_iaddr, m_oaddr, m_lgsize;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	VBITREV_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_brev = new Vvbitrev;
+		m_iaddr = m_oaddr = 0;
+		m_lgsize = LGSIZE;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_brev->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_brev->i_clk = 0;
+		m_brev->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_brev->i_clk = 1;
+		m_brev->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_brev->i_clk = 0;
+		m_brev->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_brev->i_ce)&&(nkce>0)) {
+			m_brev->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_brev->i_ce = 1;
+		}
+	}
+
+	// reset
+	// {{{
+	// The size of the reversal, i_lgsize, may only change while the
+	// stage is held in reset
+	void	reset(const int lgsize) {
+		m_brev->i_ce     = 0;
+		m_brev->i_in     = 0;
+		m_brev->i_lgsize = lgsize;
+		m_brev->i_reset  = 1;
+		tick();
+		m_brev->i_reset  = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_lgsize = lgsize;
+		m_syncd = false;
+	}
+	// }}}
+
+	void	check_results(void) {
+		const	int	len = 1<<m_lgsize;
+		unsigned long	exp;
+
+		// The first output comes one frame after the first input,
+		// when the first frame has been fully written
+		if ((!m_syncd)&&(m_brev->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			if (m_iaddr != len+1) {
+				printf("FAIL: FIRST SYNC AFTER %d INPUTS, NOT %d\n",
+					m_iaddr, len+1);
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > len+1) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_brev->o_sync != ((m_oaddr & (len-1)) == 0)) {
+			printf("BAD O-SYNC, LGSIZE = %d, k = %d\n", m_lgsize,
+				m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		exp = m_in[((m_oaddr & (-len))
+				+ bitrev(m_lgsize, m_oaddr & (len-1)))&LOGMSK];
+		if ((unsigned long)m_brev->o_out != exp) {
+			printf("FAIL: LGSIZE = %d, k = %d, O_OUT = %012lx(sut) != %012lx(exp)\n",
+				m_lgsize, m_oaddr,
+				(unsigned long)m_brev->o_out, exp);
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		m_brev->i_ce = 1;
+		m_brev->i_in = ubits(data, 2*WIDTH);
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*WIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: IN = %012lx, OUT = %012lx, SYNC=%d\n",
+				m_iaddr-1, (unsigned long)m_brev->i_in,
+				(unsigned long)m_brev->o_out,
+				m_brev->o_sync);
+
+		check_results();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	VBITREV_TB	*tb = new VBITREV_TB;
+
+	// tb->opentrace("vbitrev.vcd");
+
+	// Walk through every size, from the largest down and then back up,
+	// so that each size follows both a larger and a smaller one
+	for(int pass=0; pass<2; pass++)
+	for(int k=1; k<=LGSIZE; k++) {
+		int	lgsize = (pass) ? k : (LGSIZE+1-k);
+
+		tb->reset(lgsize);
+
+		// A counter, then random data
+		for(int n=0; n<(4<<lgsize); n++)
+			tb->test(n);
+		for(int n=0; n<(8<<lgsize); n++)
+			tb->test(((unsigned long)rand() << WIDTH) ^ rand());
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
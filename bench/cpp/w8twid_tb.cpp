@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	w8twid_tb.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the w8twid.v subfile of the radix-2^3 FFT
+//		(fftgen -R 23).  This file may be run autonomously.  If so,
+//	the last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.
+//
+//	This file depends upon verilator to both compile, run, and therefore
+//	test w8twid.v, built with its default parameters.  Since the stage's
+//	constant multiplies are fixed when the core is built, the CWIDTH they
+//	were built for comes from the header of that same core, FFTSIZE_H
+//	(fftsize.h by default).
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vw8twid.h"
+#include "twoc.h"
+
+#ifdef	FFTSIZE_H
+#include FFTSIZE_H
+#else
+#include "fftsize.h"
+#endif
+
+// These need to match the default parameters of w8twid.v
+#define	IWIDTH	16
+#define	OWIDTH	IWIDTH
+#define	LGWIDTH	6
+#define	CWIDTH	TST_W8TWID_CWIDTH
+
+#define	FRAC	(CWIDTH-2)
+#define	PW	(IWIDTH+1+FRAC)
+#define	FRAMELEN	(1<<LGWIDTH)
+#define	LOGLEN	(1<<16)
+#define	LOGMSK	(LOGLEN-1)
+
+const	bool	gbl_debug = false;
+
+class	W8TWID_TB {
+public:
+	Vw8twid		*m_stage;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_in[LOGLEN];
+	long		m_k;
+	int		m_iaddr, m_oaddr;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	W8TWID_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_stage = new Vw8twid;
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+
+		// 1/sqrt(2), rounded as gen_coeff_value() rounds it
+		m_k = llround((1ll<<FRAC) * cos(M_PI/4.0));
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_stage->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount-2));
+		m_stage->i_clk = 1;
+		m_stage->eval();
+		if (m_trace)	m_trace->dump((vluint64_t)(10ul*m_tickcount));
+		m_stage->i_clk = 0;
+		m_stage->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	nkce;
+
+		tick();
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((m_stage->i_ce)&&(nkce>0)) {
+			m_stage->i_ce = 0;
+			for(int kce = 1; kce < nkce; kce++)
+				tick();
+			m_stage->i_ce = 1;
+		}
+	}
+
+	void	reset(void) {
+		m_stage->i_ce    = 0;
+		m_stage->i_sync  = 0;
+		m_stage->i_data  = 0;
+		m_stage->i_reset = 1;
+		tick();
+		m_stage->i_reset = 0;
+		tick();
+
+		m_iaddr = m_oaddr = 0;
+		m_syncd = false;
+	}
+
+	// expected -- y[k] = x[k] * W_8^t, rounded as the stage rounds
+	// {{{
+	// Within a group of three radix-2 stages spanning FRAMELEN samples,
+	// the top bit of k is k1, the first stage's output, and the next
+	// bit is k2, the second's.  The twiddle ahead of the third stage is
+	// then W_8^(k1+2*k2) for the second half of each of its spans, where
+	// the next bit, n3, is set, and one otherwise.
+	unsigned long	expected(int k) {
+		int	n = k & (FRAMELEN-1), t = 0;
+		long	xr, xi, rv, iv;
+
+		if ((n >> (LGWIDTH-3)) & 1)
+			t = ((n >> (LGWIDTH-1)) & 1)
+				+ 2 * ((n >> (LGWIDTH-2)) & 1);
+
+		xr = sbits(m_in[k&LOGMSK] >> IWIDTH, IWIDTH);
+		xi = sbits(m_in[k&LOGMSK], IWIDTH);
+
+		switch(t) {
+		case 0: rv = xr << FRAC; iv = xi << FRAC; break;
+		// (1-j)/sqrt(2)
+		case 1: rv = m_k * (xr + xi); iv = m_k * (xi - xr); break;
+		// -j
+		case 2: rv = xi << FRAC; iv = -xr << FRAC; break;
+		// (-1-j)/sqrt(2)
+		default: rv = m_k * (xi - xr); iv = -m_k * (xr + xi);
+			break;
+		}
+
+		rv = convround(rv, PW, OWIDTH, 1);
+		iv = convround(iv, PW, OWIDTH, 1);
+
+		return (ubits(rv, OWIDTH) << OWIDTH) | ubits(iv, OWIDTH);
+	}
+	// }}}
+
+	void	check_results(void) {
+		if ((!m_syncd)&&(m_stage->o_sync)) {
+			m_syncd = true;
+			m_oaddr = 0;
+			printf("VALID-SYNC!!\n");
+		}
+
+		if (!m_syncd) {
+			if (m_iaddr > 4*FRAMELEN) {
+				printf("NO SYNC PULSE!\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_stage->o_sync != ((m_oaddr & (FRAMELEN-1)) == 0)) {
+			printf("BAD O-SYNC, k = %d\n", m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if (m_oaddr >= m_iaddr) {
+			printf("OUTPUT %d PRODUCED BEFORE ITS INPUT WAS GIVEN\n",
+				m_oaddr);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((unsigned long)m_stage->o_data != expected(m_oaddr)) {
+			printf("FAIL: k = %d, O_DATA = %0*lx(sut) != %0*lx(exp)\n",
+				m_oaddr, (2*OWIDTH+3)/4,
+				(unsigned long)m_stage->o_data,
+				(2*OWIDTH+3)/4, expected(m_oaddr));
+			exit(EXIT_FAILURE);
+		}
+
+		m_oaddr++;
+	}
+
+	void	test(unsigned long data) {
+		m_stage->i_ce   = 1;
+		// Only the first sample is marked.  The stage should keep
+		// track of every frame thereafter on its own.
+		m_stage->i_sync = (m_iaddr == 0);
+		m_stage->i_data = ubits(data, 2*IWIDTH);
+		m_in[(m_iaddr++)&LOGMSK] = ubits(data, 2*IWIDTH);
+
+		cetick();
+
+		if (gbl_debug)
+			printf("k=%4d: ISYNC=%d, IN = %08lx, OUT =%08lx, SYNC=%d\n",
+				m_iaddr-1, m_stage->i_sync,
+				(unsigned long)m_stage->i_data,
+				(unsigned long)m_stage->o_data,
+				m_stage->o_sync);
+
+		check_results();
+	}
+
+	void	test(int ir, int ii) {
+		test((ubits(ir, IWIDTH) << IWIDTH) | ubits(ii, IWIDTH));
+	}
+
+	void	random_test(void) {
+		test(sbits(rand(), IWIDTH), sbits(rand(), IWIDTH));
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	W8TWID_TB	*tb = new W8TWID_TB;
+	const	int	MAXV = (1<<(IWIDTH-1))-1, MINV = -(1<<(IWIDTH-1));
+	const	int	AMP = (1<<(IWIDTH-2));
+
+	// tb->opentrace("w8twid.vcd");
+	tb->reset();
+
+	// A constant, to read out every twiddle factor
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(AMP, 0);
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(0, -AMP);
+
+	// The extremes.  With no more bits out than in, rotating these can
+	// overflow, and the result must then wrap just as it does here
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(MAXV, MAXV);
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(MINV, MINV);
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(MAXV, MINV);
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(MINV, MAXV);
+
+	for(int k=0; k<64*FRAMELEN; k++)
+		tb->random_test();
+
+	// Flush the last outputs through
+	for(int k=0; k<FRAMELEN; k++)
+		tb->test(0, 0);
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(0);
+}
@@ -60,16 +60,21 @@
 
 #include "defaults.h"
 #include "legal.h"
+#include "fftsink.h"
 #include "bitreverse.h"
 
-// build_snglbrev(fname, async_reset)
+// build_snglbrev(fname, async_reset, varsize)
 // {{{
-void	build_snglbrev(const char *fname, const bool async_reset) {
-	FILE	*fp = fopen(fname, "w");
+// If varsize is set, the bit reversal will take an i_lgsize input, and
+// reverse frames of any (power of two) size up to 2^LGSIZE.
+//
+int	build_snglbrev(const char *fname, const bool async_reset,
+			const bool varsize) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	std::string	resetw("i_reset");
@@ -93,25 +98,40 @@ SLASHLINE
 "//		from the dblreverse module in that this is just a simple and\n"
 "//	straightforward bitreverse, rather than one written to handle two\n"
 "//	words at once.\n"
-"//\n"
 "//\n%s"
-"//\n", modulename, prjname, creator);
+"//\n%s"
+"//\n", modulename, prjname,
+	(varsize) ? "//	This version takes an i_lgsize input, and reverses frames of\n"
+		"//	2^i_lgsize words (up to 2^LGSIZE) instead.  i_lgsize is only\n"
+		"//	allowed to change while the module is held in reset.\n"
+		"//\n" : "",
+	creator);
 	fprintf(fp, "%s", cpyleft);
 	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
 	fprintf(fp,
 "module	%s #(\n"
 	"\t\t// {{{\n"
-	"\t\tparameter\t\t\tLGSIZE=%d, WIDTH=24\n"
+	"\t\tparameter\t\t\tLGSIZE=%d, WIDTH=24",
+		modulename, TST_DBLREVERSE_LGSIZE);
+	if (varsize)
+		fprintf(fp, ",\n"
+	"\t\t// LGLGSIZE is the number of bits required to hold LGSIZE\n"
+	"\t\tparameter\t\t\tLGLGSIZE=4");
+	fprintf(fp, "\n"
 	"\t\t// }}}\n"
 	"\t) (\n"
 	"\t\t// {{{\n"
-	"\t\tinput\twire\t\t\ti_clk, %s, i_ce,\n"
+	"\t\tinput\twire\t\t\ti_clk, %s, i_ce,\n",
+		resetw.c_str());
+	if (varsize)
+		fprintf(fp,
+	"\t\tinput\twire\t[(LGLGSIZE-1):0]\ti_lgsize,\n");
+	fprintf(fp,
 	"\t\tinput\twire\t[(2*WIDTH-1):0]\ti_in,\n"
 	"\t\toutput\treg\t[(2*WIDTH-1):0]\to_out,\n"
 	"\t\toutput\treg\t\t\to_sync\n"
 	"\t\t// }}}\n"
-	"\t);\n\n", modulename, TST_DBLREVERSE_LGSIZE,
-		resetw.c_str());
+	"\t);\n\n");
 
 	fprintf(fp,
 	"\t// Local declarations\n"
@@ -121,9 +141,33 @@ SLASHLINE
 "\n"
 	"\treg	[(2*WIDTH-1):0]	brmem	[0:((1<<(LGSIZE+1))-1)];\n"
 "\n"
-	"\treg	in_reset;\n"
+	"\treg	in_reset;\n");
+	if (varsize)
+		fprintf(fp,
+	"\twire	[(LGSIZE-1):0]	brevaddr, lastaddr;\n");
+	fprintf(fp,
 	"\t// }}}\n"
+"\n");
+
+	if (varsize) {
+		fprintf(fp,
+	"\t// bitreverse rdaddr\n"
+	"\t// {{{\n"
+	"\t// Reverse all LGSIZE bits, then shift the result down to the\n"
+	"\t// i_lgsize bits we are actually using\n"
+"	genvar	k;\n"
+"	generate for(k=0; k<LGSIZE; k=k+1)\n"
+"	begin : DBL\n"
+"		assign brevaddr[k] = wraddr[LGSIZE-1-k];\n"
+"	end endgenerate\n"
+"	assign	rdaddr[(LGSIZE-1):0] = brevaddr >> (LGSIZE-i_lgsize);\n"
+"	assign	rdaddr[LGSIZE] = !wraddr[LGSIZE];\n"
 "\n"
+"	assign	lastaddr = {(LGSIZE){1'b1}} >> (LGSIZE-i_lgsize);\n"
+	"\t// }}}\n"
+"\n");
+	} else {
+		fprintf(fp,
 	"\t// bitreverse rdaddr\n"
 	"\t// {{{\n"
 "	genvar	k;\n"
@@ -133,7 +177,10 @@ SLASHLINE
 "	end endgenerate\n"
 "	assign	rdaddr[LGSIZE] = !wraddr[LGSIZE];\n"
 	"\t// }}}\n"
-"\n"
+"\n");
+	}
+
+	fprintf(fp,
 	"\t// in_reset\n"
 	"\t// {{{\n"
 	"\tinitial	in_reset = 1'b1;\n");
@@ -144,13 +191,15 @@ SLASHLINE
 		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
 	fprintf(fp,
 	"\t	in_reset <= 1'b1;\n"
-	"\telse if ((i_ce)&&(&wraddr[(LGSIZE-1):0]))\n"
+	"\telse if ((i_ce)&&(%s))\n"
 	"\t	in_reset <= 1'b0;\n"
 	"\t// }}}\n"
 "\n"
 	"\t// wraddr\n"
 	"\t// {{{\n"
-	"\tinitial	wraddr = 0;\n");
+	"\tinitial	wraddr = 0;\n",
+		(varsize) ? "wraddr[(LGSIZE-1):0] == lastaddr"
+			: "&wraddr[(LGSIZE-1):0]");
 
 	if (async_reset)
 		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
@@ -160,8 +209,17 @@ SLASHLINE
 	"\t	wraddr <= 0;\n"
 	"\telse if (i_ce)\n"
 	"\tbegin\n"
-	"\t	brmem[wraddr] <= i_in;\n"
-	"\t	wraddr <= wraddr + 1;\n"
+	"\t	brmem[wraddr] <= i_in;\n");
+	if (varsize)
+		fprintf(fp,
+	"\t	if (wraddr[(LGSIZE-1):0] == lastaddr)\n"
+	"\t		wraddr <= { !wraddr[LGSIZE], {(LGSIZE){1'b0}} };\n"
+	"\t	else\n"
+	"\t		wraddr <= wraddr + 1;\n");
+	else
+		fprintf(fp,
+	"\t	wraddr <= wraddr + 1;\n");
+	fprintf(fp,
 	"\tend\n"
 	"\t// }}}\n"
 "\n"
@@ -197,7 +255,7 @@ SLASHLINE
 "\n");
 
 
-	if (formal_property_flag) {
+	if ((formal_property_flag)&&(!varsize)) {
 		fprintf(fp,
 "`ifdef\tFORMAL\n"
 "`define\tASSERT	assert\n"
@@ -342,19 +400,20 @@ SLASHLINE
 "// }}}\n"
 "endmodule\n");
 
-	fclose(fp);
+	int	r = fftsink_close(fp);
 	free(modulename);
+	return r;
 }
 // }}}
 
 // build_dblreverse(fname, async_reset)
 // {{{
-void	build_dblreverse(const char *fname, const bool async_reset) {
-	FILE	*fp = fopen(fname, "w");
+int	build_dblreverse(const char *fname, const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	std::string	resetw("i_reset");
@@ -786,7 +845,232 @@ SLASHLINE );
 "// }}}\n"
 "endmodule\n");
 
-	fclose(fp);
+	int	r = fftsink_close(fp);
+	free(modulename);
+	return r;
+}
+// }}}
+
+// build_multirev(fname, lglanes, async_reset)
+// {{{
+// Builds a bit reversal stage for an FFT that produces 2^lglanes samples per
+// clock.
+//
+int	build_multirev(const char *fname, const int lglanes,
+			const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	char	*modulename = strdup(fname), *pslash;
+	modulename[strlen(modulename)-2] = '\0';
+	pslash = strrchr(modulename, '/');
+	if (pslash != NULL)
+		strcpy(modulename, pslash+1);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\t%s.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThis module bitreverses a pipelined FFT input, arriving\n"
+"//		NLANES = 2^LGLANES samples per clock.  Operation is\n"
+"//		expected as follows:\n"
+"//\n"
+"//		i_clk	A running clock at whatever system speed is offered.\n",
+	modulename, prjname);
+
+	if (async_reset)
+		fprintf(fp,
+"//		i_areset_n	An active low asynchronous reset signal,\n"
+"//				that resets all internals\n");
+	else
+		fprintf(fp,
+"//		i_reset	A synchronous reset signal, that resets all internals\n");
+
+	fprintf(fp,
+"//		i_ce	If this is one, NLANES inputs are consumed and NLANES\n"
+"//			outputs are produced.\n"
+"//		i_in	NLANES inputs to be consumed, each of width 2*WIDTH.\n"
+"//			The first sample is found in the high order bits.\n"
+"//		o_out	NLANES bitreversed outputs, in the same format.  Of\n"
+"//			course, there is a delay from the first input to the\n"
+"//			first output.  For this purpose, o_sync is present.\n"
+"//		o_sync	This will be a 1\'b1 for the first value in any block.\n"
+"//			Following a reset, this will only become 1\'b1 once\n"
+"//			the data has been loaded and is now valid.  After that,\n"
+"//			all outputs will be valid.\n"
+"//\n"
+"// How do we bit reverse NLANES samples per clock?  The NLANES outputs of\n"
+"// any one clock all come from the same input lane, but from NLANES\n"
+"// different clocks--differing in the top LGLANES bits of the clock\n"
+"// counter.  Hence, if we rotate the input lanes into NLANES memory banks\n"
+"// by those same top LGLANES bits, every bank will see exactly one write\n"
+"// and one read on every clock.  This requires at least NLANES clocks per\n"
+"// frame, or LGSIZE >= 2*LGLANES.\n"
+"//\n"
+"//\n%s"
+"//\n", creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+	fprintf(fp,
+"module	%s #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\t\t\tLGSIZE=%d, WIDTH=24, LGLANES=%d\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t\t\ti_clk, %s, i_ce,\n"
+	"\t\tinput\twire\t[(((2*WIDTH)<<LGLANES)-1):0]\ti_in,\n"
+	"\t\toutput\twire\t[(((2*WIDTH)<<LGLANES)-1):0]\to_out,\n"
+	"\t\toutput\treg\t\t\to_sync\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", modulename, 2*lglanes+2, lglanes, resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\tlocalparam\tNLANES = (1<<LGLANES);\n"
+	"\t// The base two log of the number of clocks per frame\n"
+	"\tlocalparam\tLGCLKS = LGSIZE-LGLANES;\n"
+"\n"
+	"\treg\t\t\tin_reset;\n"
+	"\treg\t[LGCLKS:0]\tiaddr;\n"
+	"\twire\t[(LGCLKS-1):0]\tbraddr;\n"
+	"\twire\t[(LGLANES-1):0]\twr_rot, rd_rot;\n"
+	"\treg\t[(LGLANES-1):0]\tr_rot;\n"
+"\n"
+	"\twire\t[(2*WIDTH-1):0]\tin_lane  [0:(NLANES-1)];\n"
+	"\twire\t[(2*WIDTH-1):0]\tbank_out [0:(NLANES-1)];\n"
+	"\t// }}}\n"
+"\n"
+	"\t// braddr, wr_rot, rd_rot\n"
+	"\t// {{{\n"
+	"\tgenvar\tk, j;\n"
+	"\tgenerate for(k=0; k<LGCLKS; k=k+1)\n"
+	"\tbegin : gen_a_bit_reversed_value\n"
+		"\t\tassign braddr[k] = iaddr[LGCLKS-1-k];\n"
+	"\tend endgenerate\n"
+"\n"
+	"\t// Inputs are rotated into the banks by the top bits of their clock\n"
+	"\t// within the frame\n"
+	"\tassign\twr_rot = iaddr[(LGCLKS-1):(LGCLKS-LGLANES)];\n"
+	"\t// Outputs all come from this lane, rotated by the same amount they\n"
+	"\t// were rotated by when written\n"
+	"\tassign\trd_rot = braddr[(LGLANES-1):0];\n"
+	"\t// }}}\n"
+"\n"
+	"\t// iaddr, in_reset, o_sync\n"
+	"\t// {{{\n"
+	"\tinitial iaddr = 0;\n"
+	"\tinitial in_reset = 1\'b1;\n"
+	"\tinitial o_sync = 1\'b0;\n");
+
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+		"\tbegin\n"
+			"\t\tiaddr <= 0;\n"
+			"\t\tin_reset <= 1\'b1;\n"
+			"\t\to_sync <= 1\'b0;\n"
+		"\tend else if (i_ce)\n"
+		"\tbegin\n"
+			"\t\tiaddr <= iaddr + { {(LGCLKS){1\'b0}}, 1\'b1 };\n"
+			"\t\tif (&iaddr[(LGCLKS-1):0])\n"
+				"\t\t\tin_reset <= 1\'b0;\n"
+			"\t\tif (in_reset)\n"
+				"\t\t\to_sync <= 1\'b0;\n"
+			"\t\telse\n"
+				"\t\t\to_sync <= ~(|iaddr[(LGCLKS-1):0]);\n"
+		"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// in_lane\n"
+	"\t// {{{\n"
+	"\tgenerate for(k=0; k<NLANES; k=k+1)\n"
+	"\tbegin : UNPACK_INPUTS\n"
+		"\t\tassign in_lane[k] = i_in[((NLANES-k)*2*WIDTH-1)\n"
+		"\t\t\t\t\t\t:((NLANES-1-k)*2*WIDTH)];\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n"
+	"\t// The memory banks\n"
+	"\t// {{{\n"
+	"\tgenerate for(k=0; k<NLANES; k=k+1)\n"
+	"\tbegin : BANK\n"
+		"\t\t// {{{\n"
+		"\t\tlocalparam [(LGLANES-1):0]\tBANKID = k;\n"
+"\n"
+		"\t\treg\t[(2*WIDTH-1):0]\tmem [0:((1<<(LGCLKS+1))-1)];\n"
+		"\t\treg\t[(2*WIDTH-1):0]\trd_data;\n"
+		"\t\twire\t[(LGLANES-1):0]\twr_lane, rd_blk;\n"
+		"\t\twire\t[(LGCLKS-1):0]\trd_addr;\n"
+"\n"
+		"\t\tassign\twr_lane = BANKID - wr_rot;\n"
+		"\t\tassign\trd_blk  = BANKID - rd_rot;\n"
+"\n"
+		"\t\tif (LGCLKS > LGLANES)\n"
+		"\t\tbegin : GEN_WIDE_ADDR\n"
+			"\t\t\tassign\trd_addr = { rd_blk, braddr[(LGCLKS-1):LGLANES] };\n"
+		"\t\tend else begin : GEN_NARROW_ADDR\n"
+			"\t\t\tassign\trd_addr = rd_blk;\n"
+		"\t\tend\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tmem[iaddr] <= in_lane[wr_lane];\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\trd_data <= mem[{ !iaddr[LGCLKS], rd_addr }];\n"
+"\n"
+		"\t\tassign\tbank_out[k] = rd_data;\n"
+		"\t\t// }}}\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n"
+	"\t// r_rot\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\tr_rot <= rd_rot;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// o_out\n"
+	"\t// {{{\n"
+	"\t// Output lane k comes from the bank its bit-reversed lane number was\n"
+	"\t// rotated into\n"
+	"\tgenerate for(k=0; k<NLANES; k=k+1)\n"
+	"\tbegin : PACK_OUTPUTS\n"
+		"\t\tlocalparam [(LGLANES-1):0]\tLANEID = k;\n"
+		"\t\twire\t[(LGLANES-1):0]\tbrlane;\n"
+"\n"
+		"\t\tfor(j=0; j<LGLANES; j=j+1)\n"
+		"\t\tbegin : REVERSE_LANE\n"
+			"\t\t\tassign brlane[j] = LANEID[LGLANES-1-j];\n"
+		"\t\tend\n"
+"\n"
+		"\t\tassign o_out[((NLANES-k)*2*WIDTH-1):((NLANES-1-k)*2*WIDTH)]\n"
+		"\t\t\t\t= bank_out[r_rot + brlane];\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n"
+"// Formal properties have not included in this build\n"
+"endmodule\n");
+
+	int	r = fftsink_close(fp);
 	free(modulename);
+	return r;
 }
 // }}}
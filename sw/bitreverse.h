@@ -39,7 +39,10 @@
 #ifndef	BITREVERSE_H
 #define	BITREVERSE_H
 
-extern	void	build_snglbrev(const char *fname, const bool async_reset = false);
-extern	void	build_dblreverse(const char *fname, const bool async_reset = false);
+extern	int	build_snglbrev(const char *fname, const bool async_reset = false,
+			const bool varsize = false);
+extern	int	build_dblreverse(const char *fname, const bool async_reset = false);
+extern	int	build_multirev(const char *fname, const int lglanes,
+			const bool async_reset = false);
 
 #endif	// BITREVERSE_H
@@ -64,6 +64,7 @@
 
 #include "defaults.h"
 #include "legal.h"
+#include "fftsink.h"
 #include "fftlib.h"
 #include "rounding.h"
 #include "bldstage.h"
@@ -73,13 +74,13 @@
 // Builds the penultimate FFT stage, using integer operations only.
 // This stage is called laststage elsewhere.
 //
-void	build_dblstage(const char *fname, ROUND_T rounding,
+int	build_dblstage(const char *fname, ROUND_T rounding,
 			const bool async_reset, const bool dbg) {
-	FILE	*fp = fopen(fname, "w");
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	const	char	*rnd_string;
@@ -290,17 +291,18 @@ SLASHLINE
 	"\t// }}}\n"
 "\n"
 "endmodule\n");
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_stage
 // {{{
-void	build_stage(const char *fname,
+int	build_stage(const char *fname,
 		int stage, int nwide, int offset,
 		int nbits, int xtra, int ckpce,
-		const bool async_reset, const bool dbg) {
-	FILE	*fstage = fopen(fname, "w");
+		const bool async_reset, const bool dbg, const bool qtrwave,
+		const bool extcoef, const bool twidgen) {
+	FILE	*fstage = fftsink_open(fname);
 	// int	cbits = nbits + xtra;
 
 	std::string	resetw("i_reset");
@@ -311,7 +313,7 @@ void	build_stage(const char *fname,
 		fprintf(stderr, "ERROR: Could not open %s for writing!\n", fname);
 		perror("O/S Err was:");
 		fprintf(stderr, "Attempting to continue, but this file will be missing.\n");
-		return;
+		return EOF;
 	}
 
 	fprintf(fstage,
@@ -365,7 +367,8 @@ SLASHLINE
 "\t\t// Verilator lint_off UNUSED\n"
 "\t\tparameter\tLGSPAN=%d, BFLYSHIFT=0, // LGWIDTH=%d\n"
 "\t\tparameter [0:0]\tOPT_HWMPY = 1,\n",
-		(nwide <= 1) ? lgval(stage)-1 : lgval(stage)-2, lgval(stage));
+		(nwide <= 1) ? lgval(stage)-1 : lgval(stage)-1-lgval(nwide),
+		lgval(stage));
 	fprintf(fstage,
 "\t\t// Clocks per CE.  If your incoming data rate is less than 50%%\n"
 "\t\t// of your clock speed, you can set CKPCE to 2\'b10, make sure\n"
@@ -376,16 +379,46 @@ SLASHLINE
 "\t\t// butterfly code will used one multiply instead of two.\n"
 "\t\tparameter\tCKPCE = %d,\n", ckpce);
 
+	if (extcoef)
+		fprintf(fstage,
+"\t\t// The twiddle factors come from a twidrom shared with the\n"
+"\t\t// other stages, via o_caddr and i_coef, rather than from a\n"
+"\t\t// COEFFILE of this stage's own\n");
+	else
 	fprintf(fstage,
 "\t\t// The COEFFILE parameter contains the name of the file\n"
 "\t\t// containing the FFT twiddle factors\n");
-	if (nwide == 2) {
+	if (extcoef) {
+		// No coefficient file of our own
+	} else if (nwide > 2) {
+		fprintf(fstage, "\t\tparameter\tCOEFFILE=\"cmem_w%d_%d_%d.hex\",\n",
+			nwide, offset, stage);
+	} else if (nwide == 2) {
 		fprintf(fstage, "\t\tparameter\tCOEFFILE=\"cmem_%c%d.hex\",\n",
 			(offset)?'o':'e', stage*2);
+	} else if (qtrwave) {
+		fprintf(fstage,
+			"\t\tparameter\tCOEFFILE=\"cmem_q%d.hex\",\n",
+			stage);
+		fprintf(fstage,
+"\t\t// The quarter wave table is shared by forward and inverse\n"
+"\t\t// FFTs.  INVERSE selects which of the two to build.\n"
+			"\t\tparameter [0:0]\tINVERSE = 1'b0,\n");
 	} else
 		fprintf(fstage,
 			"\t\tparameter\tCOEFFILE=\"cmem_%d.hex\",\n",
 			stage);
+	if (twidgen)
+		fprintf(fstage,
+"\t\t// OPT_TWIDGEN builds each twiddle factor from the product of\n"
+"\t\t// two smaller tables, rather than reading it from one table of\n"
+"\t\t// 2^LGSPAN entries.  COEFFILE then holds the coarse table, of\n"
+"\t\t// 2^(LGSPAN-LGFINE) entries, and FINEFILE the fine table, of\n"
+"\t\t// 2^LGFINE entries, both of CWIDTH+2 bits.\n"
+			"\t\tparameter [0:0]\tOPT_TWIDGEN = 1'b0,\n"
+			"\t\tparameter\tLGFINE = %d,\n"
+			"\t\tparameter\tFINEFILE=\"cmem_f%d.hex\",\n",
+			(lgval(stage)-1)/2, stage);
 	fprintf(fstage, "\t\t// Verilator lint_on  UNUSED\n");
 
 	fprintf(fstage,"\n"
@@ -399,10 +432,17 @@ SLASHLINE
 	fprintf(fstage,
 	"\t\tinput\twire\t			i_clk, %s,\n"
 			"\t\t\t\t\t\t\ti_ce, i_sync,\n"
-	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n", resetw.c_str());
+	if (extcoef)
+		fprintf(fstage,
+	"\t\t// The address of the coefficient needed on the next clock,\n"
+	"\t\t// and the coefficient found there one clock later\n"
+	"\t\toutput\twire\t[(LGSPAN-1):0]	o_caddr,\n"
+	"\t\tinput\twire\t[(2*CWIDTH-1):0]	i_coef,\n");
+	fprintf(fstage,
 	"\t\toutput\treg\t[(2*OWIDTH-1):0]	o_data,\n"
 	"\t\toutput\treg\t			o_sync%s\n"
-"\n", resetw.c_str(), (dbg) ? ",":"");
+"\n", (dbg) ? ",":"");
 	if (dbg) { fprintf(fstage, "\t\toutput\twire\t[33:0]\t\t\to_dbg\n");
 	}
 	fprintf(fstage, "\t\t// }}}\n\t);\n\n");
@@ -421,7 +461,34 @@ SLASHLINE
 	"\treg	b_started;\n"
 	"\twire	ob_sync;\n"
 	"\twire	[(2*OWIDTH-1):0]\tob_a, ob_b;\n");
-	fprintf(fstage,
+	if (qtrwave) {
+		fprintf(fstage,
+"\n"
+"\t// qmem holds only the first quarter wave of the twiddle factors,\n"
+"\t//\n"
+"\t// qmem[j] = (2^(CWIDTH-2)) * cos(2*pi*j/(2^LGWIDTH)),\n"
+"\t//\n"
+"\t// for j = 0 ... 2^(LGSPAN-1)-1.  These values are all positive,\n"
+"\t// and so need only CWIDTH-1 bits.  The full cmem[i] is then\n"
+"\t// rebuilt from qmem[i] and qmem[2^(LGSPAN-1)-i], as a quarter of\n"
+"\t// the memory a full table would require.\n"
+"\treg	[(CWIDTH-2):0]		qmem [0:((1<<(LGSPAN-1))-1)];\n"
+"\treg	[(LGSPAN-1):0]		nxt_caddr;\n"
+"\twire	[(LGSPAN-2):0]		nxt_saddr;\n"
+"\treg	[(CWIDTH-2):0]		cq_cos, cq_sin;\n"
+"\treg				cq_zero, cq_quad;\n"
+"\twire	[(CWIDTH-1):0]		w_cos, w_sin;\n");
+	} else if (extcoef) {
+		fprintf(fstage,
+"\n"
+"\t// The twiddle factors are read from a shared twidrom.  nxt_caddr\n"
+"\t// is the address we'll need on the next clock, and i_coef then\n"
+"\t// holds the coefficient found there.\n"
+"\treg	[(LGSPAN-1):0]		nxt_caddr;\n");
+	} else if (twidgen) {
+		// cmem, if used, is declared within the generate block below
+	} else {
+		fprintf(fstage,
 "\n"
 "\t// cmem is defined as an array of real and complex values,\n"
 "\t// where the top CWIDTH bits are the real value and the bottom\n"
@@ -431,15 +498,27 @@ SLASHLINE
 "\t//		(2^(CWIDTH-2)) * sin(2*pi*i/(2^LGWIDTH)) };\n"
 "\t//\n"
 "\treg	[(2*CWIDTH-1):0]	cmem [0:((1<<LGSPAN)-1)];\n");
+	}
 
-	if (formal_property_flag)
-		fprintf(fstage, 
-			"`ifdef	FORMAL\n"
-			"// Let the formal tool pick the coefficients\n"
-			"`else\n");
-	fprintf(fstage, "\tinitial\t$readmemh(COEFFILE,cmem);\n\n");
-	if (formal_property_flag)
-		fprintf(fstage, "`endif\n\n");
+	if ((extcoef)||(twidgen))
+		fprintf(fstage, "\n");
+	else {
+		if (formal_property_flag)
+			fprintf(fstage, 
+				"`ifdef	FORMAL\n"
+				"// Let the formal tool pick the coefficients\n"
+				"`else\n");
+		gen_cmem_rom(fstage, "\t");
+		if (qtrwave)
+			gen_cmem_init(fstage, "\t", "qmem", "COEFFILE",
+				"(LGSPAN-1)");
+		else
+			gen_cmem_init(fstage, "\t", "cmem", "COEFFILE",
+				"LGSPAN");
+		fprintf(fstage, "\n");
+		if (formal_property_flag)
+			fprintf(fstage, "`endif\n\n");
+	}
 
 	// gen_coeff_file(coredir, fname, stage, cbits, nwide, offset, inv);
 
@@ -492,6 +571,59 @@ SLASHLINE
 	"\t// }}}\n"
 	"\n");
 
+	if (qtrwave)
+		fprintf(fstage,
+	"\t// nxt_caddr, cq_*: Quarter wave coefficient lookup\n"
+	"\t// {{{\n"
+	"\t// Read the quarter wave table one clock ahead, from the address\n"
+	"\t// iaddr will have on the next clock.  The coefficient for\n"
+	"\t// i = 2^(LGSPAN-1) * cq_quad + j is then rebuilt, when ib_c is set,\n"
+	"\t// from cq_cos = qmem[j] and cq_sin = qmem[2^(LGSPAN-1)-j].\n");
+	else if (extcoef)
+		fprintf(fstage,
+	"\t// nxt_caddr, o_caddr\n"
+	"\t// {{{\n"
+	"\t// Ask for each coefficient one clock ahead, using the address\n"
+	"\t// iaddr will have on the next clock.\n");
+	if ((qtrwave)||(extcoef)) {
+		fprintf(fstage, "\talways @(*)\n");
+		if (async_reset)
+			fprintf(fstage, "\tif (!i_areset_n)\n");
+		else
+			fprintf(fstage, "\tif (i_reset)\n");
+		fprintf(fstage,
+		"\t\tnxt_caddr = {(LGSPAN){1\'b0}};\n"
+	"\telse if ((i_ce)&&((!wait_for_sync)||(i_sync)))\n"
+		"\t\tnxt_caddr = iaddr[(LGSPAN-1):0] + 1\'b1;\n"
+	"\telse\n"
+		"\t\tnxt_caddr = iaddr[(LGSPAN-1):0];\n"
+"\n");
+	}
+
+	if (extcoef)
+		fprintf(fstage,
+	"\tassign\to_caddr = nxt_caddr;\n"
+	"\t// }}}\n"
+"\n");
+	else if (qtrwave) {
+		fprintf(fstage,
+	"\tassign\tnxt_saddr = -nxt_caddr[(LGSPAN-2):0];\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+		"\t\tcq_cos  <= qmem[nxt_caddr[(LGSPAN-2):0]];\n"
+		"\t\tcq_sin  <= qmem[nxt_saddr];\n"
+		"\t\t// sin(0) = 0 is the one value not found in the table\n"
+		"\t\tcq_zero <= (nxt_caddr[(LGSPAN-2):0] == 0);\n"
+		"\t\tcq_quad <= nxt_caddr[LGSPAN-1];\n"
+	"\tend\n"
+"\n"
+	"\tassign\tw_cos = { 1\'b0, cq_cos };\n"
+	"\tassign\tw_sin = (cq_zero) ? {(CWIDTH){1\'b0}} : { 1\'b0, cq_sin };\n"
+	"\t// }}}\n"
+"\n");
+	}
+
 	fprintf(fstage,
 	"\t// ib_sync\n"
 	"\t// {{{\n"
@@ -525,9 +657,122 @@ SLASHLINE
 		"\t\tib_a <= imem[iaddr[(LGSPAN-1):0]];\n"
 		"\t\t// One input clocked in from the top\n"
 		"\t\tib_b <= i_data;\n"
-		"\t\t// and the coefficient or twiddle factor\n"
-		"\t\tib_c <= cmem[iaddr[(LGSPAN-1):0]];\n"
-	"\tend\n\t// }}}\n\n");
+		"%s"
+	"\tend\n\t// }}}\n\n",
+		(twidgen) ? ""
+		: (qtrwave) ? "\t\t// and the coefficient or twiddle factor\n"
+			"\t\tib_c <= (!cq_quad)\n"
+			"\t\t\t? { w_cos, (INVERSE) ? w_sin : -w_sin }\n"
+			"\t\t\t: { -w_sin, (INVERSE) ? w_cos : -w_cos };\n"
+		: (extcoef) ? "\t\t// and the coefficient or twiddle factor\n"
+			"\t\tib_c <= i_coef;\n"
+		: "\t\t// and the coefficient or twiddle factor\n"
+			"\t\tib_c <= cmem[iaddr[(LGSPAN-1):0]];\n");
+
+	if (twidgen) {
+		fprintf(fstage,
+	"\t// ib_c, from either a twiddle generator or a ROM\n"
+	"\t// {{{\n"
+	"\tgenerate if (OPT_TWIDGEN)\n"
+	"\tbegin : GEN_TWIDDLES\n"
+		"\t\t// {{{\n"
+		"\t\t// Twiddle factor k is built from the product of a coarse\n"
+		"\t\t// table entry, W^(k & ~(2^LGFINE-1)), and a fine table\n"
+		"\t\t// entry, W^(k & (2^LGFINE-1)).  Both tables have GWIDTH bits\n"
+		"\t\t// per value, two more than CWIDTH, so that rounding their\n"
+		"\t\t// product back to CWIDTH bits costs about one LSB.  Since\n"
+		"\t\t// every value comes straight from the tables, no error\n"
+		"\t\t// accumulates from one twiddle factor to the next.\n"
+		"\t\t//\n"
+		"\t\t// It takes four (active) i_ce's to build a twiddle factor,\n"
+		"\t\t// so the generator runs GLEAD=4 addresses ahead of iaddr.\n"
+		"\t\t// Its first result isn't used until iaddr[LGSPAN] is set,\n"
+		"\t\t// 2^LGSPAN i_ce's after the first sync.\n"
+		"\t\tlocalparam\tGWIDTH = CWIDTH+2,\n"
+		"\t\t\t\tLGCOARSE = LGSPAN-LGFINE,\n"
+		"\t\t\t\tSHIFT = 2*GWIDTH-CWIDTH-2;\n"
+		"\t\tlocalparam [(LGSPAN-1):0]\tGLEAD = 4;\n"
+		"\t\tlocalparam [(2*GWIDTH-1):0]\tRNDHALF\n"
+		"\t\t\t\t= { {(2*GWIDTH-SHIFT){1\'b0}}, 1\'b1,\n"
+		"\t\t\t\t\t{(SHIFT-1){1\'b0}} };\n"
+"\n"
+		"\t\treg\t[(2*GWIDTH-1):0]\tctab [0:((1<<LGCOARSE)-1)];\n"
+		"\t\treg\t[(2*GWIDTH-1):0]\tftab [0:((1<<LGFINE)-1)];\n"
+		"\t\twire\t\t\t\tgen_ce;\n"
+		"\t\twire\t[(LGSPAN-1):0]\t\tgaddr;\n"
+		"\t\treg\tsigned [(GWIDTH-1):0]\tg_cr, g_ci, g_fr, g_fi;\n"
+		"\t\treg\tsigned [(2*GWIDTH-1):0]\tp_rr, p_ii, p_ri, p_ir;\n"
+		"\t\treg\t[(2*GWIDTH-1):0]\ts_r, s_i;\n"
+		"\t\treg\t[(2*CWIDTH-1):0]\tr_coef;\n"
+"\n");
+		if (formal_property_flag)
+			fprintf(fstage, 
+				"`ifdef	FORMAL\n"
+				"// Let the formal tool pick the coefficients\n"
+				"`else\n");
+		gen_cmem_rom(fstage, "\t\t");
+		gen_cmem_init(fstage, "\t\t", "ctab", "COEFFILE", "LGCOARSE");
+		gen_cmem_init(fstage, "\t\t", "ftab", "FINEFILE", "LGFINE");
+		if (formal_property_flag)
+			fprintf(fstage, "`endif\n");
+		fprintf(fstage,
+"\n"
+		"\t\tassign\tgen_ce = (i_ce)&&((!wait_for_sync)||(i_sync));\n"
+		"\t\tassign\tgaddr  = iaddr[(LGSPAN-1):0] + GLEAD;\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (gen_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\t// Look up both halves of the twiddle factor\n"
+			"\t\t\t{ g_cr, g_ci } <= ctab[gaddr[(LGSPAN-1):LGFINE]];\n"
+			"\t\t\t{ g_fr, g_fi } <= ftab[gaddr[(LGFINE-1):0]];\n"
+"\n"
+			"\t\t\t// Multiply them together, ...\n"
+			"\t\t\tp_rr <= g_cr * g_fr;\n"
+			"\t\t\tp_ii <= g_ci * g_fi;\n"
+			"\t\t\tp_ri <= g_cr * g_fi;\n"
+			"\t\t\tp_ir <= g_ci * g_fr;\n"
+"\n"
+			"\t\t\ts_r <= p_rr - p_ii + RNDHALF;\n"
+			"\t\t\ts_i <= p_ri + p_ir + RNDHALF;\n"
+"\n"
+			"\t\t\t// ... and round the result to CWIDTH bits\n"
+			"\t\t\tr_coef <= { s_r[SHIFT +: CWIDTH], s_i[SHIFT +: CWIDTH] };\n"
+		"\t\tend\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tib_c <= r_coef;\n"
+"\n"
+		"\t\t// Verilator lint_off UNUSED\n"
+		"\t\twire\tunused_gen;\n"
+		"\t\tassign\tunused_gen = &{ 1\'b0, s_r, s_i };\n"
+		"\t\t// Verilator lint_on  UNUSED\n"
+		"\t\t// }}}\n"
+	"\tend else begin : ROM_TWIDDLES\n"
+		"\t\t// {{{\n"
+		"\t\t// cmem[i] = { (2^(CWIDTH-2)) * cos(2*pi*i/(2^LGWIDTH)),\n"
+		"\t\t//\t\t(2^(CWIDTH-2)) * sin(2*pi*i/(2^LGWIDTH)) };\n"
+		"\t\treg\t[(2*CWIDTH-1):0]\tcmem [0:((1<<LGSPAN)-1)];\n"
+"\n");
+		if (formal_property_flag)
+			fprintf(fstage, 
+				"`ifdef	FORMAL\n"
+				"// Let the formal tool pick the coefficients\n"
+				"`else\n");
+		gen_cmem_rom(fstage, "\t\t");
+		gen_cmem_init(fstage, "\t\t", "cmem", "COEFFILE", "LGSPAN");
+		if (formal_property_flag)
+			fprintf(fstage, "`endif\n");
+		fprintf(fstage,
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tib_c <= cmem[iaddr[(LGSPAN-1):0]];\n"
+		"\t\t// }}}\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n\n");
+	}
 
 	fprintf(fstage,
 	"\t// idle\n"
@@ -835,8 +1080,12 @@ SLASHLINE
 	"\tbegin\n"
 		"\t\tassert(ib_a == f_left);\n"
 		"\t\tassert(ib_b == f_right);\n"
-		"\t\tassert(ib_c == cmem[f_addr[LGSPAN-1:0]]);\n"
-	"\tend\n\n");
+		"%s"
+	"\tend\n\n",
+		// There's no cmem to compare against with a quarter wave
+		// table, a shared twidrom, or a twiddle generator
+		((qtrwave)||(extcoef)||(twidgen)) ? ""
+		: "\t\tassert(ib_c == cmem[f_addr[LGSPAN-1:0]]);\n");
 
 	fprintf(fstage,
 	"\t////////////////////////////////////////////////////////////////////////\n"
@@ -952,5 +1201,2277 @@ SLASHLINE
 "// }}}\n");
 
 	fprintf(fstage, "endmodule\n");
+	return fftsink_close(fstage);
+}
+// }}}
+
+// build_bf2stage
+// {{{
+// Builds a multiplier-free butterfly stage, used in pairs to build the
+// radix-2^2 stages of the FFT.  The first stage of each pair rotates half
+// of its differences by -j, the second stage doesn't rotate anything.  The
+// remaining twiddle factors are then applied by a twidstage following the
+// pair.  Radix-2^3 stages use three in a row, with a w8twid between the
+// second and third.  A decimation in time FFT uses the same stage, but with the rotation
+// applied to the second input of the butterfly instead (PREROTATE).
+//
+int	build_bf2stage(const char *fname, ROUND_T rounding,
+			const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	const	char	*rnd_string;
+	if (rounding == RND_TRUNCATE)
+		rnd_string = "truncate";
+	else if (rounding == RND_FROMZERO)
+		rnd_string = "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		rnd_string = "roundhalfup";
+	else
+		rnd_string = "convround";
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tbf2stage.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThis file encapsulates one stage of a radix-2^2 single path\n"
+"//		delay feedback FFT.  Such stages come in pairs.  The first\n"
+"//	stage of the pair multiplies half of its differences by -j (+j for an\n"
+"//	inverse FFT), something that takes no multiplies at all.  The second\n"
+"//	stage of the pair doesn\'t multiply by anything.  The rest of the\n"
+"//	twiddle factors of both stages are then applied at once by a single\n"
+"//	twidstage following the pair.  In this fashion, a radix-2^2 FFT needs\n"
+"//	only half the complex multiplies of a radix-2 FFT.\n"
+"//\n"
+"// Operation:\n"
+"// 	Given a stream of values, operate upon them as though they were\n"
+"// 	value pairs, x[n] and x[n+N/2].  The stream begins when n=0, and ends\n"
+"// 	when n=N/2-1 (i.e. there's a full set of N values).  When the value\n"
+"// 	x[0] enters, the synchronization input, i_sync, must be true as well.\n"
+"//\n"
+"// 	For this stream, produce outputs\n"
+"// 	y[n    ] = x[n] + x[n+N/2], and\n"
+"// 	y[n+N/2] =  x[n] - x[n+N/2],		(n < N/4, or ROTATE == 0)\n"
+"// 	y[n+N/2] = (x[n] - x[n+N/2]) * -j,	(n >= N/4, and ROTATE == 1)\n"
+"//\n"
+"//	If PREROTATE is set as well, the rotation is instead applied to\n"
+"//	x[n+N/2] before the butterfly, as a decimation in time FFT requires.\n"
+"//	For n >= N/4 then,\n"
+"//\n"
+"// 	y[n    ] = x[n] + x[n+N/2] * -j, and\n"
+"// 	y[n+N/2] = x[n] - x[n+N/2] * -j\n"
+"//\n"
+"// 	When y[0] is output, a synchronization bit o_sync will be true as\n"
+"// 	well, otherwise it will be zero.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tbf2stage #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=16, OWIDTH=IWIDTH+1,\n"
+	"\t\t// LGSPAN is the base two log of half the span of this stage.\n"
+	"\t\t// It must be at least one.\n"
+	"\t\tparameter\tLGSPAN=3, SHIFT=0,\n"
+	"\t\t// Set ROTATE to multiply the second half of the differences\n"
+	"\t\t// by -j (or +j if INVERSE is set).\n"
+	"\t\tparameter [0:0]\tROTATE=1, INVERSE=0,\n"
+	"\t\t// Set PREROTATE to rotate x[n+N/2] before the butterfly,\n"
+	"\t\t// rather than the difference afterwards\n"
+	"\t\tparameter [0:0]\tPREROTATE=0\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s,\n"
+			"\t\t\t\t\t\t\ti_ce, i_sync,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n"
+	"\t\toutput\treg\t[(2*OWIDTH-1):0]	o_data,\n"
+	"\t\toutput\treg\t			o_sync\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\treg				wait_for_sync;\n"
+	"\treg	[LGSPAN:0]		iaddr;\n"
+	"\treg	[(2*IWIDTH-1):0]	imem	[0:((1<<LGSPAN)-1)];\n"
+"\n"
+	"\treg	[(2*IWIDTH-1):0]	ib_a, ib_b;\n"
+	"\treg				ib_sync, ib_rot;\n"
+	"\twire	signed	[(IWIDTH-1):0]	ib_a_r, ib_a_i, ib_b_r, ib_b_i;\n"
+"\n"
+	"\t// Don't forget that we accumulate a bit by adding two values\n"
+	"\t// together. Therefore our intermediate value must have one more\n"
+	"\t// bit than the two originals.\n"
+	"\treg	signed	[IWIDTH:0]	sum_r, sum_i, dif_r, dif_i;\n"
+	"\treg				r_sync, ob_sync;\n"
+	"\twire	signed	[(OWIDTH-1):0]	rnd_sum_r, rnd_sum_i,\n"
+	"\t\t\t\t\trnd_dif_r, rnd_dif_i;\n"
+	"\twire	[(2*OWIDTH-1):0]	ob_a, ob_b;\n"
+"\n"
+	"\treg				b_started;\n"
+	"\treg	[LGSPAN:0]		oaddr;\n"
+	"\treg	[(2*OWIDTH-1):0]	omem	[0:((1<<LGSPAN)-1)];\n"
+	"\treg	[(LGSPAN-1):0]		nxt_oaddr;\n"
+	"\treg	[(2*OWIDTH-1):0]	pre_ovalue;\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// wait_for_sync, iaddr\n"
+	"\t// {{{\n"
+	"\tinitial wait_for_sync = 1\'b1;\n"
+	"\tinitial iaddr = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\twait_for_sync <= 1\'b1;\n"
+		"\t\tiaddr <= 0;\n"
+	"\tend else if ((i_ce)&&((!wait_for_sync)||(i_sync)))\n"
+	"\tbegin\n"
+		"\t\tiaddr <= iaddr + { {(LGSPAN){1\'b0}}, 1\'b1 };\n"
+		"\t\twait_for_sync <= 1\'b0;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// Write to imem\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(!iaddr[LGSPAN]))\n"
+		"\t\timem[iaddr[(LGSPAN-1):0]] <= i_data;\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// ib_sync\n"
+	"\t// {{{\n"
+	"\tinitial ib_sync = 1\'b0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+		"\t\tib_sync <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+		"\t\tib_sync <= (iaddr==(1<<(LGSPAN)));\n"
+	"\t// }}}\n"
+"\n"
+	"\t// ib_a, ib_b, ib_rot\n"
+	"\t// {{{\n"
+	"\t// One input from memory, one clocked in from the top, and a flag\n"
+	"\t// to tell us if this difference needs to be rotated.  The rotation\n"
+	"\t// applies to the second half of the differences, where n >= N/4.\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tib_a   <= imem[iaddr[(LGSPAN-1):0]];\n"
+		"\t\tib_b   <= i_data;\n"
+		"\t\tib_rot <= (ROTATE)&&(iaddr[LGSPAN-1]);\n"
+	"\tend\n"
+"\n"
+	"\tassign\tib_a_r = ib_a[(2*IWIDTH-1):IWIDTH];\n"
+	"\tassign\tib_a_i = ib_a[(IWIDTH-1):0];\n"
+	"\tassign\tib_b_r = ib_b[(2*IWIDTH-1):IWIDTH];\n"
+	"\tassign\tib_b_i = ib_b[(IWIDTH-1):0];\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// sum_*, dif_*: The butterfly itself\n"
+	"\t// {{{\n"
+	"\t// Multiplying by -j maps (r,i) to (i,-r).  We fold that into the\n"
+	"\t// additions and subtractions, rather than negating (and possibly\n"
+	"\t// overflowing) anything afterwards.\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tif ((!ib_rot)||(!PREROTATE))\n"
+		"\t\tbegin\n"
+			"\t\t\tsum_r <= ib_a_r + ib_b_r;\n"
+			"\t\t\tsum_i <= ib_a_i + ib_b_i;\n"
+		"\t\tend else if (!INVERSE)\n"
+		"\t\tbegin\n"
+			"\t\t\t// x[n] + x[n+N/2] * -j\n"
+			"\t\t\tsum_r <= ib_a_r + ib_b_i;\n"
+			"\t\t\tsum_i <= ib_a_i - ib_b_r;\n"
+		"\t\tend else begin\n"
+			"\t\t\t// x[n] + x[n+N/2] * j\n"
+			"\t\t\tsum_r <= ib_a_r - ib_b_i;\n"
+			"\t\t\tsum_i <= ib_a_i + ib_b_r;\n"
+		"\t\tend\n"
+"\n"
+		"\t\tif (!ib_rot)\n"
+		"\t\tbegin\n"
+			"\t\t\tdif_r <= ib_a_r - ib_b_r;\n"
+			"\t\t\tdif_i <= ib_a_i - ib_b_i;\n"
+		"\t\tend else if (PREROTATE)\n"
+		"\t\tbegin\n"
+			"\t\t\tif (!INVERSE)\n"
+			"\t\t\tbegin\n"
+				"\t\t\t\t// x[n] - x[n+N/2] * -j\n"
+				"\t\t\t\tdif_r <= ib_a_r - ib_b_i;\n"
+				"\t\t\t\tdif_i <= ib_a_i + ib_b_r;\n"
+			"\t\t\tend else begin\n"
+				"\t\t\t\t// x[n] - x[n+N/2] * j\n"
+				"\t\t\t\tdif_r <= ib_a_r + ib_b_i;\n"
+				"\t\t\t\tdif_i <= ib_a_i - ib_b_r;\n"
+			"\t\t\tend\n"
+		"\t\tend else if (!INVERSE)\n"
+		"\t\tbegin\n"
+			"\t\t\t// W = -j\n"
+			"\t\t\tdif_r <= ib_a_i - ib_b_i;\n"
+			"\t\t\tdif_i <= ib_b_r - ib_a_r;\n"
+		"\t\tend else begin\n"
+			"\t\t\t// W = j\n"
+			"\t\t\tdif_r <= ib_b_i - ib_a_i;\n"
+			"\t\t\tdif_i <= ib_a_r - ib_b_r;\n"
+		"\t\tend\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// Round the results down to OWIDTH bits\n"
+	"\t// {{{\n"
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_r(i_clk, i_ce,\n"
+	"\t\t\t\tsum_r, rnd_sum_r);\n\n"
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_i(i_clk, i_ce,\n"
+	"\t\t\t\tsum_i, rnd_sum_i);\n\n"
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_dif_r(i_clk, i_ce,\n"
+	"\t\t\t\tdif_r, rnd_dif_r);\n\n"
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_dif_i(i_clk, i_ce,\n"
+	"\t\t\t\tdif_i, rnd_dif_i);\n\n"
+	"\tassign\tob_a = { rnd_sum_r, rnd_sum_i };\n"
+	"\tassign\tob_b = { rnd_dif_r, rnd_dif_i };\n"
+	"\t// }}}\n"
+"\n", rnd_string, rnd_string, rnd_string, rnd_string);
+
+	fprintf(fp,
+	"\t// r_sync, ob_sync\n"
+	"\t// {{{\n"
+	"\t// Follow the sync through the two clocks of the butterfly\n"
+	"\tinitial\tr_sync  = 1\'b0;\n"
+	"\tinitial\tob_sync = 1\'b0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\tr_sync  <= 1\'b0;\n"
+		"\t\tob_sync <= 1\'b0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+		"\t\tr_sync  <= ib_sync;\n"
+		"\t\tob_sync <= r_sync;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// oaddr, o_sync, b_started\n"
+	"\t// {{{\n"
+	"\t// Recover the outputs from the butterfly, exactly as fftstage does.\n"
+	"\t// The first output can go immediately to the output of this routine\n"
+	"\t// The second output must wait until this time in the idle cycle\n"
+	"\tinitial oaddr     = 0;\n"
+	"\tinitial o_sync    = 0;\n"
+	"\tinitial b_started = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\toaddr     <= 0;\n"
+		"\t\to_sync    <= 0;\n"
+		"\t\tb_started <= 0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+	"\t\to_sync <= (!oaddr[LGSPAN])?ob_sync : 1\'b0;\n"
+	"\t\tif (ob_sync||b_started)\n"
+		"\t\t\toaddr <= oaddr + 1\'b1;\n"
+	"\t\tif ((ob_sync)&&(!oaddr[LGSPAN]))\n"
+		"\t\t\tb_started <= 1\'b1;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// nxt_oaddr\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\tnxt_oaddr[0] <= oaddr[0];\n"
+	"\tgenerate if (LGSPAN>1)\n"
+	"\tbegin : WIDE_LGSPAN\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (i_ce)\n"
+		"\t\t\tnxt_oaddr[LGSPAN-1:1] <= oaddr[LGSPAN-1:1] + 1\'b1;\n"
+"\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n"
+	"\t// omem\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(!oaddr[LGSPAN]))\n"
+		"\t\tomem[oaddr[(LGSPAN-1):0]] <= ob_b;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// pre_ovalue\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\tpre_ovalue <= omem[nxt_oaddr[(LGSPAN-1):0]];\n"
+	"\t// }}}\n"
+"\n"
+	"\t// o_data\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\to_data <= (!oaddr[LGSPAN]) ? ob_a : pre_ovalue;\n"
+	"\t// }}}\n"
+"\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_twidstage
+// {{{
+// Builds the twiddle multiply that follows a group of multiplier-free
+// butterfly stages.  The twiddle factors themselves are found in a
+// coefficient file, generated by gen_twiddles().  The multiply is done by
+// the butterfly (or hwbfly), with one input set to zero.
+//
+int	build_twidstage(const char *fname, const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\ttwidstage.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tApplies the twiddle factors following a group of radix-2^2\n"
+"//		or 2^3 butterfly stages (see bf2stage.v).  Every incoming\n"
+"//	sample is multiplied by the next coefficient from COEFFILE, starting\n"
+"//	over again every 2^LGWIDTH samples.\n"
+"//\n"
+"// Operation:\n"
+"//	y[n] = x[n] * c[n], where c[n] is found in COEFFILE.\n"
+"//\n"
+"//	When the first x[0] enters, i_sync must be true.  o_sync will then be\n"
+"//	true with every y[0] produced.  The multiply itself is done by the\n"
+"//	butterfly (OPT_HWMPY=0) or hwbfly (OPT_HWMPY=1), with the right\n"
+"//	input set to zero, so that o_right = (i_left - 0) * c[n].\n"
+"//\n"
+"//	By default, OWIDTH=IWIDTH, and SHIFT=1 keeps the output at the same\n"
+"//	scale as the input.  Like any other stage, an output component may\n"
+"//	overflow if the magnitude of a complex input approaches full scale.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\ttwidstage #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=16, CWIDTH=20, OWIDTH=IWIDTH, SHIFT=1,\n"
+	"\t\t// LGWIDTH is the base two log of the number of coefficients,\n"
+	"\t\t// equal to the span of the stage pair before us\n"
+	"\t\tparameter\tLGWIDTH=6,\n"
+	"\t\tparameter [0:0]\tOPT_HWMPY = 1,\n"
+	"\t\tparameter\tCKPCE = 1,\n"
+	"\t\tparameter\tCOEFFILE=\"cmem_r4_64.hex\"\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s,\n"
+			"\t\t\t\t\t\t\ti_ce, i_sync,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n"
+	"\t\toutput\twire\t[(2*OWIDTH-1):0]	o_data,\n"
+	"\t\toutput\twire\t			o_sync\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\treg				wait_for_sync;\n"
+	"\treg	[(LGWIDTH-1):0]		iaddr;\n"
+	"\treg	[(2*IWIDTH-1):0]	ib_a;\n"
+	"\treg	[(2*CWIDTH-1):0]	ib_c;\n"
+	"\treg				ib_sync;\n"
+	"\t// Verilator lint_off UNUSED\n"
+	"\twire	[(2*OWIDTH-1):0]	ob_unused;\n"
+	"\t// Verilator lint_on  UNUSED\n"
+"\n"
+	"\treg	[(2*CWIDTH-1):0]	cmem [0:((1<<LGWIDTH)-1)];\n"
+	"\t// }}}\n"
+"\n");
+	gen_cmem_rom(fp, "\t");
+	gen_cmem_init(fp, "\t", "cmem", "COEFFILE", "LGWIDTH");
+	fprintf(fp, "\n");
+
+	fprintf(fp,
+	"\t// wait_for_sync, iaddr\n"
+	"\t// {{{\n"
+	"\tinitial wait_for_sync = 1\'b1;\n"
+	"\tinitial iaddr = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\twait_for_sync <= 1\'b1;\n"
+		"\t\tiaddr <= 0;\n"
+	"\tend else if ((i_ce)&&((!wait_for_sync)||(i_sync)))\n"
+	"\tbegin\n"
+		"\t\tiaddr <= iaddr + 1\'b1;\n"
+		"\t\twait_for_sync <= 1\'b0;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// ib_sync\n"
+	"\t// {{{\n"
+	"\tinitial ib_sync = 1\'b0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+		"\t\tib_sync <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+		"\t\tib_sync <= ((!wait_for_sync)||(i_sync))&&(iaddr == 0);\n"
+	"\t// }}}\n"
+"\n"
+	"\t// ib_a, ib_c\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tib_a <= i_data;\n"
+		"\t\tib_c <= cmem[iaddr];\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// Instantiate the multiply\n"
+	"\t// {{{\n"
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t//\n"
+"\tgenerate if (OPT_HWMPY)\n"
+"\tbegin : HWBFLY\n"
+"\n"
+	"\t\thwbfly #(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.IWIDTH(IWIDTH),\n"
+		"\t\t\t.CWIDTH(CWIDTH),\n"
+		"\t\t\t.OWIDTH(OWIDTH),\n"
+		"\t\t\t.CKPCE(CKPCE),\n"
+		"\t\t\t.SHIFT(SHIFT)\n"
+		"\t\t\t// }}}\n"
+	"\t\t) bfly(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.i_clk(i_clk), .%s(%s), .i_ce(i_ce),\n"
+		"\t\t\t.i_coef(ib_c),\n"
+		"\t\t\t.i_left(ib_a),\n"
+		"\t\t\t.i_right({(2*IWIDTH){1\'b0}}),\n"
+		"\t\t\t.i_aux(ib_sync && i_ce),\n"
+		"\t\t\t.o_left(ob_unused), .o_right(o_data), .o_aux(o_sync)\n"
+		"\t\t\t// }}}\n"
+	"\t\t);\n"
+"\n"
+"\tend else begin : FWBFLY\n"
+"\n"
+	"\t\tbutterfly #(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.IWIDTH(IWIDTH),\n"
+		"\t\t\t.CWIDTH(CWIDTH),\n"
+		"\t\t\t.OWIDTH(OWIDTH),\n"
+		"\t\t\t.CKPCE(CKPCE),\n"
+		"\t\t\t.SHIFT(SHIFT)\n"
+		"\t\t\t// }}}\n"
+	"\t\t) bfly(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.i_clk(i_clk), .%s(%s), .i_ce(i_ce),\n"
+		"\t\t\t.i_coef(ib_c),\n"
+		"\t\t\t.i_left(ib_a),\n"
+		"\t\t\t.i_right({(2*IWIDTH){1\'b0}}),\n"
+		"\t\t\t.i_aux(ib_sync && i_ce),\n"
+		"\t\t\t.o_left(ob_unused), .o_right(o_data), .o_aux(o_sync)\n"
+		"\t\t\t// }}}\n"
+	"\t\t);\n"
+"\n"
+"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), resetw.c_str(),
+		resetw.c_str(), resetw.c_str());
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_w8stage
+// {{{
+// Builds the eight point stage of a single clock, decimation in frequency
+// FFT.  Its only non-trivial twiddle factors are (+/-1 -/+ j)/sqrt(2), and so
+// its multiplies are by a single constant, K = 2^(cwidth-2)/sqrt(2), rounded
+// as the coefficient files would round it.  These are built from shifts and
+// adds, using the canonical signed digit form of K.
+//
+int	build_w8stage(const char *fname, ROUND_T rounding, int cwidth,
+			const bool async_reset, const bool dbg) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+	const	char	*rnd_string;
+	if (rounding == RND_TRUNCATE)
+		rnd_string = "truncate";
+	else if (rounding == RND_FROMZERO)
+		rnd_string = "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		rnd_string = "roundhalfup";
+	else
+		rnd_string = "convround";
+
+	// Multiply by K from its canonical signed digits
+	// {{{
+	long long		k, kim;
+	std::string		kdigits, mpy_sum, mpy_dif;
+
+	gen_coeff_value(8, 1, cwidth, false, &k, &kim);
+	mpy_sum = gen_csd_mpy(k, "w_dsum", &kdigits);
+	mpy_dif = gen_csd_mpy(k, "w_ddif");
+	// }}}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tw8stage%s.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:	This file encapsulates the 8 point stage of a decimation in\n"
+"//		frequency FFT.  Like the qtrstage, it doesn\'t need any\n"
+"//	general purpose multiplies.  Its twiddle factors are all either\n"
+"//	trivial, or (+/-1 +/- j)/sqrt(2), and so every multiply within it\n"
+"//	is by one constant, K, built from shifts and adds.\n"
+"//\n"
+"// Operation:\n"
+"// 	Given x[n] and x[n+4], with i_sync true for x[0] being input,\n"
+"// 	this stage produces\n"
+"//\n"
+"// 	y[n  ] = x[n] + x[n+4]\n"
+"// 	y[n+4] = (x[n] - x[n+4]) * e^{-j2pi n/8}	(forward transform)\n"
+"//\n"
+"// 	Writing d = x[n] - x[n+4], a = d.r + d.i, and b = d.i - d.r, the\n"
+"// 	differences of the forward transform become\n"
+"//\n"
+"// 	n = 0:	(d.r, d.i)\n"
+"// 	n = 1:	(a, b) / sqrt(2)\n"
+"// 	n = 2:	(d.i, -d.r)\n"
+"// 	n = 3:	(b, -a) / sqrt(2)\n"
+"//\n"
+"// 	The inverse transform (INVERSE = 1) uses (d.r, d.i), (-b, a)/sqrt(2),\n"
+"// 	(-d.i, d.r), and (-a, -b)/sqrt(2) instead.  Only a and b are ever\n"
+"// 	multiplied, and then only by K = 1/sqrt(2), scaled by 2^(CWIDTH-2)\n"
+"// 	and rounded exactly as the fftstage\'s coefficients would be.\n"
+"// 	The results therefore match those of an fftstage, bit for bit.\n"
+"//\n%s"
+"//\n",
+		(dbg)?"_dbg":"", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+"module\tw8stage%s(i_clk, %s, i_ce, i_sync, i_data, o_data, o_sync%s);\n"
+	"\tparameter	IWIDTH=%d, OWIDTH=IWIDTH+1;\n"
+	"\tparameter\tINVERSE=0, SHIFT=0;\n"
+	"\t// The constant multiplies below were built for twiddle factors of\n"
+	"\t// CWIDTH bits, FRAC of them fractional, and for no others\n"
+	"\tlocalparam\tCWIDTH=%d, FRAC=CWIDTH-2;\n"
+	"\t// PW is the width of the products, and of all that\'s rounded\n"
+	"\t// along with them\n"
+	"\tlocalparam\tPW=IWIDTH+2+FRAC;\n"
+	"\tinput\twire				i_clk, %s, i_ce, i_sync;\n"
+	"\tinput\twire	[(2*IWIDTH-1):0]	i_data;\n"
+	"\toutput\treg	[(2*OWIDTH-1):0]	o_data;\n"
+	"\toutput\treg				o_sync;\n"
+		"\t\n", (dbg)?"_dbg":"", resetw.c_str(),
+		(dbg)?", o_dbg":"", TST_W8STAGE_IWIDTH,
+		cwidth, resetw.c_str());
+	if (dbg) { fprintf(fp, "\toutput\twire\t[33:0]\t\t\to_dbg;\n"
+		"\tassign\to_dbg = { ((o_sync)&&(i_ce)), i_ce, o_data[(2*OWIDTH-1):(2*OWIDTH-16)],\n"
+			"\t\t\t\t\to_data[(OWIDTH-1):(OWIDTH-16)] };\n"
+"\n");
+	}
+
+	fprintf(fp,
+	"\treg\t	wait_for_sync, r_started;\n"
+	"\treg\t[3:0]	iaddr;\n"
+	"\treg\t[4:0]	pipeline;\n"
+"\n"
+	"\treg\t[(2*IWIDTH-1):0]\timem\t[0:3];\n"
+	"\treg\t[(2*OWIDTH-1):0]\tomem\t[0:3];\n"
+"\n"
+	"\twire\tsigned\t[(IWIDTH-1):0]\timem_r, imem_i;\n"
+	"\tassign\timem_r = imem[3][(2*IWIDTH-1):(IWIDTH)];\n"
+	"\tassign\timem_i = imem[3][(IWIDTH-1):0];\n"
+"\n"
+	"\twire\tsigned\t[(IWIDTH-1):0]\ti_data_r, i_data_i;\n"
+	"\tassign\ti_data_r = i_data[(2*IWIDTH-1):(IWIDTH)];\n"
+	"\tassign\ti_data_i = i_data[(IWIDTH-1):0];\n"
+"\n"
+	"\t// The butterfly\'s sum and difference, and the sum delayed to\n"
+	"\t// match the difference\'s multiply\n"
+	"\treg\tsigned\t[(IWIDTH):0]\tsum_r, sum_i, diff_r, diff_i,\n"
+	"\t\t\t\t\tsum1_r, sum1_i, diff1_r, diff1_i,\n"
+	"\t\t\t\t\tsum2_r, sum2_i, diff2_r, diff2_i,\n"
+	"\t\t\t\t\tsum3_r, sum3_i;\n"
+	"\treg\t\t[1:0]\t\tr_k, r_k1, r_k2;\n"
+"\n"
+	"\t// The sum and difference of the difference\'s halves, a and b,\n"
+	"\t// and their products with K\n"
+	"\treg\tsigned\t[(IWIDTH+1):0]\tdsum, ddif;\n"
+	"\twire\tsigned\t[(PW-1):0]\tw_dsum, w_ddif;\n"
+	"\treg\tsigned\t[(PW-1):0]\tp_sum, p_dif;\n"
+"\n"
+	"\t// The difference, rotated by its twiddle factor\n"
+	"\twire\tsigned\t[(PW-1):0]\tw_diff_r, w_diff_i;\n"
+	"\treg\tsigned\t[(PW-1):0]\trot_r, rot_i;\n"
+"\n");
+
+	fprintf(fp, "\t//\n"
+	"\t// Round our output values down to OWIDTH bits\n"
+	"\t//\n");
+
+	fprintf(fp,
+	"\twire\tsigned\t[(OWIDTH-1):0]\trnd_sum_r, rnd_sum_i,\n"
+	"\t\t\trnd_rot_r, rnd_rot_i;\n"
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_r(i_clk, i_ce,\n"
+	"\t\t\t\tsum3_r, rnd_sum_r);\n\n", rnd_string);
+	fprintf(fp,
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_i(i_clk, i_ce,\n"
+	"\t\t\t\tsum3_i, rnd_sum_i);\n\n", rnd_string);
+	fprintf(fp,
+	"\t// The rotated differences carry FRAC more bits below, and one\n"
+	"\t// more (unused) above, the sums\n"
+	"\t%s #(PW,OWIDTH,SHIFT+1)\tdo_rnd_rot_r(i_clk, i_ce,\n"
+	"\t\t\t\trot_r, rnd_rot_r);\n\n", rnd_string);
+	fprintf(fp,
+	"\t%s #(PW,OWIDTH,SHIFT+1)\tdo_rnd_rot_i(i_clk, i_ce,\n"
+	"\t\t\t\trot_i, rnd_rot_i);\n\n", rnd_string);
+
+	fprintf(fp,
+	"\tinitial wait_for_sync = 1\'b1;\n"
+	"\tinitial iaddr = 0;\n");
+	if (async_reset)
+		fprintf(fp,
+			"\talways @(posedge i_clk, negedge i_areset_n)\n"
+			"\tif (!i_areset_n)\n");
+	else
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_reset)\n");
+
+	fprintf(fp, "\tbegin\n"
+		"\t\twait_for_sync <= 1\'b1;\n"
+		"\t\tiaddr <= 0;\n"
+	"\tend else if ((i_ce)&&((!wait_for_sync)||(i_sync)))\n"
+	"\tbegin\n"
+		"\t\tiaddr <= iaddr + 1\'b1;\n"
+		"\t\twait_for_sync <= 1\'b0;\n"
+	"\tend\n\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\timem[0] <= i_data;\n"
+		"\t\timem[1] <= imem[0];\n"
+		"\t\timem[2] <= imem[1];\n"
+		"\t\timem[3] <= imem[2];\n"
+	"\tend\n"
+	"\n\n");
+	fprintf(fp,
+	"\t// As with the qtrstage, iaddr will always be zero until after the\n"
+	"\t// first i_ce, so we needn\'t check wait_for_sync here.\n"
+	"\tinitial pipeline = 5\'h0;\n");
+
+	if (async_reset)
+		fprintf(fp,
+	"\talways\t@(posedge i_clk, negedge i_areset_n)\n"
+	"\tif (!i_areset_n)\n");
+	else
+		fprintf(fp,
+	"\talways\t@(posedge i_clk)\n"
+	"\tif (i_reset)\n");
+
+	fprintf(fp,
+		"\t\tpipeline <= 5\'h0;\n"
+	"\telse if (i_ce) // is our pipeline process full?  Which stages?\n"
+		"\t\tpipeline <= { pipeline[3:0], iaddr[2] };\n\n");
+	fprintf(fp,
+	"\t// This is the pipeline[-1] stage, pipeline[0] will be set next.\n"
+	"\talways\t@(posedge i_clk)\n"
+	"\tif ((i_ce)&&(iaddr[2]))\n"
+	"\tbegin\n"
+		"\t\tsum_r  <= imem_r + i_data_r;\n"
+		"\t\tsum_i  <= imem_i + i_data_i;\n"
+		"\t\tdiff_r <= imem_r - i_data_r;\n"
+		"\t\tdiff_i <= imem_i - i_data_i;\n"
+		"\t\tr_k    <= iaddr[1:0];\n"
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\t// pipeline[0]: a = d.r + d.i, b = d.i - d.r\n"
+	"\talways\t@(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tsum1_r  <= sum_r;\n"
+		"\t\tsum1_i  <= sum_i;\n"
+		"\t\tdiff1_r <= diff_r;\n"
+		"\t\tdiff1_i <= diff_i;\n"
+		"\t\tr_k1    <= r_k;\n"
+"\n"
+		"\t\tdsum <= diff_r + diff_i;\n"
+		"\t\tddif <= diff_i - diff_r;\n"
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\t// pipeline[1]: multiply a and b by\n"
+	"\t//	K = %lld = %s\n"
+	"\tassign\tw_dsum = { {(FRAC){dsum[IWIDTH+1]}}, dsum };\n"
+	"\tassign\tw_ddif = { {(FRAC){ddif[IWIDTH+1]}}, ddif };\n"
+"\n"
+	"\talways\t@(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tsum2_r  <= sum1_r;\n"
+		"\t\tsum2_i  <= sum1_i;\n"
+		"\t\tdiff2_r <= diff1_r;\n"
+		"\t\tdiff2_i <= diff1_i;\n"
+		"\t\tr_k2    <= r_k1;\n"
+"\n"
+		"\t\tp_sum <= %s;\n"
+		"\t\tp_dif <= %s;\n"
+	"\tend\n\n", k, kdigits.c_str(), mpy_sum.c_str(), mpy_dif.c_str());
+
+	fprintf(fp,
+	"\t// pipeline[2]: rotate the difference by its twiddle factor.  The\n"
+	"\t// trivial factors need only be scaled to match the products.\n"
+	"\tassign\tw_diff_r = { diff2_r[IWIDTH], diff2_r, {(FRAC){1\'b0}} };\n"
+	"\tassign\tw_diff_i = { diff2_i[IWIDTH], diff2_i, {(FRAC){1\'b0}} };\n"
+"\n"
+	"\talways\t@(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tsum3_r <= sum2_r;\n"
+		"\t\tsum3_i <= sum2_i;\n"
+"\n"
+		"\t\tif (INVERSE == 0)\n"
+		"\t\tbegin\n"
+		"\t\t\tcase(r_k2)\n"
+		"\t\t\t// W = e^{-j2pi 0/8} = 1\n"
+		"\t\t\t2\'b00: begin rot_r <=  w_diff_r; rot_i <=  w_diff_i; end\n"
+		"\t\t\t// W = e^{-j2pi 1/8} = (1-j)/sqrt(2)\n"
+		"\t\t\t2\'b01: begin rot_r <=  p_sum;    rot_i <=  p_dif;    end\n"
+		"\t\t\t// W = e^{-j2pi 2/8} = -j\n"
+		"\t\t\t2\'b10: begin rot_r <=  w_diff_i; rot_i <= -w_diff_r; end\n"
+		"\t\t\t// W = e^{-j2pi 3/8} = (-1-j)/sqrt(2)\n"
+		"\t\t\t2\'b11: begin rot_r <=  p_dif;    rot_i <= -p_sum;    end\n"
+		"\t\t\tendcase\n"
+		"\t\tend else begin\n"
+		"\t\t\tcase(r_k2)\n"
+		"\t\t\t// W = e^{j2pi 0/8} = 1\n"
+		"\t\t\t2\'b00: begin rot_r <=  w_diff_r; rot_i <=  w_diff_i; end\n"
+		"\t\t\t// W = e^{j2pi 1/8} = (1+j)/sqrt(2)\n"
+		"\t\t\t2\'b01: begin rot_r <= -p_dif;    rot_i <=  p_sum;    end\n"
+		"\t\t\t// W = e^{j2pi 2/8} = j\n"
+		"\t\t\t2\'b10: begin rot_r <= -w_diff_i; rot_i <=  w_diff_r; end\n"
+		"\t\t\t// W = e^{j2pi 3/8} = (-1+j)/sqrt(2)\n"
+		"\t\t\t2\'b11: begin rot_r <= -p_sum;    rot_i <= -p_dif;    end\n"
+		"\t\t\tendcase\n"
+		"\t\tend\n"
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\t// pipeline[3] takes sum3_x and rot_x and produces rnd_x\n\n");
+
+	fprintf(fp,
+	"\talways\t@(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tomem[0] <= { rnd_rot_r, rnd_rot_i };\n"
+		"\t\tomem[1] <= omem[0];\n"
+		"\t\tomem[2] <= omem[1];\n"
+		"\t\tomem[3] <= omem[2];\n"
+		"\t\tif (pipeline[4])\n"
+			"\t\t\to_data <= { rnd_sum_r, rnd_sum_i };\n"
+		"\t\telse\n"
+			"\t\t\to_data <= omem[3];\n"
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\t// The first output follows the first input by nine i_ce\'s.  As\n"
+	"\t// with the fftstage, o_sync then marks every eighth output.\n"
+	"\tinitial\tr_started = 1\'b0;\n"
+	"\tinitial\to_sync = 1\'b0;\n");
+
+	if (async_reset)
+		fprintf(fp,
+	"\talways\t@(posedge i_clk, negedge i_areset_n)\n"
+	"\tif (!i_areset_n)\n");
+	else
+		fprintf(fp,
+	"\talways\t@(posedge i_clk)\n"
+	"\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\tr_started <= 1\'b0;\n"
+		"\t\to_sync    <= 1\'b0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+		"\t\tif (iaddr[3])\n"
+			"\t\t\tr_started <= 1\'b1;\n"
+		"\t\to_sync <= (iaddr[2:0] == 3\'b001)\n"
+			"\t\t\t\t&&((r_started)||(iaddr[3]));\n"
+	"\tend\n\n");
+
+	fprintf(fp, "endmodule\n");
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_w8twid
+// {{{
+// Builds the constant twiddle multiply found in the middle of each group of
+// three radix-2^3 stages.  Its only non-trivial twiddle factors are
+// (+/-1 - j)/sqrt(2), and so it multiplies by a single constant,
+// K = 2^(cwidth-2)/sqrt(2), built from shifts and adds exactly as the
+// w8stage builds it.  One module serves every group, so cwidth should be that
+// of the widest group.
+//
+int	build_w8twid(const char *fname, ROUND_T rounding, int cwidth,
+			const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	const	char	*rnd_string;
+	if (rounding == RND_TRUNCATE)
+		rnd_string = "truncate";
+	else if (rounding == RND_FROMZERO)
+		rnd_string = "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		rnd_string = "roundhalfup";
+	else
+		rnd_string = "convround";
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	// Multiply by K from its canonical signed digits
+	// {{{
+	long long	k, kim;
+	std::string	kdigits, mpy_sum, mpy_dif;
+
+	gen_coeff_value(8, 1, cwidth, false, &k, &kim);
+	mpy_sum = gen_csd_mpy(k, "w_dsum", &kdigits);
+	mpy_dif = gen_csd_mpy(k, "w_ddif");
+	// }}}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tw8twid.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tApplies the twiddle factors found between the second and third\n"
+"//		butterfly stages of a radix-2^3 group (see bf2stage.v).\n"
+"//	These are all powers of W_8 = e^{-j2pi/8}, and so need no general\n"
+"//	purpose multiply.  Two of them are trivial, and the other two are\n"
+"//	multiplies by a single constant, K, built from shifts and adds.  The\n"
+"//	one general twiddle multiply of the group, a twidstage, then follows\n"
+"//	the group\'s third stage.\n"
+"//\n"
+"// Operation:\n"
+"//	The first stage of the group produces outputs k1 (0 or 1) for inputs\n"
+"//	n (0 to N/2-1), in the order m = k1*N/2 + n.  The second, given\n"
+"//	n = n2*N/4 + n3*N/8 + n4, then produces outputs in the order\n"
+"//	m = k1*N/2 + k2*N/4 + n3*N/8 + n4.  Each of these needs the twiddle,\n"
+"//\n"
+"//	y[m] = x[m] * W_8^{n3*(k1 + 2*k2)}\n"
+"//\n"
+"//	where N = 2^LGWIDTH is the span of the group.  Writing a = x.r + x.i,\n"
+"//	and b = x.i - x.r, the products of the forward transform become\n"
+"//\n"
+"//	k1 + 2*k2 = 0:	(x.r, x.i)\n"
+"//	k1 + 2*k2 = 1:	(a, b) / sqrt(2)\n"
+"//	k1 + 2*k2 = 2:	(x.i, -x.r)\n"
+"//	k1 + 2*k2 = 3:	(b, -a) / sqrt(2)\n"
+"//\n"
+"//	for n3 = 1, and (x.r, x.i) otherwise.  The inverse transform\n"
+"//	(INVERSE = 1) uses the conjugates of these twiddles instead.  K is\n"
+"//	1/sqrt(2), scaled by 2^(CWIDTH-2) and rounded as the coefficient\n"
+"//	files would round it.\n"
+"//\n"
+"//	When the first x[0] enters, i_sync must be true.  o_sync will then be\n"
+"//	true with every y[0] produced, five clocks later.  As with the\n"
+"//	twidstage, OWIDTH=IWIDTH keeps the output at the same scale as the\n"
+"//	input, and an output component may overflow if the magnitude of a\n"
+"//	complex input approaches full scale.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tw8twid #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=16, OWIDTH=IWIDTH,\n"
+	"\t\t// LGWIDTH is the base two log of the span of the stage group\n"
+	"\t\t// we are within.  It must be at least three.\n"
+	"\t\tparameter\tLGWIDTH=6,\n"
+	"\t\tparameter [0:0]\tINVERSE=0,\n"
+	"\t\t// The constant multiplies below were built for twiddle factors\n"
+	"\t\t// of CWIDTH bits, FRAC of them fractional, and for no others\n"
+	"\t\tlocalparam\tCWIDTH=%d, FRAC=CWIDTH-2,\n"
+	"\t\t// PW is the width of the products, and of all that\'s rounded\n"
+	"\t\t// along with them\n"
+	"\t\tlocalparam\tPW=IWIDTH+1+FRAC\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s,\n"
+			"\t\t\t\t\t\t\ti_ce, i_sync,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n"
+	"\t\toutput\twire\t[(2*OWIDTH-1):0]	o_data,\n"
+	"\t\toutput\treg\t			o_sync\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", cwidth, resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\treg				wait_for_sync;\n"
+	"\treg	[(LGWIDTH-1):0]		iaddr;\n"
+"\n"
+	"\t// The input, and then the same delayed to match the multiply\n"
+	"\treg	signed	[(IWIDTH-1):0]	ib_r, ib_i, r_r, r_i, p_r, p_i;\n"
+	"\treg		[1:0]		ib_k, r_k, p_k;\n"
+	"\treg				ib_sync, r_sync, p_sync, rot_sync;\n"
+"\n"
+	"\t// a and b, and their products with K\n"
+	"\treg	signed	[IWIDTH:0]	dsum, ddif;\n"
+	"\twire	signed	[(PW-1):0]	w_dsum, w_ddif;\n"
+	"\treg	signed	[(PW-1):0]	p_sum, p_dif;\n"
+"\n"
+	"\t// The input, rotated by its twiddle factor\n"
+	"\twire	signed	[(PW-1):0]	w_r, w_i;\n"
+	"\treg	signed	[(PW-1):0]	rot_r, rot_i;\n"
+	"\twire	signed	[(OWIDTH-1):0]	rnd_r, rnd_i;\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// wait_for_sync, iaddr\n"
+	"\t// {{{\n"
+	"\tinitial wait_for_sync = 1\'b1;\n"
+	"\tinitial iaddr = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\twait_for_sync <= 1\'b1;\n"
+		"\t\tiaddr <= 0;\n"
+	"\tend else if ((i_ce)&&((!wait_for_sync)||(i_sync)))\n"
+	"\tbegin\n"
+		"\t\tiaddr <= iaddr + 1\'b1;\n"
+		"\t\twait_for_sync <= 1\'b0;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// ib_sync, r_sync, p_sync, rot_sync, o_sync\n"
+	"\t// {{{\n"
+	"\t// Follow the sync through the pipeline, and the rounding at its end\n"
+	"\tinitial { ib_sync, r_sync, p_sync, rot_sync, o_sync } = 5\'h0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+		"\t\t{ ib_sync, r_sync, p_sync, rot_sync, o_sync } <= 5\'h0;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+		"\t\tib_sync  <= ((!wait_for_sync)||(i_sync))&&(iaddr == 0);\n"
+		"\t\tr_sync   <= ib_sync;\n"
+		"\t\tp_sync   <= r_sync;\n"
+		"\t\trot_sync <= p_sync;\n"
+		"\t\to_sync   <= rot_sync;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// ib_r, ib_i, ib_k\n"
+	"\t// {{{\n"
+	"\t// The twiddle is W_8^{k1 + 2*k2} when n3 is set, and one otherwise\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tib_r <= i_data[(2*IWIDTH-1):IWIDTH];\n"
+		"\t\tib_i <= i_data[(IWIDTH-1):0];\n"
+		"\t\tib_k <= (iaddr[LGWIDTH-3])\n"
+			"\t\t\t? { iaddr[LGWIDTH-2], iaddr[LGWIDTH-1] } : 2\'b00;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// dsum, ddif: a = x.r + x.i, b = x.i - x.r\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tr_r <= ib_r;\n"
+		"\t\tr_i <= ib_i;\n"
+		"\t\tr_k <= ib_k;\n"
+"\n"
+		"\t\tdsum <= ib_r + ib_i;\n"
+		"\t\tddif <= ib_i - ib_r;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// p_sum, p_dif: multiply a and b by\n"
+	"\t// {{{\n"
+	"\t//	K = %lld = %s\n"
+	"\tassign\tw_dsum = { {(FRAC){dsum[IWIDTH]}}, dsum };\n"
+	"\tassign\tw_ddif = { {(FRAC){ddif[IWIDTH]}}, ddif };\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tp_r <= r_r;\n"
+		"\t\tp_i <= r_i;\n"
+		"\t\tp_k <= r_k;\n"
+"\n"
+		"\t\tp_sum <= %s;\n"
+		"\t\tp_dif <= %s;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n", k, kdigits.c_str(), mpy_sum.c_str(), mpy_dif.c_str());
+
+	fprintf(fp,
+	"\t// rot_r, rot_i: rotate the input by its twiddle factor\n"
+	"\t// {{{\n"
+	"\t// The trivial factors need only be scaled to match the products\n"
+	"\tassign\tw_r = { p_r[IWIDTH-1], p_r, {(FRAC){1\'b0}} };\n"
+	"\tassign\tw_i = { p_i[IWIDTH-1], p_i, {(FRAC){1\'b0}} };\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tif (!INVERSE)\n"
+		"\t\tbegin\n"
+			"\t\t\tcase(p_k)\n"
+			"\t\t\t// W = 1\n"
+			"\t\t\t2\'b00: begin rot_r <=  w_r;   rot_i <=  w_i;   end\n"
+			"\t\t\t// W = (1-j)/sqrt(2)\n"
+			"\t\t\t2\'b01: begin rot_r <=  p_sum; rot_i <=  p_dif; end\n"
+			"\t\t\t// W = -j\n"
+			"\t\t\t2\'b10: begin rot_r <=  w_i;   rot_i <= -w_r;   end\n"
+			"\t\t\t// W = (-1-j)/sqrt(2)\n"
+			"\t\t\t2\'b11: begin rot_r <=  p_dif; rot_i <= -p_sum; end\n"
+			"\t\t\tendcase\n"
+		"\t\tend else begin\n"
+			"\t\t\tcase(p_k)\n"
+			"\t\t\t// W = 1\n"
+			"\t\t\t2\'b00: begin rot_r <=  w_r;   rot_i <=  w_i;   end\n"
+			"\t\t\t// W = (1+j)/sqrt(2)\n"
+			"\t\t\t2\'b01: begin rot_r <= -p_dif; rot_i <=  p_sum; end\n"
+			"\t\t\t// W = j\n"
+			"\t\t\t2\'b10: begin rot_r <= -w_i;   rot_i <=  w_r;   end\n"
+			"\t\t\t// W = (-1+j)/sqrt(2)\n"
+			"\t\t\t2\'b11: begin rot_r <= -p_sum; rot_i <= -p_dif; end\n"
+			"\t\t\tendcase\n"
+		"\t\tend\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// Round the results down to OWIDTH bits\n"
+	"\t// {{{\n"
+	"\t// The rotated values carry FRAC more bits below the input, and one\n"
+	"\t// more (unused) above it\n"
+	"\t%s #(PW,OWIDTH,1)\tdo_rnd_r(i_clk, i_ce, rot_r, rnd_r);\n"
+	"\t%s #(PW,OWIDTH,1)\tdo_rnd_i(i_clk, i_ce, rot_i, rnd_i);\n"
+"\n"
+	"\tassign\to_data = { rnd_r, rnd_i };\n"
+	"\t// }}}\n"
+"\n"
+"endmodule\n", rnd_string, rnd_string);
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_realstage
+// {{{
+// Builds the post-processing stage of a real FFT.  An N point real FFT is
+// calculated by an N/2 point complex FFT, followed by this stage.  This stage
+// also replaces the bit reversal stage, since it needs to buffer a full frame
+// of data anyway.
+//
+int	build_realstage(const char *fname, ROUND_T rounding,
+			const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	const	char	*rnd_string;
+	if (rounding == RND_TRUNCATE)
+		rnd_string = "truncate";
+	else if (rounding == RND_FROMZERO)
+		rnd_string = "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		rnd_string = "roundhalfup";
+	else
+		rnd_string = "convround";
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\trealstage.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThe post-processing stage of a real FFT.  An N point real\n"
+"//		FFT is calculated by packing the even samples into the real\n"
+"//	portion, and the odd samples into the imaginary portion, of an N/2\n"
+"//	point complex FFT.  The (bit reversed) outputs of that complex FFT,\n"
+"//	Z[k], are then fed to this stage, which recovers the real FFT's\n"
+"//	outputs from\n"
+"//\n"
+"//	X[k] = 1/2 [(Z[k] + Z*[N/2-k]) + (-j W_N^k) (Z[k] - Z*[N/2-k])]\n"
+"//\n"
+"//	The terms in parentheses are calculated by a butterfly, given the\n"
+"//	coefficients -j W_N^k found in COEFFILE.\n"
+"//\n"
+"//	Since the outputs of a real FFT are conjugate symmetric, only the\n"
+"//	N/2+1 unique outputs, X[0] through X[N/2], are produced.  Both\n"
+"//	X[0] and X[N/2] are purely real, so they are packed into the first\n"
+"//	output word: X[0] in the real half, and X[N/2] in the imaginary half.\n"
+"//	The outputs are produced in natural order.\n"
+"//\n"
+"//	Since we need to buffer a full frame of data anyway, in order to\n"
+"//	read both Z[k] and Z[N/2-k] at once, this stage also replaces the\n"
+"//	bit reversal stage.  As with the bitreverse module, i_ce must be held\n"
+"//	low until the first sample of the first frame is available.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\trealstage #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=16, CWIDTH=20, OWIDTH=IWIDTH+1,\n"
+	"\t\t// LGSIZE is the base two log of the complex FFT size, N/2\n"
+	"\t\tparameter\tLGSIZE=10,\n"
+	"\t\tparameter [0:0]\tOPT_HWMPY = 1,\n"
+	"\t\tparameter\tCKPCE = 1,\n"
+	"\t\tparameter\tCOEFFILE=\"cmem_rl2048.hex\"\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s, i_ce,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_in,\n"
+	"\t\toutput\twire\t[(2*OWIDTH-1):0]	o_out,\n"
+	"\t\toutput\treg\t			o_sync\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\treg	[(LGSIZE):0]		wraddr;\n"
+	"\twire	[(LGSIZE-1):0]		braddr, loaddr, hiaddr, addr0, addr1;\n"
+	"\treg				in_reset;\n"
+"\n"
+	"\treg	[(2*IWIDTH-1):0]	mem0	[0:((1<<LGSIZE)-1)];\n"
+	"\treg	[(2*IWIDTH-1):0]	mem1	[0:((1<<LGSIZE)-1)];\n"
+	"\treg	[(2*IWIDTH-1):0]	rd0a, rd0b, rd1a, rd1b;\n"
+	"\treg				rd_bank, rd_sync;\n"
+	"\treg	[(LGSIZE-1):0]		rd_k;\n"
+	"\twire	[(2*IWIDTH-1):0]	rd_a, rd_b;\n"
+	"\twire	signed	[(IWIDTH-1):0]	rd_a_r, rd_a_i, rd_b_r, rd_b_i;\n"
+	"\twire	signed	[IWIDTH:0]	neg_b_i;\n"
+"\n"
+	"\treg	[(2*CWIDTH-1):0]	cmem [0:((1<<LGSIZE)-1)];\n"
+	"\treg	[(2*IWIDTH+1):0]	ib_a, ib_b;\n"
+	"\treg	[(2*CWIDTH-1):0]	ib_c;\n"
+	"\treg				ib_sync;\n"
+"\n"
+	"\twire	[(2*IWIDTH+3):0]	ob_left, ob_right;\n"
+	"\twire				ob_sync;\n"
+	"\twire	signed	[(IWIDTH+1):0]	ob_left_r, ob_left_i,\n"
+	"\t\t\t\t\tob_right_r, ob_right_i;\n"
+	"\treg	signed	[(IWIDTH+2):0]	sum_r, sum_i;\n"
+	"\treg				r_sync;\n"
+	"\twire	signed	[(OWIDTH-1):0]	rnd_r, rnd_i;\n"
+	"\t// }}}\n"
+"\n");
+	gen_cmem_rom(fp, "\t");
+	gen_cmem_init(fp, "\t", "cmem", "COEFFILE", "LGSIZE");
+	fprintf(fp, "\n");
+
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// Buffer one frame, undoing the bit reversal as we go\n"
+	"\t// {{{\n"
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t//\n"
+"\n"
+	"\t// braddr, loaddr, hiaddr\n"
+	"\t// {{{\n"
+	"\t// Incoming samples are written in bit reversed order, so that we\n"
+	"\t// can then read them back out in natural order: Z[k] from loaddr,\n"
+	"\t// and Z[N/2-k] from hiaddr\n"
+"\tgenvar	k;\n"
+"\tgenerate for(k=0; k<LGSIZE; k=k+1)\n"
+"\tbegin : BITREV\n"
+"\t\tassign braddr[k] = wraddr[LGSIZE-1-k];\n"
+"\tend endgenerate\n"
+"\n"
+	"\tassign\tloaddr = wraddr[(LGSIZE-1):0];\n"
+	"\tassign\thiaddr = ~loaddr + 1\'b1;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// in_reset\n"
+	"\t// {{{\n"
+	"\tinitial	in_reset = 1'b1;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\t	in_reset <= 1'b1;\n"
+	"\telse if ((i_ce)&&(&wraddr[(LGSIZE-1):0]))\n"
+	"\t	in_reset <= 1'b0;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// wraddr\n"
+	"\t// {{{\n"
+	"\tinitial	wraddr = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\t	wraddr <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t	wraddr <= wraddr + 1;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// mem0, mem1\n"
+	"\t// {{{\n"
+	"\t// While one bank is written, the other is read from two places.\n"
+	"\t// Each bank therefore only ever needs two ports, so that it may\n"
+	"\t// be placed into a (true dual-port) block RAM.\n"
+	"\tassign\taddr0 = (wraddr[LGSIZE]) ? loaddr : braddr;\n"
+	"\tassign\taddr1 = (wraddr[LGSIZE]) ? braddr : loaddr;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t	if (!wraddr[LGSIZE])\n"
+	"\t		mem0[addr0] <= i_in;\n"
+	"\t	rd0a <= mem0[addr0];\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t	rd0b <= mem0[hiaddr];\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t	if (wraddr[LGSIZE])\n"
+	"\t		mem1[addr1] <= i_in;\n"
+	"\t	rd1a <= mem1[addr1];\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t	rd1b <= mem1[hiaddr];\n"
+	"\t// }}}\n"
+"\n"
+	"\t// rd_bank, rd_k\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t	rd_bank <= !wraddr[LGSIZE];\n"
+	"\t	rd_k    <= loaddr;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// rd_sync\n"
+	"\t// {{{\n"
+	"\tinitial	rd_sync = 1'b0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\t	rd_sync <= 1'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t	rd_sync <= (!in_reset)&&(loaddr == 0);\n"
+	"\t// }}}\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// The butterfly: Z[k] + Z*[N/2-k], and -j W^k (Z[k] - Z*[N/2-k])\n"
+	"\t// {{{\n"
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t//\n"
+"\n"
+	"\tassign\trd_a = (rd_bank) ? rd1a : rd0a;\n"
+	"\tassign\trd_b = (rd_bank) ? rd1b : rd0b;\n"
+"\n"
+	"\tassign\trd_a_r = rd_a[(2*IWIDTH-1):IWIDTH];\n"
+	"\tassign\trd_a_i = rd_a[(IWIDTH-1):0];\n"
+	"\tassign\trd_b_r = rd_b[(2*IWIDTH-1):IWIDTH];\n"
+	"\tassign\trd_b_i = rd_b[(IWIDTH-1):0];\n"
+"\n"
+	"\t// Conjugating might overflow, so we give ourselves an extra bit\n"
+	"\tassign\tneg_b_i = -{ rd_b_i[IWIDTH-1], rd_b_i };\n"
+"\n"
+	"\t// ib_a, ib_b, ib_c\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t	ib_a <= { rd_a_r[IWIDTH-1], rd_a_r, rd_a_i[IWIDTH-1], rd_a_i };\n"
+	"\t	ib_b <= { rd_b_r[IWIDTH-1], rd_b_r, neg_b_i };\n"
+	"\t	ib_c <= cmem[rd_k];\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// ib_sync\n"
+	"\t// {{{\n"
+	"\tinitial	ib_sync = 1'b0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\t	ib_sync <= 1'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t	ib_sync <= rd_sync;\n"
+	"\t// }}}\n"
+"\n"
+"\tgenerate if (OPT_HWMPY)\n"
+"\tbegin : HWBFLY\n"
+"\n"
+	"\t\thwbfly #(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.IWIDTH(IWIDTH+1),\n"
+		"\t\t\t.CWIDTH(CWIDTH),\n"
+		"\t\t\t.OWIDTH(IWIDTH+2),\n"
+		"\t\t\t.CKPCE(CKPCE),\n"
+		"\t\t\t.SHIFT(0)\n"
+		"\t\t\t// }}}\n"
+	"\t\t) bfly(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.i_clk(i_clk), .%s(%s), .i_ce(i_ce),\n"
+		"\t\t\t.i_coef(ib_c),\n"
+		"\t\t\t.i_left(ib_a),\n"
+		"\t\t\t.i_right(ib_b),\n"
+		"\t\t\t.i_aux(ib_sync && i_ce),\n"
+		"\t\t\t.o_left(ob_left), .o_right(ob_right), .o_aux(ob_sync)\n"
+		"\t\t\t// }}}\n"
+	"\t\t);\n"
+"\n"
+"\tend else begin : FWBFLY\n"
+"\n"
+	"\t\tbutterfly #(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.IWIDTH(IWIDTH+1),\n"
+		"\t\t\t.CWIDTH(CWIDTH),\n"
+		"\t\t\t.OWIDTH(IWIDTH+2),\n"
+		"\t\t\t.CKPCE(CKPCE),\n"
+		"\t\t\t.SHIFT(0)\n"
+		"\t\t\t// }}}\n"
+	"\t\t) bfly(\n"
+		"\t\t\t// {{{\n"
+		"\t\t\t.i_clk(i_clk), .%s(%s), .i_ce(i_ce),\n"
+		"\t\t\t.i_coef(ib_c),\n"
+		"\t\t\t.i_left(ib_a),\n"
+		"\t\t\t.i_right(ib_b),\n"
+		"\t\t\t.i_aux(ib_sync && i_ce),\n"
+		"\t\t\t.o_left(ob_left), .o_right(ob_right), .o_aux(ob_sync)\n"
+		"\t\t\t// }}}\n"
+	"\t\t);\n"
+"\n"
+"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n",
+		resetw.c_str(), resetw.c_str(),
+		resetw.c_str(), resetw.c_str());
+
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// Add the two halves together, and divide by two\n"
+	"\t// {{{\n"
+	"\t////////////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t//\n"
+"\n"
+	"\tassign\tob_left_r  = ob_left[ (2*IWIDTH+3):(IWIDTH+2)];\n"
+	"\tassign\tob_left_i  = ob_left[ (IWIDTH+1):0];\n"
+	"\tassign\tob_right_r = ob_right[(2*IWIDTH+3):(IWIDTH+2)];\n"
+	"\tassign\tob_right_i = ob_right[(IWIDTH+1):0];\n"
+"\n"
+	"\t// sum_r, sum_i\n"
+	"\t// {{{\n"
+	"\t// When k == 0, both X[0] = Re{Z[0]} + Im{Z[0]} and\n"
+	"\t// X[N/2] = Re{Z[0]} - Im{Z[0]} are real.  We can then pack X[N/2]\n"
+	"\t// into the (otherwise zero) imaginary half of the output.\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t	sum_r <= ob_left_r + ob_right_r;\n"
+	"\t	if (ob_sync)\n"
+	"\t		sum_i <= ob_left_r - ob_right_r;\n"
+	"\t	else\n"
+	"\t		sum_i <= ob_left_i + ob_right_i;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// The top bit of the sum is only there to be divided by two, so we\n"
+	"\t// shift it off when rounding\n"
+	"\t%s #(IWIDTH+3,OWIDTH,1)\tdo_rnd_r(i_clk, i_ce,\n"
+	"\t\t\t\tsum_r, rnd_r);\n\n"
+	"\t%s #(IWIDTH+3,OWIDTH,1)\tdo_rnd_i(i_clk, i_ce,\n"
+	"\t\t\t\tsum_i, rnd_i);\n\n"
+	"\tassign\to_out = { rnd_r, rnd_i };\n"
+"\n"
+	"\t// r_sync, o_sync\n"
+	"\t// {{{\n"
+	"\tinitial	r_sync = 1'b0;\n"
+	"\tinitial	o_sync = 1'b0;\n", rnd_string, rnd_string);
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+	"\t	r_sync <= 1'b0;\n"
+	"\t	o_sync <= 1'b0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+	"\t	r_sync <= ob_sync;\n"
+	"\t	o_sync <= r_sync;\n"
+	"\tend\n"
+	"\t// }}}\n"
+	"\t// }}}\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_crossbfly
+// {{{
+// Builds a butterfly between two lanes of a multi-lane FFT, for those stages
+// whose span is no more than the number of samples per clock.  Since each
+// such butterfly always sees the same twiddle factor, that factor is a
+// parameter of the module rather than a memory.
+//
+int	build_crossbfly(const char *fname, ROUND_T rounding,
+			const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	const	char	*rnd_string;
+	if (rounding == RND_TRUNCATE)
+		rnd_string = "truncate";
+	else if (rounding == RND_FROMZERO)
+		rnd_string = "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		rnd_string = "roundhalfup";
+	else
+		rnd_string = "convround";
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tcrossbfly.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA butterfly with a constant twiddle factor.  When an FFT\n"
+"//		accepts P samples per clock, the last log_2(P) stages pair\n"
+"//	up samples arriving on the same clock, but on different lanes.  Every\n"
+"//	butterfly in these stages then sees one and only one twiddle factor,\n"
+"//	W = COEF_R + j COEF_I (scaled by 2^(CWIDTH-2)), and so we can skip the\n"
+"//	coefficient memory.  Given inputs L and R, this module produces\n"
+"//\n"
+"//		o_left  = L + R\n"
+"//		o_right = (L - R) * W\n"
+"//\n"
+"//	three clocks later.  i_aux is delayed along with the data, to become\n"
+"//	o_aux.  Multiplies by one, or by +/- j, reduce to wires, and so a\n"
+"//	synthesis tool will remove them.  Other multiplies are by constants,\n"
+"//	which are left to the synthesis tool to implement.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tcrossbfly #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=16, CWIDTH=20, OWIDTH=IWIDTH+1,\n"
+	"\t\t// SHIFT is the number of top bits of the (IWIDTH+1) bit sum\n"
+	"\t\t// to be dropped on the way to OWIDTH bits\n"
+	"\t\tparameter\tSHIFT=0,\n"
+	"\t\t// The twiddle factor.  The default, one, requires no multiply.\n"
+	"\t\tparameter\tsigned [(CWIDTH-1):0]\tCOEF_R = (1<<(CWIDTH-2)),\n"
+	"\t\tparameter\tsigned [(CWIDTH-1):0]\tCOEF_I = 0\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s, i_ce,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_left, i_right,\n"
+	"\t\tinput\twire\t			i_aux,\n"
+	"\t\toutput\twire\t[(2*OWIDTH-1):0]	o_left, o_right,\n"
+	"\t\toutput\treg\t			o_aux\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\twire	signed	[(IWIDTH-1):0]	i_l_r, i_l_i, i_r_r, i_r_i;\n"
+	"\treg	signed	[IWIDTH:0]	sum_r, sum_i, dif_r, dif_i;\n"
+	"\treg	signed	[(IWIDTH+CWIDTH+1):0]	p_sum_r, p_sum_i,\n"
+	"\t\t\t\t\tp_dif_r, p_dif_i;\n"
+	"\treg	[1:0]			r_aux;\n"
+	"\twire	signed	[(OWIDTH-1):0]	rnd_left_r, rnd_left_i,\n"
+	"\t\t\t\t\trnd_right_r, rnd_right_i;\n"
+	"\t// }}}\n"
+"\n"
+	"\tassign\ti_l_r = i_left[ (2*IWIDTH-1):(IWIDTH)];\n"
+	"\tassign\ti_l_i = i_left[ (IWIDTH-1):0];\n"
+	"\tassign\ti_r_r = i_right[(2*IWIDTH-1):(IWIDTH)];\n"
+	"\tassign\ti_r_i = i_right[(IWIDTH-1):0];\n"
+"\n"
+	"\t// sum_*, dif_*\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tsum_r <= i_l_r + i_r_r;\n"
+		"\t\tsum_i <= i_l_i + i_r_i;\n"
+		"\t\tdif_r <= i_l_r - i_r_r;\n"
+		"\t\tdif_i <= i_l_i - i_r_i;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// p_sum_*, p_dif_*\n"
+	"\t// {{{\n"
+	"\t// The sum is scaled up to match the product of the difference and\n"
+	"\t// the twiddle factor, so that both can be rounded the same way\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tp_sum_r <= { {(3){sum_r[IWIDTH]}}, sum_r, {(CWIDTH-2){1\'b0}} };\n"
+		"\t\tp_sum_i <= { {(3){sum_i[IWIDTH]}}, sum_i, {(CWIDTH-2){1\'b0}} };\n"
+		"\t\tp_dif_r <= dif_r * COEF_R - dif_i * COEF_I;\n"
+		"\t\tp_dif_i <= dif_r * COEF_I + dif_i * COEF_R;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// Round the results down to OWIDTH bits\n"
+	"\t// {{{\n"
+	"\t%s #(IWIDTH+CWIDTH+2,OWIDTH,SHIFT+3)\tdo_rnd_left_r(i_clk, i_ce,\n"
+	"\t\t\t\tp_sum_r, rnd_left_r);\n\n"
+	"\t%s #(IWIDTH+CWIDTH+2,OWIDTH,SHIFT+3)\tdo_rnd_left_i(i_clk, i_ce,\n"
+	"\t\t\t\tp_sum_i, rnd_left_i);\n\n"
+	"\t%s #(IWIDTH+CWIDTH+2,OWIDTH,SHIFT+3)\tdo_rnd_right_r(i_clk, i_ce,\n"
+	"\t\t\t\tp_dif_r, rnd_right_r);\n\n"
+	"\t%s #(IWIDTH+CWIDTH+2,OWIDTH,SHIFT+3)\tdo_rnd_right_i(i_clk, i_ce,\n"
+	"\t\t\t\tp_dif_i, rnd_right_i);\n\n"
+	"\tassign\to_left  = { rnd_left_r,  rnd_left_i  };\n"
+	"\tassign\to_right = { rnd_right_r, rnd_right_i };\n"
+	"\t// }}}\n"
+"\n", rnd_string, rnd_string, rnd_string, rnd_string);
+
+	fprintf(fp,
+	"\t// r_aux, o_aux\n"
+	"\t// {{{\n"
+	"\tinitial\tr_aux = 2\'b00;\n"
+	"\tinitial\to_aux = 1\'b0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\tr_aux <= 2\'b00;\n"
+		"\t\to_aux <= 1\'b0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+		"\t\tr_aux <= { r_aux[0], i_aux };\n"
+		"\t\to_aux <= r_aux[1];\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_lanestage
+// {{{
+// Builds the one stage of a multi-lane FFT whose butterflies pair up two
+// consecutive samples of the same lane.  This is an fftstage with an
+// LGSPAN of zero, for which the twiddle factor is a constant.
+//
+int	build_lanestage(const char *fname, const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tlanestage.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tWhen an FFT accepts P samples per clock, each of its P lanes\n"
+"//		carries every P\'th sample.  The stage of span 2P then pairs\n"
+"//	up x[n] and x[n+P], which arrive on the same lane one clock apart.\n"
+"//	This module handles that stage for one lane.  Since that lane only\n"
+"//	ever sees the one twiddle factor, W_{2P}^n, the butterfly itself is\n"
+"//	a crossbfly.\n"
+"//\n"
+"// Operation:\n"
+"// 	Given a stream of values, operate upon them as though they were\n"
+"// 	value pairs, x[0] and x[1].  When x[0] enters, the synchronization\n"
+"// 	input, i_sync, must be true as well.  For this stream, produce\n"
+"// 	outputs y[0] = x[0] + x[1], and y[1] = (x[0] - x[1]) * W.  When y[0]\n"
+"// 	is output, a synchronization bit o_sync will be true as well,\n"
+"// 	otherwise it will be zero.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tlanestage #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=16, CWIDTH=20, OWIDTH=IWIDTH+1,\n"
+	"\t\tparameter\tSHIFT=0,\n"
+	"\t\tparameter\tsigned [(CWIDTH-1):0]\tCOEF_R = (1<<(CWIDTH-2)),\n"
+	"\t\tparameter\tsigned [(CWIDTH-1):0]\tCOEF_I = 0\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s,\n"
+			"\t\t\t\t\t\t\ti_ce, i_sync,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n"
+	"\t\toutput\treg\t[(2*OWIDTH-1):0]	o_data,\n"
+	"\t\toutput\treg\t			o_sync\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\treg				wait_for_sync, iaddr;\n"
+	"\treg	[(2*IWIDTH-1):0]	imem;\n"
+"\n"
+	"\twire				ob_sync;\n"
+	"\twire	[(2*OWIDTH-1):0]	ob_a, ob_b;\n"
+"\n"
+	"\treg				b_started, oaddr;\n"
+	"\treg	[(2*OWIDTH-1):0]	omem;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// wait_for_sync, iaddr\n"
+	"\t// {{{\n"
+	"\tinitial wait_for_sync = 1\'b1;\n"
+	"\tinitial iaddr = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\twait_for_sync <= 1\'b1;\n"
+		"\t\tiaddr <= 0;\n"
+	"\tend else if ((i_ce)&&((!wait_for_sync)||(i_sync)))\n"
+	"\tbegin\n"
+		"\t\tiaddr <= !iaddr;\n"
+		"\t\twait_for_sync <= 1\'b0;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// imem\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(!iaddr))\n"
+		"\t\timem <= i_data;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// The butterfly\n"
+	"\t// {{{\n"
+	"\t// Every other output of the butterfly is garbage.  iaddr, as the\n"
+	"\t// butterfly\'s aux input, marks those that aren\'t.\n"
+	"\tcrossbfly #(\n"
+		"\t\t// {{{\n"
+		"\t\t.IWIDTH(IWIDTH), .CWIDTH(CWIDTH), .OWIDTH(OWIDTH),\n"
+		"\t\t.SHIFT(SHIFT), .COEF_R(COEF_R), .COEF_I(COEF_I)\n"
+		"\t\t// }}}\n"
+	"\t) bfly(\n"
+		"\t\t// {{{\n"
+		"\t\t.i_clk(i_clk), .%s(%s), .i_ce(i_ce),\n"
+		"\t\t.i_left(imem), .i_right(i_data), .i_aux(iaddr),\n"
+		"\t\t.o_left(ob_a), .o_right(ob_b), .o_aux(ob_sync)\n"
+		"\t\t// }}}\n"
+	"\t);\n"
+	"\t// }}}\n"
+"\n", resetw.c_str(), resetw.c_str());
+
+	fprintf(fp,
+	"\t// oaddr, o_sync, b_started\n"
+	"\t// {{{\n"
+	"\t// The first output can go immediately to the output of this routine\n"
+	"\t// The second output must wait a clock\n"
+	"\tinitial oaddr     = 0;\n"
+	"\tinitial o_sync    = 0;\n"
+	"\tinitial b_started = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\toaddr     <= 0;\n"
+		"\t\to_sync    <= 0;\n"
+		"\t\tb_started <= 0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+	"\t\to_sync <= (!oaddr) ? ob_sync : 1\'b0;\n"
+	"\t\tif (ob_sync||b_started)\n"
+		"\t\t\toaddr <= !oaddr;\n"
+	"\t\tif ((ob_sync)&&(!oaddr))\n"
+		"\t\t\tb_started <= 1\'b1;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// omem\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(!oaddr))\n"
+		"\t\tomem <= ob_b;\n"
+	"\t// }}}\n"
+"\n"
+	"\t// o_data\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\to_data <= (!oaddr) ? ob_a : omem;\n"
+	"\t// }}}\n"
+"\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_bfpscale
+// {{{
+// Builds the block floating point scaling stage.  One of these follows
+// every stage but the last in a block floating point FFT (-B).  Each stage
+// grows by one bit, and this stage then drops that bit again: either the
+// top bit, if no sample of the frame before needed it, or else the bottom
+// bit, halving the frame.  Choosing from the frame before, rather than
+// holding each frame until its own peak is known, costs no memory and only
+// a clock of latency.  The number of halvings so far is passed down the
+// pipeline as a frame exponent.
+//
+int	build_bfpscale(const char *fname, ROUND_T rounding,
+			const bool async_reset) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	const	char	*rnd_string;
+	if (rounding == RND_TRUNCATE)
+		rnd_string = "truncate";
+	else if (rounding == RND_FROMZERO)
+		rnd_string = "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		rnd_string = "roundhalfup";
+	else
+		rnd_string = "convround";
+
+	std::string	resetw("i_reset");
+	if (async_reset)
+		resetw = std::string("i_areset_n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tbfpscale.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tBlock floating point scaling, following an FFT stage that\n"
+"//		has grown its data by one bit.  This stage returns the data\n"
+"//	to its original width, one frame (2^LGSIZE samples) at a time, by\n"
+"//	either dropping the top bit, or else by dropping the bottom bit,\n"
+"//	halving every sample of the frame.\n"
+"//\n"
+"//	Which it does depends upon the frame before: if any sample of that\n"
+"//	frame needed the top bit, this frame is halved.  The peak of each\n"
+"//	frame is thus found as it passes through, at no cost in memory, and\n"
+"//	each sample leaves one clock after it arrives.  The first frame,\n"
+"//	with no frame before it, is always halved.  For a steady stream of\n"
+"//	frames this is the choice the frame itself would have made.  Should\n"
+"//	a frame be louder than the one before it, though, any of its\n"
+"//	samples needing the top bit are saturated rather than wrapped.\n"
+"//\n"
+"// Exponents:\n"
+"//	The number of times each frame has been halved, its exponent, is\n"
+"//	passed from one scaling stage to the next.  Since the stages between\n"
+"//	them may delay a frame by more than a frame, each scaling stage\n"
+"//	keeps the exponents of the last four frames, indexed by the frame\n"
+"//	number modulo four.  The exponent of frame f is then found in\n"
+"//	o_exp[f%%4*EWIDTH +: EWIDTH] by the time the first sample of\n"
+"//	frame f leaves this stage.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tbfpscale #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter\tIWIDTH=17, OWIDTH=IWIDTH-1,\n"
+	"\t\t// LGSIZE is the base two log of the FFT size, EWIDTH the width\n"
+	"\t\t// of the exponent\n"
+	"\t\tparameter\tLGSIZE=10, EWIDTH=4\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t			i_clk, %s,\n"
+			"\t\t\t\t\t\t\ti_ce, i_sync,\n"
+	"\t\tinput\twire\t[(2*IWIDTH-1):0]	i_data,\n"
+	"\t\tinput\twire\t[(4*EWIDTH-1):0]	i_exp,\n"
+	"\t\toutput\twire\t[(2*OWIDTH-1):0]	o_data,\n"
+	"\t\toutput\treg\t			o_sync,\n"
+	"\t\toutput\treg\t[(4*EWIDTH-1):0]	o_exp\n"
+	"\t\t// }}}\n"
+	"\t);\n\n", resetw.c_str());
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\treg				wait_for_sync, r_ovfl, r_shift, o_sel;\n"
+	"\t// The bottom LGSIZE bits of iaddr are the sample within the frame,\n"
+	"\t// the top two bits the frame number (modulo four)\n"
+	"\treg	[(LGSIZE+1):0]		iaddr;\n"
+	"\twire				active, new_frame, cur_shift,\n"
+	"\t\t\t\t\tovfl_r, ovfl_i;\n"
+	"\twire	[1:0]			frame;\n"
+	"\twire	signed	[(IWIDTH-1):0]	i_r, i_i;\n"
+	"\twire	signed	[(OWIDTH-1):0]	rnd_r, rnd_i;\n"
+	"\treg	signed	[(OWIDTH-1):0]	r_top_r, r_top_i;\n"
+	"\t// }}}\n"
+"\n"
+	"\tassign\ti_r = i_data[(2*IWIDTH-1):IWIDTH];\n"
+	"\tassign\ti_i = i_data[(IWIDTH-1):0];\n"
+"\n");
+
+	fprintf(fp,
+	"\t// wait_for_sync, iaddr\n"
+	"\t// {{{\n"
+	"\tinitial wait_for_sync = 1\'b1;\n"
+	"\tinitial iaddr = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\twait_for_sync <= 1\'b1;\n"
+		"\t\tiaddr <= 0;\n"
+	"\tend else if (active)\n"
+	"\tbegin\n"
+		"\t\tiaddr <= iaddr + 1\'b1;\n"
+		"\t\twait_for_sync <= 1\'b0;\n"
+	"\tend\n"
+"\n"
+	"\tassign\tactive    = (i_ce)&&((!wait_for_sync)||(i_sync));\n"
+	"\tassign\tnew_frame = (iaddr[(LGSIZE-1):0] == 0);\n"
+	"\tassign\tframe     = iaddr[(LGSIZE+1):LGSIZE];\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// r_ovfl, r_shift\n"
+	"\t// {{{\n"
+	"\t// A sample needs the top bit if the top two bits of either component\n"
+	"\t// differ.  r_ovfl captures whether any sample of the frame did so.\n"
+	"\t// By the time the next frame starts, it holds the answer for the\n"
+	"\t// frame before, and so whether the new frame should be halved.  It\n"
+	"\t// starts out set, so that the first frame is halved.\n"
+	"\tassign\tovfl_r = (i_r[IWIDTH-1] != i_r[IWIDTH-2]);\n"
+	"\tassign\tovfl_i = (i_i[IWIDTH-1] != i_i[IWIDTH-2]);\n"
+"\n"
+	"\tassign\tcur_shift = (new_frame) ? r_ovfl : r_shift;\n"
+"\n"
+	"\tinitial\tr_ovfl  = 1\'b1;\n"
+	"\tinitial\tr_shift = 1\'b1;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+	"\tbegin\n"
+		"\t\tr_ovfl  <= 1\'b1;\n"
+		"\t\tr_shift <= 1\'b1;\n"
+	"\tend else if (active)\n"
+	"\tbegin\n"
+		"\t\tr_ovfl  <= ((!new_frame)&&(r_ovfl)) || ovfl_r || ovfl_i;\n"
+		"\t\tr_shift <= cur_shift;\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// o_exp\n"
+	"\t// {{{\n"
+	"\tinitial\to_exp = 0;\n");
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+		"\t\to_exp <= 0;\n"
+	"\telse if ((active)&&(new_frame))\n"
+		"\t\to_exp[frame*EWIDTH +: EWIDTH]\n"
+		"\t\t\t<= i_exp[frame*EWIDTH +: EWIDTH]\n"
+		"\t\t\t\t+ { {(EWIDTH-1){1\'b0}}, cur_shift };\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// Halve: drop the bottom bit\n"
+	"\t// {{{\n"
+	"\t%s #(IWIDTH,OWIDTH,0)\tdo_rnd_r(i_clk, i_ce, i_r, rnd_r);\n"
+	"\t%s #(IWIDTH,OWIDTH,0)\tdo_rnd_i(i_clk, i_ce, i_i, rnd_i);\n"
+	"\t// }}}\n"
+"\n"
+	"\t// Don\'t halve: drop the top bit, saturating any sample that needs it\n"
+	"\t// {{{\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tif (ovfl_r)\n"
+			"\t\t\tr_top_r <= { i_r[IWIDTH-1], {(OWIDTH-1){!i_r[IWIDTH-1]}} };\n"
+		"\t\telse\n"
+			"\t\t\tr_top_r <= i_r[(OWIDTH-1):0];\n"
+"\n"
+		"\t\tif (ovfl_i)\n"
+			"\t\t\tr_top_i <= { i_i[IWIDTH-1], {(OWIDTH-1){!i_i[IWIDTH-1]}} };\n"
+		"\t\telse\n"
+			"\t\t\tr_top_i <= i_i[(OWIDTH-1):0];\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// o_sel, o_sync\n"
+	"\t// {{{\n"
+	"\t// o_sel and o_sync follow the data, one clock behind\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\to_sel <= cur_shift;\n"
+"\n"
+	"\tinitial\to_sync = 1\'b0;\n", rnd_string, rnd_string);
+	if (async_reset)
+		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else
+		fprintf(fp, "\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	fprintf(fp,
+		"\t\to_sync <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+		"\t\to_sync <= (active)&&(new_frame);\n"
+	"\t// }}}\n"
+"\n"
+	"\tassign\to_data = (o_sel) ? { rnd_r, rnd_i } : { r_top_r, r_top_i };\n"
+"\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_twidrom
+// {{{
+// Builds a twiddle factor ROM shared by several fftstages (-C).  The table
+// is that of the largest stage it serves.  A stage of 2^k times a smaller
+// span needs every 2^k'th entry of it, and so reads it with its address
+// shifted up by k bits.  Each stage gets the coefficient at the address it
+// gives one clock later, as its own cmem would have.  With CKPCE > 2, each
+// read port takes turns serving CKPCE-1 stages between samples.
+//
+int	build_twidrom(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\ttwidrom.v\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA twiddle factor ROM, shared by NSTAGES fftstages.  The\n"
+"//		table, cmem, is that of the largest stage.  Every other\n"
+"//	stage reads it with its address shifted up, picking out every\n"
+"//	second, fourth, etc. entry of the table.  Stage k's address is found\n"
+"//	in i_addr[k*LGSPAN +: LGSPAN], and the coefficient found there\n"
+"//	is returned in o_coef[k*2*CWIDTH +: 2*CWIDTH] on the next clock.\n"
+"//\n"
+"//	If CKPCE > 2, there are always at least CKPCE-1 clocks between one\n"
+"//	i_ce and the next.  Since each stage only needs one coefficient per\n"
+"//	i_ce, each read port of the ROM then serves CKPCE-1 stages, one per\n"
+"//	clock, starting with the clock of the i_ce.  Every stage still has\n"
+"//	its coefficient before its next i_ce.  The number of read ports is\n"
+"//	therefore NSTAGES, or NSTAGES/(CKPCE-1) if CKPCE > 2.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\ttwidrom #(\n"
+	"\t\t// {{{\n"
+	"\t\t// CWIDTH is the width of each real or imaginary coefficient,\n"
+	"\t\t// LGSPAN the width of each address, and NSTAGES the number\n"
+	"\t\t// of stages reading from this ROM\n"
+	"\t\tparameter\tCWIDTH=20, LGSPAN=9, NSTAGES=2,\n"
+	"\t\t// Clocks per CE.  fftgen never builds an FFT with more than\n"
+	"\t\t// three\n"
+	"\t\tparameter\tCKPCE=1,\n"
+	"\t\tparameter\tCOEFFILE=\"cmem_1024.hex\"\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t\t\t\t\ti_clk, i_ce,\n"
+	"\t\tinput\twire\t[(NSTAGES*LGSPAN-1):0]\t\ti_addr,\n"
+	"\t\toutput\treg\t[(NSTAGES*2*CWIDTH-1):0]\to_coef\n"
+	"\t\t// }}}\n"
+	"\t);\n\n");
+
+	fprintf(fp,
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\t// NSLOTS is the number of stages served by each read port\n"
+	"\tlocalparam\tNSLOTS = (CKPCE > 2) ? (CKPCE-1) : 1;\n"
+	"\tlocalparam\tNPORTS = (NSTAGES + NSLOTS - 1) / NSLOTS;\n"
+"\n"
+	"\treg	[(2*CWIDTH-1):0]	cmem [0:((1<<LGSPAN)-1)];\n"
+	"\t// }}}\n"
+"\n");
+
+	if (formal_property_flag)
+		fprintf(fp, 
+			"`ifdef	FORMAL\n"
+			"// Let the formal tool pick the coefficients\n"
+			"`else\n");
+	gen_cmem_rom(fp, "\t");
+	gen_cmem_init(fp, "\t", "cmem", "COEFFILE", "LGSPAN");
+	fprintf(fp, "\n");
+	if (formal_property_flag)
+		fprintf(fp, "`endif\n\n");
+
+	fprintf(fp,
+	"\tgenerate if (NSLOTS == 1)\n"
+	"\tbegin : ONE_STAGE_PER_PORT\n"
+	"\t\t// {{{\n"
+	"\t\tgenvar\tk;\n"
+"\n"
+	"\t\tfor(k=0; k<NSTAGES; k=k+1)\n"
+	"\t\tbegin : GEN_PORT\n"
+"\n"
+		"\t\t\talways @(posedge i_clk)\n"
+			"\t\t\t\to_coef[k*2*CWIDTH +: 2*CWIDTH]\n"
+			"\t\t\t\t\t<= cmem[i_addr[k*LGSPAN +: LGSPAN]];\n"
+"\n"
+	"\t\tend\n"
+	"\t\t// }}}\n"
+	"\tend else begin : TIME_MULTIPLEXED\n"
+	"\t\t// {{{\n"
+	"\t\t// r_slot counts the clocks since the last i_ce, and slot is\n"
+	"\t\t// then the stage (within each port) being read on this clock.\n"
+	"\t\t// With CKPCE <= 3, two bits are enough to count to NSLOTS.\n"
+	"\t\treg	[1:0]	r_slot, rd_slot;\n"
+	"\t\twire	[1:0]	slot;\n"
+	"\t\t// The addresses, padded out to a whole number of ports\n"
+	"\t\twire	[(NPORTS*NSLOTS*LGSPAN-1):0]	w_addr;\n"
+	"\t\tgenvar\tp, s;\n"
+"\n"
+	"\t\tif (NPORTS*NSLOTS > NSTAGES)\n"
+	"\t\tbegin : PAD_ADDR\n"
+		"\t\t\tassign\tw_addr = { {((NPORTS*NSLOTS-NSTAGES)*LGSPAN){1\'b0}},\n"
+		"\t\t\t\t\ti_addr };\n"
+	"\t\tend else begin : NO_PAD\n"
+		"\t\t\tassign\tw_addr = i_addr;\n"
+	"\t\tend\n"
+"\n"
+	"\t\tinitial\tr_slot = NSLOTS;\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (i_ce)\n"
+		"\t\t\tr_slot <= 1;\n"
+	"\t\telse if (r_slot < NSLOTS)\n"
+		"\t\t\tr_slot <= r_slot + 1\'b1;\n"
+"\n"
+	"\t\tassign\tslot = (i_ce) ? 2\'b00 : r_slot;\n"
+"\n"
+	"\t\t// Which slot was read on the last clock.  This will be NSLOTS\n"
+	"\t\t// if none was.\n"
+	"\t\tinitial\trd_slot = NSLOTS;\n"
+	"\t\talways @(posedge i_clk)\n"
+		"\t\t\trd_slot <= slot;\n"
+"\n"
+	"\t\tfor(p=0; p<NPORTS; p=p+1)\n"
+	"\t\tbegin : GEN_PORT\n"
+		"\t\t\treg	[(LGSPAN-1):0]		addr;\n"
+		"\t\t\treg	[(2*CWIDTH-1):0]	rd_coef;\n"
+		"\t\t\tinteger				m;\n"
+"\n"
+		"\t\t\talways @(*)\n"
+		"\t\t\tbegin\n"
+			"\t\t\t\taddr = w_addr[p*NSLOTS*LGSPAN +: LGSPAN];\n"
+			"\t\t\t\tfor(m=1; m<NSLOTS; m=m+1)\n"
+			"\t\t\t\tif (slot == m)\n"
+				"\t\t\t\t\taddr = w_addr[(p*NSLOTS+m)*LGSPAN +: LGSPAN];\n"
+		"\t\t\tend\n"
+"\n"
+		"\t\t\talways @(posedge i_clk)\n"
+			"\t\t\t\trd_coef <= cmem[addr];\n"
+"\n"
+		"\t\t\t// Hand the result to the stage it was read for, where\n"
+		"\t\t\t// it then waits for that stage's next i_ce\n"
+		"\t\t\tfor(s=0; s<NSLOTS; s=s+1)\n"
+		"\t\t\tbegin : GEN_STAGE\n"
+			"\t\t\t\tif (p*NSLOTS+s < NSTAGES)\n"
+			"\t\t\t\tbegin : GEN_HOLD\n"
+				"\t\t\t\t\talways @(posedge i_clk)\n"
+				"\t\t\t\t\tif (rd_slot == s)\n"
+					"\t\t\t\t\t\to_coef[(p*NSLOTS+s)*2*CWIDTH +: 2*CWIDTH]\n"
+					"\t\t\t\t\t\t\t<= rd_coef;\n"
+			"\t\t\t\tend\n"
+		"\t\t\tend\n"
+	"\t\tend\n"
+	"\t\t// }}}\n"
+	"\tend endgenerate\n"
+"\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
 }
 // }}}
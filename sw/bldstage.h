@@ -40,13 +40,41 @@
 
 #include "rounding.h"
 
-extern	void	build_dblstage(const char *fname, ROUND_T rounding,
+extern	int	build_dblstage(const char *fname, ROUND_T rounding,
 		const bool async_reset = false, const bool dbg = false);
 
-extern	void	build_stage(const char *fname,
+extern	int	build_stage(const char *fname,
 		int stage, int nwide, int offset,
 		int nbits, int xtra, int ckpce,
 		const bool async_reset = false,
-		const bool dbg=false);
+		const bool dbg=false, const bool qtrwave = false,
+		const bool extcoef = false, const bool twidgen = false);
+
+extern	int	build_bf2stage(const char *fname, ROUND_T rounding,
+		const bool async_reset = false);
+
+extern	int	build_twidstage(const char *fname,
+		const bool async_reset = false);
+
+extern	int	build_w8stage(const char *fname, ROUND_T rounding,
+		int cwidth, const bool async_reset = false,
+		const bool dbg = false);
+
+extern	int	build_w8twid(const char *fname, ROUND_T rounding,
+		int cwidth, const bool async_reset = false);
+
+extern	int	build_realstage(const char *fname, ROUND_T rounding,
+		const bool async_reset = false);
+
+extern	int	build_crossbfly(const char *fname, ROUND_T rounding,
+		const bool async_reset = false);
+
+extern	int	build_lanestage(const char *fname,
+		const bool async_reset = false);
+
+extern	int	build_bfpscale(const char *fname, ROUND_T rounding,
+		const bool async_reset = false);
+
+extern	int	build_twidrom(const char *fname);
 
 #endif	// BLDSTAGE_H
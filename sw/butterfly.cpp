@@ -85,6 +85,7 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 
 #include "defaults.h"
 #include "legal.h"
+#include "fftsink.h"
 #include "rounding.h"
 #include "fftlib.h"
 #include "bldstage.h"
@@ -94,13 +95,14 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 
 // build_butterfly
 // {{{
-void	build_butterfly(const char *fname, int xtracbits, ROUND_T rounding,
-			int	ckpce, const bool async_reset) {
-	FILE	*fp = fopen(fname, "w");
+int	build_butterfly(const char *fname, int xtracbits, ROUND_T rounding,
+			int	ckpce, const bool async_reset, const bool booth,
+			int mpyrows, int mpyoutregs, const bool bypass) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 	const	char	*rnd_string;
 	if (rounding == RND_TRUNCATE)
@@ -121,6 +123,17 @@ void	build_butterfly(const char *fname, int xtracbits, ROUND_T rounding,
 	if (async_reset)
 		resetw = std::string("i_areset_n");
 
+	// The Booth multiply takes two clocks less than the longbimpy.  Only
+	// the longbimpy can trade clocks for rows of its tableau.
+	const	char	*mpyname = (booth) ? "boothmpy" : "longbimpy";
+	const	char	*mpyparams = (booth) ? ""
+				: ",\n\t\t\t.ROWS(MPYROWS), .OUTREGS(MPYOUTREGS)";
+
+	if (mpyrows < 1)
+		mpyrows = 1;
+	if (mpyoutregs < 0)
+		mpyoutregs = 0;
+
 
 	fprintf(fp,
 SLASHLINE
@@ -151,6 +164,11 @@ SLASHLINE
 "//\n"
 "//	This design features no overflow checking.\n"
 "//\n"
+"//	With OPT_BYPASS set, coefficients of +/-1 or +/-j skip the multiply.\n"
+"//	The difference is rotated by adds alone, and delayed alongside the\n"
+"//	sum, while the multiply's inputs are held to save power.  The\n"
+"//	results are the same, bit for bit.\n"
+"//\n"
 "// Notes:\n"
 "//	CORDIC:\n"
 "//		Much as we might like, we can't use a cordic here.\n"
@@ -245,6 +263,25 @@ SLASHLINE
 		"\t\t// this many for extra internal processing.\n"
 		"\t\tparameter	CKPCE=%d,\n\t\t// }}}\n", ckpce);
 
+	if (!booth)
+		fprintf(fp,
+		"\t\t// MPYROWS, MPYOUTREGS\n"
+		"\t\t// {{{\n"
+		"\t\t// The longbimpy adds MPYROWS rows of its tableau on each\n"
+		"\t\t// clock, and follows its final accumulate with MPYOUTREGS\n"
+		"\t\t// more registers.  Fewer clocks, or a faster one.\n"
+		"\t\tparameter	MPYROWS=%d, MPYOUTREGS=%d,\n\t\t// }}}\n",
+		mpyrows, mpyoutregs);
+
+	fprintf(fp,
+		"\t\t// OPT_BYPASS\n"
+		"\t\t// {{{\n"
+		"\t\t// Set to pass trivial twiddle factors, +/-1 and +/-j, around\n"
+		"\t\t// the multiply.  This costs a second FIFO, as deep as the\n"
+		"\t\t// first, to hold the rotated difference.\n"
+		"\t\tparameter [0:0]	OPT_BYPASS=1\'b%d,\n\t\t// }}}\n",
+		(bypass) ? 1 : 0);
+
 	fprintf(fp,
 		"\t\t//\n"
 		"\t\t// Local/derived parameters\n"
@@ -266,7 +303,7 @@ SLASHLINE
 		"\t\t// {{{\n"
 		"\t\t// Given this \"fewest\" number of bits, we can calculate\n"
 		"\t\t// the number of clocks the multiply itself will take.\n"
-		"\t\tlocalparam	MPYDELAY=((MXMPYBITS+1)/2)+2,\n"
+		"\t\tlocalparam	MPYDELAY=%s,\n"
 		"\t\t// }}}\n"
 		"\t\t// LCLDELAY\n"
 		"\t\t// {{{\n"
@@ -295,7 +332,8 @@ SLASHLINE
 	"\t\tlocalparam	MPYREMAINDER = MPYDELAY - CKPCE*(MPYDELAY/CKPCE)\n"
 	"\t\t// }}}\n"
 	"\t\t// }}}\n"
-	"\t) (\n");
+	"\t) (\n", (booth) ? "((MXMPYBITS+1)/2)"
+		: "((((MXMPYBITS+1)/2)+MPYROWS-1)/MPYROWS)+2+MPYOUTREGS");
 
 	fprintf(fp,
 	"\t\t// {{{\n"
@@ -342,6 +380,7 @@ SLASHLINE
 "\n"
 	"\twire	[(CWIDTH):0]	fp_one_ic, fp_two_ic, fp_three_ic, f_p3c_in;\n"
 	"\twire	[(IWIDTH+1):0]	fp_one_id, fp_two_id, fp_three_id, f_p3d_in;\n"
+	"\twire				f_pretriv;\n"
 	"\t// }}}\n"
 "`endif\n\n");
 
@@ -365,6 +404,8 @@ SLASHLINE
 	"\twire\tsigned\t[(OWIDTH-1):0]\trnd_left_r, rnd_left_i, rnd_right_r, rnd_right_i;\n\n"
 	"\twire\tsigned\t[(CWIDTH+IWIDTH+3-1):0]\tleft_sr, left_si;\n"
 	"\treg\t[(AUXLEN-1):0]\taux_pipeline;\n"
+	"\t// True if r_coef is +/-1 or +/-j, and so needs no multiply\n"
+	"\twire\t\t\ttriv_coef;\n"
 	"\t// }}}\n"
 "\n");
 	fprintf(fp,
@@ -394,10 +435,15 @@ SLASHLINE
 		"\t\t// Next clock adds/subtracts\n"
 		"\t\tr_sum_r <= r_left_r + r_right_r; // Now IWIDTH+1 bits\n"
 		"\t\tr_sum_i <= r_left_i + r_right_i;\n"
-		"\t\tr_dif_r <= r_left_r - r_right_r;\n"
-		"\t\tr_dif_i <= r_left_i - r_right_i;\n"
-		"\t\t// Other inputs are simply delayed on second clock\n"
-		"\t\tr_coef_2<= r_coef;\n"
+		"\t\t// The multiply's inputs are held, rather than changed,\n"
+		"\t\t// when the bypass will replace its result\n"
+		"\t\tif (!triv_coef)\n"
+		"\t\tbegin\n"
+		"\t\t\tr_dif_r <= r_left_r - r_right_r;\n"
+		"\t\t\tr_dif_i <= r_left_i - r_right_i;\n"
+		"\t\t\t// Other inputs are simply delayed on second clock\n"
+		"\t\t\tr_coef_2<= r_coef;\n"
+		"\t\tend\n"
 	"\tend\n"
 	"\t// }}}\n"
 "\n");
@@ -479,14 +525,14 @@ SLASHLINE
 		"\t\t// We need to pad these first two multiplies by an extra\n"
 		"\t\t// bit just to keep them aligned with the third,\n"
 		"\t\t// simpler, multiply.\n"
-		"\t\tlongbimpy #(\n"
-		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)\n"
+		"\t\t%s #(\n"
+		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)%s\n"
 		"\t\t) p1(\n"
 		"\t\t\t// {{{\n"
 		"\t\t\t.i_clk(i_clk), .i_ce(i_ce),\n"
 		"\t\t\t.i_a_unsorted({ir_coef_r[CWIDTH-1],ir_coef_r}),\n"
 		"\t\t\t.i_b_unsorted({r_dif_r[IWIDTH],r_dif_r}),\n"
-		"\t\t\t.o_r(p_one)\n");
+		"\t\t\t.o_r(p_one)\n", mpyname, mpyparams);
 		if (formal_property_flag) fprintf(fp,
 "`ifdef\tFORMAL\n"
 				"\t\t\t, .f_past_a_unsorted(fp_one_ic),\n"
@@ -498,14 +544,14 @@ SLASHLINE
 		"\n"
 		"\t\t// p_two = ir_coef_i * r_dif_i\n"
 		"\t\t// {{{\n"
-		"\t\tlongbimpy #(\n"
-		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)\n"
+		"\t\t%s #(\n"
+		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)%s\n"
 		"\t\t) p2(\n"
 		"\t\t\t// {{{\n"
 		"\t\t\t.i_clk(i_clk), .i_ce(i_ce),\n"
 			"\t\t\t.i_a_unsorted({ir_coef_i[CWIDTH-1],ir_coef_i}),\n"
 			"\t\t\t.i_b_unsorted({r_dif_i[IWIDTH],r_dif_i}),\n"
-			"\t\t\t.o_r(p_two)\n");
+			"\t\t\t.o_r(p_two)\n", mpyname, mpyparams);
 		if (formal_property_flag) fprintf(fp,
 "`ifdef\tFORMAL\n"
 				"\t\t\t, .f_past_a_unsorted(fp_two_ic),\n"
@@ -517,14 +563,14 @@ SLASHLINE
 		"\n"
 		"\t\t// p_three = (ir_coef_i + ir_coef_r) * (r_dif_r + r_dif_i)\n"
 		"\t\t// {{{\n"
-		"\t\tlongbimpy #(\n"
-		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)\n"
+		"\t\t%s #(\n"
+		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)%s\n"
 		"\t\t) p3(\n"
 		"\t\t\t// {{{\n"
 		"\t\t\t.i_clk(i_clk), .i_ce(i_ce),\n"
 		"\t\t\t.i_a_unsorted(p3c_in),\n"
 		"\t\t\t.i_b_unsorted(p3d_in),\n"
-		"\t\t\t.o_r(p_three)\n");
+		"\t\t\t.o_r(p_three)\n", mpyname, mpyparams);
 		if (formal_property_flag) fprintf(fp,
 "`ifdef\tFORMAL\n"
 			"\t\t\t, .f_past_a_unsorted(fp_three_ic),\n"
@@ -638,14 +684,14 @@ SLASHLINE
 	fprintf(fp,
 		"\t\t// longmpy = mpy_cof_sum * mpy_dif_sum\n"
 		"\t\t// {{{\n"
-		"\t\tlongbimpy #(\n"
-		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)\n"
+		"\t\t%s #(\n"
+		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)%s\n"
 		"\t\t) mpy0(\n"
 		"\t\t\t// {{{\n"
 		"\t\t\t.i_clk(i_clk), .i_ce(mpy_pipe_v),\n"
 			"\t\t\t.i_a_unsorted(mpy_cof_sum),\n"
 			"\t\t\t.i_b_unsorted(mpy_dif_sum),\n"
-			"\t\t\t.o_r(longmpy)\n");
+			"\t\t\t.o_r(longmpy)\n", mpyname, mpyparams);
 		if (formal_property_flag) fprintf(fp,
 "`ifdef	FORMAL\n"
 			"\t\t\t, .f_past_a_unsorted(f_past_ic),\n"
@@ -661,14 +707,14 @@ SLASHLINE
 		"\t\t// {{{\n"
 		"\t\t// This is the shared multiply, but still multiplying\n"
 		"\t\t// a coefficient (i.e. twiddle factor) times data\n"
-		"\t\tlongbimpy #(\n"
-		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)\n"
+		"\t\t%s #(\n"
+		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)%s\n"
 		"\t\t) mpy1(\n"
 		"\t\t\t// {{{\n"
 		"\t\t\t.i_clk(i_clk), .i_ce(mpy_pipe_v),\n"
 		"\t\t\t.i_a_unsorted({ mpy_pipe_vc[CWIDTH-1], mpy_pipe_vc }),\n"
 		"\t\t\t.i_b_unsorted({ mpy_pipe_vd[IWIDTH  ], mpy_pipe_vd }),\n"
-		"\t\t\t.o_r(mpy_pipe_out)\n");
+		"\t\t\t.o_r(mpy_pipe_out)\n", mpyname, mpyparams);
 		if (formal_property_flag) fprintf(fp,
 "`ifdef	FORMAL\n"
 			"\t\t\t, .f_past_a_unsorted(f_past_mux_ic),\n"
@@ -897,14 +943,14 @@ SLASHLINE
 	fprintf(fp,
 		"\t\t// mpy_pipe_out = mpy_pipe_vc * mpy_pipe_vd\n"
 		"\t\t// {{{\n"
-		"\t\tlongbimpy #(\n"
-		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)\n"
+		"\t\t%s #(\n"
+		"\t\t\t.IAW(CWIDTH+1), .IBW(IWIDTH+2)%s\n"
 		"\t\t) mpy(\n"
 		"\t\t\t// {{{\n"
 		"\t\t\t.i_clk(i_clk), .i_ce(mpy_pipe_v),\n"
 		"\t\t\t.i_a_unsorted(mpy_pipe_vc),\n"
 		"\t\t\t.i_b_unsorted(mpy_pipe_vd),\n"
-		"\t\t\t.o_r(mpy_pipe_out)\n");
+		"\t\t\t.o_r(mpy_pipe_out)\n", mpyname, mpyparams);
 	if (formal_property_flag) fprintf(fp,
 "`ifdef	FORMAL\n"
 			"\t\t\t, .f_past_a_unsorted(f_past_ic),\n"
@@ -1142,21 +1188,117 @@ SLASHLINE
 	"\tdo_rnd_right_i(i_clk, i_ce, mpy_i, rnd_right_i);\n", rnd_string);
 	fprintf(fp, "\t// }}}\n\n");
 	fprintf(fp,
-	"\t// fifo_read, mpy_r, mpy_i\n"
+	"\t// fifo_read\n"
 	"\t// {{{\n"
-	"\t// Unwrap the three multiplies into the two multiply results\n"
 	"\talways @(posedge i_clk)\n"
 	"\tif (i_ce)\n"
-	"\tbegin\n"
 		"\t\t// First clock, recover all values\n"
 		"\t\tfifo_read <= fifo_left[fifo_read_addr];\n"
-		"\t\t// These values are IWIDTH+CWIDTH+3 bits wide\n"
-		"\t\t// although they only need to be (IWIDTH+1)\n"
-		"\t\t// + (CWIDTH) bits wide.  (We\'ve got two\n"
-		"\t\t// extra bits we need to get rid of.)\n"
-		"\t\tmpy_r <= p_one - p_two;\n"
-		"\t\tmpy_i <= p_three - p_one - p_two;\n"
-	"\tend\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// triv_coef, mpy_r, mpy_i\n"
+	"\t// {{{\n"
+	"\tgenerate if (OPT_BYPASS)\n"
+	"\tbegin : BYPASS_TRIVIAL\n"
+		"\t\t// {{{\n"
+		"\t\t// Local declarations\n"
+		"\t\t// {{{\n"
+		"\t\tlocalparam\t[(CWIDTH-1):0]\tTW_ONE = 1 << (CWIDTH-2),\n"
+		"\t\t\t\t\tTW_NEG = ~TW_ONE + 1\'b1,\n"
+		"\t\t\t\t\tTW_ZERO = 0;\n"
+		"\t\twire\t\t\ttriv_one, triv_neg, triv_nj, triv_pj;\n"
+		"\t\treg\t\t\tr_bypass;\n"
+		"\t\treg\tsigned\t[(IWIDTH):0]\tr_byp_r, r_byp_i;\n"
+		"\t\treg\t[(2*IWIDTH+2):0]\tfifo_bypass [0:((1<<LGDELAY)-1)];\n"
+		"\t\twire\t[(2*IWIDTH+2):0]\tbypass_read;\n"
+		"\t\twire\tsigned\t[(IWIDTH):0]\tbypass_r, bypass_i;\n"
+		"\t\t// }}}\n"
+"\n"
+		"\t\tassign\ttriv_one = (r_coef == { TW_ONE,  TW_ZERO });\n"
+		"\t\tassign\ttriv_neg = (r_coef == { TW_NEG,  TW_ZERO });\n"
+		"\t\tassign\ttriv_nj  = (r_coef == { TW_ZERO, TW_NEG  });\n"
+		"\t\tassign\ttriv_pj  = (r_coef == { TW_ZERO, TW_ONE  });\n"
+		"\t\tassign\ttriv_coef = (triv_one)||(triv_neg)||(triv_nj)||(triv_pj);\n"
+"\n"
+		"\t\t// r_bypass, r_byp_r, r_byp_i\n"
+		"\t\t// {{{\n"
+		"\t\t// The difference times the coefficient, on the same clock\n"
+		"\t\t// as r_sum.  Since the difference can never be -2^IWIDTH,\n"
+		"\t\t// its negative always fits in IWIDTH+1 bits.\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\tr_bypass <= triv_coef;\n"
+			"\t\t\tif (triv_one)\n"
+			"\t\t\tbegin\n"
+			"\t\t\t\tr_byp_r <= r_left_r - r_right_r;\n"
+			"\t\t\t\tr_byp_i <= r_left_i - r_right_i;\n"
+			"\t\t\tend else if (triv_neg)\n"
+			"\t\t\tbegin\n"
+			"\t\t\t\tr_byp_r <= r_right_r - r_left_r;\n"
+			"\t\t\t\tr_byp_i <= r_right_i - r_left_i;\n"
+			"\t\t\tend else if (triv_nj)\n"
+			"\t\t\tbegin\n"
+			"\t\t\t\tr_byp_r <= r_left_i - r_right_i;\n"
+			"\t\t\t\tr_byp_i <= r_right_r - r_left_r;\n"
+			"\t\t\tend else if (triv_pj)\n"
+			"\t\t\tbegin\n"
+			"\t\t\t\tr_byp_r <= r_right_i - r_left_i;\n"
+			"\t\t\t\tr_byp_i <= r_left_r - r_right_r;\n"
+			"\t\t\tend\n"
+		"\t\tend\n"
+		"\t\t// }}}\n"
+"\n"
+		"\t\t// Delay the bypass alongside the sum, in fifo_bypass\n"
+		"\t\t// {{{\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tfifo_bypass[fifo_addr] <= { r_bypass, r_byp_r, r_byp_i };\n"
+"\n"
+		"\t\tassign\tbypass_read = fifo_bypass[fifo_read_addr];\n"
+		"\t\tassign\tbypass_r = bypass_read[(2*IWIDTH+1):(IWIDTH+1)];\n"
+		"\t\tassign\tbypass_i = bypass_read[(IWIDTH):0];\n"
+		"\t\t// }}}\n"
+"\n"
+		"\t\t// mpy_r, mpy_i\n"
+		"\t\t// {{{\n"
+		"\t\t// A bypassed difference is scaled by 2^(CWIDTH-2), just as\n"
+		"\t\t// the multiply would\'ve scaled it.\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\tif (bypass_read[2*IWIDTH+2])\n"
+			"\t\t\tbegin\n"
+			"\t\t\t\tmpy_r <= { {(4){bypass_r[IWIDTH]}}, bypass_r,\n"
+			"\t\t\t\t\t\t{(CWIDTH-2){1\'b0}} };\n"
+			"\t\t\t\tmpy_i <= { {(4){bypass_i[IWIDTH]}}, bypass_i,\n"
+			"\t\t\t\t\t\t{(CWIDTH-2){1\'b0}} };\n"
+			"\t\t\tend else begin\n"
+			"\t\t\t\tmpy_r <= p_one - p_two;\n"
+			"\t\t\t\tmpy_i <= p_three - p_one - p_two;\n"
+			"\t\t\tend\n"
+		"\t\tend\n"
+		"\t\t// }}}\n"
+		"\t\t// }}}\n"
+	"\tend else begin : NO_BYPASS\n"
+		"\t\t// {{{\n"
+		"\t\tassign\ttriv_coef = 1\'b0;\n"
+"\n"
+		"\t\t// Unwrap the three multiplies into the two multiply results\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\t// These values are IWIDTH+CWIDTH+3 bits wide\n"
+			"\t\t\t// although they only need to be (IWIDTH+1)\n"
+			"\t\t\t// + (CWIDTH) bits wide.  (We\'ve got two\n"
+			"\t\t\t// extra bits we need to get rid of.)\n"
+			"\t\t\tmpy_r <= p_one - p_two;\n"
+			"\t\t\tmpy_i <= p_three - p_one - p_two;\n"
+		"\t\tend\n"
+		"\t\t// }}}\n"
+	"\tend endgenerate\n"
 	"\t// }}}\n"
 "\n");
 
@@ -1450,10 +1592,22 @@ SLASHLINE
 		"\t\tf_sumcoef = f_dlycoeff_r[F_D-1] + f_dlycoeff_i[F_D-1];\n"
 		"\t\tf_sumdiff = f_predifr + f_predifi;\n"
 	"\tend\n"
+"\n"
+	"\t// With OPT_BYPASS, the multiply\'s inputs are held rather than\n"
+	"\t// loaded whenever the coefficient is +/-1 or +/-j.  Its products\n"
+	"\t// then follow the last nontrivial coefficient, so the checks on\n"
+	"\t// them below only apply when the coefficient isn\'t trivial.\n"
+	"\tassign\tf_pretriv = (OPT_BYPASS)\n"
+		"\t\t&&(((f_dlycoeff_i[F_D-1] == 0)\n"
+		"\t\t\t&&((f_dlycoeff_r[F_D-1] == (1<<(CWIDTH-2)))\n"
+		"\t\t\t||(f_dlycoeff_r[F_D-1] == -(1<<(CWIDTH-2)))))\n"
+		"\t\t||((f_dlycoeff_r[F_D-1] == 0)\n"
+		"\t\t\t&&((f_dlycoeff_i[F_D-1] == (1<<(CWIDTH-2)))\n"
+		"\t\t\t||(f_dlycoeff_i[F_D-1] == -(1<<(CWIDTH-2))))));\n"
 "\n"
 	"\t// Induction helpers\n"
 	"\talways @(posedge i_clk)\n"
-	"\tif (f_startup_counter >= { 1'b0, F_D })\n"
+	"\tif ((!f_pretriv)&&(f_startup_counter >= { 1'b0, F_D }))\n"
 	"\tbegin\n"
 		"\t\tif (f_dlycoeff_r[F_D-1] == 0)\n"
 			"\t\t\tassert(p_one == 0);\n"
@@ -1507,7 +1661,7 @@ SLASHLINE
 	"\tassign\tf_p3d_in = f_predifi + f_predifr;\n"
 "\n"
 	"\talways @(*)\n"
-	"\tif (f_startup_counter >= { 1'b0, F_D })\n"
+	"\tif ((!f_pretriv)&&(f_startup_counter >= { 1'b0, F_D }))\n"
 	"\tbegin\n"
 		"\t\tassert(fp_one_ic == { f_dlycoeff_r[F_D-1][CWIDTH-1],\n"
 				"\t\t\t\tf_dlycoeff_r[F_D-1][CWIDTH-1:0] });\n"
@@ -1540,19 +1694,26 @@ SLASHLINE
 	fprintf(fp,
 "// }}}\n"
 "endmodule\n");
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_hwbfly
 // {{{
-void	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
-		int ckpce, const bool async_reset) {
-	FILE	*fp = fopen(fname, "w");
+int	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
+		int ckpce, const bool async_reset, int dsp_aw, int dsp_bw,
+		int cmpy) {
+	// Given the size of a DSP, tile (and pipeline) the CKPCE=1 multiplies
+	const	bool	tiled = (dsp_aw > 1)&&(dsp_bw > 1);
+	// The CKPCE=1 complex product may be built from four multiplies,
+	// rather than three, if so asked (cmpy == 4) or if, left to choose
+	// (cmpy == 0), it can compare the DSPs each form takes
+	const	bool	fourmpy = (cmpy == 4)||((cmpy == 0)&&(tiled));
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	const	char	*rnd_string;
@@ -1628,9 +1789,75 @@ SLASHLINE
 		"\t\t// CKPCE\n"
 		"\t\t// {{{\n"
 		"\t\t// The number of clocks per clock enable, 1, 2, or 3.\n"
-		"\t\tparameter\t[1:0]\tCKPCE=%d\n\t\t// }}}\n\t\t// }}}\n",
+		"\t\tparameter\t[1:0]\tCKPCE=%d",
 			xtracbits, ckpce);
 
+	if (tiled)
+		fprintf(fp, ",\n"
+		"\t\t// }}}\n"
+		"\t\t// DSPAW, DSPBW\n"
+		"\t\t// {{{\n"
+		"\t\t// The size of the signed multiply one DSP can do.  When\n"
+		"\t\t// CKPCE=1, each multiply is tiled across as many DSPs as\n"
+		"\t\t// it needs, taking one clock per tile.\n"
+		"\t\tparameter\tDSPAW=%d, DSPBW=%d,\n"
+		"\t\t// }}}\n"
+		"\t\t// MPYDELAY\n"
+		"\t\t// {{{\n"
+		"\t\t// The clocks taken by the widest (third) multiply, as\n"
+		"\t\t// dspmpy.v tiles it.  The other two are padded to match.\n"
+		"\t\tlocalparam\tMPYNSA = (CWIDTH-1)/(DSPAW-1)+1,\n"
+		"\t\t\t\tMPYNSB = (IWIDTH)/(DSPBW-1)+1,\n"
+		"\t\t\t\tMPYNXA = (CWIDTH-1)/(DSPBW-1)+1,\n"
+		"\t\t\t\tMPYNXB = (IWIDTH)/(DSPAW-1)+1,\n"
+		"\t\t\t\tMPYTILES = (MPYNXA*MPYNXB < MPYNSA*MPYNSB)\n"
+		"\t\t\t\t\t? (MPYNXA*MPYNXB) : (MPYNSA*MPYNSB),\n",
+			dsp_aw, dsp_bw);
+
+	if ((tiled)&&(fourmpy))
+		fprintf(fp,
+		"\t\t// The tiles of each multiply in the four multiply form,\n"
+		"\t\t// CWIDTH by IWIDTH+1 bits\n"
+		"\t\tlocalparam\tMPY4NSA = (CWIDTH-2)/(DSPAW-1)+1,\n"
+		"\t\t\t\tMPY4NSB = (IWIDTH-1)/(DSPBW-1)+1,\n"
+		"\t\t\t\tMPY4NXA = (CWIDTH-2)/(DSPBW-1)+1,\n"
+		"\t\t\t\tMPY4NXB = (IWIDTH-1)/(DSPAW-1)+1,\n"
+		"\t\t\t\tMPY4TILES = (MPY4NXA*MPY4NXB < MPY4NSA*MPY4NSB)\n"
+		"\t\t\t\t\t? (MPY4NXA*MPY4NXB) : (MPY4NSA*MPY4NSB),\n");
+
+	if (fourmpy) {
+		fprintf(fp, "%s"
+		"\t\t// }}}\n"
+		"\t\t// OPT_FOURMPY\n"
+		"\t\t// {{{\n"
+		"\t\t// Build the complex product from four multiplies of\n"
+		"\t\t// CWIDTH by IWIDTH+1 bits, rather than from three, the\n"
+		"\t\t// third of which is a bit wider on each side and needs\n"
+		"\t\t// pre-adders to feed it.  Only CKPCE=1 has this form.\n",
+		(tiled) ? "" : ",\n");
+		if (cmpy == 0)
+			fprintf(fp,
+		"\t\t// It's used wherever that third multiply would take\n"
+		"\t\t// at least as many DSPs as the fourth.\n"
+		"\t\tlocalparam\tOPT_FOURMPY = (CKPCE <= 1)\n"
+		"\t\t\t\t&&(2*MPY4TILES <= MPYTILES)");
+		else
+			fprintf(fp,
+		"\t\tlocalparam\tOPT_FOURMPY = (CKPCE <= 1)");
+	}
+
+	if ((tiled)&&(fourmpy))
+		fprintf(fp, ",\n"
+		"\t\t// With four multiplies, MPYDELAY follows the narrower\n"
+		"\t\t// ones\n"
+		"\t\tlocalparam\tMPYDELAY = (CKPCE > 1) ? 1\n"
+		"\t\t\t\t: (OPT_FOURMPY) ? (MPY4TILES+1) : (MPYTILES+1)");
+	else if (tiled)
+		fprintf(fp,
+		"\t\tlocalparam\tMPYDELAY = (CKPCE <= 1) ? (MPYTILES+1) : 1");
+
+	fprintf(fp, "\n\t\t// }}}\n\t\t// }}}\n");
+
 	fprintf(fp,
 	"\t) (\n"
 	"\t\t// {{{\n"
@@ -1656,6 +1883,7 @@ SLASHLINE
 	"\treg	signed	[(IWIDTH):0]	r_sum_r, r_sum_i, r_dif_r, r_dif_i;\n"
 "\n"
 	"\treg	[(2*IWIDTH+2):0]	leftv, leftvv;\n"
+	"%s"
 	"\n"
 	"\twire\tsigned	[((IWIDTH+1)+(CWIDTH)-1):0]	p_one, p_two;\n"
 	"\twire\tsigned	[((IWIDTH+2)+(CWIDTH+1)-1):0]	p_three;\n"
@@ -1681,7 +1909,8 @@ SLASHLINE
 	"\t// r_aux, r_aux_2\n"
 	"\t// {{{\n"
 	"\tinitial r_aux   = 1\'b0;\n"
-	"\tinitial r_aux_2 = 1\'b0;\n");
+	"\tinitial r_aux_2 = 1\'b0;\n",
+	(tiled) ? "\twire	[(2*IWIDTH+2):0]	leftvd;\n" : "");
 	if (async_reset)
 		fprintf(fp, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
 	else
@@ -1748,6 +1977,35 @@ SLASHLINE
 		"\t// }}}\n"
 "\n");
 
+	if (tiled) {
+		fprintf(fp,
+		"\t// leftvd\n"
+		"\t// {{{\n"
+		"\t// The tiled multiplies take MPYDELAY clocks, rather than one,\n"
+		"\t// so leftvv must wait for them\n"
+		"\tgenerate if (MPYDELAY > 1)\n"
+		"\tbegin : DELAY_LEFT\n"
+			"\t\treg\t[(MPYDELAY-1)*(2*IWIDTH+3)-1:0]\tr_leftvd;\n"
+"\n"
+			"\t\tinitial\tr_leftvd = 0;\n");
+		if (async_reset)
+			fprintf(fp, "\t\talways @(posedge i_clk, negedge i_areset_n)\n\t\tif (!i_areset_n)\n");
+		else
+			fprintf(fp, "\t\talways @(posedge i_clk)\n\t\tif (i_reset)\n");
+		fprintf(fp,
+			"\t\t\tr_leftvd <= 0;\n"
+			"\t\telse if (i_ce)\n"
+			"\t\t\tr_leftvd <= { r_leftvd, leftvv };\n"
+"\n"
+			"\t\tassign\tleftvd = r_leftvd[(MPYDELAY-1)*(2*IWIDTH+3)-1\n"
+			"\t\t\t\t\t-: (2*IWIDTH+3)];\n"
+		"\tend else begin : NO_DELAY\n"
+			"\t\tassign\tleftvd = leftvv;\n"
+		"\tend endgenerate\n"
+		"\t// }}}\n"
+"\n");
+	}
+
 	// Nominally, we should handle code for 1, 2, or 3 clocks per CE, with
 	// one clock per CE meaning CE could be constant.  The code below
 	// instead handles 1 or 3 clocks per CE, leaving the two clocks per
@@ -1762,7 +2020,89 @@ SLASHLINE
 	///
 	fprintf(fp,
 "\t// Core multiply section\n"
-"\t// {{{\n"
+"\t// {{{\n");
+
+	///////////////////////////////////////////
+	///
+	///	One clock per CE, four multiplies and no pre-adders
+	///
+	if (fourmpy) {
+		fprintf(fp,
+"\tgenerate if (OPT_FOURMPY)\n\tbegin : CKPCE_ONE_FOURMPY\n"
+	"\t\t// {{{\n"
+	"\t\t// Local declarations\n"
+	"\t\t// {{{\n"
+	"\t\t// Coefficient multiply inputs\n"
+	"\t\treg\tsigned	[(CWIDTH-1):0]	p1c_in, p2c_in;\n"
+	"\t\t// Data multiply inputs\n"
+	"\t\treg\tsigned	[(IWIDTH):0]	p1d_in, p2d_in;\n"
+	"\t\t// The cross products, p1c_in * p2d_in and p2c_in * p1d_in\n"
+	"\t\t%s\tsigned	[((IWIDTH+1)+(CWIDTH)-1):0]	rp_rxi, rp_ixr;\n",
+		(tiled) ? "wire" : "reg");
+		if (!tiled) fprintf(fp,
+	"\t\treg\tsigned	[((IWIDTH+1)+(CWIDTH)-1):0]	rp_one, rp_two;\n");
+		fprintf(fp,
+	"\t\t// }}}\n"
+"\n"
+	"\t\t// p[1|2]c_in, p[1|2]d_in\n"
+	"\t\t// {{{\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (i_ce)\n"
+	"\t\tbegin\n"
+		"\t\t\t// Second clock, pipeline = 1\n"
+		"\t\t\tp1c_in <= ir_coef_r;\n"
+		"\t\t\tp2c_in <= ir_coef_i;\n"
+		"\t\t\tp1d_in <= r_dif_r;\n"
+		"\t\t\tp2d_in <= r_dif_i;\n"
+	"\t\tend\n\t\t// }}}\n\n");
+
+		if (tiled) {
+			const char *mpyname[4] = { "one", "two", "rxi", "ixr" },
+				*outname[4] = { "p_one", "p_two", "rp_rxi", "rp_ixr" };
+			const int ain[4] = { 1, 2, 1, 2 }, bin[4] = { 1, 2, 2, 1 };
+
+			fprintf(fp,
+	"\t\t// Perform our multiplies, each tiled across DSPs\n"
+	"\t\t// {{{\n");
+			for(int k=0; k<4; k++)
+				fprintf(fp,
+	"\t\tdspmpy #(\n"
+		"\t\t\t.IAW(CWIDTH), .IBW(IWIDTH+1),\n"
+		"\t\t\t.DSPAW(DSPAW), .DSPBW(DSPBW), .DELAY(MPYDELAY)\n"
+	"\t\t) %si(\n"
+		"\t\t\t.i_clk(i_clk), .i_ce(i_ce),\n"
+		"\t\t\t.i_a(p%dc_in), .i_b(p%dd_in),\n"
+		"\t\t\t.o_r(%s)\n"
+	"\t\t);\n\n",
+					mpyname[k], ain[k], bin[k], outname[k]);
+			fprintf(fp, "\t\t// }}}\n");
+		} else fprintf(fp,
+	"\t\t// Perform our multiplies\n"
+	"\t\t// {{{\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (i_ce)\n"
+	"\t\tbegin\n"
+		"\t\t\t// Third clock, pipeline = 3\n"
+		"\t\t\t//   As desired, each of these lines infers a DSP48\n"
+		"\t\t\trp_one <= p1c_in * p1d_in;\n"
+		"\t\t\trp_two <= p2c_in * p2d_in;\n"
+		"\t\t\trp_rxi <= p1c_in * p2d_in;\n"
+		"\t\t\trp_ixr <= p2c_in * p1d_in;\n"
+	"\t\tend\n"
+	"\t\t// }}}\n"
+"\n"
+	"\t\tassign\tp_one   = rp_one;\n"
+	"\t\tassign\tp_two   = rp_two;\n");
+
+		fprintf(fp,
+"\n"
+	"\t\t// In this form, p_three is the imaginary part of the product\n"
+	"\t\t// itself, rather than what must be subtracted to get it\n"
+	"\t\tassign\tp_three = rp_rxi + rp_ixr;\n"
+	"\t\t// }}}\n"
+"\tend else if (CKPCE <= 1)\n\tbegin : CKPCE_ONE\n");
+	} else
+		fprintf(fp,
 "\tgenerate if (CKPCE <= 1)\n\tbegin : CKPCE_ONE\n");
 
 	fprintf(fp,
@@ -1778,9 +2118,10 @@ SLASHLINE
 	"\t\t// Product 3, data input\n"
 	"\t\treg\tsigned	[(IWIDTH+1):0]	p3d_in;\n"
 "\n");
-	fprintf(fp,
+	if (!tiled) fprintf(fp,
 	"\t\treg\tsigned	[((IWIDTH+1)+(CWIDTH)-1):0]	rp_one, rp_two;\n"
-	"\t\treg\tsigned	[((IWIDTH+2)+(CWIDTH+1)-1):0]	rp_three;\n"
+	"\t\treg\tsigned	[((IWIDTH+2)+(CWIDTH+1)-1):0]	rp_three;\n");
+	fprintf(fp,
 	"\t\t// }}}\n"
 "\n");
 
@@ -1799,13 +2140,32 @@ SLASHLINE
 		"\t\t\tp3d_in <= r_dif_r + r_dif_i;\n"
 	"\t\tend\n\t\t// }}}\n\n");
 
-	if (formal_property_flag)
+	if ((formal_property_flag)&&(!tiled))
 		fprintf(fp,
 	"\t\t// Perform our multiplies\n"
 	"\t\t// {{{\n"
 "`ifndef	FORMAL\n");
 
-	fprintf(fp,
+	if (tiled) {
+		const char *mpyname[3] = { "one", "two", "three" };
+
+		fprintf(fp,
+	"\t\t// Perform our multiplies, each tiled across DSPs\n"
+	"\t\t// {{{\n");
+		for(int k=0; k<3; k++)
+			fprintf(fp,
+	"\t\tdspmpy #(\n"
+		"\t\t\t.IAW(CWIDTH%s), .IBW(IWIDTH%s),\n"
+		"\t\t\t.DSPAW(DSPAW), .DSPBW(DSPBW), .DELAY(MPYDELAY)\n"
+	"\t\t) %si(\n"
+		"\t\t\t.i_clk(i_clk), .i_ce(i_ce),\n"
+		"\t\t\t.i_a(p%dc_in), .i_b(p%dd_in),\n"
+		"\t\t\t.o_r(p_%s)\n"
+	"\t\t);\n\n",
+				(k==2) ? "+1":"", (k==2) ? "+2":"+1",
+				mpyname[k], k+1, k+1, mpyname[k]);
+		fprintf(fp, "\t\t// }}}\n");
+	} else fprintf(fp,
 	"\t\talways @(posedge i_clk)\n"
 	"\t\tif (i_ce)\n"
 	"\t\tbegin\n"
@@ -1816,7 +2176,7 @@ SLASHLINE
 		"\t\t\trp_three <= p3c_in * p3d_in;\n"
 	"\t\tend\n");
 
-	if (formal_property_flag)
+	if ((formal_property_flag)&&(!tiled))
 		fprintf(fp,
 "`else\n"
 		"\t\t// {{{\n"
@@ -1841,10 +2201,11 @@ SLASHLINE
 "`endif // FORMAL\n"
 		"\t\t// }}}\n");
 
-	fprintf(fp,"\n"
+	if (!tiled) fprintf(fp,"\n"
 	"\t\tassign\tp_one   = rp_one;\n"
 	"\t\tassign\tp_two   = rp_two;\n"
-	"\t\tassign\tp_three = rp_three;\n"
+	"\t\tassign\tp_three = rp_three;\n");
+	fprintf(fp,
 	"\t\t// }}}\n");
 
 	///////////////////////////////////////////
@@ -2185,7 +2546,7 @@ SLASHLINE
 	"\tend else if (i_ce)\n"
 	"\tbegin\n"
 		"\t\t// First clock, recover all values\n"
-		"\t\tleft_saved <= leftvv;\n"
+		"\t\tleft_saved <= %s;\n"
 "\n"
 		"\t\t// Second clock, round and latch for final clock\n"
 		"\t\to_aux <= aux_s;\n"
@@ -2205,10 +2566,16 @@ SLASHLINE
 		"\t\t// they are prevented from using DSP48\'s\n"
 		"\t\t// by the (* use_dsp48 ... *) comment above.\n"
 		"\t\tmpy_r <= w_one - w_two;\n"
-		"\t\tmpy_i <= p_three - w_one - w_two;\n"
+		"%s"
 	"\tend\n"
 	"\t// }}}\n"
-	"\n");
+	"\n", (tiled) ? "leftvd" : "leftvv",
+	(fourmpy)
+	? "\t\tif (OPT_FOURMPY)\n"
+		"\t\t\tmpy_i <= p_three;\n"
+		"\t\telse\n"
+		"\t\t\tmpy_i <= p_three - w_one - w_two;\n"
+	: "\t\tmpy_i <= p_three - w_one - w_two;\n");
 
 	fprintf(fp,
 	"\t// Round the results\n"
@@ -2252,8 +2619,13 @@ SLASHLINE );
 	if (formal_property_flag) {
 		fprintf(fp,
 "`ifdef	FORMAL\n"
-	"\tlocalparam	F_LGDEPTH = 3;\n"
-	"\tlocalparam	F_DEPTH = 5;\n"
+	"%s", (tiled)
+	? "\tlocalparam	F_DEPTH = 4+MPYDELAY;\n"
+	"\tlocalparam	F_LGDEPTH = (F_DEPTH < 8) ? 3 : (F_DEPTH < 16) ? 4\n"
+	"\t\t\t\t: (F_DEPTH < 32) ? 5 : 6;\n"
+	: "\tlocalparam	F_LGDEPTH = 3;\n"
+	"\tlocalparam	F_DEPTH = 5;\n");
+		fprintf(fp,
 	"\tlocalparam	[F_LGDEPTH-1:0]	F_D = F_DEPTH-1;\n"
 "\n"
 	"\treg	signed	[IWIDTH-1:0]	f_dlyleft_r  [0:F_DEPTH-1];\n"
@@ -2496,7 +2868,41 @@ SLASHLINE );
 		"\t\tif (f_predifi == 1)\n"
 			"\t\t\tassert(p_two == f_dlycoeff_i[F_D-1]);\n"
 		"\t\t// verilator lint_on  WIDTH\n"
-"\n"
+"\n");
+
+		if (fourmpy)
+			fprintf(fp,
+		"\t\tif (OPT_FOURMPY)\n"
+		"\t\tbegin\n"
+		"\t\t\t// p_three is the sum of the cross products\n"
+		"\t\t\tif ((f_predifr == 0)&&(f_predifi == 0))\n"
+			"\t\t\t\tassert(p_three == 0);\n"
+		"\t\t\tif ((f_dlycoeff_r[F_D-1] == 0)\n"
+		"\t\t\t\t\t&&(f_dlycoeff_i[F_D-1] == 0))\n"
+			"\t\t\t\tassert(p_three == 0);\n"
+		"\t\tend else begin\n"
+		"\t\t\tif (f_sumcoef == 0)\n"
+			"\t\t\t\tassert(p_three == 0);\n"
+		"\t\t\tif (f_sumdiff == 0)\n"
+			"\t\t\t\tassert(p_three == 0);\n"
+		"\t\t\t// verilator lint_off WIDTH\n"
+		"\t\t\tif (f_sumcoef == 1)\n"
+			"\t\t\t\tassert(p_three == f_sumdiff);\n"
+		"\t\t\tif (f_sumdiff == 1)\n"
+			"\t\t\t\tassert(p_three == f_sumcoef);\n"
+		"\t\t\t// verilator lint_on  WIDTH\n"
+		"\t\tend\n"
+"`ifdef	VERILATOR\n"
+		"\t\tassert(p_one   == f_predifr * f_dlycoeff_r[F_D-1]);\n"
+		"\t\tassert(p_two   == f_predifi * f_dlycoeff_i[F_D-1]);\n"
+		"\t\tif (OPT_FOURMPY)\n"
+		"\t\t\tassert(p_three == f_predifr * f_dlycoeff_i[F_D-1]\n"
+		"\t\t\t\t\t+ f_predifi * f_dlycoeff_r[F_D-1]);\n"
+		"\t\telse\n"
+		"\t\t\tassert(p_three == f_sumdiff * f_sumcoef);\n"
+"`endif	// VERILATOR\n");
+		else
+			fprintf(fp,
 		"\t\tif (f_sumcoef == 0)\n"
 			"\t\t\tassert(p_three == 0);\n"
 		"\t\tif (f_sumdiff == 0)\n"
@@ -2511,7 +2917,9 @@ SLASHLINE );
 		"\t\tassert(p_one   == f_predifr * f_dlycoeff_r[F_D-1]);\n"
 		"\t\tassert(p_two   == f_predifi * f_dlycoeff_i[F_D-1]);\n"
 		"\t\tassert(p_three == f_sumdiff * f_sumcoef);\n"
-"`endif	// VERILATOR\n"
+"`endif	// VERILATOR\n");
+
+		fprintf(fp,
 	"\tend\n\n"
 "`endif // FORMAL\n");
 	} else
@@ -2521,6 +2929,6 @@ SLASHLINE );
 "// }}}\n"
 "endmodule\n");
 
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
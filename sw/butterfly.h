@@ -39,11 +39,14 @@
 #ifndef	BUTTERFLY_H
 #define	BUTTERFLY_H
 
-extern	void	build_butterfly(const char *fname, int xtracbits,
+extern	int	build_butterfly(const char *fname, int xtracbits,
 			ROUND_T rounding, int ckpce = 1,
-			const bool async_reset = false);
+			const bool async_reset = false, const bool booth = false,
+			int mpyrows = 1, int mpyoutregs = 0,
+			const bool bypass = false);
 
-extern	void	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
-		int ckpce = 3, const bool async_reset= false);
+extern	int	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
+		int ckpce = 3, const bool async_reset= false,
+		int dsp_aw = 0, int dsp_bw = 0, int cmpy = 0);
 
 #endif
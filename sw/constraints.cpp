@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	constraints.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Writes the timing exceptions a core guarantees by construction,
+//		as both Vivado (XDC) and Quartus (SDC) constraints, so that
+//	the timing tools don't need to close timing on paths that have
+//	several clocks in which to settle.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "legal.h"
+#include "fftsink.h"
+#include "constraints.h"
+
+// CEREG -- a register that is loaded only on i_ce, and never reset
+// {{{
+// i_ce is never true more than once in any CKPCE clocks.  A register only
+// ever loaded on i_ce, and never reset, therefore only ever changes on a
+// clock following an i_ce, and only ever captures on an i_ce clock, at
+// least CKPCE clocks later.  Any path from one such register to another
+// has CKPCE clocks to settle in.  Registers loaded on any other clock, such
+// as those of a multiply shared across the clocks of one i_ce, or loaded
+// on a reset, aren't listed, and so keep their single clock constraint.
+//
+// m_block is the generate block within fftstage holding the butterfly, or
+// NULL for fftstage's own registers.  m_inst, if not NULL, is an instance
+// within that butterfly.  m_ckpce is the only CKPCE the register is found
+// with, or zero if it's found with any CKPCE.
+typedef	struct	{
+	const char	*m_block, *m_inst, *m_name;
+	int		m_ckpce;
+} CEREG;
+
+static	const	CEREG	ce_regs[] = {
+	// fftstage.v: the butterfly's inputs
+	{ NULL, NULL, "ib_a", 0 },
+	{ NULL, NULL, "ib_b", 0 },
+	{ NULL, NULL, "ib_c", 0 },
+	// butterfly.v
+	{ "FWBFLY", NULL, "r_left",    0 },
+	{ "FWBFLY", NULL, "r_right",   0 },
+	{ "FWBFLY", NULL, "r_coef",    0 },
+	{ "FWBFLY", NULL, "r_coef_2",  0 },
+	{ "FWBFLY", NULL, "r_sum_r",   0 },
+	{ "FWBFLY", NULL, "r_sum_i",   0 },
+	{ "FWBFLY", NULL, "r_dif_r",   0 },
+	{ "FWBFLY", NULL, "r_dif_i",   0 },
+	{ "FWBFLY", NULL, "rp_three",  2 },
+	{ "FWBFLY", NULL, "rp2_one",   0 },
+	{ "FWBFLY", NULL, "rp2_two",   0 },
+	{ "FWBFLY", NULL, "rp2_three", 0 },
+	{ "FWBFLY", NULL, "rp3_one",   3 },
+	{ "FWBFLY", NULL, "fifo_read", 0 },
+	{ "FWBFLY", NULL, "mpy_r",     0 },
+	{ "FWBFLY", NULL, "mpy_i",     0 },
+	{ "FWBFLY", "do_rnd_*", "o_val", 0 },
+	// hwbfly.v
+	{ "HWBFLY", NULL, "r_left",    0 },
+	{ "HWBFLY", NULL, "r_right",   0 },
+	{ "HWBFLY", NULL, "r_coef",    0 },
+	{ "HWBFLY", NULL, "r_sum_r",   0 },
+	{ "HWBFLY", NULL, "r_sum_i",   0 },
+	{ "HWBFLY", NULL, "r_dif_r",   0 },
+	{ "HWBFLY", NULL, "r_dif_i",   0 },
+	{ "HWBFLY", NULL, "ir_coef_r", 0 },
+	{ "HWBFLY", NULL, "ir_coef_i", 0 },
+	{ "HWBFLY", NULL, "longmpy",   2 },
+	{ "HWBFLY", NULL, "rp_one",    3 },
+	{ "HWBFLY", NULL, "rp_two",    2 },
+	{ "HWBFLY", NULL, "rp_three",  2 },
+	{ "HWBFLY", NULL, "rp2_one",   0 },
+	{ "HWBFLY", NULL, "rp2_two",   3 },
+	{ "HWBFLY", NULL, "rp2_three", 3 },
+	{ "HWBFLY", NULL, "mpy_r",     0 },
+	{ "HWBFLY", NULL, "mpy_i",     0 },
+	{ "HWBFLY", "do_rnd_*", "o_val", 0 }
+};
+// }}}
+
+// cereg_pattern -- the name of a CEREG, in a given tool's hierarchy
+// {{{
+// Vivado separates levels of hierarchy with a '/', and names registers
+// <name>_reg, Quartus separates them with a '|'.  Both may name the blocks
+// of a generate differently, so these are matched with a wildcard.
+static	std::string	cereg_pattern(const CEREG &r, char sep,
+			const char *suffix) {
+	std::string	pat = "*stage_*";
+
+	pat += sep;
+	if (r.m_block) {
+		pat += "*"; pat += r.m_block; pat += "*bfly"; pat += sep;
+	} if (r.m_inst) {
+		pat += r.m_inst; pat += sep;
+	}
+	pat += r.m_name;
+	pat += suffix;
+	return pat;
+}
+// }}}
+
+// write_constraints -- one constraint file, for either Vivado or Quartus
+// {{{
+static	int	write_constraints(const std::string &fname, bool vivado,
+			const char *mainname, int ckpce) {
+	FILE	*fp;
+	unsigned	nregs = sizeof(ce_regs)/sizeof(ce_regs[0]);
+	bool		first = true;
+
+	fp = fftsink_open(fname.c_str());
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n",
+			fname.c_str());
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	fprintf(fp,
+"################################################################################\n"
+"##\n"
+"## Filename:\t%s.%s\n"
+"##\n"
+"## Project:\t%s\n"
+"##\n"
+"## Purpose:\tTiming exceptions for %s.v, built for one i_ce every %d\n"
+"##\t\tclocks (CKPCE=%d).  Registers loaded only on i_ce, and never\n"
+"##\treset, have %d clocks from one to the next, so the paths between\n"
+"##\tthem are declared as multicycle paths.  This is only valid if i_ce\n"
+"##\tis never true more than once in any %d clocks.\n"
+"##\n"
+"##\tThe multiplies shared across the clocks of an i_ce, and the\n"
+"##\tcoefficient ROM addresses (which are reset), keep their single\n"
+"##\tclock constraints.\n"
+"##\n"
+"################################################################################\n"
+"##\n",
+		mainname, (vivado) ? "xdc" : "sdc", prjname, mainname,
+		ckpce, ckpce, ckpce, ckpce);
+
+	for(unsigned k=0; k<nregs; k++) {
+		const CEREG	&r = ce_regs[k];
+
+		if ((r.m_ckpce != 0)&&(r.m_ckpce != ckpce))
+			continue;
+
+		if (vivado) {
+			fprintf(fp, "%s(NAME =~ %s)",
+				(first) ? "set fft_ce_regs [get_cells -quiet -hier -filter {IS_SEQUENTIAL && (\n\t"
+					: " ||\n\t",
+				cereg_pattern(r, '/', "_reg*").c_str());
+		} else {
+			fprintf(fp, "set fft_ce_regs %s[get_registers -nowarn {%s}]%s\n",
+				(first) ? "" : "[add_to_collection $fft_ce_regs ",
+				cereg_pattern(r, '|', "*").c_str(),
+				(first) ? "" : "]");
+		}
+		first = false;
+	} if (vivado)
+		fprintf(fp, ")}]\n");
+
+	fprintf(fp, "\n"
+		"set_multicycle_path -setup %s%d -from $fft_ce_regs -to $fft_ce_regs\n"
+		"set_multicycle_path -hold  %s%d -from $fft_ce_regs -to $fft_ce_regs\n",
+		(vivado) ? "" : "-end ", ckpce,
+		(vivado) ? "" : "-end ", ckpce-1);
+
+	return fftsink_close(fp);
+}
+// }}}
+
+// build_constraints -- write [i]fftmain.xdc and [i]fftmain.sdc
+// {{{
+// Only a core accepting one sample every CKPCE > 1 clocks has any paths
+// that can be relaxed.
+int	build_constraints(const char *coredir, bool inverse, int ckpce) {
+	std::string	mainname, base;
+
+	if (ckpce <= 1)
+		return 0;
+
+	mainname = (inverse) ? "ifftmain" : "fftmain";
+	base = coredir;
+	if (base.size() > 0)
+		base += "/";
+	base += mainname;
+
+	if (write_constraints(base + ".xdc", true,  mainname.c_str(), ckpce))
+		return EOF;
+	return write_constraints(base + ".sdc", false, mainname.c_str(), ckpce);
+}
+// }}}
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	constraints.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Writes the timing exceptions a core guarantees by construction,
+//		as both Vivado (XDC) and Quartus (SDC) constraints, so that
+//	the timing tools don't need to close timing on paths that have
+//	several clocks in which to settle.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	CONSTRAINTS_H
+#define	CONSTRAINTS_H
+
+extern	int	build_constraints(const char *coredir, bool inverse,
+			int ckpce);
+
+#endif	// CONSTRAINTS_H
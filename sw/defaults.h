@@ -44,6 +44,14 @@
 #ifndef	DEFAULTS_H
 #define	DEFAULTS_H
 
+// The cache (--cache) keys every core by FFTGEN_SRCHASH, lest it hand out
+// cores built by an older fftgen.  The Makefile sets it to a checksum of
+// fftgen's sources.  Builds without it fall back to the time fftcache.cpp
+// was compiled, which at worst only misses the cache more often.
+#ifndef	FFTGEN_SRCHASH
+#define	FFTGEN_SRCHASH	__DATE__ " " __TIME__
+#endif
+
 #define	DEF_NBITSIN	16
 #define	DEF_COREDIR	"fft-core"
 #define	DEF_XTRACBITS	4
@@ -75,6 +83,9 @@
 #define	TST_QTRSTAGE_IWIDTH	16
 #define	TST_QTRSTAGE_LGWIDTH	8
 
+// And for those matching the w8stage
+#define	TST_W8STAGE_IWIDTH	16
+
 // Parameters for the dblstage
 #define	TST_DBLSTAGE_IWIDTH	16
 #define	TST_DBLSTAGE_SHIFT	0
@@ -0,0 +1,326 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dspmpy.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Builds dspmpy.v, a hardware multiply explicitly tiled across
+//		as many DSPs as its widths need.  Left to itself, a synthesis
+//	tool will split a product too wide for one DSP across several, but
+//	with nothing to pipeline the adds joining them back together.  Here,
+//	each DSP gets a tile, and each tile adds its product into a pipelined
+//	accumulator, so the multiply costs a clock for each DSP it uses,
+//	rather than the Fmax of the whole core.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftsink.h"
+#include "dspmpy.h"
+
+// build_dspmpy
+// {{{
+// dsp_aw by dsp_bw is the size of the (signed) multiply a single DSP can do,
+// as given by --dsp.  The tiling built here must match mpy_tiles().
+int	build_dspmpy(const char *fname, int dsp_aw, int dsp_bw) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename: 	%s\n"
+"// {{{\n" // "}}}"
+"// Project:	%s\n"
+"//\n"
+"// Purpose:	A signed hardware multiply, too wide for a single DSP, and so\n"
+"//		tiled across several.  Each input is cut into pieces that\n"
+"//	fit a DSP port: the top piece carries the sign, and the rest are\n"
+"//	given a zero sign bit.  Every pair of pieces, one from each input,\n"
+"//	is a tile.  Each tile gets its own DSP, and adds its product into an\n"
+"//	accumulator, one tile per clock.  The inputs are delayed along with\n"
+"//	the accumulator, so a new product may start on every i_ce.\n"
+"//\n"
+"//	The product is available NT+1 clocks after the inputs, where NT is\n"
+"//	the number of tiles, or DELAY clocks if that's more.\n"
+"//\n"
+"//\n%s"
+"//\n", fname, prjname, creator);
+
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+	fprintf(fp,
+"module	dspmpy #(\n"
+	"\t\t// {{{\n"
+	"\t\tparameter	IAW=%d,	// The width of i_a\n"
+			"\t\t\t\tIBW=%d,	// The width of i_b\n"
+	"\t\t// DSPAW x DSPBW is the size of the signed multiply\n"
+	"\t\t// a single DSP can do\n"
+	"\t\tparameter	DSPAW=%d, DSPBW=%d,\n"
+	"\t\t// DELAY, if greater than NT+1, pads the output out to this\n"
+	"\t\t// many clocks\n"
+	"\t\tparameter	DELAY=0,\n",
+		TST_BUTTERFLY_CWIDTH+1, TST_BUTTERFLY_IWIDTH+2,
+		dsp_aw, dsp_bw);
+
+	fprintf(fp,
+	"\t\t// The following parameters should not be changed\n"
+	"\t\t// by any implementation, but are based upon the\n"
+	"\t\t// above values:\n"
+	"\t\t//\n"
+	"\t\t// The pieces each input is cut into, with the DSP used\n"
+	"\t\t// either way around--whichever takes fewer tiles\n"
+	"\t\tlocalparam	NSA = (IAW-2)/(DSPAW-1)+1,\n"
+			"\t\t\t\tNSB = (IBW-2)/(DSPBW-1)+1,\n"
+			"\t\t\t\tNXA = (IAW-2)/(DSPBW-1)+1,\n"
+			"\t\t\t\tNXB = (IBW-2)/(DSPAW-1)+1,\n"
+			"\t\t\t\tCROSS = (NXA*NXB < NSA*NSB),\n"
+	"\t\t// TAW x TBW, the size of each tile\n"
+	"\t\tlocalparam	TAW = (CROSS) ? DSPBW : DSPAW,\n"
+			"\t\t\t\tTBW = (CROSS) ? DSPAW : DSPBW,\n"
+	"\t\t// NA x NB, the number of tiles\n"
+	"\t\tlocalparam	NA = (CROSS) ? NXA : NSA,\n"
+			"\t\t\t\tNB = (CROSS) ? NXB : NSB,\n"
+			"\t\t\t\tNT = NA*NB,\n"
+	"\t\t// Each input, sign extended to fill all of its pieces\n"
+	"\t\tlocalparam	XAW = NA*(TAW-1)+1,\n"
+			"\t\t\t\tXBW = NB*(TBW-1)+1,\n"
+			"\t\t\t\tOW  = IAW+IBW,\n"
+			"\t\t\t\tPAD = (DELAY > NT+1) ? (DELAY-NT-1) : 0\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t\t\ti_clk, i_ce,\n"
+	"\t\tinput\twire\t[(IAW-1):0]\ti_a,\n"
+	"\t\tinput\twire\t[(IBW-1):0]\ti_b,\n"
+	"\t\toutput\twire\t[(OW-1):0]\to_r\n"
+	"\t\t// }}}\n"
+	"\t);\n"
+"\n"
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\twire\tsigned\t[(XAW-1):0]\tw_a;\n"
+	"\twire\tsigned\t[(XBW-1):0]\tw_b;\n"
+	"\treg\t[(XAW-1):0]\tr_a\t[0:(NT-1)];\n"
+	"\treg\t[(XBW-1):0]\tr_b\t[0:(NT-1)];\n"
+	"\twire\t[(OW-1):0]\tw_p\t[0:(NT-1)];\n"
+	"\treg\t[(OW-1):0]\tacc\t[0:(NT-1)];\n"
+	"\tgenvar\tk;\n"
+	"\t// }}}\n"
+"\n"
+	"\tassign\tw_a = $signed(i_a);\n"
+	"\tassign\tw_b = $signed(i_b);\n"
+"\n");
+
+	fprintf(fp,
+	"\t// r_a, r_b\n"
+	"\t// {{{\n"
+	"\t// The inputs are registered, and then follow the accumulator\n"
+	"\t// from one tile to the next\n"
+	"\tinitial\tr_a[0] = 0;\n"
+	"\tinitial\tr_b[0] = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tr_a[0] <= w_a;\n"
+		"\t\tr_b[0] <= w_b;\n"
+	"\tend\n"
+"\n"
+	"\tgenerate for(k=1; k<NT; k=k+1)\n"
+	"\tbegin : DELAY_INPUTS\n"
+		"\t\tinitial\tr_a[k] = 0;\n"
+		"\t\tinitial\tr_b[k] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\tr_a[k] <= r_a[k-1];\n"
+			"\t\t\tr_b[k] <= r_b[k-1];\n"
+		"\t\tend\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// w_p: the product of each tile, shifted into place\n"
+	"\t// {{{\n"
+	"\t// Tile k multiplies piece k/NB of A by piece k%%NB of B\n"
+	"\tgenerate for(k=0; k<NT; k=k+1)\n"
+	"\tbegin : TILE\n"
+		"\t\twire\tsigned\t[(TAW-1):0]\t\tt_a;\n"
+		"\t\twire\tsigned\t[(TBW-1):0]\t\tt_b;\n"
+		"\t\twire\tsigned\t[(TAW+TBW-1):0]\tt_p;\n"
+		"\t\twire\tsigned\t[(OW-1):0]\t\tsx_p;\n"
+"\n"
+		"\t\tif (k/NB < NA-1)\n"
+		"\t\tbegin : LOW_A\n"
+			"\t\t\tassign\tt_a = { 1\'b0, r_a[k][(k/NB)*(TAW-1) +: (TAW-1)] };\n"
+		"\t\tend else begin : TOP_A\n"
+			"\t\t\tassign\tt_a = r_a[k][(k/NB)*(TAW-1) +: TAW];\n"
+		"\t\tend\n"
+"\n"
+		"\t\tif (k%%NB < NB-1)\n"
+		"\t\tbegin : LOW_B\n"
+			"\t\t\tassign\tt_b = { 1\'b0, r_b[k][(k%%NB)*(TBW-1) +: (TBW-1)] };\n"
+		"\t\tend else begin : TOP_B\n"
+			"\t\t\tassign\tt_b = r_b[k][(k%%NB)*(TBW-1) +: TBW];\n"
+		"\t\tend\n"
+"\n"
+		"\t\tassign\tt_p  = t_a * t_b;\n"
+		"\t\tassign\tsx_p = t_p;\n"
+		"\t\tassign\tw_p[k] = sx_p << ((k/NB)*(TAW-1) + (k%%NB)*(TBW-1));\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// acc\n"
+	"\t// {{{\n"
+	"\t// Each tile adds its product into the accumulator.  Since only the\n"
+	"\t// bottom OW bits of the sum matter, it can wrap freely.\n"
+	"\tinitial\tacc[0] = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\tacc[0] <= w_p[0];\n"
+"\n"
+	"\tgenerate for(k=1; k<NT; k=k+1)\n"
+	"\tbegin : ACCUMULATE\n"
+		"\t\tinitial\tacc[k] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tacc[k] <= acc[k-1] + w_p[k];\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// o_r\n"
+	"\t// {{{\n"
+	"\tgenerate if (PAD > 0)\n"
+	"\tbegin : PAD_OUTPUT\n"
+		"\t\treg\t[(OW-1):0]\tr_pad\t[0:(PAD-1)];\n"
+"\n"
+		"\t\tinitial\tr_pad[0] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tr_pad[0] <= acc[NT-1];\n"
+"\n"
+		"\t\tfor(k=1; k<PAD; k=k+1)\n"
+		"\t\tbegin : PAD\n"
+			"\t\t\tinitial\tr_pad[k] = 0;\n"
+			"\t\t\talways @(posedge i_clk)\n"
+			"\t\t\tif (i_ce)\n"
+				"\t\t\t\tr_pad[k] <= r_pad[k-1];\n"
+		"\t\tend\n"
+"\n"
+		"\t\tassign\to_r = r_pad[PAD-1];\n"
+	"\tend else begin : NO_PAD\n"
+		"\t\tassign\to_r = acc[NT-1];\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// Make Verilator happy\n"
+	"\t// {{{\n"
+	"\t// Each tile uses only its own piece of the delayed inputs\n"
+	"\t// verilator lint_off UNUSED\n"
+	"\twire\tunused;\n"
+	"\tassign\tunused = &{ 1\'b0, r_a[NT-1], r_b[NT-1] };\n"
+	"\t// verilator lint_on UNUSED\n"
+	"\t// }}}\n");
+
+	// The formal property section
+	fprintf(fp,
+SLASHLINE
+SLASHLINE
+SLASHLINE
+"//\n"
+"// Formal property section\n"
+"// {{{\n"
+SLASHLINE
+SLASHLINE
+SLASHLINE
+"`ifdef	FORMAL\n");
+
+	if (formal_property_flag) {
+		fprintf(fp,
+	"\treg	[IAW-1:0]	f_past_a	[0:NT+PAD];\n"
+	"\treg	[IBW-1:0]	f_past_b	[0:NT+PAD];\n"
+	"\twire	[OW-1:0]	f_product;\n"
+"\n"
+	"\tinitial\tf_past_a[0] = 0;\n"
+	"\tinitial\tf_past_b[0] = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tf_past_a[0] <= i_a;\n"
+		"\t\tf_past_b[0] <= i_b;\n"
+	"\tend\n"
+"\n"
+	"\tgenerate for(k=1; k<=NT+PAD; k=k+1)\n"
+	"\tbegin : F_PAST\n"
+		"\t\tinitial\tf_past_a[k] = 0;\n"
+		"\t\tinitial\tf_past_b[k] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\tf_past_a[k] <= f_past_a[k-1];\n"
+			"\t\t\tf_past_b[k] <= f_past_b[k-1];\n"
+		"\t\tend\n"
+	"\tend endgenerate\n"
+"\n"
+	"\tassign\tf_product = $signed(f_past_a[NT+PAD])\n"
+				"\t\t\t\t* $signed(f_past_b[NT+PAD]);\n"
+"\n"
+"`ifdef	DSPMPY\n"
+	"\talways @(*)\n"
+		"\t\tassert(o_r == f_product);\n"
+"`endif\t// DSPMPY\n");
+	} else {
+		fprintf(fp, "// Formal property generation was not been enabled\n");
+	}
+
+	fprintf(fp,
+"`endif\t// FORMAL\n"
+"// }}}\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
@@ -0,0 +1,701 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	estimate.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Estimates the cost of each of the stages fftgen builds.  The
+//		stage building code in fftgen.cpp calls one of the est_*
+//	functions below for every stage it instantiates, with the same widths
+//	it gives to that stage.  The result can then be reported (-E), and its
+//	totals are placed into the -a header file.
+//
+//	Latencies are exact.  They are counted in i_ce's, from the i_ce with
+//	the first sample of a block going into a stage until the i_ce where
+//	the first result of that block, together with o_sync, comes out.
+//	Each is derived from the RTL of the matching module, as described
+//	with each function below.  Because every stage starts on the first
+//	sync it receives, the latency of the FFT is just the sum of the
+//	latencies of its stages.
+//
+//	Multiplies come in two flavors.  Hardware multiplies (OPT_HWMPY,
+//	opt -p) are counted as DSPs: one per multiply, or, once the size of
+//	a DSP has been given (--dsp), as many as it takes to tile the whole
+//	product with DSPs of that size.  Soft multiplies are
+//	built from the shift-add longbimpy, or from the Booth encoded boothmpy
+//	once est_softmpy() says so, and are estimated in LUTs.
+//	These LUT estimates are only that: estimates, ignoring any
+//	optimizations the synthesis tool might make.  Adds, subtracts, and
+//	registers aren't counted at all.
+//
+//	Memory is counted in bits: imem for the memories holding inputs
+//	(including the bit reversal buffers), omem for those holding outputs,
+//	and cmem for the twiddle factor tables.
+//
+//	Quantization noise is tracked from stage to stage, as the power of a
+//	reference signal and of the noise accompanying it.  The reference is
+//	a white, complex input, each component having an RMS value a quarter
+//	of full scale (12dB below), together with the noise of quantizing it
+//	to the input width.  Since the power of such a signal doubles with
+//	each radix-2 stage, and the FFT grows by one bit every other stage,
+//	the reference stays 12dB below full scale throughout.  Each rounding
+//	then adds noise, following the widths and shifts given to the
+//	convround() of each stage.  The resulting SQNR is an estimate: it
+//	ignores overflow, and treats all rounding errors as independent.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <math.h>
+
+#include "fftlib.h"
+#include "estimate.h"
+
+// bfly_mpys -- multiplies used by one butterfly, given CKPCE
+// {{{
+// Both butterfly.v and hwbfly.v use three multiplies per complex product,
+// and share them among the clocks available when CKPCE > 1.
+int	bfly_mpys(int ckpce) {
+	if (ckpce <= 1)
+		return 3;
+	else if (ckpce == 2)
+		return 2;
+	return 1;
+}
+// }}}
+
+// Set by est_softmpy(), true if soft multiplies use the boothmpy, else the
+// rows of the longbimpy tableau added per clock and its extra output registers
+static	bool	est_booth = false;
+static	int	est_mpyrows = 1, est_mpyoregs = 0;
+
+// The size of the multiply a DSP can do, as set by est_dspsize(), or zero
+// if every multiply is to be counted as a single DSP
+static	int	dsp_aw = 0, dsp_bw = 0;
+
+// The complex multiply form, as set by est_cmpy(): 3 or 4 multiplies per
+// complex product, or 0 to choose between them from the operand widths
+static	int	est_cmpyform = 0;
+
+// est_softmpy -- choose the soft multiply being estimated
+// {{{
+void	est_softmpy(bool booth, int rows, int oregs) {
+	est_booth = booth;
+	est_mpyrows  = rows;
+	est_mpyoregs = oregs;
+}
+// }}}
+
+// est_cmpy -- choose the complex multiply form of the hardware butterflies
+// {{{
+void	est_cmpy(int form) {
+	est_cmpyform = form;
+}
+// }}}
+
+// cmpy_four -- true if hwbfly.v builds its complex product from four multiplies
+// {{{
+// The three multiply form widens the operands of its third multiply by a bit
+// each, to (cw+1) by (iw+2), and needs pre-adders to form them.  The four
+// multiply form keeps every multiply at cw by (iw+1) bits, and so needs
+// neither.  Only the CKPCE=1 hwbfly has the four multiply form.  Left to
+// choose (est_cmpy(0)), it's used wherever those two extra bits cost at least
+// as many DSP tiles as the fourth multiply.  This must match OPT_FOURMPY in
+// hwbfly.v.
+bool	cmpy_four(int iw, int cw, int ckpce) {
+	if ((ckpce > 1)||(est_cmpyform == 3))
+		return false;
+	if (est_cmpyform == 4)
+		return true;
+	if ((dsp_aw <= 1)||(dsp_bw <= 1))
+		return false;
+	return (2 * mpy_dsps(cw, iw+1) <= mpy_dsps(cw+1, iw+2));
+}
+// }}}
+
+// bfly_dsps -- DSPs used by the multiplies of one hwbfly
+// {{{
+// With CKPCE=1, two of the three multiplies are cw by (iw+1) bits and the
+// third is (cw+1) by (iw+2), unless all four are cw by (iw+1).  With CKPCE=2,
+// one multiply of each size, and with CKPCE=3 only the wider one.
+int	bfly_dsps(int iw, int cw, int ckpce) {
+	const int	narrow = mpy_dsps(cw, iw+1),
+			wide   = mpy_dsps(cw+1, iw+2);
+
+	if (ckpce <= 1)
+		return (cmpy_four(iw, cw, ckpce)) ? 4 * narrow
+				: 2 * narrow + wide;
+	else if (ckpce == 2)
+		return narrow + wide;
+	return wide;
+}
+// }}}
+
+// bfly_latency -- i_ce's from i_aux going into a butterfly until o_aux
+// {{{
+// hwbfly.v delays i_aux through r_aux, r_aux_2, leftv, leftvv, left_saved,
+// and then o_aux, regardless of CKPCE.  Once a DSP size has been given, its
+// CKPCE=1 multiplies take a clock to register their inputs and another for
+// each DSP tile, rather than the one, and leftvv is delayed to match.  With
+// four multiplies, those tiles are the narrower ones.
+// butterfly.v delays it by an AUXLEN (LCLDELAY+3) long shift register and
+// then o_aux, where LCLDELAY is the multiply delay (bflydelay()) scaled by
+// CKPCE.
+int	bfly_latency(int iw, int cw, bool hwmpy, int ckpce) {
+	int	mpydelay, lcldelay;
+
+	if ((hwmpy)&&(ckpce <= 1)&&(dsp_aw > 1))
+		return 6 + ((cmpy_four(iw, cw, ckpce)) ? mpy_dsps(cw, iw+1)
+				: mpy_dsps(cw+1, iw+2));
+	else if (hwmpy)
+		return 6;
+
+	mpydelay = bflydelay(iw, cw-iw, est_booth, est_mpyrows, est_mpyoregs);
+	if (ckpce <= 1)
+		lcldelay = mpydelay;
+	else if (ckpce == 2)
+		lcldelay = mpydelay/2+2;
+	else
+		lcldelay = mpydelay/3+2;
+
+	return lcldelay + 4;
+}
+// }}}
+
+// est_dspsize -- set the size of the multiply a DSP can do
+// {{{
+void	est_dspsize(int aw, int bw) {
+	dsp_aw = aw;
+	dsp_bw = bw;
+}
+// }}}
+
+// mpy_tiles -- how a multiply of aw bits by bw bits is tiled with DSPs
+// {{{
+// A DSP multiplies two signed values, so every piece of a wider input, but
+// its top one, loses a bit to a zero sign bit.  The top piece carries the
+// sign.  The multiply (or the DSP) may be turned around if that takes fewer
+// tiles.  This matches the tiling dspmpy.v builds, and returns the number of
+// tiles, na by nb, each of ta by tb bits.  Without a DSP size, every multiply
+// is a single tile.
+int	mpy_tiles(int aw, int bw, int *na, int *nb, int *ta, int *tb) {
+	int	sa, sb, xa, xb;
+
+	if ((dsp_aw <= 1)||(dsp_bw <= 1)) {
+		*na = *nb = 1;
+		*ta = aw; *tb = bw;
+		return 1;
+	}
+
+	sa = (aw-2) / (dsp_aw-1) + 1;
+	sb = (bw-2) / (dsp_bw-1) + 1;
+	xa = (aw-2) / (dsp_bw-1) + 1;
+	xb = (bw-2) / (dsp_aw-1) + 1;
+
+	if (xa * xb < sa * sb) {
+		*na = xa; *nb = xb;
+		*ta = dsp_bw; *tb = dsp_aw;
+	} else {
+		*na = sa; *nb = sb;
+		*ta = dsp_aw; *tb = dsp_bw;
+	}
+
+	return (*na) * (*nb);
+}
+// }}}
+
+// mpy_dsps -- DSPs used by a hardware multiply of aw bits by bw bits
+// {{{
+// One per tile.  The adds joining the tiles back together are ignored.
+int	mpy_dsps(int aw, int bw) {
+	int	na, nb, ta, tb;
+
+	return mpy_tiles(aw, bw, &na, &nb, &ta, &tb);
+}
+// }}}
+
+// mpy_luts -- LUTs used by a soft multiply of aw bits by bw bits
+// {{{
+// The longbimpy takes absolute values of both inputs, then builds a tableau
+// of (aw+1)/2 rows, each a bimpy of two bits by bw bits and each added into
+// an accumulator, and finally restores the sign.  One LUT per bit of each.
+//
+// The boothmpy has the same (aw+1)/2 rows, but each selects 0, +/-B, or
+// +/-2B within the same LUT that adds it into the accumulator.  Since the
+// bits below each row are already final, row k only adds aw+bw-2k bits.
+int	mpy_luts(int aw, int bw) {
+	int	tlen;
+
+	if (aw > bw) {
+		int tmp = aw;
+		aw = bw; bw = tmp;
+	}
+
+	tlen = (aw+1)/2;
+	if (est_booth)
+		return (bw+2)			// The first row
+			+ (tlen-1) * (aw+bw)	// The accumulating rows
+			- tlen * (tlen-1);	// ... less their final bits
+
+	return 2*(aw+bw)		// Absolute values in, sign out
+		+ tlen * (bw+2)		// The bimpy rows
+		+ (tlen-1) * (aw+bw);	// The accumulators
+}
+// }}}
+
+// constmpy_luts -- LUTs used to multiply iw bits by a constant coefficient
+// {{{
+// A multiply by a constant costs one adder per non-zero digit of the
+// coefficient, less one, once the coefficient is written in canonical signed
+// digit form.
+int	constmpy_luts(long long coef, int iw, int cw) {
+	int	digits = 0;
+
+	if (coef < 0)
+		coef = -coef;
+	while(coef != 0) {
+		if (coef & 1) {
+			digits++;
+			// A run of ones becomes a single subtract, followed
+			// by a single add
+			coef = ((coef & 3) == 3) ? coef+1 : coef-1;
+		}
+		coef >>= 1;
+	}
+
+	if (digits <= 1)
+		return 0;
+	return (digits-1)*(iw+cw);
+}
+// }}}
+
+// est_stage -- record the cost of a stage
+// {{{
+void	est_stage(FFTEST &est, const std::string &name,
+		const char *module, int span, int dsps, int luts,
+		long imem, long omem, long cmem, int latency) {
+	STAGEEST	st;
+
+	st.m_name    = name;
+	st.m_module  = module;
+	st.m_span    = span;
+	st.m_dsps    = dsps;
+	st.m_luts    = luts;
+	st.m_latency = latency;
+	st.m_imem    = imem;
+	st.m_omem    = omem;
+	st.m_cmem    = cmem;
+	st.m_fourmpy = false;
+	// Until told otherwise, the stage passes its input through exactly
+	if (est.size() > 0) {
+		st.m_signal = est.back().m_signal;
+		st.m_noise  = est.back().m_noise;
+	} else
+		st.m_signal = st.m_noise = 0.0;
+	est.push_back(st);
+}
+// }}}
+
+// est_input -- the reference signal going into the FFT
+// {{{
+// Each component of the reference has an RMS value of 2^(iw-1)/4 LSBs, for a
+// complex power of 2^(2iw-5).  Rounding it to iw bits in the first place adds
+// 1/12th of an LSB squared of noise to each component.
+void	est_input(FFTEST &est, int iw) {
+	est_stage(est, "i_sample", "fftmain", 0, 0, 0, 0, 0, 0, 0);
+	est.back().m_signal = ldexp(1.0, 2*iw-5);
+	est.back().m_noise  = 2.0 / 12.0;
+}
+// }}}
+
+// est_quantize -- track the signal and noise through the last stage in est
+// {{{
+// The stage adds its inputs into an exact sum of sumw bits, whose LSB is the
+// same as that of its inputs, raising the power of both the signal and noise
+// by gain.  If it multiplies (cw > 0), the product carries another cw-2 bits
+// below that LSB.  convround() then shifts off shift top bits and rounds to
+// ow bits.  Dropping a single bit in this fashion leaves an error of either
+// zero or half an LSB, for a variance of 1/8, while dropping more leaves a
+// (nearly) uniform error of variance 1/12.  Finally, the error in the cw bit
+// coefficients adds noise in proportion to the signal, on the cfrac of the
+// outputs that are multiplied.
+static	void	est_quantize(FFTEST &est, int sumw, int ow, int shift,
+			double gain, int cw, double cfrac) {
+	const int	frac = (cw > 0) ? cw-2 : 0;
+	int		drop;
+	double		scale, rndvar;
+
+	if (est.size() < 2)
+		return;
+
+	STAGEEST	&st = est.back(), &prior = est[est.size()-2];
+
+	// drop is the number of bits rounded away, counted from the LSB of
+	// the sum (or product)
+	drop = sumw + frac - shift - ow;
+	if ((drop < 0)||(sumw + frac == ow))
+		drop = 0;
+
+	if (drop == 0)
+		rndvar = 0.0;
+	else if (drop == 1)
+		rndvar = 1.0 / 8.0;
+	else
+		rndvar = 1.0 / 12.0;
+
+	// scale converts powers from input LSB's into output LSB's
+	scale = gain * ldexp(1.0, -2*(drop - frac));
+
+	st.m_signal = prior.m_signal * scale;
+	st.m_noise  = prior.m_noise  * scale + 2.0 * rndvar;
+	if (cw > 0)
+		st.m_noise += st.m_signal * cfrac
+				* 2.0 * ldexp(1.0, -2*frac) / 12.0;
+}
+// }}}
+
+// est_fftstage -- an fftstage, or several identical ones running in parallel
+// {{{
+// An fftstage delays the first half of its block through imem.  The first
+// butterfly input is registered (ib_sync) one i_ce after the first sample of
+// the second half arrives, and o_sync is registered one i_ce after the
+// butterfly's o_aux.  Only the difference, half of the outputs, is multiplied
+// by a twiddle factor.  (fftgen always sets BFLYSHIFT to zero.)  A quarter wave
+// table (qtrwave) holds only span/2 coefficients, of cw-1 bits each.  A stage
+// reading from a shared twidrom (see est_twidrom) has no table of its own.
+// A stage generating its own twiddles (lgfine > 0) keeps a coarse and a fine
+// table, of cw+2 bits each, and uses four more multiplies to combine them.
+void	est_fftstage(FFTEST &est, const std::string &name,
+		int ninst, int iw, int cw, int ow, int lgspan,
+		bool hwmpy, int ckpce, bool qtrwave, bool shared, int lgfine) {
+	const long	span = 1l << lgspan;
+	int		mpys = bfly_mpys(ckpce);
+
+	est_stage(est, name, "fftstage", 2*span,
+		((hwmpy) ? ninst * bfly_dsps(iw, cw, ckpce) : 0)
+			+ ((lgfine > 0) ? ninst * 4 : 0),
+		(hwmpy) ? 0 : ninst * mpys * mpy_luts(cw+1, iw+2),
+		ninst * span * 2 * iw, ninst * span * 2 * ow,
+		(shared) ? 0
+		: (qtrwave) ? ninst * (span/2) * (cw-1)
+		: (lgfine > 0) ? ninst * ((span >> lgfine) + (1l << lgfine))
+				* 2 * (cw+2)
+		: ninst * span * 2 * cw,
+		span + 2 + bfly_latency(iw, cw, hwmpy, ckpce));
+	est.back().m_fourmpy = (hwmpy)&&(cmpy_four(iw, cw, ckpce));
+	est_quantize(est, iw+1, ow, 0, 2.0, cw, 0.5);
+}
+// }}}
+
+// est_twidrom -- a twiddle factor ROM shared by several fftstages
+// {{{
+// Holds the table of the largest stage it serves, of span 2^lgspan, at the
+// widest coefficient width of those stages.  It sits beside the pipeline,
+// and so adds no latency.
+void	est_twidrom(FFTEST &est, const std::string &name,
+		int lgspan, int cw) {
+	est_stage(est, name, "twidrom", 0, 0, 0, 0, 0,
+		(1l << lgspan) * 2 * cw, 0);
+}
+// }}}
+
+// est_twidstage -- a twiddle multiply, without any butterfly
+// {{{
+// The twidstage registers its input and coefficient (ib_sync) on the first
+// i_ce, and then passes o_aux straight out as its o_sync.  Its butterfly
+// doesn't add anything, but rather keeps the width of its input by shifting
+// off the top bit (SHIFT=1).
+void	est_twidstage(FFTEST &est, const std::string &name,
+		int iw, int cw, int lgwidth, bool hwmpy, int ckpce) {
+	int	mpys = bfly_mpys(ckpce);
+
+	est_stage(est, name, "twidstage", 1<<lgwidth,
+		(hwmpy) ? bfly_dsps(iw, cw, ckpce) : 0,
+		(hwmpy) ? 0 : mpys * mpy_luts(cw+1, iw+2),
+		0, 0, (1l<<lgwidth) * 2 * cw,
+		1 + bfly_latency(iw, cw, hwmpy, ckpce));
+	est.back().m_fourmpy = (hwmpy)&&(cmpy_four(iw, cw, ckpce));
+	est_quantize(est, iw+1, iw, 1, 1.0, cw, 1.0);
+}
+// }}}
+
+// est_bf2stage -- a multiplier free butterfly stage
+// {{{
+// Like the fftstage, save that the butterfly is replaced by one clock of
+// adds and one of rounding, r_sync and ob_sync.
+void	est_bf2stage(FFTEST &est, const std::string &name,
+		int iw, int ow, int lgspan) {
+	const long	span = 1l << lgspan;
+
+	est_stage(est, name, "bf2stage", 2*span, 0, 0,
+		span * 2 * iw, span * 2 * ow, 0, span + 4);
+	est_quantize(est, iw+1, ow, 0, 2.0, 0, 0.0);
+}
+// }}}
+
+// est_qtrstage -- the quarter stage, span four, adds and subtracts only
+// {{{
+// Both the single and double clock qtrstage's register o_sync when their
+// iaddr reaches five, so the first output comes six i_ce's after the first
+// input.
+void	est_qtrstage(FFTEST &est, const std::string &name, int iw, int ow) {
+	est_stage(est, name, "qtrstage", 4, 0, 0, 0, 0, 0, 6);
+	est_quantize(est, iw+1, ow, 0, 2.0, 0, 0.0);
+}
+// }}}
+
+// est_w8stage -- the eight point stage, built from constant multiplies
+// {{{
+// The w8stage holds four samples in imem and four results in omem.  It adds,
+// forms the sum and difference of the difference's two halves, multiplies
+// these by the one constant, rotates, and then rounds, registering o_sync
+// when its iaddr reaches nine, so the first output comes ten i_ce's after the
+// first input.  Only two of its eight outputs carry the constant's error.
+void	est_w8stage(FFTEST &est, const std::string &name,
+		int iw, int cw, int ow) {
+	long long	k, kim;
+
+	gen_coeff_value(8, 1, cw, false, &k, &kim);
+	est_stage(est, name, "w8stage", 8, 0,
+		2 * constmpy_luts(k, iw+2, cw) + 2 * (iw+2),
+		4 * 2 * iw, 4 * 2 * ow, 0, 10);
+	est_quantize(est, iw+1, ow, 0, 2.0, cw, 0.25);
+}
+// }}}
+
+// est_w8twid -- the W_8 twiddles within a radix-2^3 group of stages
+// {{{
+// Registers its input, forms the sum and difference of its two halves,
+// multiplies these by the one constant, rotates, and rounds, for a latency
+// of five.  Only one output in four, those with n3 set and k1 + 2*k2 odd,
+// carries the constant's error.
+void	est_w8twid(FFTEST &est, const std::string &name,
+		int iw, int cw, int lgwidth) {
+	long long	k, kim;
+
+	gen_coeff_value(8, 1, cw, false, &k, &kim);
+	est_stage(est, name, "w8twid", 1<<lgwidth, 0,
+		2 * constmpy_luts(k, iw+1, cw) + 2 * (iw+1),
+		0, 0, 0, 5);
+	est_quantize(est, iw+1, iw, 1, 1.0, cw, 0.25);
+}
+// }}}
+
+// est_laststage -- the last stage, span two, adds and subtracts only
+// {{{
+// One clock to gather the pair of inputs (or, with two inputs per clock, to
+// add them), one to add (or round), and one to round (or register the
+// output).
+void	est_laststage(FFTEST &est, const std::string &name,
+		int iw, int ow, int shift) {
+	est_stage(est, name, "laststage", 2, 0, 0, 0, 0, 0, 3);
+	est_quantize(est, iw+1, ow, shift, 2.0, 0, 0.0);
+}
+// }}}
+
+// est_bfpscale -- a block floating point scaling stage
+// {{{
+// The scaling stage chooses the scale of each frame from the peak of the frame
+// before it, and so needs no memory.  Each sample is rounded (or registered)
+// on the clock it arrives.  Whether or not it halves a given frame depends
+// upon the data.  The reference signal is steady, so each frame is scaled as
+// the one before: halved whenever that leaves it no more than 12dB below the
+// full scale of the (iw-1) bit output, and otherwise passed through unchanged.
+void	est_bfpscale(FFTEST &est, const std::string &name, int span, int iw) {
+	est_stage(est, name, "bfpscale", span, 0, 0, 0, 0, 0, 1);
+	if (est.back().m_signal / 4.0 >= ldexp(1.0, 2*(iw-1)-5))
+		est_quantize(est, iw, iw-1, 0, 1.0, 0, 0.0);
+}
+// }}}
+
+// crossbfly_luts -- LUTs used by the constant multiplies of a crossbfly
+// {{{
+// The crossbfly multiplies the difference, iw+1 bits wide, by a constant
+// coefficient.  That's four real constant multiplies, plus two more adders
+// if neither half of the coefficient is zero.
+int	crossbfly_luts(long long cr, long long ci, int iw, int cw) {
+	int	luts;
+
+	luts = 2 * (constmpy_luts(cr, iw+1, cw) + constmpy_luts(ci, iw+1, cw));
+	if ((cr != 0)&&(ci != 0))
+		luts += 2 * (iw+1+cw);
+	return luts;
+}
+// }}}
+
+// est_crossbfly -- a set of butterflies across lanes
+// {{{
+// The crossbfly adds on the first clock, multiplies on the second, and rounds
+// on the third, delaying i_aux to match.  As with the fftstage, only half of
+// the outputs are multiplied.
+void	est_crossbfly(FFTEST &est, const std::string &name,
+		int span, int iw, int cw, int ow, int shift, int luts) {
+	est_stage(est, name, "crossbfly", span, 0, luts, 0, 0, 0, 3);
+	est_quantize(est, iw+1, ow, shift, 2.0, cw, 0.5);
+}
+// }}}
+
+// est_lanestage -- a set of span two butterflies, each within one lane
+// {{{
+// The lanestage holds the first sample of each pair, passes the second along
+// with it into a crossbfly, and then registers its first output (and o_sync)
+// one i_ce after the crossbfly's o_aux.
+void	est_lanestage(FFTEST &est, const std::string &name,
+		int span, int iw, int cw, int ow, int luts) {
+	est_stage(est, name, "lanestage", span, 0, luts, 0, 0, 0, 2+3);
+	est_quantize(est, iw+1, ow, 0, 2.0, cw, 0.5);
+}
+// }}}
+
+// est_realstage -- the real FFT post-processing stage
+// {{{
+// The realstage buffers a whole block, then emits rd_sync with the first
+// read, ib_sync as the butterfly input is registered, and after the
+// butterfly two more clocks to sum and round the results.  For the noise
+// estimate, the rounding within the butterfly is folded into the final
+// rounding of the (iw+3) bit sum, whose top bit is shifted off.
+void	est_realstage(FFTEST &est, const std::string &name,
+		int iw, int cw, int ow, int lgsize, bool hwmpy, int ckpce) {
+	const long	size = 1l << lgsize;
+	int		mpys = bfly_mpys(ckpce);
+
+	est_stage(est, name, "realstage", 2*size,
+		(hwmpy) ? bfly_dsps(iw+1, cw, ckpce) : 0,
+		(hwmpy) ? 0 : mpys * mpy_luts(cw+1, iw+3),
+		2 * size * 2 * iw, 0, size * 2 * cw,
+		size + 4 + bfly_latency(iw+1, cw, hwmpy, ckpce));
+	est.back().m_fourmpy = (hwmpy)&&(cmpy_four(iw+1, cw, ckpce));
+	est_quantize(est, iw+3, ow, 1, 2.0, cw, 1.0);
+}
+// }}}
+
+// est_bitreverse -- the bit reversal stage
+// {{{
+// Any bit reversal stage needs to read in a full block, (1<<lgsize)/nlanes
+// i_ce's, before its first output can be read and registered.  Its memory
+// holds two blocks.
+void	est_bitreverse(FFTEST &est, int lgsize, int width, int nlanes) {
+	const long	size = 1l << lgsize;
+
+	est_stage(est, "revstage", "bitreverse", 0, 0, 0,
+		2 * size * 2 * width, 0, 0, (int)(size / nlanes) + 1);
+}
+// }}}
+
+// est_output -- the final output register of the FFT
+// {{{
+void	est_output(FFTEST &est) {
+	est_stage(est, "o_result", "fftmain", 0, 0, 0, 0, 0, 0, 1);
+}
+// }}}
+
+// est_sqnr -- the estimated SQNR at the output of a stage, in dB
+// {{{
+double	est_sqnr(const STAGEEST &st) {
+	if (st.m_noise <= 0.0)
+		return 0.0;
+	return 10.0 * log10(st.m_signal / st.m_noise);
+}
+// }}}
+
+// est_total -- add all of the stages together
+// {{{
+STAGEEST	est_total(const FFTEST &est) {
+	STAGEEST	total;
+
+	total.m_name = "Total";
+	total.m_module = "";
+	total.m_span = 0;
+	total.m_dsps = total.m_luts = total.m_latency = 0;
+	total.m_imem = total.m_omem = total.m_cmem = 0;
+	total.m_signal = total.m_noise = 0.0;
+	total.m_fourmpy = false;
+	for(unsigned k=0; k<est.size(); k++) {
+		total.m_dsps    += est[k].m_dsps;
+		total.m_luts    += est[k].m_luts;
+		total.m_latency += est[k].m_latency;
+		total.m_imem    += est[k].m_imem;
+		total.m_omem    += est[k].m_omem;
+		total.m_cmem    += est[k].m_cmem;
+	}
+
+	// The SQNR of the whole is that of its last stage
+	if (est.size() > 0) {
+		total.m_signal = est.back().m_signal;
+		total.m_noise  = est.back().m_noise;
+	}
+
+	return total;
+}
+// }}}
+
+// est_report -- print a table of our estimates
+// {{{
+void	est_report(FILE *fp, const FFTEST &est, int ckpce) {
+	STAGEEST	total = est_total(est);
+
+	fprintf(fp, "%-12s %-10s %5s %8s %9s %9s %9s %8s %6s\n",
+		"Stage", "Module", "DSPs", "MPY-LUTs",
+		"imem", "omem", "cmem", "Latency", "SQNR");
+	for(unsigned k=0; k<est.size(); k++)
+		fprintf(fp, "%-12s %-10s %5d %8d %9ld %9ld %9ld %8d %6.1f\n",
+			est[k].m_name.c_str(), est[k].m_module.c_str(),
+			est[k].m_dsps, est[k].m_luts,
+			est[k].m_imem, est[k].m_omem, est[k].m_cmem,
+			est[k].m_latency, est_sqnr(est[k]));
+	fprintf(fp, "%-12s %-10s %5d %8d %9ld %9ld %9ld %8d %6.1f\n",
+		total.m_name.c_str(), "",
+		total.m_dsps, total.m_luts,
+		total.m_imem, total.m_omem, total.m_cmem,
+		total.m_latency, est_sqnr(total));
+
+	fprintf(fp, "Latency is measured in i_ce's");
+	if (ckpce > 1)
+		fprintf(fp, ", or %d clocks at one i_ce every %d clocks",
+			total.m_latency * ckpce, ckpce);
+	fprintf(fp, "\n");
+	fprintf(fp, "SQNR is in dB, for a white input 12dB below full scale\n");
+
+	// Name any stages whose complex products take four multiplies
+	bool	four = false;
+	for(unsigned k=0; k<est.size(); k++) {
+		if (!est[k].m_fourmpy)
+			continue;
+		fprintf(fp, "%s %s", (four) ? ","
+				: "Four multiplies per complex product, not three:",
+			est[k].m_name.c_str());
+		four = true;
+	} if (four)
+		fprintf(fp, "\n");
+}
+// }}}
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	estimate.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Keeps track of what each stage of a generated FFT will cost,
+//		in multiplies, LUTs, memory, and latency, so that fftgen can
+//	report these numbers (-E) before any synthesis is ever run.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	ESTIMATE_H
+#define	ESTIMATE_H
+
+#include <vector>
+
+// STAGEEST -- the estimated cost of one stage, or one set of parallel stages
+// {{{
+typedef	struct	STAGEEST_S {
+	std::string	m_name, m_module;
+	int		m_span,		// Points transformed by this stage
+			m_dsps,		// Hardware multiplies
+			m_luts,		// LUTs used by shift-add multiplies
+			m_latency;	// In i_ce's, first input to first output
+	long		m_imem, m_omem, m_cmem;	// Memory bits
+	bool		m_fourmpy;	// Four multiplies per complex product
+	// The power of a reference signal, and of the quantization noise
+	// accompanying it, at the output of this stage, both in units of
+	// the output LSB squared
+	double		m_signal, m_noise;
+} STAGEEST;
+// }}}
+
+typedef	std::vector<STAGEEST>	FFTEST;
+
+extern	int	bfly_mpys(int ckpce);
+extern	int	bfly_latency(int iw, int cw, bool hwmpy, int ckpce);
+extern	void	est_softmpy(bool booth, int rows = 1, int oregs = 0);
+extern	void	est_cmpy(int form);
+extern	bool	cmpy_four(int iw, int cw, int ckpce);
+extern	int	bfly_dsps(int iw, int cw, int ckpce);
+extern	void	est_dspsize(int aw, int bw);
+extern	int	mpy_tiles(int aw, int bw, int *na, int *nb, int *ta, int *tb);
+extern	int	mpy_dsps(int aw, int bw);
+extern	int	mpy_luts(int aw, int bw);
+extern	int	constmpy_luts(long long coef, int iw, int cw);
+extern	int	crossbfly_luts(long long cr, long long ci, int iw, int cw);
+
+extern	void	est_stage(FFTEST &est, const std::string &name,
+			const char *module, int span, int dsps, int luts,
+			long imem, long omem, long cmem, int latency);
+extern	void	est_input(FFTEST &est, int iw);
+extern	void	est_fftstage(FFTEST &est, const std::string &name,
+			int ninst, int iw, int cw, int ow, int lgspan,
+			bool hwmpy, int ckpce, bool qtrwave = false,
+			bool shared = false, int lgfine = 0);
+extern	void	est_twidrom(FFTEST &est, const std::string &name,
+			int lgspan, int cw);
+extern	void	est_twidstage(FFTEST &est, const std::string &name,
+			int iw, int cw, int lgwidth, bool hwmpy, int ckpce);
+extern	void	est_bf2stage(FFTEST &est, const std::string &name,
+			int iw, int ow, int lgspan);
+extern	void	est_qtrstage(FFTEST &est, const std::string &name,
+			int iw, int ow);
+extern	void	est_w8stage(FFTEST &est, const std::string &name,
+			int iw, int cw, int ow);
+extern	void	est_w8twid(FFTEST &est, const std::string &name,
+			int iw, int cw, int lgwidth);
+extern	void	est_laststage(FFTEST &est, const std::string &name,
+			int iw, int ow, int shift);
+extern	void	est_bfpscale(FFTEST &est, const std::string &name,
+			int span, int iw);
+extern	void	est_crossbfly(FFTEST &est, const std::string &name,
+			int span, int iw, int cw, int ow, int shift, int luts);
+extern	void	est_lanestage(FFTEST &est, const std::string &name,
+			int span, int iw, int cw, int ow, int luts);
+extern	void	est_realstage(FFTEST &est, const std::string &name,
+			int iw, int cw, int ow, int lgsize, bool hwmpy,
+			int ckpce);
+extern	void	est_bitreverse(FFTEST &est, int lgsize, int width,
+			int nlanes);
+extern	void	est_output(FFTEST &est);
+
+extern	double	est_sqnr(const STAGEEST &st);
+extern	STAGEEST	est_total(const FFTEST &est);
+extern	void	est_report(FILE *fp, const FFTEST &est, int ckpce);
+
+#endif	// ESTIMATE_H
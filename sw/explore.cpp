@@ -0,0 +1,401 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	explore.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Implements fftgen --explore.  Given an FFT size, and
+//		optionally the sample rate, the clock rate, and a minimum
+//	SQNR, this enumerates the options controlling the cost and precision
+//	of the FFT: the input width (-n), the extra coefficient (-c) and
+//	internal (-x) bits, the maximum width (-m), the number of hardware
+//	multiplies (-p), and the clocks per sample (-k) or samples per clock
+//	(-2, -4, -8) which keep up with the sample rate.  Any of these the
+//	user gives on the command line are held fixed.
+//
+//	Each candidate is built in memory, by fftgen_estimate(), which keeps
+//	nothing but the estimates -E would report: its cost and SQNR.  No
+//	files are written, and no other program is run.  Those that no
+//	other candidate beats in every respect--DSPs, LUTs, and memory--form
+//	the Pareto frontier, and are reported cheapest first.  If a minimum
+//	SQNR is given, only candidates meeting it are considered.  Otherwise,
+//	the SQNR is one more respect in which a candidate may be beaten.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "defaults.h"
+#include "fftlib.h"
+#include "estimate.h"
+#include "libfftgen.h"
+#include "explore.h"
+
+// CANDIDATE -- one set of options, and what building with them would cost
+// {{{
+typedef	struct	CANDIDATE_S {
+	std::string	m_opts;
+	int		m_dsps, m_luts, m_latency;
+	long		m_mem;
+	double		m_sqnr;
+} CANDIDATE;
+// }}}
+
+// explore_rate -- convert a rate, such as 100M or 1.5G, into a number
+// {{{
+// As with the FFT size, a trailing k, m, or g (in either case) multiplies the
+// rate by a thousand, million, or billion.  Returns a negative value on any
+// error.
+double	explore_rate(const char *str) {
+	char	*end;
+	double	rate;
+
+	rate = strtod(str, &end);
+	if (end == str)
+		return -1.0;
+	switch(*end) {
+	case 'k': case 'K':	rate *= 1e3; end++; break;
+	case 'm': case 'M':	rate *= 1e6; end++; break;
+	case 'g': case 'G':	rate *= 1e9; end++; break;
+	default: break;
+	}
+
+	if ((*end != '\0')&&(strcasecmp(end, "Hz") != 0))
+		return -1.0;
+	if (rate <= 0.0)
+		return -1.0;
+	return rate;
+}
+// }}}
+
+// input_sqnr -- the best SQNR an iw bit input can offer
+// {{{
+// The SQNR of the reference signal (see estimate.cpp) going into the FFT.
+static	double	input_sqnr(int iw) {
+	FFTEST	est;
+
+	est_input(est, iw);
+	return est_sqnr(est.back());
+}
+// }}}
+
+// dominates -- true if a is at least as good as b in every respect
+// {{{
+// When the SQNR is only a constraint (use_sqnr is false), the SQNR only
+// breaks ties.
+static	bool	dominates(const CANDIDATE &a, const CANDIDATE &b,
+			bool use_sqnr) {
+	if ((a.m_dsps > b.m_dsps)||(a.m_luts > b.m_luts)||(a.m_mem > b.m_mem))
+		return false;
+	if (use_sqnr)
+		return (a.m_sqnr >= b.m_sqnr);
+	if ((a.m_dsps == b.m_dsps)&&(a.m_luts == b.m_luts)
+			&&(a.m_mem == b.m_mem))
+		return (a.m_sqnr >= b.m_sqnr);
+	return true;
+}
+// }}}
+
+// cheaper -- the order in which we report the frontier
+// {{{
+static	bool	cheaper(const CANDIDATE &a, const CANDIDATE &b) {
+	if (a.m_dsps != b.m_dsps)
+		return a.m_dsps < b.m_dsps;
+	if (a.m_luts != b.m_luts)
+		return a.m_luts < b.m_luts;
+	if (a.m_mem != b.m_mem)
+		return a.m_mem < b.m_mem;
+	return a.m_sqnr > b.m_sqnr;
+}
+// }}}
+
+// quiet -- silence stdout and stderr while building a candidate, or restore
+// {{{
+// A candidate that can't be built says why, and others leave notes, none of
+// which are of any interest here.  Output is only silenced, and never lost,
+// as the saved descriptors are restored afterwards.
+static	void	quiet(bool silent) {
+	static	int	saved_out = -1, saved_err = -1;
+
+	fflush(stdout);
+	fflush(stderr);
+	if ((silent)&&(saved_out < 0)) {
+		int	null = open("/dev/null", O_WRONLY);
+
+		if (null < 0)
+			return;
+		saved_out = dup(STDOUT_FILENO);
+		saved_err = dup(STDERR_FILENO);
+		dup2(null, STDOUT_FILENO);
+		dup2(null, STDERR_FILENO);
+		close(null);
+	} else if ((!silent)&&(saved_out >= 0)) {
+		dup2(saved_out, STDOUT_FILENO);
+		dup2(saved_err, STDERR_FILENO);
+		close(saved_out);
+		close(saved_err);
+		saved_out = saved_err = -1;
+	}
+}
+// }}}
+
+// explore
+// {{{
+int	explore(const EXPLORE &cfg) {
+	std::vector<CANDIDATE>	cands, frontier;
+	std::vector<int>	nlist, clist, xlist;
+	std::vector<std::pair<int,int> >	clocks; // nlanes, ckpce
+	int		lgsize, nfailed = 0;
+
+	if ((cfg.m_fftsize < 2)||(nextlg(cfg.m_fftsize) != cfg.m_fftsize)) {
+		fprintf(stderr, "ERR: --explore requires an FFT size, -f, which is a power of two\n");
+		return EXIT_FAILURE;
+	} lgsize = lgval(cfg.m_fftsize);
+
+	// Clocks per sample, and samples per clock
+	// {{{
+	if (cfg.m_nlanes > 0) {
+		clocks.push_back(std::make_pair(cfg.m_nlanes,
+			(cfg.m_ckpce > 0) ? cfg.m_ckpce : 1));
+	} else {
+		// Clocks available per sample, assuming one sample per clock
+		// if we haven't been told otherwise.  A real FFT takes two
+		// (real) samples each clock a complex one would take one.
+		const bool	single_only = fftgen_single_only(cfg.m_base);
+		double	ratio = 1.0;
+
+		if ((cfg.m_fs > 0.0)&&(cfg.m_fclk > 0.0))
+			ratio = ((cfg.m_base.m_real) ? 2.0 : 1.0)
+					* cfg.m_fclk / cfg.m_fs;
+
+		if (ratio >= 1.0) {
+			for(int k=1; k<=3 && k <= ratio; k++)
+				clocks.push_back(std::make_pair(1, k));
+			if (!single_only)
+				clocks.push_back(std::make_pair(2, 1));
+		} else if (!single_only) {
+			// We'll need several samples per clock
+			for(int lanes=2; lanes <= 8; lanes *= 2) {
+				if ((lanes > 2)&&(cfg.m_fftsize < lanes*lanes))
+					break;
+				if (lanes * ratio >= 1.0) {
+					clocks.push_back(std::make_pair(lanes, 1));
+					break;
+				}
+			}
+		}
+
+		if (clocks.size() == 0) {
+			fprintf(stderr, "ERR: No %d point FFT can keep up with %.3g samples per second\n"
+				"at a clock rate of %.3g Hz\n",
+				cfg.m_fftsize, cfg.m_fs, cfg.m_fclk);
+			return EXIT_FAILURE;
+		}
+	}
+	// }}}
+
+	// Input widths
+	// {{{
+	if (cfg.m_nbitsin > 0)
+		nlist.push_back(cfg.m_nbitsin);
+	else if (cfg.m_sqnr > 0.0) {
+		// Start from the narrowest input that can offer this SQNR
+		int	n0 = 2;
+
+		while((n0 < 48)&&(input_sqnr(n0) < cfg.m_sqnr))
+			n0++;
+		for(int n=n0; n<n0+4 && n <= 48; n++)
+			nlist.push_back(n);
+	} else
+		nlist.push_back(DEF_NBITSIN);
+	// }}}
+
+	// Extra coefficient and internal bits
+	// {{{
+	if (cfg.m_xtracbits >= 0)
+		clist.push_back(cfg.m_xtracbits);
+	else for(int c=0; c<=DEF_XTRACBITS; c++)
+		clist.push_back(c);
+
+	if (cfg.m_xtrapbits >= 0)
+		xlist.push_back(cfg.m_xtrapbits);
+	else for(int x=0; x<=2; x++)
+		xlist.push_back(x);
+	// }}}
+
+	// Build every candidate
+	// {{{
+	for(unsigned ck=0; ck<clocks.size(); ck++)
+	for(unsigned ni=0; ni<nlist.size(); ni++)
+	for(unsigned ci=0; ci<clist.size(); ci++)
+	for(unsigned xi=0; xi<xlist.size(); xi++) {
+		const int	nlanes = clocks[ck].first,
+				ckpce  = clocks[ck].second,
+				nbits  = nlist[ni];
+		std::vector<int>	mlist, plist;
+		int	mpys;
+
+		// Maximum widths: unlimited, or one or two bits short of
+		// the natural output width
+		if (cfg.m_maxbitsout > 0)
+			mlist.push_back(cfg.m_maxbitsout);
+		else {
+			const int	natural = nbits + 1 + lgsize/2;
+
+			mlist.push_back(-1);
+			for(int m=natural-1; m >= natural-2 && m > nbits+1; m--)
+				mlist.push_back(m);
+		}
+
+		// Hardware multiplies, a stage at a time
+		mpys = (nlanes > 1) ? 3*nlanes : bfly_mpys(ckpce);
+		if (cfg.m_nummpy >= 0)
+			plist.push_back(cfg.m_nummpy);
+		else for(int s=0; s<lgsize; s++)
+			plist.push_back(s * mpys);
+
+		for(unsigned mi=0; mi<mlist.size(); mi++)
+		for(unsigned pi=0; pi<plist.size(); pi++) {
+			CANDIDATE	cnd;
+			char		opts[128];
+			FFTGEN_CONFIG	build;
+			STAGEEST	total;
+			int		r;
+
+			if (nlanes > 1)
+				sprintf(opts, "-%d", nlanes);
+			else
+				sprintf(opts, "-1 -k %d", ckpce);
+			sprintf(opts + strlen(opts), " -n %d -c %d -x %d",
+				nbits, clist[ci], xlist[xi]);
+			if (mlist[mi] > 0)
+				sprintf(opts + strlen(opts), " -m %d",
+					mlist[mi]);
+			sprintf(opts + strlen(opts), " -p %d", plist[pi]);
+			cnd.m_opts = opts;
+
+			if (cfg.m_verbose)
+				printf("Trying %s\n", cnd.m_opts.c_str());
+
+			// Built in memory, and then thrown away, leaving
+			// only the estimates
+			build = cfg.m_base;
+			build.m_fftsize    = cfg.m_fftsize;
+			build.m_nlanes     = nlanes;
+			build.m_ckpce      = (nlanes > 1) ? 0 : ckpce;
+			build.m_nbitsin    = nbits;
+			build.m_xtracbits  = clist[ci];
+			build.m_xtrapbits  = xlist[xi];
+			build.m_maxbitsout = mlist[mi];
+			build.m_nummpy     = plist[pi];
+			build.m_verbose    = false;
+			build.m_estimate   = false;
+			build.m_hdrname    = "";
+
+			quiet(true);
+			r = fftgen_estimate(build, total);
+			quiet(false);
+			if (r != EXIT_SUCCESS) {
+				nfailed++;
+				continue;
+			}
+
+			cnd.m_dsps    = total.m_dsps;
+			cnd.m_luts    = total.m_luts;
+			cnd.m_latency = total.m_latency;
+			cnd.m_mem     = total.m_imem + total.m_omem
+					+ total.m_cmem;
+			// Compared only to the tenth of a dB it's reported
+			// in, lest a costlier candidate survive on the
+			// strength of a difference no one can see
+			cnd.m_sqnr    = round(10.0 * est_sqnr(total)) / 10.0;
+
+			if (cnd.m_sqnr >= cfg.m_sqnr)
+				cands.push_back(cnd);
+		}
+	}
+	// }}}
+
+	// Find the Pareto frontier
+	// {{{
+	// Of any identical candidates, only the first is kept
+	const bool	use_sqnr = (cfg.m_sqnr <= 0.0);
+	for(unsigned k=0; k<cands.size(); k++) {
+		bool	dominated = false;
+
+		for(unsigned j=0; j<cands.size() && !dominated; j++) {
+			if ((j == k)||(!dominates(cands[j], cands[k], use_sqnr)))
+				continue;
+			if (dominates(cands[k], cands[j], use_sqnr))
+				dominated = (j < k);
+			else
+				dominated = true;
+		}
+
+		if (!dominated)
+			frontier.push_back(cands[k]);
+	}
+
+	std::sort(frontier.begin(), frontier.end(), cheaper);
+	// }}}
+
+	// Report
+	// {{{
+	printf("Explored %d point FFTs", cfg.m_fftsize);
+	if (cfg.m_sqnr > 0.0)
+		printf(" with an SQNR of at least %.1f dB", cfg.m_sqnr);
+	printf("\n%d candidates met this SQNR", (int)cands.size());
+	if (nfailed > 0)
+		printf(", %d others could not be built", nfailed);
+	printf(".  The best of these are:\n\n");
+
+	printf("%5s %8s %9s %8s %6s  %s\n",
+		"DSPs", "MPY-LUTs", "Mem-bits", "Latency", "SQNR", "Options");
+	for(unsigned k=0; k<frontier.size(); k++)
+		printf("%5d %8d %9ld %8d %6.1f  %s\n",
+			frontier[k].m_dsps, frontier[k].m_luts,
+			frontier[k].m_mem, frontier[k].m_latency,
+			frontier[k].m_sqnr, frontier[k].m_opts.c_str());
+	printf("\nLatency is measured in i_ce's, SQNR in dB\n");
+	// }}}
+
+	return (frontier.size() > 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+// }}}
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	explore.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Searches the space of fftgen options for those FFTs which
+//		meet a given throughput and SQNR, and reports the ones that
+//	are the cheapest to build.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	EXPLORE_H
+#define	EXPLORE_H
+
+#include <string>
+
+#include "libfftgen.h"
+
+// EXPLORE -- what the user asked us to explore
+// {{{
+typedef	struct	EXPLORE_S {
+	int		m_fftsize;
+	// Sample and clock rates, and the minimum SQNR (in dB), or zero if
+	// not given
+	double		m_fs, m_fclk, m_sqnr;
+	// Options the user has given, fixing them, or -1 to explore them
+	int		m_nbitsin, m_xtracbits, m_xtrapbits, m_maxbitsout,
+			m_nummpy, m_nlanes, m_ckpce;
+	// Every other option, to be passed as is to every candidate
+	FFTGEN_CONFIG	m_base;
+	bool		m_verbose;
+} EXPLORE;
+// }}}
+
+extern	double	explore_rate(const char *str);
+extern	int	explore(const EXPLORE &cfg);
+
+#endif	// EXPLORE_H
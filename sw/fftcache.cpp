@@ -0,0 +1,310 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftcache.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A cache of generated cores.  Each entry is a directory, named
+//		by the key of the core it holds, containing every file of
+//	that core, any header (-a) as "header", and a MANIFEST listing them.
+//	The MANIFEST is written last, so an entry without one is incomplete
+//	and ignored.  Entries are built under a temporary name, and then
+//	renamed into place, so two fftgen's building the same core at once
+//	won't trip over each other.
+//
+//	Cores are linked out of the cache where possible, so that they keep
+//	the timestamps of the cached copy.  fftsink_open removes any file
+//	before rewriting it, so regenerating a core never writes through
+//	such a link into the cache.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+// {{{
+#include <io.h>
+#include <direct.h>
+#include <process.h>
+#define	mkdir(A,B)	_mkdir(A)
+#define	getpid		_getpid
+#define	unlink		_unlink
+#define	rmdir		_rmdir
+// }}}
+#elif defined(__MINGW32__)
+// {{{
+#include <direct.h>
+#include <unistd.h>
+#define	mkdir(A,B)	_mkdir(A)
+// }}}
+#else
+// {{{
+#include <unistd.h>
+#include <sys/stat.h>
+// }}}
+#endif
+
+#include <string>
+#include <vector>
+
+#include "defaults.h"
+#include "libfftgen.h"
+#include "fftcache.h"
+
+// fftcache_key -- the cache key of a core
+// {{{
+// A 64-bit FNV-1a hash, of FFTGEN_SRCHASH followed by the options of the
+// core, as fftgen_args() lists them once made canonical.  Options are so
+// listed in a fixed order, so command lines differing only in their order,
+// in the path to fftgen, or in options that don't change the files built
+// (-v), all share one entry.  These are also the options fftmain.v quotes.
+std::string	fftcache_key(const FFTGEN_CONFIG &cfg) {
+	const unsigned long long	FNV_PRIME = 0x100000001b3ull;
+	unsigned long long	h = 0xcbf29ce484222325ull;
+	std::vector<std::string>	args;
+	std::string	str = FFTGEN_SRCHASH;
+	char		buf[32];
+
+	// Skip the program name
+	args = fftgen_args(fftgen_canonical(cfg));
+	for(unsigned k=1; k<args.size(); k++)
+		str += "\n" + args[k];
+
+	for(unsigned k=0; k<str.size(); k++) {
+		h ^= (unsigned char)str[k];
+		h *= FNV_PRIME;
+	}
+
+	sprintf(buf, "%016llx", h);
+	return std::string(buf);
+}
+// }}}
+
+// copy_file -- copies src to dst, returning true on success
+// {{{
+// Anything short of a complete copy, such as a src that can't be read in
+// full (a directory, say), is a failure.
+static	bool	copy_file(const std::string &src, const std::string &dst) {
+	FILE	*fin, *fout;
+	char	buf[16384];
+	size_t	ln;
+	bool	ok = true;
+
+	fin = fopen(src.c_str(), "rb");
+	if (NULL == fin)
+		return false;
+	unlink(dst.c_str());
+	fout = fopen(dst.c_str(), "wb");
+	if (NULL == fout) {
+		fclose(fin);
+		return false;
+	}
+
+	while((ln = fread(buf, 1, sizeof(buf), fin)) > 0)
+		if (fwrite(buf, 1, ln, fout) != ln) {
+			ok = false;
+			break;
+		}
+
+	if (ferror(fin))
+		ok = false;
+	fclose(fin);
+	if (fclose(fout) != 0)
+		ok = false;
+	return ok;
+}
+// }}}
+
+// same_file -- true if a and b both exist, with the same contents
+// {{{
+static	bool	same_file(const std::string &a, const std::string &b) {
+	FILE	*fa, *fb;
+	char	bufa[16384], bufb[16384];
+	size_t	lna, lnb;
+	bool	same = true;
+
+	if (NULL == (fa = fopen(a.c_str(), "rb")))
+		return false;
+	if (NULL == (fb = fopen(b.c_str(), "rb"))) {
+		fclose(fa);
+		return false;
+	}
+
+	do {
+		lna = fread(bufa, 1, sizeof(bufa), fa);
+		lnb = fread(bufb, 1, sizeof(bufb), fb);
+		if ((lna != lnb)||(memcmp(bufa, bufb, lna) != 0))
+			same = false;
+	} while((same)&&(lna > 0));
+
+	fclose(fa);
+	fclose(fb);
+	return same;
+}
+// }}}
+
+// link_file -- links (or, failing that, copies) src to dst
+// {{{
+// A dst that already matches src is left alone, keeping its timestamp.
+static	bool	link_file(const std::string &src, const std::string &dst) {
+	if (same_file(src, dst))
+		return true;
+#ifndef	_WIN32
+	unlink(dst.c_str());
+	if (link(src.c_str(), dst.c_str()) == 0)
+		return true;
+	// Otherwise, perhaps the cache is on another file system
+#endif
+	return copy_file(src, dst);
+}
+// }}}
+
+// fftcache_fetch -- materialize a core from the cache
+// {{{
+// Returns true if the core was found, and placed into coredir (and hdrname,
+// if one is given).  On false, the core needs to be built.
+bool	fftcache_fetch(const std::string &cachedir, const std::string &key,
+		const std::string &coredir, const std::string &hdrname) {
+	const std::string	entry = cachedir + "/" + key;
+	std::vector<std::string>	names;
+	bool	has_header = false;
+	char	line[512];
+	FILE	*fp;
+
+	fp = fopen((entry + "/MANIFEST").c_str(), "r");
+	if (NULL == fp)
+		return false;
+	while(fgets(line, sizeof(line), fp)) {
+		char	*nl = strchr(line, '\n');
+
+		if (nl)
+			*nl = '\0';
+		if (strcmp(line, "h") == 0)
+			has_header = true;
+		else if ((line[0] == 'c')&&(line[1] == ' ')&&(line[2]))
+			names.push_back(std::string(line+2));
+	} fclose(fp);
+
+	// An entry built without a header can't supply one
+	if ((hdrname.size() > 0)&&(!has_header))
+		return false;
+
+	for(unsigned k=0; k<names.size(); k++)
+		if (!link_file(entry + "/" + names[k], coredir + "/" + names[k]))
+			return false;
+	if ((hdrname.size() > 0)
+			&&(!link_file(entry + "/header", hdrname)))
+		return false;
+
+	return true;
+}
+// }}}
+
+// fftcache_store -- copy a newly built core into the cache
+// {{{
+// files is the list of every file built, as given by fftsink_files.  Only
+// cores whose every file is either within coredir, or the header, can be
+// cached.  Returns true if the core is now in the cache.
+bool	fftcache_store(const std::string &cachedir, const std::string &key,
+		const std::string &coredir, const std::string &hdrname,
+		const std::vector<std::string> &files) {
+	const std::string	entry = cachedir + "/" + key,
+				tmpdir = entry + "." + std::to_string(getpid());
+	const std::string	prefix = coredir + "/";
+	std::vector<std::string>	names;
+	bool	has_header = false, ok = true;
+	FILE	*fp;
+
+	// What goes where
+	// {{{
+	for(unsigned k=0; k<files.size(); k++) {
+		const std::string	&f = files[k];
+		std::string		name;
+		bool			dup = false;
+
+		if ((hdrname.size() > 0)&&(f == hdrname)) {
+			has_header = true;
+			continue;
+		} else if ((f.compare(0, prefix.size(), prefix) != 0)
+				|| (f.find('/', prefix.size())
+						!= std::string::npos))
+			// Not one of ours
+			return false;
+
+		name = f.substr(prefix.size());
+		for(unsigned j=0; j<names.size(); j++)
+			if (names[j] == name)
+				dup = true;
+		if (!dup)
+			names.push_back(name);
+	}
+	// }}}
+
+	mkdir(cachedir.c_str(), 0755);
+	if (mkdir(tmpdir.c_str(), 0755) != 0)
+		return false;
+
+	// Copy the files, rather than linking them, so that later changes
+	// to the core can't reach the cache
+	for(unsigned k=0; (ok)&&(k<names.size()); k++)
+		ok = copy_file(prefix + names[k], tmpdir + "/" + names[k]);
+	if ((ok)&&(has_header))
+		ok = copy_file(hdrname, tmpdir + "/header");
+
+	// The MANIFEST goes last, marking the entry as complete
+	// {{{
+	if ((ok)&&(NULL != (fp = fopen((tmpdir + "/MANIFEST").c_str(), "w")))) {
+		for(unsigned k=0; k<names.size(); k++)
+			fprintf(fp, "c %s\n", names[k].c_str());
+		if (has_header)
+			fprintf(fp, "h\n");
+		if (fclose(fp) != 0)
+			ok = false;
+	} else
+		ok = false;
+	// }}}
+
+	// If someone else has already placed this core into the cache, the
+	// rename will fail, and our copy is simply thrown away
+	if ((ok)&&(rename(tmpdir.c_str(), entry.c_str()) == 0))
+		return true;
+
+	for(unsigned k=0; k<names.size(); k++)
+		unlink((tmpdir + "/" + names[k]).c_str());
+	unlink((tmpdir + "/header").c_str());
+	unlink((tmpdir + "/MANIFEST").c_str());
+	rmdir(tmpdir.c_str());
+	return false;
+}
+// }}}
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftcache.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A cache of generated cores (--cache).  Each core is kept
+//		under a hash of the command line that built it, and of the
+//	build of fftgen that built it.  Asking for the same core again then
+//	just links (or copies) it back out of the cache.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	FFTCACHE_H
+#define	FFTCACHE_H
+
+#include <string>
+#include <vector>
+
+#include "libfftgen.h"
+
+extern	std::string	fftcache_key(const FFTGEN_CONFIG &cfg);
+extern	bool	fftcache_fetch(const std::string &cachedir,
+			const std::string &key, const std::string &coredir,
+			const std::string &hdrname);
+extern	bool	fftcache_store(const std::string &cachedir,
+			const std::string &key, const std::string &coredir,
+			const std::string &hdrname,
+			const std::vector<std::string> &files);
+
+#endif	// FFTCACHE_H
@@ -87,6 +87,7 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 // {{{
 #include <direct.h>	// mkdir
 #include <unistd.h>
+#include <getopt.h>
 #include <sys/stat.h>
 
 #define	mkdir(A,B)	_mkdir(A)
@@ -96,6 +97,7 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 // And for G++/Linux environment
 // {{{
 #include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <getopt.h>
 #include <sys/stat.h>
 // }}}
 #endif
@@ -108,21 +110,29 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 
 #include "defaults.h"
 #include "legal.h"
+#include "fftsink.h"
 #include "rounding.h"
 #include "fftlib.h"
 #include "bldstage.h"
 #include "bitreverse.h"
 #include "softmpy.h"
 #include "butterfly.h"
+#include "constraints.h"
+#include "estimate.h"
+#include "mpyalloc.h"
+#include "dspmpy.h"
+#include "explore.h"
+#include "fftcache.h"
+#include "libfftgen.h"
 
 // build_dblquarters
 // {{{
-void	build_dblquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false) {
-	FILE	*fp = fopen(fname, "w");
+int	build_dblquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 	const	char	*rnd_string;
 	if (rounding == RND_TRUNCATE)
@@ -391,17 +401,18 @@ SLASHLINE
 	fprintf(fp, "\n\tend endgenerate\n\n");
 
 	fprintf(fp, "endmodule\n");
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_snglquarters
 // {{{
-void	build_snglquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false) {
-	FILE	*fp = fopen(fname, "w");
+int	build_snglquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 	const	char	*rnd_string;
 	if (rounding == RND_TRUNCATE)
@@ -813,17 +824,18 @@ SLASHLINE
 	}
 
 	fprintf(fp, "endmodule\n");
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_sngllast
 // {{{
-void	build_sngllast(const char *fname, const bool async_reset = false) {
-	FILE	*fp = fopen(fname, "w");
+int	build_sngllast(const char *fname, const bool async_reset = false) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	std::string	resetw("i_reset");
@@ -1084,7 +1096,7 @@ SLASHLINE );
 "// }}}\n"
 "endmodule\n");
 
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
 
@@ -1093,12 +1105,28 @@ SLASHLINE );
 void	usage(void) {
 	fprintf(stderr,
 "USAGE:\tfftgen [-f <size>] [-d dir] [-c cbits] [-n nbits] [-m mxbits] [-s]\n"
+"\tfftgen --explore -f <size> [--fs <rate>] [--fclk <rate>] [--sqnr <dB>]\n"
+"\tfftgen -f <size> --fs <rate> --fclk <rate> [-p nmpy] [-v]\n"
 // "\tfftgen -i\n"
 "\t-1\tBuild a normal FFT, running at one clock per complex sample, or\n"
 "\t\t(for a real FFT) at one clock per two real input samples.\n"
+"\t-4, -8\tBuild an FFT that accepts four (or eight) complex samples per\n"
+"\t\tclock, all packed into one i_sample input.  The FFT size must be\n"
+"\t\tat least the square of the number of samples per clock.\n"
 "\t-A\t(Experimental) Use a negative edged asynchronous reset.\n"
+"\t-B\tBuild a block floating point FFT.  Rather than growing by a bit\n"
+"\t\tevery other stage, the data stays at the input width, and\n"
+"\t\tframes are only halved by those stages where the frame before\n"
+"\t\tneeded it.  The number of halvings is then output as\n"
+"\t\to_exponent.  (Radix-2, complex, single clock (opt -1) FFTs\n"
+"\t\tonly.)\n"
 "\t-a <hdrname>  Create a header of information describing the built-in\n"
 "\t\tparameters, useful for module-level testing with Verilator\n"
+"\t-C\tShare twiddle factor ROMs between stages.  Each ROM holds the\n"
+"\t\ttable of the largest of the two (or, with -k 3, four) stages\n"
+"\t\tit serves, which the smaller stages read at a stride.  This\n"
+"\t\tcuts the total twiddle memory from about N to about 2N/3 (N/2\n"
+"\t\twith -k 3) coefficients.  (Single clock (opt -1) FFTs only.)\n"
 "\t-c <cbits>\tCauses all internal complex coefficients to be\n"
 "\t\tlonger than the corresponding data bits, to help avoid\n"
 "\t\tcoefficient truncation errors.  The default is %d bits longer\n"
@@ -1106,14 +1134,26 @@ void	usage(void) {
 "\t-d <dir>  Places all of the generated verilog files into <dir>.\n"
 "\t\tThe default is a subdirectory of the current directory\n"
 "\t\tnamed %s.\n"
+"\t-E\tReport the estimated cost of each stage: hardware multiplies\n"
+"\t\t(DSPs), LUTs used by shift-add multiplies, memory bits, and the\n"
+"\t\t(exact) latency in i_ce's.  The totals are also placed into the\n"
+"\t\theader file given by -a.\n"
 "\t-f <size>  Sets the size of the FFT as the number of complex\n"
 "\t\tsamples input to the transform.  (No default value, this is\n"
 "\t\ta required parameter.)\n"
+"\t-g <n>\tGenerate the twiddle factors of the first <n> stages on the\n"
+"\t\tfly, rather than reading them from a ROM.  Each is built from\n"
+"\t\tthe product of two tables of about sqrt(N) entries, at a cost\n"
+"\t\tof four multiplies per stage.  The twiddle error of both paths\n"
+"\t\tis reported with -v or -E.  Stages of fewer than 32 points\n"
+"\t\tkeep their ROMs.  (Single clock (opt -1) FFTs only.)\n"
 "\t-i\tAn inverse FFT, meaning that the coefficients are\n"
 "\t\tgiven by e^{ j 2 pi k/N n }.  The default is a forward FFT, with\n"
 "\t\tcoefficients given by e^{ -j 2 pi k/N n }.\n"
 "\t-k #\tSets # clocks per sample, used to minimize multiplies.  Also\n"
 "\t\tsets one sample in per i_ce clock (opt -1)\n"
+"\t\tFor # > 1, fftmain.xdc and fftmain.sdc are also written, declaring\n"
+"\t\tthe multicycle paths this allows for Vivado and Quartus.\n"
 "\t-m <mxbits>\tSets the maximum bit width that the FFT should ever\n"
 "\t\tproduce.  Internal values greater than this value will be\n"
 "\t\ttruncated to this value.  (The default value grows the input\n"
@@ -1123,22 +1163,103 @@ void	usage(void) {
 "\t\tcomplex values into the FFT.\n"
 "\t-p <nmpy>  Sets the number of hardware multiplies (DSPs) to use, versus\n"
 "\t\tshift-add emulation.  The default is not to use any hardware\n"
-"\t\tmultipliers.\n"
-"\t-r\tBuild a real-FFT at four input points per sample, rather than a\n"
-"\t\tcomplex FFT.  (Default is a Complex FFT.)\n"
-"\t\tThis option is a place-holder.  The real-FFT has not (yet) been\n"
-"\t\timplemented.\n"
+"\t\tmultipliers.  They go to those stages saving the most LUTs.\n"
+"\t-q\tStore only a quarter wave of each stage\'s twiddle factors, and\n"
+"\t\trebuild the rest within the stage.  This uses a quarter of the\n"
+"\t\tcoefficient memory.  (Single clock (opt -1) FFTs only.)\n"
+"\t-r\tBuild a real-FFT at two real input points per sample, rather\n"
+"\t\tthan a complex FFT.  (Default is a Complex FFT.)  The real FFT\n"
+"\t\tproduces the N/2+1 unique outputs, in natural order, with X[0]\n"
+"\t\tand X[N/2] packed together into the first output.  Forward,\n"
+"\t\tsingle clock (opt -1) FFTs only.\n"
+"\t-R <2|22|23>  Selects the FFT architecture.  -R 2, the default,\n"
+"\t\tbuilds a radix-2 FFT with one (multiplying) butterfly per stage.\n"
+"\t\t-R 22 builds a radix-2^2 FFT, where pairs of multiplier free stages\n"
+"\t\tare followed by a single twiddle multiply, using half the\n"
+"\t\tmultiplies.  -R 23 builds a radix-2^3 FFT, grouping stages in\n"
+"\t\tthrees, with constant multiplies between the second and third,\n"
+"\t\tand so needs only a third of the twiddle multiplies.\n"
+"\t\t(Single clock FFTs, opt -1, only.)\n"
 "\t-s\tSkip the final bit reversal stage.  This is useful in\n"
 "\t\talgorithms that need to apply a filter without needing to do\n"
 "\t\tbin shifting, as these algorithms can, with this option, just\n"
 "\t\tmultiply by a bit reversed correlation sequence and then\n"
 "\t\tinverse FFT the (still bit reversed) result.  (You would need\n"
-"\t\ta decimation in time inverse to do this, which this program does\n"
-"\t\tnot yet provide.)\n"
+"\t\ta decimation in time inverse to do this, see opt -t.)\n"
 "\t-S\tInclude the final bit reversal stage (default).\n"
+"\t-t\tBuild a decimation in time FFT, accepting its inputs in bit\n"
+"\t\treversed order and producing its outputs in natural order.  No\n"
+"\t\tbit reversal stage is needed.  An inverse FFT built this way\n"
+"\t\t(opts -i -t) can directly follow a forward FFT built with -s.\n"
+"\t\t(Radix-2, complex, single clock (opt -1) FFTs only.)\n"
+"\t-v\tVerbose.  Report the widths chosen, and which files changed.\n"
+"\t\tFiles that haven\'t changed are never rewritten.\n"
+"\t\tAlso reports the time taken to generate the coefficient files.\n"
 "\t-x <xtrabits>\tUse this many extra bits internally, before any final\n"
 "\t\trounding or truncation of the answer to the final number of\n"
-"\t\tbits.  The default is to use %d extra bits internally.\n",
+"\t\tbits.  The default is to use %d extra bits internally.\n"
+"\t-z\tBuild a variable size FFT.  The FFT size given by -f becomes\n"
+"\t\tthe maximum size, and an i_lgsize input selects (on reset) any\n"
+"\t\tpower of two size from 16 up to this maximum.  (Radix-2, complex,\n"
+"\t\tsingle clock (opt -1) FFTs only.)\n"
+"\t--explore  Rather than building a core, search for the cheapest FFTs\n"
+"\t\tof the given size that keep up with --fs samples per second\n"
+"\t\tat a --fclk clock rate (rates may end in k, M, or G), and have an\n"
+"\t\t(estimated) SQNR of at least --sqnr dB.  Any of -n, -c, -x, -m,\n"
+"\t\t-p, -k, -1, -2, -4, or -8 that are given are held fixed, the rest\n"
+"\t\tare explored.  All other options are passed on as given.  The\n"
+"\t\tFFTs which no other FFT beats in DSPs, LUTs, memory, and SQNR\n"
+"\t\tare then listed.\n"
+"\t--fs <rate> --fclk <rate>  Without --explore, plan the core for this\n"
+"\t\tsample rate and clock rate.  The most clocks per sample (-k)\n"
+"\t\tthat keep up, or else the fewest samples per clock (-2, -4, -8),\n"
+"\t\tare chosen, as these need the fewest multiplies.  A -k, -1, -2,\n"
+"\t\t-4, or -8 given is checked instead.  -v explains the choice.\n"
+"\t--cache <dir>  Keep every core built in <dir>, under a hash of its\n"
+"\t\toptions (in any order) and of this version of fftgen.  Asking\n"
+"\t\tfor the same core again then hard links (or copies) it from\n"
+"\t\t<dir>, rather than building it.  Builds with -E always build\n"
+"\t\tthe core.\n"
+"\t--dsp <a>x<b>  The size of the multiply one DSP can do, such as 18x25.\n"
+"\t\tEach hardware multiply then counts against -p as the number of\n"
+"\t\tDSPs needed to tile it, rather than as one.  With -k 1, these\n"
+"\t\tmultiplies are tiled and pipelined explicitly, in dspmpy.v.\n"
+"\t--hwmpy <list>  Give hardware multiplies to the stages listed, and to no\n"
+"\t\tothers, in place of -p.  Stages are named as -E or -v name them,\n"
+"\t\twith or without their stage_ prefix, and separated by commas,\n"
+"\t\tas in --hwmpy 1024,128,revstage.  --hwmpy none uses no DSPs.\n"
+"\t--softmpy <mpy>  How multiplies without a DSP are built:\n"
+"\t\tbimpy\tas a shift-add tableau of two bit by N bit products,\n"
+"\t\t\tthe longbimpy (default)\n"
+"\t\tbooth\tas a radix-4 Booth encoded shift-add, the boothmpy,\n"
+"\t\t\ttaking fewer LUTs and two fewer clocks\n"
+"\t--mpyrows <n>  Add n rows of the longbimpy's tableau between registers,\n"
+"\t\trather than one.  The multiply then takes fewer clocks, at a\n"
+"\t\tlower clock speed.  Ignored by --softmpy booth.\n"
+"\t--mpyoutregs <n>  Follow the longbimpy's final accumulate with n more\n"
+"\t\tregisters, for a faster clock.  Ignored by --softmpy booth.\n"
+"\t--twidbypass  Detect twiddle factors of +/-1 and +/-j within each soft\n"
+"\t\tbutterfly, and route those differences around its multiply,\n"
+"\t\tholding the multiply's inputs to save power.  Costs a second\n"
+"\t\tdelay FIFO in each soft butterfly.  Hardware butterflies (-p)\n"
+"\t\tare left alone, as their DSPs draw little of the power.\n"
+"\t--no-w8stage  Build the eight point stage of a single clock, decimation\n"
+"\t\tin frequency FFT as a multiplying fftstage, rather than as a\n"
+"\t\tw8stage from constant multiplies by 1/sqrt(2).  Both produce\n"
+"\t\tthe same outputs.  (Ignored by -R 23.)\n"
+"\t--cmpy <n>  How a hardware butterfly at -k 1 forms its complex product:\n"
+"\t\t3\tfrom three multiplies, the third a bit wider on each side\n"
+"\t\t\tand fed by pre-adders\n"
+"\t\t4\tfrom four multiplies, with no pre-adders\n"
+"\t\tauto\tfrom four wherever, given --dsp, the wider multiply takes\n"
+"\t\t\tat least twice the DSPs of the others, else three (default)\n"
+"\t--cmem <fmt>  How the twiddle factor tables are delivered to the RTL:\n"
+"\t\thex\tas hex files, read by $readmemh (default)\n"
+"\t\tmif\tas hex files, plus a Quartus MIF file for each\n"
+"\t\tcoe\tas hex files, plus a Vivado COE file for each\n"
+"\t\trom\tcompiled into the RTL, from coefrom.vh, with no hex\n"
+"\t\t\tfiles to read at elaboration.  The core directory must\n"
+"\t\t\tthen be on the include path.\n",
 /*
 "\t-0\tA forward FFT (default), meaning that the coefficients are\n"
 "\t\tgiven by e^{-j 2 pi k/N n }.\n"
@@ -1151,89 +1272,453 @@ void	usage(void) {
 
 // Features still needed:
 //	Interactivity.
-int main(int argc, char **argv) {
-	int	fftsize = -1, lgsize = -1;
-	int	nbitsin = DEF_NBITSIN, xtracbits = DEF_XTRACBITS,
-			nummpy=DEF_NMPY, nmpypstage=6, mpy_stages;
-	int	nbitsout, maxbitsout = -1, xtrapbits=DEF_XTRAPBITS, ckpce = 0;
-	const char *EMPTYSTR = "";
-	bool	bitreverse = true, inverse=false,
-		verbose_flag = false,
-		single_clock = true,
-		real_fft = false,
-		async_reset = false;
-	FILE	*vmain;
-	std::string	coredir = DEF_COREDIR, cmdline = "", hdrname = "";
-	ROUND_T	rounding = RND_CONVERGENT;
-	// ROUND_T	rounding = RND_HALFUP;
+// bfpscale_instance
+// {{{
+// Instantiates the block floating point scaling stage following the FFT
+// stage of the given span.  Its inputs come from that stage, w_s<span> and
+// w_d<span>, its outputs go to w_bs<span> and w_bd<span>, and the exponents
+// of the last four frames are passed down from one scaling stage to the
+// next in w_be<span>.  The first scaling stage, with no scaling stage
+// before it (prevspan == 0), starts from an exponent of zero.  The cost of
+// the new stage is added to est.
+static void	bfpscale_instance(FILE *vmain, FFTEST &est, int span,
+			int prevspan, int iwidth, int lgsize, int ewidth,
+			const std::string &resetw) {
+	char	iexp[32];
+
+	if (prevspan > 0)
+		sprintf(iexp, "w_be%d", prevspan);
+	else
+		sprintf(iexp, "%d\'h0", 4*ewidth);
 
-	bool	dbg = false;
-	int	dbgstage = 128;
+	fprintf(vmain, "\n");
+	fprintf(vmain, "\twire\t\tw_bs%d;\n", span);
+	fprintf(vmain, "\twire\t[%d:0]\tw_bd%d;\n", 2*(iwidth-1)-1, span);
+	fprintf(vmain, "\twire\t[%d:0]\tw_be%d;\n", 4*ewidth-1, span);
+	fprintf(vmain, "\tbfpscale\t#(\n"
+		"\t\t// {{{\n"
+		"\t\t.IWIDTH(%d),\n"
+		"\t\t.OWIDTH(%d),\n"
+		"\t\t.LGSIZE(%d),\n"
+		"\t\t.EWIDTH(%d)\n"
+		"\t\t// }}}\n"
+		"\t) bfp_%d(\n"
+		"\t\t// {{{\n"
+		"\t\t.i_clk(i_clk),\n"
+		"\t\t.%s(%s),\n"
+		"\t\t.i_ce(i_ce),\n"
+		"\t\t.i_sync(w_s%d),\n"
+		"\t\t.i_data(w_d%d),\n"
+		"\t\t.i_exp(%s),\n"
+		"\t\t.o_data(w_bd%d),\n"
+		"\t\t.o_sync(w_bs%d),\n"
+		"\t\t.o_exp(w_be%d)\n"
+		"\t\t// }}}\n"
+		"\t);\n",
+		iwidth, iwidth-1, lgsize, ewidth, span,
+		resetw.c_str(), resetw.c_str(),
+		span, span, iexp, span, span, span);
+
+	est_bfpscale(est, "bfp_"+std::to_string(span), span, iwidth);
+}
+// }}}
 
-	// Argument processing
-	// {{{
-	if (argc <= 1)
-		usage();
+// mpy_hwunit -- true if a multiplying stage was given hardware multiplies
+// {{{
+// Of the nunits multiplying stages in the plan, n counts back from the end of
+// the pipeline: n=1 is the last.  The real FFT's post-processing stage, if
+// any, follows them all in the plan, but isn't counted.
+static bool	mpy_hwunit(const MPYPLAN &plan, int nunits, int n) {
+	if ((n < 1)||(n > nunits))
+		return false;
+	return plan[nunits-n].m_hwmpy;
+}
+// }}}
 
-	// Copy the original command line before we mess with it
-	cmdline = argv[0];
-	for(int argn=1; argn<argc; argn++) {
-		cmdline += " ";
-		cmdline += argv[argn];
-	}
+// TWIDUSER -- an fftstage with no twiddle ROM of its own
+// {{{
+// Either one reading its twiddles from a shared twidrom (-C), or one
+// generating them (-g)
+// {{{
+typedef	struct	{
+	int	m_span, m_lgspan, m_cwidth;
+} TWIDUSER;
+// }}}
 
-	{ int c;
-	while((c = getopt(argc, argv, "12Aa:c:d:D:f:hik:m:n:p:rsSx:v")) != -1) {
-		switch(c) {
-		case '1':	single_clock = true;  break;
-		case '2':	single_clock = false; break;
-		case 'A':	async_reset  = true;  break;
-		case 'a':	hdrname = strdup(optarg);	break;
-		case 'c':	xtracbits = atoi(optarg);	break;
-		case 'd':	coredir = std::string(optarg);	break;
-		case 'D':	dbgstage = atoi(optarg);	break;
-		case 'f':	fftsize = atoi(optarg);	
-				{ int sln = strlen(optarg);
-				if (!isdigit(optarg[sln-1])){
-					switch(optarg[sln-1]) {
-					case 'k': case 'K':
-						fftsize <<= 10;
-						break;
-					case 'm': case 'M':
-						fftsize <<= 20;
-						break;
-					case 'g': case 'G':
-						fftsize <<= 30;
-						break;
-					default:
-						printf("ERR: Unknown FFT size, %s!\n", optarg);
-						exit(EXIT_FAILURE);
-					}
-				}} break;
-		case 'h':	usage(); exit(EXIT_SUCCESS);	break;
-		case 'i':	inverse = true;			break;
-		case 'k':	ckpce = atoi(optarg);
-				// After CKPCE=3, there's no advantage
-				// only bits lost, so keep CKPCE <=3 here
-				if (ckpce > 3)
-					ckpce = 3;
-				single_clock = true;
-				break;
-		case 'm':	maxbitsout = atoi(optarg);	break;
-		case 'n':	nbitsin = atoi(optarg);		break;
-		case 'p':	nummpy = atoi(optarg);		break;
-		case 'r':	real_fft = true;		break;
-		case 'S':	bitreverse = true;		break;
-		case 's':	bitreverse = false;		break;
-		case 'x':	xtrapbits = atoi(optarg);	break;
-		case 'v':	verbose_flag = true;		break;
-		// case 'z':	variable_size = true;		break;
-		default:
-			printf("Unknown argument, -%c\n", c);
-			usage();
-			exit(EXIT_FAILURE);
+// twidgen_tables
+// {{{
+// Writes the coarse and fine tables of an fftstage generating its own twiddle
+// factors (-g), and returns the names of both as the stage should find them.
+// The fine table gets the low half of the bits of each coefficient address,
+// the coarse table the rest.  The return value is the number of fine bits,
+// LGFINE.
+static int	twidgen_tables(const std::string &coredir, int span,
+			int lgspan, int cw, bool inverse,
+			std::string &cfile, std::string &ffile) {
+	const int	lgfine = lgspan / 2;
+	const char	*EMPTYSTR = "";
+	std::string	fname;
+	FILE		*cmemfp;
+
+	fname  = gen_twidgen_fname(coredir.c_str(), span, true, inverse);
+	cmemfp = gen_coeff_open(fname.c_str());
+	gen_stridecoeffs(cmemfp, span, cw+2, 1<<lgfine, 1<<(lgspan-lgfine),
+		inverse);
+
+	fname  = gen_twidgen_fname(coredir.c_str(), span, false, inverse);
+	cmemfp = gen_coeff_open(fname.c_str());
+	gen_stridecoeffs(cmemfp, span, cw+2, 1, 1<<lgfine, inverse);
+
+	cfile = gen_twidgen_fname(EMPTYSTR, span, true, inverse);
+	ffile = gen_twidgen_fname(EMPTYSTR, span, false, inverse);
+	return lgfine;
+}
+// }}}
+
+// twidrom_instances
+// {{{
+// Connects the fftstages of a shared twiddle ROM FFT (-C), given in order
+// from the largest span down, to their twidroms.  Each fftstage asks for
+// its coefficient on w_ca<span>, and gets it back on w_cc<span>.  A ROM
+// can be read twice per clock, and so serves two stages, or 2(CKPCE-1)
+// stages if each read port can take turns (CKPCE > 2).  Each group of
+// stages shares the table of its largest stage, exactly as that stage would
+// have had it.  Since coefficients only ever grow wider down the pipeline,
+// the other stages of the group just pad these with zeros.  (Their
+// coefficients are then no more precise than the first stage's, but this
+// is still well below the precision of the data.)  The cost of each ROM is
+// added to est.
+static void	twidrom_instances(FILE *vmain, FFTEST &est,
+			const std::string &coredir,
+			const std::vector<TWIDUSER> &stages,
+			int ckpce, bool inverse) {
+	const int	nslots = (ckpce > 2) ? ckpce-1 : 1;
+	const unsigned	ngroup = 2 * nslots;
+
+	for(unsigned g=0; g<stages.size(); g+=ngroup) {
+		const TWIDUSER	&lead = stages[g];
+		const int	tw = lead.m_cwidth;
+		unsigned	nstages = stages.size()-g;
+		std::string	cmem;
+		FILE		*cmemfp;
+
+		if (nstages > ngroup)
+			nstages = ngroup;
+
+		cmem = gen_coeff_fname(coredir.c_str(), lead.m_span, 1, 0, inverse);
+		cmemfp = gen_coeff_open(cmem.c_str());
+		gen_coeffs(cmemfp, lead.m_span, tw, 1, 0, inverse);
+		cmem = gen_coeff_fname("", lead.m_span, 1, 0, inverse);
+
+		fprintf(vmain, "\n\t// Twiddle factors for ");
+		for(unsigned k=0; k<nstages; k++)
+			fprintf(vmain, "%sstage_%d", (k == 0) ? ""
+				: (k+1 == nstages) ? " and " : ", ",
+				stages[g+k].m_span);
+		fprintf(vmain, "\n");
+		fprintf(vmain, "\twire\t[%d:0]\tw_ta%d;\n",
+			nstages * lead.m_lgspan-1, lead.m_span);
+		fprintf(vmain, "\twire\t[%d:0]\tw_tc%d;\n",
+			nstages * 2 * tw-1, lead.m_span);
+		fprintf(vmain, "\tassign\tw_ta%d = {", lead.m_span);
+		for(int k=nstages-1; k>=0; k--) {
+			const TWIDUSER	&st = stages[g+k];
+
+			if (st.m_lgspan < lead.m_lgspan)
+				fprintf(vmain, " { w_ca%d, %d\'h0 }%s", st.m_span,
+					lead.m_lgspan - st.m_lgspan,
+					(k > 0) ? ",":"");
+			else
+				fprintf(vmain, " w_ca%d%s", st.m_span,
+					(k > 0) ? ",":"");
+		} fprintf(vmain, " };\n");
+
+		for(unsigned k=0; k<nstages; k++) {
+			const TWIDUSER	&st = stages[g+k];
+			const int	base = k * 2 * tw, cw = st.m_cwidth;
+
+			if (cw == tw)
+				fprintf(vmain, "\tassign\tw_cc%d = w_tc%d[%d:%d];\n",
+					st.m_span, lead.m_span,
+					base+2*tw-1, base);
+			else
+				fprintf(vmain, "\tassign\tw_cc%d = {\n"
+					"\t\tw_tc%d[%d:%d], %d\'h0,\n"
+					"\t\tw_tc%d[%d:%d], %d\'h0 };\n",
+					st.m_span,
+					lead.m_span, base+2*tw-1, base+tw, cw-tw,
+					lead.m_span, base+tw-1, base, cw-tw);
 		}
-	}}
+
+		fprintf(vmain, "\ttwidrom\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.CWIDTH(%d),\n"
+			"\t\t.LGSPAN(%d),\n"
+			"\t\t.NSTAGES(%d),\n"
+			"\t\t.CKPCE(%d),\n"
+			"\t\t.COEFFILE(\"%s\")\n"
+			"\t\t// }}}\n"
+			"\t) twid_%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.i_ce(i_ce),\n"
+			"\t\t.i_addr(w_ta%d),\n"
+			"\t\t.o_coef(w_tc%d)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+			tw, lead.m_lgspan, nstages, ckpce, cmem.c_str(),
+			lead.m_span, lead.m_span, lead.m_span);
+
+		est_twidrom(est, "twid_"+std::to_string(lead.m_span),
+			lead.m_lgspan, tw);
+	}
+}
+// }}}
+
+// Option values
+// {{{
+// Each of these turns the text of one of FFTGEN_CONFIG's string options (or,
+// for opt_radix, its -R value) into what the build uses.  On an unknown value,
+// they say so on stderr and return false.
+static bool	opt_radix(int radix, int &r2group) {
+	switch(radix) {
+	case 2:		r2group = 1; return true;
+	case 22:	r2group = 2; return true;
+	case 23:	r2group = 3; return true;
+	default:
+		fprintf(stderr, "ERR: Unknown radix, -R %d\n", radix);
+		return false;
+	}
+}
+
+static bool	opt_cmem(const std::string &opt, CMEM_FORMAT &fmt) {
+	if ((opt.size() == 0)||(opt == "hex"))
+		fmt = CMEM_HEX;
+	else if (opt == "mif")
+		fmt = CMEM_MIF;
+	else if (opt == "coe")
+		fmt = CMEM_COE;
+	else if (opt == "rom")
+		fmt = CMEM_ROM;
+	else {
+		fprintf(stderr, "ERR: Unknown coefficient format, --cmem %s\n", opt.c_str());
+		return false;
+	} return true;
+}
+
+static bool	opt_dsp(const std::string &opt, int &aw, int &bw) {
+	aw = bw = 0;
+	if (opt.size() == 0)
+		return true;
+	if ((sscanf(opt.c_str(), "%dx%d", &aw, &bw) != 2)
+			||(aw < 2)||(bw < 2)) {
+		fprintf(stderr, "ERR: Unknown DSP size, --dsp %s\n", opt.c_str());
+		return false;
+	} return true;
+}
+
+static bool	opt_softmpy(const std::string &opt, bool &booth) {
+	if ((opt.size() == 0)||(opt == "bimpy"))
+		booth = false;
+	else if (opt == "booth")
+		booth = true;
+	else {
+		fprintf(stderr, "ERR: Unknown soft multiply, --softmpy %s\n", opt.c_str());
+		return false;
+	} return true;
+}
+
+static bool	opt_cmpy(const std::string &opt, int &cmpy) {
+	if ((opt.size() == 0)||(opt == "auto"))
+		cmpy = 0;
+	else if (opt == "3")
+		cmpy = 3;
+	else if (opt == "4")
+		cmpy = 4;
+	else {
+		fprintf(stderr, "ERR: Unknown complex multiply form, --cmpy %s\n", opt.c_str());
+		return false;
+	} return true;
+}
+// }}}
+
+// FFTCORE -- one FFT core, as it's being built
+// {{{
+// fftgen_core() builds a core in steps: checking its options, planning its
+// stages, building fftmain.v (its pipeline built by one of the pipe_*()
+// methods below, depending upon the architecture), the header, and then
+// every module.  Each step returns EXIT_SUCCESS or EXIT_FAILURE.  The members
+// hold everything more than one step needs.
+class	FFTCORE {
+public:
+	const FFTGEN_CONFIG	&cfg;
+	// The stage given debugging outputs, if dbg is set
+	int	dbgstage;
+
+	int	fftsize, lgsize, rfftsize;
+	int	nbitsin, xtracbits, nummpy, nmpypstage, mpy_stages;
+	int	nbitsout, rlbitsout, maxbitsout, xtrapbits, ckpce;
+	// r2group is the base two log of the radix: 1 for radix-2, 2 for
+	// radix-2^2, and 3 for radix-2^3
+	int	r2group;
+	// The number of stages generating their own twiddles (-g)
+	int	twidgen;
+	// nlanes is the number of samples accepted per clock: one for a
+	// single clock FFT, two for the dblclk FFT, or else four or eight
+	int	nlanes;
+	const char *EMPTYSTR;
+	bool	bitreverse, inverse, verbose_flag, single_clock,
+		real_fft, rl_hwmpy, variable_size, dit, bfp,
+		async_reset, est_flag, qtrwave, shared_rom, w8opt;
+	FILE	*vmain;
+	// The estimated cost of every stage, in pipeline order
+	FFTEST	est;
+	// Those fftstages generating their own twiddles (-g)
+	std::vector<TWIDUSER>	twidgens;
+	// The coefficient width of the w8stage, if any
+	int	w8cw;
+	// The coefficient width of the widest radix-2^3 group's w8twid
+	int	w8tcw;
+	std::string	coredir, hdrname;
+	// How the twiddle factor tables are delivered (--cmem)
+	CMEM_FORMAT	cmemfmt;
+	// Which stages get hardware multiplies, and how they're chosen: by
+	// hand (--hwmpy), or else within -p DSPs of dsp_aw x dsp_bw (--dsp)
+	MPYPLAN		mpyplan;
+	const char	*hwmpy_list;
+	int		dsp_aw, dsp_bw;
+	// Build soft multiplies from the Booth encoded boothmpy (--softmpy)
+	bool		booth;
+	// Multiplies per complex product in hwbfly (--cmpy), or 0 for either
+	int		cmpy;
+	// Rows of the longbimpy tableau per register (--mpyrows), and the
+	// registers following its final accumulate (--mpyoutregs)
+	int		mpyrows, mpyoutregs;
+	// Pass trivial twiddle factors around the soft multiplies
+	// (--twidbypass)
+	bool		twidbypass;
+	ROUND_T	rounding;
+	bool	dbg;
+
+	// The stage plan
+	// {{{
+	// The width of the block floating point exponent
+	int	ewidth;
+	// Whether the stages are built in radix-2^2 pairs, or radix-2^3
+	// triples, and how many such triples there are
+	bool	r22, r23;
+	int	ntriples;
+	// Whether the eight point stage is a w8stage
+	bool	w8stage;
+	// The number of stages with twiddle factor multiplies
+	int	mpy_units;
+	// }}}
+
+	// The pipeline, as it's built
+	// {{{
+	// The name of the reset input, i_reset or i_areset_n
+	std::string	resetw;
+	// The span of the next stage to be built, and its log base two
+	int	tmp_size, lgtmp;
+	// The widths of the data into (nbits) and out of (obits) that stage,
+	// and whether the last stage dropped its growth bit
+	int	nbits, obits, dropbit;
+	// The prefix of the outputs of a block floating point scaling stage
+	const char	*bfpfx;
+	// Those fftstages reading from a shared twidrom (-C)
+	std::vector<TWIDUSER>	twidusers;
+	// }}}
+
+	FFTCORE(const FFTGEN_CONFIG &c, int dbgs);
+
+	int	check_options(void);
+	int	plan_stages(void);
+	int	make_coredir(void);
+	int	build(void);
+
+	int	open_main(void);
+	void	main_header(void);
+	int	pipe_two(void);
+	int	pipe_dit(void);
+	int	pipe_four(void);
+	int	pipe_lanes(void);
+	int	pipe_sdf(void);
+	int	pipe_groups(void);
+	int	radix2_stages(void);
+	int	last_stages(void);
+	int	pipe_real(void);
+	int	pipe_reorder(void);
+	int	close_main(void);
+	int	write_header(void);
+	void	report(void);
+	int	build_modules(void);
+};
+
+FFTCORE::FFTCORE(const FFTGEN_CONFIG &c, int dbgs) : cfg(c), dbgstage(dbgs) {
+	fftsize = cfg.m_fftsize; lgsize = -1; rfftsize = 0;
+	nbitsin = cfg.m_nbitsin; xtracbits = cfg.m_xtracbits;
+	nummpy = cfg.m_nummpy; nmpypstage = 6; mpy_stages = 0;
+	nbitsout = rlbitsout = 0; maxbitsout = cfg.m_maxbitsout;
+	xtrapbits = cfg.m_xtrapbits; ckpce = cfg.m_ckpce;
+	r2group = 1;
+	twidgen = cfg.m_twidgen;
+	nlanes = (cfg.m_nlanes > 1) ? cfg.m_nlanes : 1;
+	EMPTYSTR = "";
+	bitreverse = cfg.m_bitreverse; inverse = cfg.m_inverse;
+	verbose_flag = cfg.m_verbose;
+	single_clock = (nlanes == 1);
+	real_fft = cfg.m_real; rl_hwmpy = false;
+	variable_size = cfg.m_variable_size;
+	dit = cfg.m_dit; bfp = cfg.m_bfp;
+	async_reset = cfg.m_async_reset; est_flag = cfg.m_estimate;
+	qtrwave = cfg.m_qtrwave; shared_rom = cfg.m_shared_rom;
+	w8opt = cfg.m_w8stage;
+	vmain = NULL;
+	w8cw = 0;
+	w8tcw = 0;
+	coredir = cfg.m_coredir; hdrname = cfg.m_hdrname;
+	cmemfmt = CMEM_HEX;
+	hwmpy_list = (cfg.m_hwmpy.size() > 0) ? cfg.m_hwmpy.c_str() : NULL;
+	dsp_aw = 0; dsp_bw = 0;
+	booth = false;
+	cmpy = 0;
+	mpyrows = cfg.m_mpyrows; mpyoutregs = cfg.m_mpyoutregs;
+	twidbypass = cfg.m_twidbypass;
+	rounding = RND_CONVERGENT;
+	// rounding = RND_HALFUP;
+	dbg = false;
+
+	ewidth = 0;
+	r22 = r23 = false;
+	ntriples = 0;
+	w8stage = false;
+	mpy_units = 0;
+
+	resetw = "i_reset";
+	tmp_size = lgtmp = 0;
+	nbits = obits = dropbit = 0;
+	bfpfx = (bfp) ? "b" : "";
+}
+// }}}
+
+// FFTCORE::check_options -- check the options given, and fill in the rest
+// {{{
+int	FFTCORE::check_options(void) {
+	// The options given as text
+	// {{{
+	if ((!opt_radix(cfg.m_radix, r2group))
+			||(!opt_cmem(cfg.m_cmem, cmemfmt))
+			||(!opt_dsp(cfg.m_dsp, dsp_aw, dsp_bw))
+			||(!opt_softmpy(cfg.m_softmpy, booth))
+			||(!opt_cmpy(cfg.m_cmpy, cmpy)))
+		return EXIT_FAILURE;
+	if (mpyrows < 1) {
+		fprintf(stderr, "ERR: At least one row per register, --mpyrows %d\n", mpyrows);
+		return EXIT_FAILURE;
+	} if (mpyoutregs < 0) {
+		fprintf(stderr, "ERR: Negative output registers, --mpyoutregs %d\n", mpyoutregs);
+		return EXIT_FAILURE;
+	}
 	// }}}
 
 	// verbose: Repeat back our chosen arguments
@@ -1247,8 +1732,14 @@ int main(int argc, char **argv) {
 			printf("Building a %d point %sforward FFT module\n",
 				fftsize,
 				(real_fft)?"real ":"");
-		if (!single_clock)
+		if (nlanes > 2)
+			printf("  that accepts %d inputs per clock\n", nlanes);
+		else if (!single_clock)
 			printf("  that accepts two inputs per clock\n");
+		if (dit)
+			printf("  using decimation in time, from bit-reversed inputs\n");
+		if (bfp)
+			printf("  using block floating point\n");
 		if (async_reset)
 			printf("  using a negative logic ASYNC reset\n");
 
@@ -1266,16 +1757,79 @@ int main(int argc, char **argv) {
 	// Argument sanity checks
 	// {{{
 	if (real_fft) {
-		printf("The real FFT option is not implemented yet, but still on\nmy to do list.  Please try again later.\n");
-		exit(EXIT_FAILURE);
+		if (!single_clock) {
+			fprintf(stderr, "ERR: The real FFT option (-r) is only built for single\n");
+			fprintf(stderr, "clock FFTs (opt -1)\n");
+			return EXIT_FAILURE;
+		} if (inverse) {
+			fprintf(stderr, "ERR: The real FFT option (-r) only supports forward FFTs\n");
+			return EXIT_FAILURE;
+		} if (!bitreverse) {
+			printf("NOTE: A real FFT always produces its outputs in natural order\n");
+			bitreverse = true;
+		}
 	}
 
 	if (ckpce < 1)
 		ckpce = 1;
-	if (!bitreverse) {
-		printf("WARNING: While I can skip the bit reverse stage, the code to do\n");
-		printf("an inverse FFT on a bit--reversed input has not yet been\n");
-		printf("built.\n");
+	if ((variable_size)&&((!single_clock)||(r2group > 1)||(real_fft))) {
+		fprintf(stderr, "ERR: The variable size option (-z) is only built for\n");
+		fprintf(stderr, "radix-2, complex, single clock FFTs (opt -1)\n");
+		return EXIT_FAILURE;
+	}
+	if ((r2group > 1)&&(!single_clock)) {
+		fprintf(stderr, "ERR: The radix-2^2 and 2^3 architectures (-R 22, -R 23) are only\n");
+		fprintf(stderr, "built for single clock FFTs (opt -1)\n");
+		return EXIT_FAILURE;
+	}
+	if (bfp) {
+		if ((!single_clock)||(r2group > 1)||(real_fft)||(variable_size)
+				||(dit)) {
+			fprintf(stderr, "ERR: The block floating point option (-B) is only built for\n");
+			fprintf(stderr, "fixed size, radix-2, complex, single clock FFTs (opt -1)\n");
+			return EXIT_FAILURE;
+		} if ((maxbitsout > 0)||(xtrapbits != 0)) {
+			fprintf(stderr, "ERR: The block floating point option (-B) sets its own\n");
+			fprintf(stderr, "internal widths, and so doesn't support -m or -x\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	if ((qtrwave)&&((!single_clock)||(dit))) {
+		fprintf(stderr, "ERR: The quarter wave twiddle option (-q) is only built for\n");
+		fprintf(stderr, "decimation in frequency, single clock FFTs (opt -1)\n");
+		return EXIT_FAILURE;
+	}
+
+	if ((shared_rom)&&((!single_clock)||(dit)||(qtrwave))) {
+		fprintf(stderr, "ERR: The shared twiddle ROM option (-C) is only built for\n");
+		fprintf(stderr, "decimation in frequency, single clock FFTs (opt -1), and\n");
+		fprintf(stderr, "may not be combined with a quarter wave table (opt -q)\n");
+		return EXIT_FAILURE;
+	}
+
+	if ((twidgen > 0)&&((!single_clock)||(dit)||(r2group > 1)
+				||(qtrwave)||(shared_rom))) {
+		fprintf(stderr, "ERR: The twiddle generator option (-g) is only built for\n");
+		fprintf(stderr, "radix-2, decimation in frequency, single clock FFTs (opt -1),\n");
+		fprintf(stderr, "and may not be combined with opts -q or -C\n");
+		return EXIT_FAILURE;
+	}
+
+	if (dit) {
+		if ((!single_clock)||(r2group > 1)||(real_fft)||(variable_size)) {
+			fprintf(stderr, "ERR: The decimation in time option (-t) is only built for\n");
+			fprintf(stderr, "fixed size, radix-2, complex, single clock FFTs (opt -1)\n");
+			return EXIT_FAILURE;
+		}
+
+		// The inputs arrive in bit-reversed order, so the outputs
+		// come out in natural order without any bit reversal stage
+		bitreverse = false;
+	} else if (!bitreverse) {
+		printf("NOTE: The outputs will be left in bit-reversed order.  To\n");
+		printf("inverse FFT them, build a decimation in time inverse FFT\n");
+		printf("(opts -i -t) to accept them in that order.\n");
 	}
 
 	if ((lgsize < 0)&&(fftsize > 1)) {
@@ -1286,23 +1840,23 @@ int main(int argc, char **argv) {
 	if (fftsize <= 0) {
 		printf("ERROR: Invalid size.  FFT size (%d) may not be <= 0\n",
 			fftsize);
-		exit(EXIT_FAILURE);
+		return EXIT_FAILURE;
 	}
 
 	if (nbitsin < 1) {
 		printf("ERROR: Not enough input bits, %d >= 1\n", nbitsin);
-		exit(EXIT_FAILURE);
+		return EXIT_FAILURE;
 	} else if (nbitsin>48) {
 		printf("ERROR: Too many input bits, %d is greater than 48\n",
 			nbitsin);
-		exit(EXIT_FAILURE);
+		return EXIT_FAILURE;
 	}
 
 
 	if (nextlg(fftsize) != fftsize) {
 		fprintf(stderr, "ERR: FFTSize (%d) *must* be a power of two\n",
 				fftsize);
-		exit(EXIT_FAILURE);
+		return EXIT_FAILURE;
 	} else if (fftsize < 2) {
 		fprintf(stderr, "ERR: Minimum FFTSize is 2, not %d\n",
 				fftsize);
@@ -1315,10 +1869,49 @@ int main(int argc, char **argv) {
 			fprintf(stderr, "Indeed, a size of %d doesn\'t make much sense to me at all.\n", fftsize);
 			fprintf(stderr, "Is such an operation even defined?\n");
 		}
-		exit(EXIT_FAILURE);
+		return EXIT_FAILURE;
+	}
+
+	if ((nlanes > 2)&&(fftsize < nlanes * nlanes)) {
+		fprintf(stderr, "ERR: Minimum FFT size at %d samples per clock is %d, not %d\n",
+			nlanes, nlanes*nlanes, fftsize);
+		return EXIT_FAILURE;
+	}
+
+	if ((bfp)&&(fftsize < 8)) {
+		fprintf(stderr, "ERR: Minimum block floating point FFT size is 8, not %d\n",
+			fftsize);
+		return EXIT_FAILURE;
+	}
+
+	if ((variable_size)&&(fftsize < 16)) {
+		fprintf(stderr, "ERR: Minimum variable FFT size is 16, not %d\n",
+			fftsize);
+		return EXIT_FAILURE;
+	}
+
+	if (real_fft) {
+		if (fftsize < 16) {
+			fprintf(stderr, "ERR: Minimum real FFT size is 16, not %d\n",
+				fftsize);
+			return EXIT_FAILURE;
+		}
+
+		// An N point real FFT is built from an N/2 point complex FFT,
+		// followed by a post-processing stage
+		rfftsize = fftsize;
+		fftsize >>= 1;
+		lgsize--;
 	}
 	// }}}
 
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::plan_stages -- the width of every stage, and its multiplies
+// {{{
+int	FFTCORE::plan_stages(void) {
 	// nbitsout, bitreverse, and tmp_size
 	// {{{
 	// Calculate how many output bits we'll have, and what the log
@@ -1343,18 +1936,44 @@ int main(int argc, char **argv) {
 			bitreverse = false;
 	} if ((maxbitsout > 0)&&(nbitsout > maxbitsout))
 		nbitsout = maxbitsout;
+
+	// A block floating point FFT only grows by the one bit of its last
+	// stage.  Every other stage is followed by a scaling stage.
+	if (bfp)
+		nbitsout = nbitsin + 1;
+	// The exponent must count up to one halving for every stage but the
+	// last
+	ewidth = lgval(lgsize);
+
+	// The real FFT's post-processing stage accumulates one more bit
+	rlbitsout = nbitsout;
+	if (real_fft) {
+		rlbitsout = nbitsout + 1;
+		if ((maxbitsout > 0)&&(rlbitsout > maxbitsout))
+			rlbitsout = maxbitsout;
+	}
 	// }}}
 
 	// Reflect our bit-width calcualtion
 	// {{{
 	if (verbose_flag) {
-		printf("Output samples will be %d bits wide\n", nbitsout);
-		printf("This %sFFT will take %d-bit samples in, and produce %d samples out\n", (inverse)?"i":"", nbitsin, nbitsout);
+		printf("Output samples will be %d bits wide\n", rlbitsout);
+		printf("This %sFFT will take %d-bit samples in, and produce %d samples out\n", (inverse)?"i":"", nbitsin, rlbitsout);
 		if (maxbitsout > 0)
 			printf("  Internally, it will allow items to accumulate to %d bits\n", maxbitsout);
 		printf("  Twiddle-factors of %d bits will be used\n",
 			nbitsin+xtracbits);
-		if (!bitreverse)
+		if (qtrwave)
+		printf("  Only a quarter wave of these will be stored per stage\n");
+		else if (shared_rom)
+		printf("  These will be shared between stages, %d stages per ROM\n",
+			(ckpce > 2) ? 2*(ckpce-1) : 2);
+		else if (twidgen > 0)
+		printf("  Those of the first %d stage%s (of 32+ points) will be generated\n",
+			twidgen, (twidgen > 1) ? "s":"");
+		if (dit)
+		printf("  The input is expected in bit-reversed order\n");
+		else if (!bitreverse)
 		printf("  The output will be left in bit-reversed order\n");
 	}
 	// }}}
@@ -1362,7 +1981,8 @@ int main(int argc, char **argv) {
 	// Figure out how many multiply stages to use, and how many to skip
 	// {{{
 	if (!single_clock) {
-		nmpypstage = 6;
+		// Three multiplies per butterfly, one butterfly per lane
+		nmpypstage = 3 * nlanes;
 	} else if (ckpce <= 1) {
 		nmpypstage = 3;
 	} else if (ckpce == 2) {
@@ -1370,140 +1990,174 @@ int main(int argc, char **argv) {
 	} else
 		nmpypstage = 1;
 
-	mpy_stages = nummpy / nmpypstage;
-	if (mpy_stages > lgval(fftsize)-2)
-		mpy_stages = lgval(fftsize)-2;
+	// A radix-2^2 FFT only needs one multiply per pair of stages, plus
+	// one more for any (odd) radix-2 stage left over.  It also needs at
+	// least one full pair of stages.
+	r22 = (r2group == 2)&&(fftsize >= 16);
+	// A radix-2^3 FFT needs only one per triple of stages, and at least
+	// one full triple.  Of the two to four stages left over, only a
+	// sixteen point stage needs a multiply of its own.
+	r23 = (r2group == 3)&&(fftsize >= 32);
+	ntriples = (r23) ? (lgsize-2)/3 : 0;
+	// Unless given --no-w8stage, a single clock, decimation in frequency
+	// FFT of sixteen points or more builds its eight point stage from
+	// constant multiplies alone.  This stage, the w8stage, takes the place of the
+	// last multiplying stage, and also of any (odd) radix-2 stage a
+	// radix-2^2 FFT leaves over.  A radix-2^3 FFT, already built around
+	// the same constant multiply, always uses it.
+	w8stage = ((w8opt)||(r23))&&(single_clock)&&(!dit)
+		&&(fftsize >= 16);
+	mpy_units = lgval(fftsize)-((w8stage) ? 3 : 2);
+	if (r22)
+		mpy_units = (lgsize-2)/2 + (((!w8stage)&&(lgsize & 1)) ? 1 : 0);
+	else if (r23)
+		mpy_units = ntriples + ((lgsize-3*ntriples == 4) ? 1 : 0);
+	// With more than two lanes, only the stages spanning at least four
+	// clocks use coefficient memories.  The rest have constant twiddles.
+	if (nlanes > 2)
+		mpy_units = lgsize - lgval(nlanes) - 1;
+	if (mpy_units < 0)
+		mpy_units = 0;
+
+	// Describe each of these mpy_units stages, in pipeline order, and then
+	// the real FFT's post-processing stage.  The stages building the FFT
+	// count them backwards, from one at the end of the pipeline on up.
+	// pw[p] is the width of the data going into the p'th stage of the
+	// pipeline, as it grows through a radix-2 FFT.
+	{
+		std::vector<int>	pw;
+		int	nb = nbitsin, ob;
+		bool	drop = false;
+
+		pw.push_back(nbitsin);
+		ob = nb+1+xtrapbits;
+		if ((maxbitsout > 0)&&(ob > maxbitsout))
+			ob = maxbitsout;
+		nb = (bfp) ? ob-1 : ob;
+		for(int p=1; p<=lgsize; p++) {
+			pw.push_back(nb+xtrapbits);
+			ob = nb+(((bfp)||(!drop))?1:0);
+			if ((maxbitsout > 0)&&(ob > maxbitsout))
+				ob = maxbitsout;
+			drop = !drop;
+			nb = (bfp) ? ob-1 : ob;
+		}
+
+		est_dspsize(dsp_aw, dsp_bw);
+		est_softmpy(booth, mpyrows, mpyoutregs);
+		est_cmpy(cmpy);
+		for(int n=mpy_units; n > 0; n--) {
+			std::string	name;
+			int		pos, span;
+
+			if (dit) {
+				span = 1 << (lgsize-n+1);
+				name = "stage_t" + std::to_string(span);
+				pos  = lgsize-n;
+			} else if (nlanes > 2) {
+				span = 1 << (n+lgval(nlanes)+1);
+				name = "stage_" + std::to_string(span);
+				pos  = lgsize - lgval(span);
+			} else if ((r22)&&((n > 1)||(w8stage)
+						||((lgsize & 1)==0))) {
+				// The twiddle multiply following a pair
+				int	pairno = mpy_units - n;
+
+				span = fftsize >> (2*pairno);
+				name = "stage_t" + std::to_string(span);
+				pos  = 2*pairno+2;
+			} else if ((r23)&&(n > mpy_units - ntriples)) {
+				// The twiddle multiply following a triple
+				int	grpno = mpy_units - n;
+
+				span = fftsize >> (3*grpno);
+				name = "stage_t" + std::to_string(span);
+				pos  = 3*grpno+3;
+			} else {
+				span = 1 << (n+((w8stage) ? 3 : 2));
+				name = "stage_" + std::to_string(span);
+				pos  = lgsize - lgval(span);
+			}
+
+			// One butterfly per lane, of pw[pos] bits in
+			mpy_unit(mpyplan, name, (single_clock) ? 1 : nlanes,
+				pw[pos], pw[pos]+xtracbits,
+				(single_clock) ? ckpce : 1);
+		} if (real_fft)
+			mpy_unit(mpyplan, "revstage", 1,
+				nbitsout+1, nbitsout+xtracbits, ckpce);
+	}
+
+	// Then give hardware multiplies to those listed by hand (--hwmpy),
+	// or else to those saving the most LUTs within the -p budget.
+	// Without a DSP size (--dsp), that budget counts multiplies.
+	if (hwmpy_list != NULL) {
+		if (!mpy_override(mpyplan, hwmpy_list))
+			return EXIT_FAILURE;
+	} else
+		mpy_allocate(mpyplan, nummpy);
+
+	mpy_stages = 0;
+	for(int n=1; n<=mpy_units; n++)
+		if (mpy_hwunit(mpyplan, mpy_units, n))
+			mpy_stages++;
+	rl_hwmpy = (real_fft)&&(mpyplan.back().m_hwmpy);
+
+	// Explain how the hardware multiplies were allocated
+	if ((verbose_flag)&&(mpyplan.size() > 0)) {
+		int	used = mpy_dsps_used(mpyplan);
+
+		printf("  Each multiplying stage needs %d multipl%s, either in DSPs or in LUTs.\n",
+			nmpypstage, (nmpypstage == 1) ? "y" : "ies");
+		if (hwmpy_list != NULL)
+			printf("  Those given DSPs by --hwmpy %s use %d in all:\n",
+				hwmpy_list, used);
+		else
+			printf("  Of the -p %d DSPs allowed, those saving the most LUTs use %d:\n",
+				nummpy, used);
+		mpy_report(stdout, mpyplan);
+		if ((hwmpy_list == NULL)&&(nummpy > used))
+			printf("  NOTE: -p %d would build the same core, as %d of -p %d %s unused\n",
+				used, nummpy - used, nummpy,
+				(nummpy - used == 1) ? "is" : "are");
+	}
 	// }}}
 
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::make_coredir -- create the directory the core goes into
+// {{{
+int	FFTCORE::make_coredir(void) {
 	// Create an output directory
 	// {{{
-	{
+	// (Unless the files are going to a sink, rather than to disk)
+	if (!fftsink_active()) {
 		struct stat	sbuf;
 		if (lstat(coredir.c_str(), &sbuf)==0) {
 			if (!S_ISDIR(sbuf.st_mode)) {
 				fprintf(stderr, "\'%s\' already exists, and is not a directory!\n", coredir.c_str());
 				fprintf(stderr, "I will stop now, lest I overwrite something you care about.\n");
 				fprintf(stderr, "To try again, please remove this file.\n");
-				exit(EXIT_FAILURE);
+				return EXIT_FAILURE;
 			}
 		} else
 			mkdir(coredir.c_str(), 0755);
 		if (access(coredir.c_str(), X_OK|W_OK) != 0) {
 			fprintf(stderr, "I have no access to the directory \'%s\'.\n", coredir.c_str());
-			exit(EXIT_FAILURE);
+			return EXIT_FAILURE;
 		}
 	}
 	// }}}
 
-	// Write a header file with our chosen parameters
-	// {{{
-	if (hdrname.length() > 0) {
-		FILE	*hdr = fopen(hdrname.c_str(), "w");
-		if (hdr == NULL) {
-			fprintf(stderr, "ERROR: Cannot open %s to create header file\n", hdrname.c_str());
-			perror("O/S Err:");
-			exit(EXIT_FAILURE);
-		}
-
-		fprintf(hdr,
-SLASHLINE
-"//\n"
-"// Filename:\t%s\n"
-"// {{{\n" // "}}}"
-"// Project:\t%s\n"
-"//\n"
-"// Purpose:	This simple header file captures the internal constants\n"
-"//		within the FFT that were used to build it, for the purpose\n"
-"//	of making C++ integration (and test bench testing) simpler.  That is,\n"
-"//	should the FFT change size, this will note that size change and thus\n"
-"//	any test bench or other C++ program dependent upon either the size of\n"
-"//	the FFT, the number of bits in or out of it, etc., can pick up the\n"
-"//	changes in the defines found within this file.\n"
-"//\n",
-		hdrname.c_str(), prjname);
-		fprintf(hdr, "%s", creator);
-		fprintf(hdr, "//\n");
-		fprintf(hdr, "%s", cpyleft);
-		fprintf(hdr, "//\n"
-		"//\n"
-		"#ifndef %sFFTHDR_H\n"
-		"#define %sFFTHDR_H\n"
-		"\n"
-		"#define\t%sFFT_IWIDTH\t%d\n"
-		"#define\t%sFFT_OWIDTH\t%d\n"
-		"#define\t%sFFT_LGWIDTH\t%d\n"
-		"#define\t%sFFT_SIZE\t(1<<%sFFT_LGWIDTH)\n\n",
-			(inverse)?"I":"", (inverse)?"I":"",
-			(inverse)?"I":"", nbitsin,
-			(inverse)?"I":"", nbitsout,
-			(inverse)?"I":"", lgsize,
-			(inverse)?"I":"", (inverse)?"I":"");
-		if (async_reset)
-			fprintf(hdr, "#define\tASYNC_RESETN\n");
-		else
-			fprintf(hdr, "// #define ASYNC_RESETN\n");
-		if (ckpce > 0)
-			fprintf(hdr, "#define\t%sFFT_CKPCE\t%d\t// Clocks per CE\n",
-				(inverse)?"I":"", ckpce);
-		else
-			fprintf(hdr, "// Two samples per i_ce\n");
-		if (!bitreverse)
-			fprintf(hdr, "#define\t%sFFT_SKIPS_BIT_REVERSE\n",
-				(inverse)?"I":"");
-		if (real_fft)
-			fprintf(hdr, "#define\tRL%sFFT\n\n", (inverse)?"I":"");
-		if (!single_clock)
-			fprintf(hdr, "#define\tDBLCLK%sFFT\n\n", (inverse)?"I":"");
-		else
-			fprintf(hdr, "// #define\tDBLCLK%sFFT // this FFT takes one input sample per clock\n\n", (inverse)?"I":"");
-		if (USE_OLD_MULTIPLY)
-			fprintf(hdr, "#define\tUSE_OLD_MULTIPLY\n\n");
-
-		fprintf(hdr, "// Parameters for testing the longbimpy\n");
-		fprintf(hdr, "#define\tTST_LONGBIMPY_AW\t%d\n", TST_LONGBIMPY_AW);
-#ifdef	TST_LONGBIMPY_BW
-		fprintf(hdr, "#define\tTST_LONGBIMPY_BW\t%d\n\n", TST_LONGBIMPY_BW);
-#else
-		fprintf(hdr, "#define\tTST_LONGBIMPY_BW\tTST_LONGBIMPY_AW\n\n");
-#endif
-
-		fprintf(hdr, "// Parameters for testing the shift add multiply\n");
-		fprintf(hdr, "#define\tTST_SHIFTADDMPY_AW\t%d\n", TST_SHIFTADDMPY_AW);
-#ifdef	TST_SHIFTADDMPY_BW
-		fprintf(hdr, "#define\tTST_SHIFTADDMPY_BW\t%d\n\n", TST_SHIFTADDMPY_BW);
-#else
-		fprintf(hdr, "#define\tTST_SHIFTADDMPY_BW\tTST_SHIFTADDMPY_AW\n\n");
-#endif
-
-#define	TST_SHIFTADDMPY_AW	16
-#define	TST_SHIFTADDMPY_BW	20	// Leave undefined to match AW
-		fprintf(hdr, "// Parameters for testing the butterfly\n");
-		fprintf(hdr, "#define\tTST_BUTTERFLY_IWIDTH\t%d\n", TST_BUTTERFLY_IWIDTH);
-		fprintf(hdr, "#define\tTST_BUTTERFLY_CWIDTH\t%d\n", TST_BUTTERFLY_CWIDTH);
-		fprintf(hdr, "#define\tTST_BUTTERFLY_OWIDTH\t%d\n", TST_BUTTERFLY_OWIDTH);
-		fprintf(hdr, "#define\tTST_BUTTERFLY_MPYDELAY\t%d\n\n",
-				bflydelay(TST_BUTTERFLY_IWIDTH,
-					TST_BUTTERFLY_CWIDTH-TST_BUTTERFLY_IWIDTH));
-
-		fprintf(hdr, "// Parameters for testing the quarter stage\n");
-		fprintf(hdr, "#define\tTST_QTRSTAGE_IWIDTH\t%d\n", TST_QTRSTAGE_IWIDTH);
-		fprintf(hdr, "#define\tTST_QTRSTAGE_LGWIDTH\t%d\n\n", TST_QTRSTAGE_LGWIDTH);
-
-		fprintf(hdr, "// Parameters for testing the double stage\n");
-		fprintf(hdr, "#define\tTST_DBLSTAGE_IWIDTH\t%d\n", TST_DBLSTAGE_IWIDTH);
-		fprintf(hdr, "#define\tTST_DBLSTAGE_SHIFT\t%d\n\n", TST_DBLSTAGE_SHIFT);
-
-		fprintf(hdr, "// Parameters for testing the bit reversal stage\n");
-		fprintf(hdr, "#define\tTST_DBLREVERSE_LGSIZE\t%d\n\n", TST_DBLREVERSE_LGSIZE);
-		fprintf(hdr, "\n" "#endif\n\n");
-		fclose(hdr);
-	}
-	// }}}
+	return EXIT_SUCCESS;
+}
+// }}}
 
-	////////////////////////////////////////////////////////////////////////
-	//
-	// Build FFTMAIN
-	// {{{
+// FFTCORE::open_main -- open [i]fftmain.v, as vmain
+// {{{
+int	FFTCORE::open_main(void) {
 	// Open the file
 	// {{{
 	{
@@ -1514,11 +2168,11 @@ SLASHLINE
 		if (inverse) fname_string += "i";
 		fname_string += "fftmain.v";
 
-		vmain = fopen(fname_string.c_str(), "w");
+		vmain = fftsink_open(fname_string.c_str());
 		if (NULL == vmain) {
 			fprintf(stderr, "Could not open \'%s\' for writing\n", fname_string.c_str());
 			perror("Err from O/S:");
-			exit(EXIT_FAILURE);
+			return EXIT_FAILURE;
 		}
 
 		if (verbose_flag)
@@ -1526,6 +2180,13 @@ SLASHLINE
 	}
 	// }}}
 
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::main_header -- everything in fftmain.v ahead of its stages
+// {{{
+void	FFTCORE::main_header(void) {
 	// Give it a header
 	// {{{
 	fprintf(vmain,
@@ -1540,10 +2201,28 @@ SLASHLINE
 "//	to this one.  This module accomplish a fixed size Complex FFT on\n"
 "//	%d data points.\n",
 		(inverse)?"i":"",prjname, fftsize);
-	if (single_clock) {
+	if (real_fft) {
+	fprintf(vmain,
+"//	This complex FFT is then followed by a post-processing stage, turning\n"
+"//	it into a real FFT on %d data points.\n", rfftsize);
+	}
+	if (real_fft) {
+	fprintf(vmain,
+"//	The FFT is fully pipelined, and accepts as inputs two real two's\n"
+"//	complement samples per clock.\n");
+	} else if (single_clock) {
 	fprintf(vmain,
 "//	The FFT is fully pipelined, and accepts as inputs one complex two\'s\n"
 "//	complement sample per clock.\n");
+	if (dit)
+		fprintf(vmain,
+"//	This is a decimation in time FFT.  It expects its inputs in bit\n"
+"//	reversed order, such as the outputs of an FFT built without its\n"
+"//	bit reversal stage, and produces its outputs in natural order.\n");
+	} else if (nlanes > 2) {
+	fprintf(vmain,
+"//	The FFT is fully pipelined, and accepts as inputs %d complex two\'s\n"
+"//	complement samples per clock.\n", nlanes);
 	} else {
 	fprintf(vmain,
 "//	The FFT is fully pipelined, and accepts as inputs two complex two\'s\n"
@@ -1559,7 +2238,7 @@ SLASHLINE
 "//	\t\tFurther, following a reset, the o_sync line will go\n"
 "//	\t\thigh the same time the first output sample is valid.\n",
 		(async_reset)?"a":"", (async_reset)?"_n":"");
-	if (single_clock) {
+	if ((single_clock)&&(!real_fft)) {
 		fprintf(vmain,
 "//	i_ce\tA clock enable line.  If this line is set, this module\n"
 "//	\t\twill accept one complex input value, and produce\n"
@@ -1574,7 +2253,63 @@ SLASHLINE
 "//	o_sync\tA one bit output indicating the first sample of the FFT frame.\n"
 "//	\t\tIt also indicates the first valid sample out of the FFT\n"
 "//	\t\ton the first frame.\n", nbitsin, nbitsin, nbitsout, nbitsout*2);
-	} else {
+		if (variable_size)
+			fprintf(vmain,
+"//	i_lgsize\tThe log, base two, of the FFT size, captured on any reset.\n"
+"//	\t\tAny size from 16 (i_lgsize = 4) to %d (i_lgsize = %d)\n"
+"//	\t\tmay be used.  Smaller FFTs bypass the leading stages of\n"
+"//	\t\tthe pipeline, and so they grow fewer bits on the way to\n"
+"//	\t\tthe output.\n", fftsize, lgsize);
+		if (bfp)
+			fprintf(vmain,
+"//	o_exponent\tThe block floating point exponent of the frame being\n"
+"//	\t\toutput, %d bits wide.  This is the number of times the\n"
+"//	\t\tframe was halved along the way, so that o_result times\n"
+"//	\t\t2^o_exponent is the full (unscaled) FFT of the input.\n"
+"//	\t\tEach stage holds a whole frame, and chooses whether or\n"
+"//	\t\tnot to halve it from the peak of that frame, so that no\n"
+"//	\t\tframe ever saturates.\n",
+				ewidth);
+	} else if (real_fft) {
+		fprintf(vmain,
+"//	i_ce\tA clock enable line.  If this line is set, this module\n"
+"//	\t\twill accept two real input values, and produce\n"
+"//	\t\tone (possibly empty) complex output value.\n"
+"//	i_sample\tTwo real input samples.  This value is split\n"
+"//	\t\tinto two two's complement numbers, %d bits each, with\n"
+"//	\t\tthe first (even) sample in the high order bits, and the\n"
+"//	\t\tsecond (odd) sample taking the bottom %d bits.\n"
+"//	o_result\tThe output result, having %d bits for each of the real\n"
+"//	\t\tand imaginary components, leading to %d bits total.  Only\n"
+"//	\t\tthe %d unique outputs, X[0] through X[%d], are produced.\n"
+"//	\t\tSince X[0] and X[%d] are both real, they are packed together\n"
+"//	\t\tinto the first output: X[0] in the real (high order) bits,\n"
+"//	\t\tand X[%d] in the imaginary (low order) bits.\n"
+"//	o_sync\tA one bit output indicating the first sample of the FFT frame.\n"
+"//	\t\tIt also indicates the first valid sample out of the FFT\n"
+"//	\t\ton the first frame.\n", nbitsin, nbitsin,
+		rlbitsout, rlbitsout*2, fftsize+1, fftsize, fftsize, fftsize);
+	} else if (nlanes > 2) {
+		fprintf(vmain,
+"//	i_ce\tA clock enable line.  If this line is set, this module\n"
+"//	\t\twill accept %d complex values as inputs, and produce\n"
+"//	\t\t%d (possibly empty) complex values as outputs.\n"
+"//	i_sample\tThe %d complex input samples.  Each is split into two\n"
+"//	\t\ttwo\'s complement numbers, %d bits each, with the real\n"
+"//	\t\tportion in the high order bits, and the imaginary\n"
+"//	\t\tportion taking the bottom %d bits.  The first sample,\n"
+"//	\t\tsample zero, occupies the high order %d bits, sample\n"
+"//	\t\tone the next %d bits, and so forth.  On the next clock,\n"
+"//	\t\tthe high order bits would contain sample %d.\n"
+"//	o_result\tThe %d output samples produced each clock, in the same\n"
+"//	\t\tformat as i_sample, only having %d bits for each of the\n"
+"//	\t\treal and imaginary components.\n"
+"//	o_sync\tA one bit output indicating the first valid sample produced by\n"
+"//	\t\tthis FFT following a reset.  Ever after, this will\n"
+"//	\t\tindicate the first sample of an FFT frame.\n",
+	nlanes, nlanes, nlanes, nbitsin, nbitsin, 2*nbitsin,
+	2*nbitsin, nlanes, nlanes, nbitsout);
+	} else {
 		fprintf(vmain,
 "//	i_ce\tA clock enable line.  If this line is set, this module\n"
 "//	\t\twill accept two complex values as inputs, and produce\n"
@@ -1604,10 +2339,20 @@ SLASHLINE
 "// Arguments:\tThis file was computer generated using the following command\n"
 "//\t\tline:\n"
 "//\n");
-	fprintf(vmain, "//\t\t%% %s\n", cmdline.c_str());
+	fprintf(vmain, "//\t\t%% %s\n", fftgen_cmdline(cfg).c_str());
 	fprintf(vmain, "//\n");
-	fprintf(vmain, "//\tThis core will use hardware accelerated multiplies (DSPs)\n"
-		"//\tfor %d of the %d stages\n", mpy_stages, lgval(fftsize));
+	fprintf(vmain, "//\tThis core will use hardware accelerated multiplies (DSPs)\n");
+	if ((r22)||(r23)||(dit))
+		fprintf(vmain, "//\tfor %d of the %d twiddle multiplies\n",
+			mpy_stages, mpy_units);
+	else if (nlanes > 2)
+		fprintf(vmain, "//\tfor %d of the %d stages with twiddle factor memories\n",
+			mpy_stages, mpy_units);
+	else
+		fprintf(vmain, "//\tfor %d of the %d stages\n",
+			mpy_stages, lgval(fftsize));
+	if (rl_hwmpy)
+		fprintf(vmain, "//\tas well as for the real FFT post-processing stage\n");
 	fprintf(vmain, "//\n");
 	fprintf(vmain, "%s", creator);
 	fprintf(vmain, "//\n");
@@ -1617,17 +2362,18 @@ SLASHLINE
 
 	// Module declaration
 	// {{{
-	std::string	resetw("i_reset");
+	resetw = "i_reset";
 	if (async_reset)
 		resetw = "i_areset_n";
 
 	fprintf(vmain, "//\n");
 	fprintf(vmain, "//\n");
-	fprintf(vmain, "module %sfftmain(i_clk, %s, i_ce,\n",
-		(inverse)?"i":"", resetw.c_str());
-	if (single_clock) {
-		fprintf(vmain, "\t\ti_sample, o_result, o_sync%s);\n",
-			(dbg)?", o_dbg":"");
+	fprintf(vmain, "module %sfftmain(i_clk, %s, i_ce,%s\n",
+		(inverse)?"i":"", resetw.c_str(),
+		(variable_size)?" i_lgsize,":"");
+	if ((single_clock)||(nlanes > 2)) {
+		fprintf(vmain, "\t\ti_sample, o_result, o_sync%s%s);\n",
+			(bfp)?", o_exponent":"", (dbg)?", o_dbg":"");
 	} else {
 		fprintf(vmain, "\t\ti_left, i_right,\n");
 		fprintf(vmain, "\t\to_left, o_right, o_sync%s);\n",
@@ -1640,192 +2386,495 @@ SLASHLINE
 	"\t// changed.  (These values can be adjusted by running the core\n"
 	"\t// generator again.)  The reason is simply that these values have\n"
 	"\t// been hardwired into the core at several places.\n");
-	fprintf(vmain, "\tlocalparam\tIWIDTH=%d, OWIDTH=%d; // LGWIDTH=%d;\n\t//\n", nbitsin, nbitsout, lgsize);
+	fprintf(vmain, "\tlocalparam\tIWIDTH=%d, OWIDTH=%d; // LGWIDTH=%d;\n", nbitsin, rlbitsout, lgsize);
+	if (nlanes > 2)
+		fprintf(vmain, "\t// The number of samples per clock\n"
+			"\tlocalparam\tNLANES=%d;\n", nlanes);
+	if (bfp)
+		fprintf(vmain, "\t// The width of the block floating point exponent\n"
+			"\tlocalparam\tEWIDTH=%d;\n", ewidth);
+	fprintf(vmain, "\t//\n");
 	assert(lgsize > 0);
 	fprintf(vmain, "\tinput\twire\t\t\t\ti_clk, %s, i_ce;\n\t//\n",
 		resetw.c_str());
+	if (variable_size)
+		fprintf(vmain, "\tinput\twire\t[%d:0]\t\t\ti_lgsize;\n",
+			lgval(lgsize+1)-1);
 	if (single_clock) {
 	fprintf(vmain, "\tinput\twire\t[(2*IWIDTH-1):0]\ti_sample;\n");
 	fprintf(vmain, "\toutput\treg\t[(2*OWIDTH-1):0]\to_result;\n");
+	} else if (nlanes > 2) {
+	fprintf(vmain, "\tinput\twire\t[(NLANES*2*IWIDTH-1):0]\ti_sample;\n");
+	fprintf(vmain, "\toutput\treg\t[(NLANES*2*OWIDTH-1):0]\to_result;\n");
 	} else {
 	fprintf(vmain, "\tinput\twire\t[(2*IWIDTH-1):0]\ti_left, i_right;\n");
 	fprintf(vmain, "\toutput\treg\t[(2*OWIDTH-1):0]\to_left, o_right;\n");
 	}
 	fprintf(vmain, "\toutput\treg\t\t\t\to_sync;\n");
+	if (bfp)
+		fprintf(vmain, "\toutput\treg\t[(EWIDTH-1):0]\t\to_exponent;\n");
 	if (dbg)
 		fprintf(vmain, "\toutput\twire\t[33:0]\t\to_dbg;\n");
 	fprintf(vmain, "\n\n");
 	// }}}
 
+	if (variable_size) {
+		// {{{
+		int	lgw = lgval(lgsize+1);
+
+		fprintf(vmain,
+	"\t// r_lgsize\n"
+	"\t// {{{\n"
+	"\t// The log, base two, of the FFT size is captured on any reset.  A\n"
+	"\t// 2^r_lgsize point FFT then enters the pipeline at the stage of that\n"
+	"\t// span, bypassing all of the stages before it.  Sizes outside of the\n"
+	"\t// range this core was built for are clipped to that range.\n"
+	"\treg\t[%d:0]\t\t\tr_lgsize;\n"
+	"\n"
+	"\tinitial\tr_lgsize = %d;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (%si_%sreset%s)\n"
+	"\tbegin\n"
+	"\t\tif (i_lgsize < %d)\n"
+	"\t\t\tr_lgsize <= %d;\n"
+	"\t\telse if (i_lgsize > %d)\n"
+	"\t\t\tr_lgsize <= %d;\n"
+	"\t\telse\n"
+	"\t\t\tr_lgsize <= i_lgsize;\n"
+	"\tend\n"
+	"\t// }}}\n\n",
+			lgw-1, lgsize,
+			(async_reset)?"!":"", (async_reset)?"a":"",
+			(async_reset)?"_n":"",
+			4, 4, lgsize, lgsize);
+		// }}}
+	}
+
 	fprintf(vmain, "\t// Outputs of the FFT, ready for bit reversal.\n");
 	fprintf(vmain, "\twire\t\t\t\tbr_sync;\n");
 	if (single_clock)
 		fprintf(vmain, "\twire\t[(2*OWIDTH-1):0]\tbr_result;\n");
+	else if (nlanes > 2)
+		fprintf(vmain, "\twire\t[(NLANES*2*OWIDTH-1):0]\tbr_result;\n");
 	else
 		fprintf(vmain, "\twire\t[(2*OWIDTH-1):0]\tbr_left, br_right;\n");
+}
+// }}}
 
-	int	tmp_size = fftsize, lgtmp = lgsize;
-	if (fftsize == 2) { // Special case
-		// {{{
-		if (bitreverse) {
-			fprintf(vmain, "\treg\tbr_start;\n");
-			fprintf(vmain, "\tinitial br_start = 1\'b0;\n");
-			if (async_reset) {
-				fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
-				fprintf(vmain, "\tif (!i_areset_n)\n");
-			} else {
-				fprintf(vmain, "\talways @(posedge i_clk)\n");
-				fprintf(vmain, "\tif (i_reset)\n");
-			}
-			fprintf(vmain, "\t\tbr_start <= 1\'b0;\n");
-			fprintf(vmain, "\telse if (i_ce)\n");
-			fprintf(vmain, "\t\tbr_start <= 1\'b1;\n");
-		}
-		fprintf(vmain, "\n\n");
-		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
-		if (single_clock) {
-			fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n",
-				2*nbitsout-1);
-			fprintf(vmain, "\tlaststage\t#(\n"
-				"\t\t// {{{\n"
-				"\t\t.IWIDTH(IWIDTH),\n"
-				"\t\t.OWIDTH(OWIDTH)\n"
-				"\t\t// }}}\n"
-				"\t) stage_2(\n"
-				"\t\t// {{{\n"
-				"\t\t.i_clk(i_clk),\n"
-				"\t\t.%s(%s),\n"
-				"\t\t.i_ce(i_ce),\n",
-				resetw.c_str(), resetw.c_str());
-			fprintf(vmain, "\t\t.i_sync(%s%s),\n"
-					"\t\t.i_val(i_sample),\n"
-					"\t\t.o_val(w_d2),\n"
-					"\t\t.o_sync(w_s2)\n"
-					"\t\t// }}}\n"
-					"\t);\n",
-				(async_reset)?"":"!", resetw.c_str());
+// FFTCORE::pipe_two -- the pipeline of a two point FFT, a lone laststage
+// {{{
+int	FFTCORE::pipe_two(void) {
+	// {{{
+	if (bitreverse) {
+		fprintf(vmain, "\treg\tbr_start;\n");
+		fprintf(vmain, "\tinitial br_start = 1\'b0;\n");
+		if (async_reset) {
+			fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
+			fprintf(vmain, "\tif (!i_areset_n)\n");
 		} else {
-			fprintf(vmain, "\twire\t[%d:0]\tw_e2, w_o2;\n",
-				2*nbitsout-1);
-			fprintf(vmain, "\tlaststage\t#(\n"
-				"\t\t// {{{\n"
-				"\t\t.IWIDTH(IWIDTH),\n"
-				"\t\t.OWIDTH(OWIDTH)\n"
-				"\t\t// }}}\n"
-				"\t) stage_2(\n"
-				"\t\t.i_clk(i_clk),\n"
-				"\t\t.%s(%s),\n"
-				"\t\t.i_ce(i_ce),\n",
-				resetw.c_str(), resetw.c_str());
-			fprintf(vmain, "\t\t.i_sync(%s%s),\n"
-					"\t\t.i_left(i_left), .i_right(i_right),\n"
-					"\t\t.o_left(w_e2), .o_right(w_o2),\n"
-					"\t\t.o_sync(w_s2)\n"
-					"\t\t// }}}\n"
-					"\t);\n",
-				(async_reset)?"":"!", resetw.c_str());
-		}
-		fprintf(vmain, "\n\n");
-		// }}}
-	} else if (fftsize == 4) { // Special case
-		// {{{
-		if (!single_clock) {
-			fprintf(stderr, "ERR: The two-clocks per sample FFT does not support 4-pt FFTs\n");
-			exit(EXIT_FAILURE);
-		}
-
-		if (bitreverse) {
-			fprintf(vmain, "\treg\tbr_start;\n");
-			fprintf(vmain, "\tinitial br_start = 1\'b0;\n");
-			if (async_reset) {
-				fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
-				fprintf(vmain, "\tif (!i_areset_n)\n");
-			} else {
-				fprintf(vmain, "\talways @(posedge i_clk)\n");
-				fprintf(vmain, "\tif (i_reset)\n");
-			}
-			fprintf(vmain, "\t\tbr_start <= 1\'b0;\n");
-			fprintf(vmain, "\telse if (i_ce)\n");
-			fprintf(vmain, "\t\tbr_start <= 1\'b1;\n");
+			fprintf(vmain, "\talways @(posedge i_clk)\n");
+			fprintf(vmain, "\tif (i_reset)\n");
 		}
-		fprintf(vmain, "\n\n");
-		fprintf(vmain, "\twire\t\tw_s4;\n");
-		fprintf(vmain, "\twire\t[%d:0]\tw_d4;\n", 2*nbitsout-1);
-		fprintf(vmain, "\tqtrstage\t#(\n"
-				"\t\t// {{{\n"
-				"\t\t.IWIDTH(IWIDTH),\n"
-				"\t\t.OWIDTH(OWIDTH)\n"
+		fprintf(vmain, "\t\tbr_start <= 1\'b0;\n");
+		fprintf(vmain, "\telse if (i_ce)\n");
+		fprintf(vmain, "\t\tbr_start <= 1\'b1;\n");
+	}
+	fprintf(vmain, "\n\n");
+	fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
+	if (single_clock) {
+		fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n",
+			2*nbitsout-1);
+		fprintf(vmain, "\tlaststage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(IWIDTH),\n"
+			"\t\t.OWIDTH(OWIDTH)\n"
+			"\t\t// }}}\n"
+			"\t) stage_2(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			resetw.c_str(), resetw.c_str());
+		fprintf(vmain, "\t\t.i_sync(%s%s),\n"
+				"\t\t.i_val(i_sample),\n"
+				"\t\t.o_val(w_d2),\n"
+				"\t\t.o_sync(w_s2)\n"
 				"\t\t// }}}\n"
-				"\t) stage_4(\n"
-				"\t\t// {{{\n"
-				"\t\t.i_clk(i_clk),\n"
-				"\t\t.%s(%s),\n"
-				"\t\t.i_ce(i_ce),\n",
-				resetw.c_str(), resetw.c_str());
+				"\t);\n",
+			(async_reset)?"":"!", resetw.c_str());
+	} else {
+		fprintf(vmain, "\twire\t[%d:0]\tw_e2, w_o2;\n",
+			2*nbitsout-1);
+		fprintf(vmain, "\tlaststage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(IWIDTH),\n"
+			"\t\t.OWIDTH(OWIDTH)\n"
+			"\t\t// }}}\n"
+			"\t) stage_2(\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			resetw.c_str(), resetw.c_str());
 		fprintf(vmain, "\t\t.i_sync(%s%s),\n"
-				"\t\t.i_data(i_sample),\n"
-				"\t\t.o_data(w_d4),\n"
-				"\t\t.o_sync(w_s4)\n"
+				"\t\t.i_left(i_left), .i_right(i_right),\n"
+				"\t\t.o_left(w_e2), .o_right(w_o2),\n"
+				"\t\t.o_sync(w_s2)\n"
 				"\t\t// }}}\n"
 				"\t);\n",
 			(async_reset)?"":"!", resetw.c_str());
-		fprintf(vmain, "\n\n");
+	}
+	est_laststage(est, "stage_2", nbitsin, nbitsout, 0);
+	fprintf(vmain, "\n\n");
+	// }}}
 
-		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
-		fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n", 2*nbitsout-1);
-		fprintf(vmain, "\tlaststage\t#(\n"
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_dit -- the pipeline of a decimation in time FFT (-t)
+// {{{
+int	FFTCORE::pipe_dit(void) {
+	// Nonzero if any file failed to be written
+	int	wrerr = 0;
+
+	// {{{
+	// The stages run in the reverse order of the decimation in
+	// frequency FFT: a span two stage first, followed by stages of
+	// span 4, 8, 16, etc.  Each stage (other than the span four
+	// stage, whose twiddle is just a rotation) first multiplies
+	// its second half by W_span^k in a twidstage, and then
+	// applies a multiplier free bf2stage butterfly.
+	int	nbits = nbitsin, dropbit = 0, obits, owidth;
+	std::string	cmem, fname;
+	FILE	*cmemfp;
+
+	// The first stage, of span two
+	// {{{
+	obits = nbits+1+xtrapbits;
+	if ((maxbitsout > 0)&&(obits > maxbitsout))
+		obits = maxbitsout;
+
+	fprintf(vmain, "\n\n");
+	fprintf(vmain, "\twire\t\tw_s2;\n");
+	fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n", 2*(obits+xtrapbits)-1);
+	fprintf(vmain, "\tlaststage\t#(\n"
+		"\t\t// {{{\n"
+		"\t\t.IWIDTH(IWIDTH),\n"
+		"\t\t.OWIDTH(%d),\n"
+		"\t\t.SHIFT(0)\n"
+		"\t\t// }}}\n"
+		"\t) stage_2(\n"
+		"\t\t// {{{\n"
+		"\t\t.i_clk(i_clk),\n"
+		"\t\t.%s(%s),\n"
+		"\t\t.i_ce(i_ce),\n",
+		obits+xtrapbits, resetw.c_str(), resetw.c_str());
+	fprintf(vmain, "\t\t.i_sync(%s%s),\n"
+		"\t\t.i_val(i_sample),\n"
+		"\t\t.o_val(w_d2),\n"
+		"\t\t.o_sync(w_s2)\n"
+		"\t\t// }}}\n"
+		"\t);\n",
+		(async_reset)?"":"!", resetw.c_str());
+	est_laststage(est, "stage_2", nbitsin, obits+xtrapbits, 0);
+
+	nbits = obits;
+	// }}}
+
+	// Every following stage
+	// {{{
+	for(int span=4; span <= fftsize; span <<= 1) {
+		int	lgspan = lgval(span);
+		char	isync[32], idata[32];
+
+		sprintf(isync, "w_s%d", span>>1);
+		sprintf(idata, "w_d%d", span>>1);
+
+		// The twiddle multiply
+		// {{{
+		if (span > 4) {
+			// Counted from the end of the pipeline, as
+			// with every other multiplying stage
+			bool	mpystage = mpy_hwunit(mpyplan,
+					mpy_units, lgsize-lgspan+1);
+
+			fprintf(vmain, "\n");
+			if (mpystage)
+				fprintf(vmain, "\t// A hardware optimized twiddle stage\n");
+			fprintf(vmain, "\twire\t\tw_ts%d;\n", span);
+			fprintf(vmain, "\twire\t[%d:0]\tw_td%d;\n",
+				2*(nbits+xtrapbits)-1, span);
+			cmem = gen_twiddle_fname(coredir.c_str(), span, 1, inverse);
+			cmemfp = gen_coeff_open(cmem.c_str());
+			gen_twiddles(cmemfp, span,
+				nbits+xtracbits+xtrapbits, 1, inverse);
+			cmem = gen_twiddle_fname(EMPTYSTR, span, 1, inverse);
+			fprintf(vmain, "\ttwidstage\t#(\n"
 				"\t\t// {{{\n"
-				"\t\t.IWIDTH(OWIDTH),\n"
-				"\t\t.OWIDTH(OWIDTH)\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.CWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.LGWIDTH(%d),\n"
+				"\t\t.SHIFT(1),\n"
+				"\t\t.OPT_HWMPY(%d),\n"
+				"\t\t.CKPCE(%d),\n"
+				"\t\t.COEFFILE(\"%s\")\n"
 				"\t\t// }}}\n"
-				"\t) stage_2(\n"
+				"\t) stage_t%d(\n"
 				"\t\t// {{{\n"
 				"\t\t.i_clk(i_clk),\n"
 				"\t\t.%s(%s),\n"
 				"\t\t.i_ce(i_ce),\n",
-				resetw.c_str(),
-				resetw.c_str());
-		fprintf(vmain, "\t\t.i_sync(w_s4),\n"
-				"\t\t.i_val(w_d4),\n"
-				"\t\t.o_val(w_d2),\n"
-				"\t\t.o_sync(w_s2)\n"
+				nbits+xtrapbits,
+				nbits+xtracbits+xtrapbits,
+				nbits+xtrapbits, lgspan,
+				(mpystage)?1:0, ckpce, cmem.c_str(),
+				span, resetw.c_str(), resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(%s),\n"
+				"\t\t.i_data(%s),\n"
+				"\t\t.o_data(w_td%d),\n"
+				"\t\t.o_sync(w_ts%d)\n"
 				"\t\t// }}}\n"
-				"\t);\n");
+				"\t);\n",
+				isync, idata, span, span);
+			est_twidstage(est,
+				"stage_t" + std::to_string(span),
+				nbits+xtrapbits,
+				nbits+xtracbits+xtrapbits,
+				lgspan, mpystage, ckpce);
+
+			sprintf(isync, "w_ts%d", span);
+			sprintf(idata, "w_td%d", span);
+		}
 		// }}}
-	} else { // General case -- build the FFT stages
-		// {{{
-		int	nbits = nbitsin, dropbit=0;
-		int	obits = nbits+1+xtrapbits;
-		std::string	cmem;
-		FILE	*cmemfp;
 
+		// The butterfly
+		// {{{
+		obits = nbits+((dropbit)?0:1);
+		if ((span == fftsize)&&(obits > nbitsout))
+			obits = nbitsout;
 		if ((maxbitsout > 0)&&(obits > maxbitsout))
 			obits = maxbitsout;
+		// The final stage drops any extra bits
+		owidth = (span == fftsize) ? obits : obits+xtrapbits;
+
+		fprintf(vmain, "\n");
+		fprintf(vmain, "\twire\t\tw_s%d;\n", span);
+		fprintf(vmain, "\twire\t[%d:0]\tw_d%d;\n",
+			2*owidth-1, span);
+		fprintf(vmain, "\tbf2stage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(%d),\n"
+			"\t\t.OWIDTH(%d),\n"
+			"\t\t.LGSPAN(%d),\n"
+			"\t\t.SHIFT(0),\n"
+			"\t\t.ROTATE(%d),\n"
+			"\t\t.INVERSE(%d),\n"
+			"\t\t.PREROTATE(%d)\n"
+			"\t\t// }}}\n"
+			"\t) stage_%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			nbits+xtrapbits, owidth, lgspan-1,
+			(span == 4)?1:0, (inverse)?1:0,
+			(span == 4)?1:0, span,
+			resetw.c_str(), resetw.c_str());
+		fprintf(vmain, "\t\t.i_sync(%s),\n"
+			"\t\t.i_data(%s),\n"
+			"\t\t.o_data(w_d%d),\n"
+			"\t\t.o_sync(w_s%d)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+			isync, idata, span, span);
+		est_bf2stage(est, "stage_" + std::to_string(span),
+			nbits+xtrapbits, owidth, lgspan-1);
+
+		dropbit ^= 1;
+		nbits = obits;
+		// }}}
+	}
+	// }}}
+
+	// Build the logic for the stages
+	// {{{
+	fname = coredir + "/bf2stage.v";
+	wrerr |= build_bf2stage(fname.c_str(), rounding, async_reset);
+	if (fftsize > 4) {
+		fname = coredir + "/twidstage.v";
+		wrerr |= build_twidstage(fname.c_str(), async_reset);
+	}
+	// }}}
+
+	fprintf(vmain, "\n\n");
+	// }}}
+
+	return (wrerr) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_four -- the pipeline of a four point FFT
+// {{{
+int	FFTCORE::pipe_four(void) {
+	// {{{
+	if (!single_clock) {
+		fprintf(stderr, "ERR: The two-clocks per sample FFT does not support 4-pt FFTs\n");
+		return EXIT_FAILURE;
+	}
+
+	if (bitreverse) {
+		fprintf(vmain, "\treg\tbr_start;\n");
+		fprintf(vmain, "\tinitial br_start = 1\'b0;\n");
+		if (async_reset) {
+			fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
+			fprintf(vmain, "\tif (!i_areset_n)\n");
+		} else {
+			fprintf(vmain, "\talways @(posedge i_clk)\n");
+			fprintf(vmain, "\tif (i_reset)\n");
+		}
+		fprintf(vmain, "\t\tbr_start <= 1\'b0;\n");
+		fprintf(vmain, "\telse if (i_ce)\n");
+		fprintf(vmain, "\t\tbr_start <= 1\'b1;\n");
+	}
+	fprintf(vmain, "\n\n");
+	fprintf(vmain, "\twire\t\tw_s4;\n");
+	fprintf(vmain, "\twire\t[%d:0]\tw_d4;\n", 2*nbitsout-1);
+	fprintf(vmain, "\tqtrstage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(IWIDTH),\n"
+			"\t\t.OWIDTH(OWIDTH)\n"
+			"\t\t// }}}\n"
+			"\t) stage_4(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			resetw.c_str(), resetw.c_str());
+	fprintf(vmain, "\t\t.i_sync(%s%s),\n"
+			"\t\t.i_data(i_sample),\n"
+			"\t\t.o_data(w_d4),\n"
+			"\t\t.o_sync(w_s4)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+		(async_reset)?"":"!", resetw.c_str());
+	fprintf(vmain, "\n\n");
+
+	fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
+	fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n", 2*nbitsout-1);
+	fprintf(vmain, "\tlaststage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(OWIDTH),\n"
+			"\t\t.OWIDTH(OWIDTH)\n"
+			"\t\t// }}}\n"
+			"\t) stage_2(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			resetw.c_str(),
+			resetw.c_str());
+	fprintf(vmain, "\t\t.i_sync(w_s4),\n"
+			"\t\t.i_val(w_d4),\n"
+			"\t\t.o_val(w_d2),\n"
+			"\t\t.o_sync(w_s2)\n"
+			"\t\t// }}}\n"
+			"\t);\n");
+	est_qtrstage(est, "stage_4", nbitsin, nbitsout);
+	est_laststage(est, "stage_2", nbitsout, nbitsout, 0);
+	// }}}
+
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_lanes -- the pipeline of an FFT taking four or eight samples
+// per clock (-4, -8)
+// {{{
+int	FFTCORE::pipe_lanes(void) {
+	// Nonzero if any file failed to be written
+	int	wrerr = 0;
+
+	// {{{
+	// Lane p carries samples p, p+P, p+2P, etc.  So long as the
+	// span of a stage is at least 2P, both halves of every
+	// butterfly are found on the same lane, and each lane can be
+	// handled by its own fftstage--using only every P'th
+	// coefficient.  The stage of span 2P pairs consecutive samples
+	// within a lane, and so needs only one (constant) coefficient
+	// per lane.  All stages after that pair up samples from
+	// different lanes, but on the same clock.
+	int	nbits = nbitsin, dropbit = 0, obits = 0;
+	const int	lglanes = lgval(nlanes);
+	bool		first = true;
+	std::string	cmem;
+	FILE		*cmemfp;
+	char		isync[32], idata[64];
+	int		luts;
 
-		// Always do a first stage
+	fprintf(vmain, "\n\n");
+	while(tmp_size >= 2*nlanes) {
 		// {{{
-		{
-			bool	mpystage;
+		int	iw, cw, ow;
+		bool	mpystage;
 
-			// Last two stages are always non-multiply stages
-			// since the multiplies can be done by adds
-			mpystage = ((lgtmp-2) <= mpy_stages);
+		if (first) {
+			iw = nbitsin;
+			obits = nbits+1+xtrapbits;
+			sprintf(isync, "%s%s", (async_reset)?"":"!",
+				resetw.c_str());
+		} else {
+			iw = nbits+xtrapbits;
+			obits = nbits+((dropbit)?0:1);
+			sprintf(isync, "w_s%d", tmp_size<<1);
+		}
+		if ((maxbitsout > 0)&&(obits > maxbitsout))
+			obits = maxbitsout;
+		cw = iw + xtracbits;
+		ow = obits + xtrapbits;
+
+		mpystage = mpy_hwunit(mpyplan, mpy_units,
+					lgtmp-lglanes-1);
+		if ((mpystage)&&(tmp_size > 2*nlanes))
+			fprintf(vmain, "\t// A hardware optimized FFT stage\n");
+		fprintf(vmain, "\twire\t\tw_s%d;\n", tmp_size);
+		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t");
+		for(int p=1; p<nlanes; p++)
+			fprintf(vmain, "%sw_s%d_%d", (p>1)?", ":"",
+				tmp_size, p);
+		fprintf(vmain, ";\n\t// verilator lint_on  UNUSED\n");
+		fprintf(vmain, "\twire\t[%d:0]\t", 2*ow-1);
+		for(int p=0; p<nlanes; p++)
+			fprintf(vmain, "%sw_d%d_%d", (p>0)?", ":"",
+				tmp_size, p);
+		fprintf(vmain, ";\n");
+
+		luts = 0;
+		for(int p=0; p<nlanes; p++) {
+			char	osync[32];
+
+			if (first)
+				sprintf(idata, "i_sample[%d:%d]",
+					2*nbitsin*(nlanes-p)-1,
+					2*nbitsin*(nlanes-p-1));
+			else
+				sprintf(idata, "w_d%d_%d", tmp_size<<1, p);
+			if (p == 0)
+				sprintf(osync, "w_s%d", tmp_size);
+			else
+				sprintf(osync, "w_s%d_%d", tmp_size, p);
 
-			fprintf(vmain, "\n\n");
-			if (mpystage)
-				fprintf(vmain, "\t// A hardware optimized FFT stage\n");
-			fprintf(vmain, "\twire\t\tw_s%d;\n", fftsize);
-			if (single_clock) {
+			if (tmp_size > 2*nlanes) {
 				// {{{
-				fprintf(vmain, "\twire\t[%d:0]\tw_d%d;\n", 2*(obits+xtrapbits)-1, fftsize);
-				cmem = gen_coeff_fname(coredir.c_str(), fftsize, 1, 0, inverse);
+				cmem = gen_coeff_fname(coredir.c_str(), tmp_size, nlanes, p, inverse);
 				cmemfp = gen_coeff_open(cmem.c_str());
-				gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 1, 0, inverse);
-				cmem = gen_coeff_fname(EMPTYSTR, fftsize, 1, 0, inverse);
-				fprintf(vmain, "\tfftstage%s\t#(\n"
+				gen_coeffs(cmemfp, tmp_size, cw, nlanes, p, inverse);
+				cmem = gen_coeff_fname(EMPTYSTR, tmp_size, nlanes, p, inverse);
+
+				fprintf(vmain, "\tfftstage\t#(\n"
 					"\t\t// {{{\n"
-					"\t\t.IWIDTH(IWIDTH),\n"
-					"\t\t.CWIDTH(IWIDTH+%d),\n"
+					"\t\t.IWIDTH(%d),\n"
+					"\t\t.CWIDTH(%d),\n"
 					"\t\t.OWIDTH(%d),\n"
 					"\t\t.LGSPAN(%d),\n"
 					"\t\t.BFLYSHIFT(0),\n"
@@ -1833,592 +2882,1713 @@ SLASHLINE
 					"\t\t.CKPCE(%d),\n"
 					"\t\t.COEFFILE(\"%s\")\n"
 					"\t\t// }}}\n"
-					"\t) stage_%d(\n"
-					"\t\t// {{{\n"
-					"\t\t.i_clk(i_clk),\n"
-					"\t\t.%s(%s),\n"
-					"\t\t.i_ce(i_ce),\n",
-					((dbg)&&(dbgstage == fftsize))?"_dbg":"",
-					xtracbits, obits+xtrapbits,
-					lgtmp-1, (mpystage)?1:0,
-					ckpce, cmem.c_str(),
-					fftsize, resetw.c_str(), resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(%s%s),\n"
-					"\t\t.i_data(i_sample),\n"
-					"\t\t.o_data(w_d%d),\n"
-					"\t\t.o_sync(w_s%d%s)\n"
-					"\t\t// }}}\n"
-					"\t);\n",
-					(async_reset)?"":"!", resetw.c_str(),
-					fftsize, fftsize,
-					((dbg)&&(dbgstage == fftsize))
-						? ", o_dbg":"");
+					"\t) stage_%d_%d(\n",
+					iw, cw, ow, lgtmp-1-lglanes,
+					(mpystage)?1:0, ckpce, cmem.c_str(),
+					tmp_size, p);
 				// }}}
 			} else {
 				// {{{
-				fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os%d;\n\t// verilator lint_on  UNUSED\n", fftsize);
-				fprintf(vmain, "\twire\t[%d:0]\tw_e%d, w_o%d;\n", 2*(obits+xtrapbits)-1, fftsize, fftsize);
-				cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 0, inverse);
-				cmemfp = gen_coeff_open(cmem.c_str());
-				gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 2, 0, inverse);
-				cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 0, inverse);
-				fprintf(vmain, "\tfftstage%s\t#(\n"
-					"\t\t// {{{\n"
-					"\t\t.IWIDTH(IWIDTH),\n"
-					"\t\t.CWIDTH(IWIDTH+%d),\n"
-					"\t\t.OWIDTH(%d),\n"
-					"\t\t.LGSPAN(%d),\n"
-					"\t\t.BFLYSHIFT(0),\n"
-					"\t\t.OPT_HWMPY(%d),\n"
-					"\t\t.CKPCE(%d),\n"
-					"\t\t.COEFFILE(\"%s\")\n"
-					"\t\t// }}}\n"
-					"\t) stage_e%d(\n"
-					"\t\t// {{{\n"
-					"\t\t.i_clk(i_clk),\n"
-					"\t\t.%s(%s),\n"
-					"\t\t.i_ce(i_ce),\n",
-					((dbg)&&(dbgstage == fftsize))?"_dbg":"",
-					xtracbits, obits+xtrapbits,
-					lgtmp-2, (mpystage)?1:0,
-					ckpce, cmem.c_str(),
-					fftsize, resetw.c_str(),
-					resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(%s%s),\n"
-					"\t\t.i_data(i_left),\n"
-					"\t\t.o_data(w_e%d),\n"
-					"\t\t.o_sync(w_s%d%s)\n"
-					"\t\t// }}}\n"
-					"\t);\n",
-					(async_reset)?"":"!", resetw.c_str(),
-					fftsize, fftsize,
-					((dbg)&&(dbgstage == fftsize))?", o_dbg":"");
-				cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 1, inverse);
-				cmemfp = gen_coeff_open(cmem.c_str());
-				gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 2, 1, inverse);
-				cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 1, inverse);
-				fprintf(vmain, "\tfftstage\t#(\n"
+				long long	cr, ci;
+
+				gen_coeff_value(tmp_size, p, cw, inverse,
+					&cr, &ci);
+				luts += crossbfly_luts(cr, ci, iw, cw);
+				fprintf(vmain, "\tlanestage\t#(\n"
 					"\t\t// {{{\n"
-					"\t\t.IWIDTH(IWIDTH),\n"
-					"\t\t.CWIDTH(IWIDTH+%d),\n"
+					"\t\t.IWIDTH(%d),\n"
+					"\t\t.CWIDTH(%d),\n"
 					"\t\t.OWIDTH(%d),\n"
-					"\t\t.LGSPAN(%d),\n"
-					"\t\t.BFLYSHIFT(0),\n"
-					"\t\t.OPT_HWMPY(%d),\n"
-					"\t\t.CKPCE(%d),\n"
-					"\t\t.COEFFILE(\"%s\")\n"
-					"\t\t// }}}\n"
-					"\t) stage_o%d(\n"
-					"\t\t// {{{\n"
-					"\t\t.i_clk(i_clk),\n"
-					"\t\t.%s(%s),\n"
-					"\t\t.i_ce(i_ce),\n",
-					xtracbits, obits+xtrapbits,
-					lgtmp-2, (mpystage)?1:0,
-					ckpce, cmem.c_str(),
-					fftsize, resetw.c_str(),
-					resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(%s%s),\n"
-					"\t\t.i_data(i_right),\n"
-					"\t\t.o_data(w_o%d),\n"
-					"\t\t.o_sync(w_os%d)\n"
+					"\t\t.SHIFT(0),\n"
+					"\t\t.COEF_R(%lld),\n"
+					"\t\t.COEF_I(%lld)\n"
 					"\t\t// }}}\n"
-					"\t);\n",
-					(async_reset)?"":"!",resetw.c_str(),
-					fftsize, fftsize);
+					"\t) stage_%d_%d(\n",
+					iw, cw, ow, cr, ci, tmp_size, p);
 				// }}}
 			}
+			fprintf(vmain, "\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n"
+				"\t\t.i_sync(%s),\n"
+				"\t\t.i_data(%s),\n"
+				"\t\t.o_data(w_d%d_%d),\n"
+				"\t\t.o_sync(%s)\n"
+				"\t\t// }}}\n"
+				"\t);\n\n",
+				resetw.c_str(), resetw.c_str(),
+				isync, idata, tmp_size, p, osync);
+		}
 
-			// Build the logic for the FFT stage
-			// {{{
-			std::string	fname;
-
-			fname = coredir + "/";
-			if (inverse)
-				fname += "i";
-			fname += "fftstage";
-			if (dbg) {
-				std::string	dbgname(fname);
-				dbgname += "_dbg";
-				dbgname += ".v";
-				if (single_clock)
-					build_stage(fname.c_str(), fftsize, 1, 0, nbits, xtracbits, ckpce, async_reset, true);
-				else
-					build_stage(fname.c_str(), fftsize, 2, 1, nbits, xtracbits, ckpce, async_reset, true);
-			}
+		if (tmp_size > 2*nlanes)
+			est_fftstage(est, "stage_"+std::to_string(tmp_size),
+				nlanes, iw, cw, ow, lgtmp-1-lglanes,
+				mpystage, ckpce);
+		else
+			est_lanestage(est,
+				"stage_"+std::to_string(tmp_size),
+				tmp_size, iw, cw, ow, luts);
 
-			fname += ".v";
-			if (single_clock) {
-				build_stage(fname.c_str(), fftsize, 1, 0,
-					nbits, xtracbits, ckpce, async_reset,
-					false);
-			} else {
-				// All stages use the same Verilog, so we only
-				// need to build one
-				build_stage(fname.c_str(), fftsize, 2, 1,
-					nbits, xtracbits, ckpce, async_reset, false);
-			}
-			// }}}
-		}
+		if (!first)
+			dropbit ^= 1;
+		first = false;
+		nbits = obits;
+		tmp_size >>= 1; lgtmp--;
 		// }}}
+	}
 
-		// Build all following stages, up to the two last ones
+	while(tmp_size >= 2) {
 		// {{{
-		nbits = obits;	// New number of input bits
-		tmp_size >>= 1; lgtmp--;
-		dropbit = 0;
-		fprintf(vmain, "\n\n");
-		while(tmp_size >= 8) {
-			obits = nbits+((dropbit)?0:1);
-
-			if ((maxbitsout > 0)&&(obits > maxbitsout))
-				obits = maxbitsout;
+		const bool	last = (tmp_size == 2);
+		int	iw, cw, ow;
 
-			{
-				bool		mpystage;
-
-				mpystage = ((lgtmp-2) <= mpy_stages);
-
-				if (mpystage)
-					fprintf(vmain, "\t// A hardware optimized FFT stage\n");
-				fprintf(vmain, "\twire\t\tw_s%d;\n",
-					tmp_size);
-				if (single_clock) {
-					// {{{
-					fprintf(vmain,"\twire\t[%d:0]\tw_d%d;\n",
-						2*(obits+xtrapbits)-1,
-						tmp_size);
-					cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 1, 0, inverse);
-					cmemfp = gen_coeff_open(cmem.c_str());
-					gen_coeffs(cmemfp, tmp_size,
-						nbits+xtracbits+xtrapbits, 1, 0, inverse);
-					cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 1, 0, inverse);
-					fprintf(vmain, "\tfftstage%s\t#(\n"
-						"\t\t// {{{\n"
-						"\t\t.IWIDTH(%d),\n"
-						"\t\t.CWIDTH(%d),\n"
-						"\t\t.OWIDTH(%d),\n"
-						"\t\t.LGSPAN(%d),\n"
-						"\t\t.BFLYSHIFT(%d),\n"
-						"\t\t.OPT_HWMPY(%d),\n"
-						"\t\t.CKPCE(%d),\n"
-						"\t\t.COEFFILE(\"%s\")\n"
-						"\t\t// }}}\n"
-						"\t) stage_%d(\n"
-						"\t\t// {{{\n"
-						"\t\t.i_clk(i_clk),\n"
-						"\t\t.%s(%s),\n"
-						"\t\t.i_ce(i_ce),\n",
-						((dbg)&&(dbgstage==tmp_size))?"_dbg":"",
-						nbits+xtrapbits,
-						nbits+xtracbits+xtrapbits,
-						obits+xtrapbits,
-						lgtmp-1, (dropbit)?0:0, (mpystage)?1:0,
-						ckpce,
-						cmem.c_str(), tmp_size,
-						resetw.c_str(),
-						resetw.c_str());
-					fprintf(vmain, "\t\t.i_sync(w_s%d),\n"
-						"\t\t.i_data(w_d%d),\n"
-						"\t\t.o_data(w_d%d),\n"
-						"\t\t.o_sync(w_s%d%s)\n"
-						"\t\t// }}}\n"
-						"\t);\n",
-						tmp_size<<1, tmp_size<<1,
-						tmp_size, tmp_size,
-						((dbg)&&(dbgstage == tmp_size))
-							?", o_dbg":"");
-					// }}}
-				} else {
-					// {{{
-					fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os%d;\n\t// verilator lint_on  UNUSED\n",
-						tmp_size);
-					fprintf(vmain,"\twire\t[%d:0]\tw_e%d, w_o%d;\n",
-						2*(obits+xtrapbits)-1,
-						tmp_size, tmp_size);
-					cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 2, 0, inverse);
-					cmemfp = gen_coeff_open(cmem.c_str());
-					gen_coeffs(cmemfp, tmp_size,
-						nbits+xtracbits+xtrapbits, 2, 0, inverse);
-					cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 2, 0, inverse);
-					fprintf(vmain, "\tfftstage%s\t#(\n"
-						"\t\t// {{{\n"
-						"\t\t.IWIDTH(%d),\n"
-						"\t\t.CWIDTH(%d),\n"
-						"\t\t.OWIDTH(%d),\n"
-						"\t\t.LGSPAN(%d),\n"
-						"\t\t.BFLYSHIFT(%d),\n"
-						"\t\t.OPT_HWMPY(%d),\n"
-						"\t\t.CKPCE(%d),\n"
-						"\t\t.COEFFILE(\"%s\")\n"
-						"\t\t// }}}\n"
-						"\t) stage_e%d(\n"
-						"\t\t// {{{\n"
-						"\t\t.i_clk(i_clk),\n"
-						"\t\t.%s(%s),\n"
-						"\t\t.i_ce(i_ce),\n",
-						((dbg)&&(dbgstage==tmp_size))?"_dbg":"",
-						nbits+xtrapbits,
-						nbits+xtracbits+xtrapbits,
-						obits+xtrapbits,
-						lgtmp-2, (dropbit)?0:0, (mpystage)?1:0,
-						ckpce,
-						cmem.c_str(), tmp_size,
-						resetw.c_str(),
-						resetw.c_str());
-					fprintf(vmain, "\t\t.i_sync(w_s%d),\n"
-						"\t\t.i_data(w_e%d),\n"
-						"\t\t.o_data(w_e%d),\n"
-						"\t\t.o_sync(w_s%d%s)\n"
-						"\t\t// }}}\n"
-						"\t);\n",
-						tmp_size<<1, tmp_size<<1,
-						tmp_size, tmp_size,
-						((dbg)&&(dbgstage == tmp_size))
-							?", o_dbg":"");
-					cmem = gen_coeff_fname(coredir.c_str(),
-						tmp_size, 2, 1, inverse);
-					cmemfp = gen_coeff_open(cmem.c_str());
-					gen_coeffs(cmemfp, tmp_size,
-						nbits+xtracbits+xtrapbits,
-						2, 1, inverse);
-					cmem = gen_coeff_fname(EMPTYSTR,
-						tmp_size, 2, 1, inverse);
-					fprintf(vmain, "\tfftstage\t#(\n"
-						"\t\t// {{{\n"
-						"\t\t.IWIDTH(%d),\n"
-						"\t\t.CWIDTH(%d),\n"
-						"\t\t.OWIDTH(%d),\n"
-						"\t\t.LGSPAN(%d),\n"
-						"\t\t.BFLYSHIFT(%d),\n"
-						"\t\t.OPT_HWMPY(%d),\n"
-						"\t\t.CKPCE(%d),\n"
-						"\t\t.COEFFILE(\"%s\")\n"
-						"\t\t// }}}\n"
-						"\n) \tstage_o%d(\n"
-						"\t\t// {{{\n"
-						"\t\t.i_clk(i_clk),\n"
-						"\t\t.%s(%s),\n"
-						"\t\t.i_ce(i_ce),\n",
-						nbits+xtrapbits,
-						nbits+xtracbits+xtrapbits,
-						obits+xtrapbits,
-						lgtmp-2, (dropbit)?0:0, (mpystage)?1:0,
-						ckpce, cmem.c_str(), tmp_size,
-						resetw.c_str(),
-						resetw.c_str());
-					fprintf(vmain, "\t\t.i_sync(w_s%d),\n"
-						"\t\t.i_data(w_o%d),\n"
-						"\t\t.o_data(w_o%d),\n"
-						"\t\t.o_sync(w_os%d)\n"
-						"\t\t// }}}\n"
-						"\t);\n",
-						tmp_size<<1, tmp_size<<1,
-						tmp_size, tmp_size);
-					// }}}
-				}
-				fprintf(vmain, "\n");
-			}
+		obits = nbits+((dropbit)?0:1);
+		if ((last)&&(obits > nbitsout))
+			obits = nbitsout;
+		if ((maxbitsout > 0)&&(obits > maxbitsout))
+			obits = maxbitsout;
+		iw = nbits+xtrapbits;
+		cw = iw + xtracbits;
+		ow = (last) ? obits : (obits + xtrapbits);
 
+		if (last)
+			fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
+		else
+			fprintf(vmain, "\twire\t\tw_s%d;\n", tmp_size);
+		fprintf(vmain, "\twire\t[%d:0]\t", 2*ow-1);
+		for(int p=0; p<nlanes; p++)
+			fprintf(vmain, "%sw_d%d_%d", (p>0)?", ":"",
+				tmp_size, p);
+		fprintf(vmain, ";\n");
+
+		luts = 0;
+		for(int p=0; p<nlanes; p++) {
+			long long	cr, ci;
+			int		n = p % tmp_size, q = p + tmp_size/2;
+
+			if (n >= tmp_size/2)
+				continue;
+
+			gen_coeff_value(tmp_size, n, cw, inverse,
+					&cr, &ci);
+			luts += crossbfly_luts(cr, ci, iw, cw);
+			fprintf(vmain, "\tcrossbfly\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.CWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.SHIFT(%d),\n"
+				"\t\t.COEF_R(%lld),\n"
+				"\t\t.COEF_I(%lld)\n"
+				"\t\t// }}}\n"
+				"\t) stage_%d_%d(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n"
+				"\t\t.i_left(w_d%d_%d),\n"
+				"\t\t.i_right(w_d%d_%d),\n",
+				iw, cw, ow,
+				(last) ? ((dropbit)?0:1) : 0,
+				cr, ci, tmp_size, p,
+				resetw.c_str(), resetw.c_str(),
+				tmp_size<<1, p, tmp_size<<1, q);
+			if (p == 0)
+				fprintf(vmain, "\t\t.i_aux(w_s%d),\n",
+					tmp_size<<1);
+			else
+				fprintf(vmain, "\t\t.i_aux(1\'b0),\n");
+			fprintf(vmain, "\t\t.o_left(w_d%d_%d),\n"
+				"\t\t.o_right(w_d%d_%d),\n",
+				tmp_size, p, tmp_size, q);
+			if (p == 0)
+				fprintf(vmain, "\t\t.o_aux(w_s%d)\n",
+					tmp_size);
+			else
+				fprintf(vmain, "\t\t// verilator lint_off PINCONNECTEMPTY\n"
+					"\t\t.o_aux()\n"
+					"\t\t// verilator lint_on  PINCONNECTEMPTY\n");
+			fprintf(vmain, "\t\t// }}}\n\t);\n\n");
+		}
+		est_crossbfly(est, "stage_"+std::to_string(tmp_size),
+			tmp_size, iw, cw, ow,
+			(last) ? ((dropbit)?0:1) : 0, luts);
 
+		if (!last)
 			dropbit ^= 1;
-			nbits = obits;
-			tmp_size >>= 1; lgtmp--;
+		nbits = obits;
+		tmp_size >>= 1; lgtmp--;
+		// }}}
+	}
+
+	// Gather the lanes back together
+	fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n"
+		"\tassign\tw_d2 = { ", 2*nlanes*nbits-1);
+	for(int p=0; p<nlanes; p++)
+		fprintf(vmain, "%sw_d2_%d", (p>0)?", ":"", p);
+	fprintf(vmain, " };\n\n");
+
+	// Build the logic for the stages
+	// {{{
+	{
+		std::string	fname;
+
+		fname = coredir + "/";
+		if (inverse)
+			fname += "i";
+		fname += "fftstage.v";
+		wrerr |= build_stage(fname.c_str(), fftsize, nlanes, 0,
+			nbitsin, xtracbits, ckpce, async_reset, false);
+		fname = coredir + "/lanestage.v";
+		wrerr |= build_lanestage(fname.c_str(), async_reset);
+		fname = coredir + "/crossbfly.v";
+		wrerr |= build_crossbfly(fname.c_str(), rounding, async_reset);
+	}
+	// }}}
+
+	if (bitreverse) {	// Prep for bit reversal
+		// {{{
+		fprintf(vmain, "\twire\tbr_start;\n");
+		fprintf(vmain, "\treg\tr_br_started;\n");
+		fprintf(vmain, "\tinitial\tr_br_started = 1\'b0;\n");
+		if (async_reset) {
+			fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
+			fprintf(vmain, "\tif (!i_areset_n)\n");
+		} else {
+			fprintf(vmain, "\talways @(posedge i_clk)\n");
+			fprintf(vmain, "\tif (i_reset)\n");
 		}
+		fprintf(vmain, "\t\tr_br_started <= 1\'b0;\n");
+		fprintf(vmain, "\telse if (i_ce)\n");
+		fprintf(vmain, "\t\tr_br_started <= r_br_started || w_s2;\n");
+		fprintf(vmain, "\tassign\tbr_start = r_br_started || w_s2;\n");
 		// }}}
+	}
+	// }}}
 
-		// The Quarter stage : 90 degrees, adds and subtracts only
+	return (wrerr) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_sdf -- the pipeline of a radix-2 single path delay feedback
+// FFT, taking either one (-1) or two (-2) samples per clock
+// {{{
+int	FFTCORE::pipe_sdf(void) {
+	// Nonzero if any file failed to be written
+	int	wrerr = 0;
+	std::string	cmem;
+	FILE	*cmemfp;
+
+	nbits = nbitsin; dropbit = 0;
+	obits = nbits+1+xtrapbits;
+	if ((maxbitsout > 0)&&(obits > maxbitsout))
+		obits = maxbitsout;
+	twidusers.clear();
+
+	// The first stage
+	// {{{
+	bool	mpystage;
+
+	// Last two stages are always non-multiply stages
+	// since the multiplies can be done by adds
+	mpystage = mpy_hwunit(mpyplan, mpy_units,
+			lgtmp-((w8stage) ? 3 : 2));
+
+	fprintf(vmain, "\n\n");
+	if (mpystage)
+		fprintf(vmain, "\t// A hardware optimized FFT stage\n");
+	fprintf(vmain, "\twire\t\tw_s%d;\n", fftsize);
+	if (single_clock) {
 		// {{{
-		if (tmp_size == 4) {
-			obits = nbits+((dropbit)?0:1);
+		std::string	fmem;
+		int		lgfine = 0;
+
+		fprintf(vmain, "\twire\t[%d:0]\tw_d%d;\n", 2*(obits+xtrapbits)-1, fftsize);
+		if ((twidgen > 0)&&(lgtmp-1 >= 4)) {
+			// This stage generates its own twiddles
+			lgfine = twidgen_tables(coredir, fftsize,
+				lgtmp-1, nbitsin+xtracbits,
+				inverse, cmem, fmem);
+			twidgens.push_back({ fftsize, lgtmp-1,
+				nbitsin+xtracbits });
+		} else if (shared_rom) {
+			// The twiddles come from a twidrom
+			fprintf(vmain, "\twire\t[%d:0]\tw_ca%d;\n"
+				"\twire\t[%d:0]\tw_cc%d;\n",
+				lgtmp-2, fftsize,
+				2*(nbitsin+xtracbits)-1, fftsize);
+			twidusers.push_back({ fftsize, lgtmp-1,
+				nbitsin+xtracbits });
+		} else if (qtrwave) {
+			cmem = gen_qtrcoeff_fname(coredir.c_str(), fftsize);
+			cmemfp = gen_coeff_open(cmem.c_str());
+			gen_qtrcoeffs(cmemfp, fftsize, nbitsin+xtracbits);
+			cmem = gen_qtrcoeff_fname(EMPTYSTR, fftsize);
+		} else {
+			cmem = gen_coeff_fname(coredir.c_str(), fftsize, 1, 0, inverse);
+			cmemfp = gen_coeff_open(cmem.c_str());
+			gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 1, 0, inverse);
+			cmem = gen_coeff_fname(EMPTYSTR, fftsize, 1, 0, inverse);
+		}
+		fprintf(vmain, "\tfftstage%s\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(IWIDTH),\n"
+			"\t\t.CWIDTH(IWIDTH+%d),\n"
+			"\t\t.OWIDTH(%d),\n"
+			"\t\t.LGSPAN(%d),\n"
+			"\t\t.BFLYSHIFT(0),\n"
+			"\t\t.OPT_HWMPY(%d),\n"
+			"\t\t.CKPCE(%d)",
+			((dbg)&&(dbgstage == fftsize))?"_dbg":"",
+			xtracbits, obits+xtrapbits,
+			lgtmp-1, (mpystage)?1:0, ckpce);
+		if (qtrwave)
+			fprintf(vmain, ",\n\t\t.INVERSE(%d)",
+				(inverse)?1:0);
+		if (lgfine > 0)
+			fprintf(vmain, ",\n\t\t.OPT_TWIDGEN(1\'b1),\n"
+				"\t\t.LGFINE(%d)", lgfine);
+		if (!shared_rom)
+			fprintf(vmain, ",\n\t\t.COEFFILE(\"%s\")",
+				cmem.c_str());
+		if (lgfine > 0)
+			fprintf(vmain, ",\n\t\t.FINEFILE(\"%s\")",
+				fmem.c_str());
+		fprintf(vmain, "\n"
+			"\t\t// }}}\n"
+			"\t) stage_%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			fftsize, resetw.c_str(), resetw.c_str());
+		if (shared_rom)
+			fprintf(vmain, "\t\t.o_caddr(w_ca%d),\n"
+				"\t\t.i_coef(w_cc%d),\n",
+				fftsize, fftsize);
+		fprintf(vmain, "\t\t.i_sync(%s%s),\n"
+			"\t\t.i_data(i_sample),\n"
+			"\t\t.o_data(w_d%d),\n"
+			"\t\t.o_sync(w_s%d%s)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+			(async_reset)?"":"!", resetw.c_str(),
+			fftsize, fftsize,
+			((dbg)&&(dbgstage == fftsize))
+				? ", o_dbg":"");
+		// }}}
+	} else {
+		// {{{
+		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os%d;\n\t// verilator lint_on  UNUSED\n", fftsize);
+		fprintf(vmain, "\twire\t[%d:0]\tw_e%d, w_o%d;\n", 2*(obits+xtrapbits)-1, fftsize, fftsize);
+		cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 0, inverse);
+		cmemfp = gen_coeff_open(cmem.c_str());
+		gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 2, 0, inverse);
+		cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 0, inverse);
+		fprintf(vmain, "\tfftstage%s\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(IWIDTH),\n"
+			"\t\t.CWIDTH(IWIDTH+%d),\n"
+			"\t\t.OWIDTH(%d),\n"
+			"\t\t.LGSPAN(%d),\n"
+			"\t\t.BFLYSHIFT(0),\n"
+			"\t\t.OPT_HWMPY(%d),\n"
+			"\t\t.CKPCE(%d),\n"
+			"\t\t.COEFFILE(\"%s\")\n"
+			"\t\t// }}}\n"
+			"\t) stage_e%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			((dbg)&&(dbgstage == fftsize))?"_dbg":"",
+			xtracbits, obits+xtrapbits,
+			lgtmp-2, (mpystage)?1:0,
+			ckpce, cmem.c_str(),
+			fftsize, resetw.c_str(),
+			resetw.c_str());
+		fprintf(vmain, "\t\t.i_sync(%s%s),\n"
+			"\t\t.i_data(i_left),\n"
+			"\t\t.o_data(w_e%d),\n"
+			"\t\t.o_sync(w_s%d%s)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+			(async_reset)?"":"!", resetw.c_str(),
+			fftsize, fftsize,
+			((dbg)&&(dbgstage == fftsize))?", o_dbg":"");
+		cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 1, inverse);
+		cmemfp = gen_coeff_open(cmem.c_str());
+		gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 2, 1, inverse);
+		cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 1, inverse);
+		fprintf(vmain, "\tfftstage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(IWIDTH),\n"
+			"\t\t.CWIDTH(IWIDTH+%d),\n"
+			"\t\t.OWIDTH(%d),\n"
+			"\t\t.LGSPAN(%d),\n"
+			"\t\t.BFLYSHIFT(0),\n"
+			"\t\t.OPT_HWMPY(%d),\n"
+			"\t\t.CKPCE(%d),\n"
+			"\t\t.COEFFILE(\"%s\")\n"
+			"\t\t// }}}\n"
+			"\t) stage_o%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			xtracbits, obits+xtrapbits,
+			lgtmp-2, (mpystage)?1:0,
+			ckpce, cmem.c_str(),
+			fftsize, resetw.c_str(),
+			resetw.c_str());
+		fprintf(vmain, "\t\t.i_sync(%s%s),\n"
+			"\t\t.i_data(i_right),\n"
+			"\t\t.o_data(w_o%d),\n"
+			"\t\t.o_sync(w_os%d)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+			(async_reset)?"":"!",resetw.c_str(),
+			fftsize, fftsize);
+		// }}}
+	}
+	est_fftstage(est, "stage_"+std::to_string(fftsize),
+		(single_clock) ? 1 : 2, nbitsin,
+		nbitsin+xtracbits, obits+xtrapbits,
+		(single_clock) ? lgtmp-1 : lgtmp-2,
+		mpystage, ckpce, qtrwave, shared_rom,
+		((twidgen > 0)&&(lgtmp-1 >= 4)) ? (lgtmp-1)/2 : 0);
+
+	// Build the logic for the FFT stage
+	// {{{
+	std::string	fname;
+
+	fname = coredir + "/";
+	if (inverse)
+		fname += "i";
+	fname += "fftstage";
+	if (dbg) {
+		std::string	dbgname(fname);
+		dbgname += "_dbg";
+		dbgname += ".v";
+		if (single_clock)
+			wrerr |= build_stage(fname.c_str(), fftsize, 1, 0, nbits, xtracbits, ckpce, async_reset, true, qtrwave, shared_rom, (twidgen > 0));
+		else
+			wrerr |= build_stage(fname.c_str(), fftsize, 2, 1, nbits, xtracbits, ckpce, async_reset, true);
+	}
+
+	fname += ".v";
+	if (single_clock) {
+		wrerr |= build_stage(fname.c_str(), fftsize, 1, 0,
+			nbits, xtracbits, ckpce, async_reset,
+			false, qtrwave, shared_rom, (twidgen > 0));
+	} else {
+		// All stages use the same Verilog, so we only
+		// need to build one
+		wrerr |= build_stage(fname.c_str(), fftsize, 2, 1,
+			nbits, xtracbits, ckpce, async_reset, false);
+	}
+	// }}}
+	// }}}
+
+	nbits = obits;	// New number of input bits
+	if (bfp) {
+		bfpscale_instance(vmain, est, fftsize, 0,
+			obits+xtrapbits, lgsize, ewidth,
+			resetw);
+		nbits = obits-1;
+	}
+	tmp_size >>= 1; lgtmp--;
+	dropbit = 0;
 
+	wrerr |= radix2_stages();
+	wrerr |= last_stages();
+
+	return (wrerr) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_groups -- the pipeline of a radix-2^2 (-R 22) or radix-2^3
+// (-R 23) FFT
+// {{{
+// Both are built from groups of stages, pairs or triples, and differ only
+// in the size of those groups.  Any stages left over are radix-2 stages.
+int	FFTCORE::pipe_groups(void) {
+	// Nonzero if any file failed to be written
+	int	wrerr = 0;
+	std::string	cmem;
+	FILE	*cmemfp;
+
+	nbits = nbitsin; dropbit = 0;
+	obits = nbits+1+xtrapbits;
+	if ((maxbitsout > 0)&&(obits > maxbitsout))
+		obits = maxbitsout;
+	twidusers.clear();
+
+	// The radix-2^2 stage pairs, or radix-2^3 stage triples
+	// {{{
+	// Each pair consists of a bf2stage that rotates half of its
+	// differences by -j, a second bf2stage that doesn't, and then
+	// a twidstage to apply the rest of the twiddle factors.  A
+	// triple follows its second bf2stage with a w8twid, applying
+	// the W_8 twiddles from constant multiplies, and then a third
+	// bf2stage, before its one twidstage.
+	const int	ngroup = (r23) ? 3 : 2;
+	std::string	isync, idata, fname;
+	int	grpno = 0, iw, tspan;
+
+	isync = std::string((async_reset)?"":"!") + resetw;
+	idata = "i_sample";
+	// Each group leaves at least four points behind it
+	while(tmp_size >= (4 << ngroup)) {
+		bool	mpystage;
+
+		// tspan is the span of the twidstage's output
+		tspan = tmp_size >> (ngroup-1);
+
+		// The first stage of the group
+		// {{{
+		if (grpno == 0) {
+			// obits already follows the rule for
+			// the first stage
+			iw = nbitsin;
+		} else {
+			obits = nbits+((dropbit)?0:1);
 			if ((maxbitsout > 0)&&(obits > maxbitsout))
 				obits = maxbitsout;
+			iw = nbits+xtrapbits;
+		}
 
-			fprintf(vmain, "\twire\t\tw_s4;\n");
-			if (single_clock) {
-				// {{{
-				fprintf(vmain, "\twire\t[%d:0]\tw_d4;\n",
-					2*(obits+xtrapbits)-1);
-				fprintf(vmain, "\tqtrstage%s\t#(\n"
-					"\t\t// {{{\n"
-					"\t\t.IWIDTH(%d),\n"
-					"\t\t.OWIDTH(%d),\n"
-					"\t\t.LGWIDTH(%d),\n"
-					"\t\t.INVERSE(%d),\n"
-					"\t\t.SHIFT(%d)\n"
-					"\t\t// }}}\n"
-					"\t) stage_4(\n"
-						"\t\t// {{{\n"
-						"\t\t.i_clk(i_clk),\n"
-						"\t\t.%s(%s),\n"
-						"\t\t.i_ce(i_ce),\n",
-					((dbg)&&(dbgstage==4))?"_dbg":"",
-					nbits+xtrapbits, obits+xtrapbits, lgsize,
-					(inverse)?1:0, (dropbit)?0:0,
-					resetw.c_str(),
-					resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(w_s8),\n"
-					"\t\t.i_data(w_d8),\n"
-					"\t\t.o_data(w_d4),\n"
-					"\t\t.o_sync(w_s4%s)\n"
-					"\t\t// }}}\n"
-					"\t);\n",
-					((dbg)&&(dbgstage==4))?", o_dbg":"");
-				// }}}
-			} else {
+		fprintf(vmain, "\n\n");
+		fprintf(vmain, "\twire\t\tw_s%d;\n", tmp_size);
+		fprintf(vmain, "\twire\t[%d:0]\tw_d%d;\n",
+			2*(obits+xtrapbits)-1, tmp_size);
+		fprintf(vmain, "\tbf2stage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(%d),\n"
+			"\t\t.OWIDTH(%d),\n"
+			"\t\t.LGSPAN(%d),\n"
+			"\t\t.SHIFT(0),\n"
+			"\t\t.ROTATE(1),\n"
+			"\t\t.INVERSE(%d)\n"
+			"\t\t// }}}\n"
+			"\t) stage_%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			iw, obits+xtrapbits, lgtmp-1,
+			(inverse)?1:0, tmp_size,
+			resetw.c_str(), resetw.c_str());
+		fprintf(vmain, "\t\t.i_sync(%s),\n"
+			"\t\t.i_data(%s),\n"
+			"\t\t.o_data(w_d%d),\n"
+			"\t\t.o_sync(w_s%d)\n"
+			"\t\t// }}}\n"
+			"\t);\n\n",
+			isync.c_str(), idata.c_str(),
+			tmp_size, tmp_size);
+		est_bf2stage(est, "stage_"+std::to_string(tmp_size),
+			iw, obits+xtrapbits, lgtmp-1);
+
+		if (grpno == 0)
+			dropbit = 0;
+		else
+			dropbit ^= 1;
+		nbits = obits;
+		// }}}
+
+		// The remaining stages of the group
+		// {{{
+		for(int stg=1; stg<ngroup; stg++) {
+			const int	ospan = tmp_size >> stg;
+			std::string	ssync, sdata;
+
+			ssync = "w_s" + std::to_string(tmp_size);
+			sdata = "w_d" + std::to_string(tmp_size);
+			if (stg == 2) {
+				// The W_8 twiddles between
+				// the second and third stages
 				// {{{
-				fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os4;\n\t// verilator lint_on  UNUSED\n");
-				fprintf(vmain, "\twire\t[%d:0]\tw_e4, w_o4;\n", 2*(obits+xtrapbits)-1);
-				fprintf(vmain, "\tqtrstage%s\t#(\n"
-					"\t\t// {{{\n"
-					"\t\t.IWIDTH(%d),\n"
-					"\t\t.OWIDTH(%d),\n"
-					"\t\t.LGWIDTH(%d),\n"
-					"\t\t.ODD(0),\n"
-					"\t\t.INVERSE(%d),\n"
-					"\t\t.SHIFT(%d)\n"
-					"\t\t// }}}\n"
-					"\t) stage_e4(\n"
-					"\t\t// {{{\n"
-					"\t\t.i_clk(i_clk),\n"
-					"\t\t.%s(%s),\n"
-					"\t\t.i_ce(i_ce),\n",
-					((dbg)&&(dbgstage==4))?"_dbg":"",
-					nbits+xtrapbits, obits+xtrapbits, lgsize,
-					(inverse)?1:0, (dropbit)?0:0,
-					resetw.c_str(),
-					resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(w_s8),\n"
-					"\t\t.i_data(w_e8),\n"
-					"\t\t.o_data(w_e4),\n"
-					"\t\t.o_sync(w_s4%s)\n"
-					"\t\t// }}}\n"
-					"\t);\n",
-					((dbg)&&(dbgstage==4))?", o_dbg":"");
-				fprintf(vmain, "\tqtrstage\t#(\n"
+				const int	cw = nbits+xtracbits+xtrapbits;
+
+				if (cw > w8tcw)
+					w8tcw = cw;
+				fprintf(vmain, "\twire\t\tw_ws%d;\n", 2*ospan);
+				fprintf(vmain, "\twire\t[%d:0]\tw_wd%d;\n",
+					2*(nbits+xtrapbits)-1, 2*ospan);
+				fprintf(vmain, "\tw8twid\t#(\n"
 					"\t\t// {{{\n"
 					"\t\t.IWIDTH(%d),\n"
-					"\t\t.OWIDTH(%d),\n"
 					"\t\t.LGWIDTH(%d),\n"
-					"\t\t.ODD(1),\n"
-					"\t\t.INVERSE(%d),\n"
-					"\t\t.SHIFT(%d)\n"
+					"\t\t.INVERSE(%d)\n"
 					"\t\t// }}}\n"
-					"\t) stage_o4(\n"
+					"\t) stage_w%d(\n"
 					"\t\t// {{{\n"
 					"\t\t.i_clk(i_clk),\n"
 					"\t\t.%s(%s),\n"
 					"\t\t.i_ce(i_ce),\n",
-					nbits+xtrapbits, obits+xtrapbits, lgsize, (inverse)?1:0, (dropbit)?0:0,
-					resetw.c_str(),
-					resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(w_s8),\n"
-					"\t\t.i_data(w_o8),\n"
-					"\t\t.o_data(w_o4),\n"
-					"\t\t.o_sync(w_os4)\n"
+					nbits+xtrapbits, lgtmp,
+					(inverse)?1:0, tmp_size,
+					resetw.c_str(), resetw.c_str());
+				fprintf(vmain, "\t\t.i_sync(w_rs%d),\n"
+					"\t\t.i_data(w_rd%d),\n"
+					"\t\t.o_data(w_wd%d),\n"
+					"\t\t.o_sync(w_ws%d)\n"
 					"\t\t// }}}\n"
-					"\t);\n");
+					"\t);\n\n",
+					2*ospan, 2*ospan,
+					2*ospan, 2*ospan);
+				est_w8twid(est,
+					"stage_w"+std::to_string(tmp_size),
+					nbits+xtrapbits, cw, lgtmp);
+
+				ssync = "w_ws" + std::to_string(2*ospan);
+				sdata = "w_wd" + std::to_string(2*ospan);
 				// }}}
 			}
+
+			obits = nbits+((dropbit)?0:1);
+			if ((maxbitsout > 0)&&(obits > maxbitsout))
+				obits = maxbitsout;
+
+			fprintf(vmain, "\twire\t\tw_rs%d;\n", ospan);
+			fprintf(vmain, "\twire\t[%d:0]\tw_rd%d;\n",
+				2*(obits+xtrapbits)-1, ospan);
+			fprintf(vmain, "\tbf2stage\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.LGSPAN(%d),\n"
+				"\t\t.SHIFT(0),\n"
+				"\t\t.ROTATE(0),\n"
+				"\t\t.INVERSE(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_r%d(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n",
+				nbits+xtrapbits, obits+xtrapbits,
+				lgtmp-1-stg, (inverse)?1:0, ospan,
+				resetw.c_str(), resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(%s),\n"
+				"\t\t.i_data(%s),\n"
+				"\t\t.o_data(w_rd%d),\n"
+				"\t\t.o_sync(w_rs%d)\n"
+				"\t\t// }}}\n"
+				"\t);\n\n",
+				ssync.c_str(), sdata.c_str(),
+				ospan, ospan);
+			est_bf2stage(est,
+				"stage_r"+std::to_string(ospan),
+				nbits+xtrapbits, obits+xtrapbits,
+				lgtmp-1-stg);
+
 			dropbit ^= 1;
 			nbits = obits;
-			tmp_size >>= 1; lgtmp--;
 		}
 		// }}}
 
-		// The last stage : adds and subtracts only
+		// The twiddle multiply following the group
 		// {{{
-		{
-			obits = nbits+((dropbit)?0:1);
-			if (obits > nbitsout)
-				obits = nbitsout;
-			if ((maxbitsout>0)&&(obits > maxbitsout))
-				obits = maxbitsout;
-			fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
-			if (single_clock) {
-				fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n",
-					2*obits-1);
-			} else {
-				fprintf(vmain, "\twire\t[%d:0]\tw_e2, w_o2;\n",
-					2*obits-1);
-			}
-			/*
-			if ((nbits+xtrapbits+1 == obits)&&(!dropbit))
-				printf("Warning: Less than optimal scaling\n");
-			*/
+		mpystage = mpy_hwunit(mpyplan, mpy_units,
+				mpy_units - grpno);
+		if (mpystage)
+			fprintf(vmain, "\t// A hardware optimized twiddle stage\n");
+		fprintf(vmain, "\twire\t\tw_s%d;\n", tspan);
+		fprintf(vmain, "\twire\t[%d:0]\tw_d%d;\n",
+			2*(nbits+xtrapbits)-1, tspan);
+		cmem = gen_twiddle_fname(coredir.c_str(), tmp_size, ngroup, inverse);
+		cmemfp = gen_coeff_open(cmem.c_str());
+		gen_twiddles(cmemfp, tmp_size,
+			nbits+xtracbits+xtrapbits, ngroup, inverse);
+		cmem = gen_twiddle_fname(EMPTYSTR, tmp_size, ngroup, inverse);
+		fprintf(vmain, "\ttwidstage\t#(\n"
+			"\t\t// {{{\n"
+			"\t\t.IWIDTH(%d),\n"
+			"\t\t.CWIDTH(%d),\n"
+			"\t\t.OWIDTH(%d),\n"
+			"\t\t.LGWIDTH(%d),\n"
+			"\t\t.SHIFT(1),\n"
+			"\t\t.OPT_HWMPY(%d),\n"
+			"\t\t.CKPCE(%d),\n"
+			"\t\t.COEFFILE(\"%s\")\n"
+			"\t\t// }}}\n"
+			"\t) stage_t%d(\n"
+			"\t\t// {{{\n"
+			"\t\t.i_clk(i_clk),\n"
+			"\t\t.%s(%s),\n"
+			"\t\t.i_ce(i_ce),\n",
+			nbits+xtrapbits,
+			nbits+xtracbits+xtrapbits,
+			nbits+xtrapbits, lgtmp,
+			(mpystage)?1:0, ckpce, cmem.c_str(),
+			tmp_size, resetw.c_str(), resetw.c_str());
+		fprintf(vmain, "\t\t.i_sync(w_rs%d),\n"
+			"\t\t.i_data(w_rd%d),\n"
+			"\t\t.o_data(w_d%d),\n"
+			"\t\t.o_sync(w_s%d)\n"
+			"\t\t// }}}\n"
+			"\t);\n",
+			tspan, tspan, tspan, tspan);
+		est_twidstage(est,
+			"stage_t"+std::to_string(tmp_size),
+			nbits+xtrapbits,
+			nbits+xtracbits+xtrapbits, lgtmp,
+			mpystage, ckpce);
+		// }}}
+
+		// The next group takes its inputs from this
+		// twidstage
+		isync = "w_s" + std::to_string(tspan);
+		idata = "w_d" + std::to_string(tspan);
+		grpno++;
+		tmp_size >>= ngroup; lgtmp -= ngroup;
+	}
+
+	// Build the logic for the stages
+	// {{{
+	fname = coredir + "/bf2stage.v";
+	wrerr |= build_bf2stage(fname.c_str(), rounding, async_reset);
+	fname = coredir + "/twidstage.v";
+	wrerr |= build_twidstage(fname.c_str(), async_reset);
+	if (w8tcw > 0) {
+		fname = coredir + "/w8twid.v";
+		wrerr |= build_w8twid(fname.c_str(), rounding, w8tcw,
+			async_reset);
+	}
+
+	// Any stages left over are built below as normal
+	// radix-2 stages, but for an eight point stage built
+	// as a w8stage
+	if ((tmp_size > 8)||((!w8stage)&&(tmp_size == 8))) {
+		fname = coredir + "/";
+		if (inverse)
+			fname += "i";
+		fname += "fftstage.v";
+		wrerr |= build_stage(fname.c_str(), fftsize, 1, 0,
+			nbits, xtracbits, ckpce, async_reset,
+			false, qtrwave, shared_rom,
+			(twidgen > 0));
+	}
+	// }}}
+	// }}}
+
+	wrerr |= radix2_stages();
+	wrerr |= last_stages();
+
+	return (wrerr) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::radix2_stages -- every radix-2 stage of span eight or more
+// {{{
+// These follow the first stage, or any stage groups, up to the two last
+// stages.  Any twidrom (-C) they share is built here too.
+int	FFTCORE::radix2_stages(void) {
+	// Nonzero if any file failed to be written
+	int	wrerr = 0;
+	std::string	cmem;
+	FILE	*cmemfp;
+
+	// Build all following stages, up to the two last ones
+	// {{{
+	// In a block floating point FFT, every stage but the last grows
+	// by one bit, and is then followed by a scaling stage dropping
+	// that bit again.  The next stage then takes its inputs from
+	// the scaling stage, w_bs<span> and w_bd<span>.
+	fprintf(vmain, "\n\n");
+	while(tmp_size >= 8) {
+		obits = nbits+(((bfp)||(!dropbit))?1:0);
+
+		if ((maxbitsout > 0)&&(obits > maxbitsout))
+			obits = maxbitsout;
+
+		if ((w8stage)&&(tmp_size == 8)) {
+			// The eight point stage, using constant
+			// multiplies only
+			// {{{
+			w8cw = nbits+xtracbits+xtrapbits;
+			fprintf(vmain, "\twire\t\tw_s8;\n");
+			fprintf(vmain, "\twire\t[%d:0]\tw_d8;\n",
+				2*(obits+xtrapbits)-1);
+			fprintf(vmain, "\tw8stage%s\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.INVERSE(%d),\n"
+				"\t\t.SHIFT(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_8(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n",
+				((dbg)&&(dbgstage==8))?"_dbg":"",
+				nbits+xtrapbits, obits+xtrapbits,
+				(inverse)?1:0, (dropbit)?0:0,
+				resetw.c_str(), resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(w_%ss16),\n"
+				"\t\t.i_data(w_%sd16),\n"
+				"\t\t.o_data(w_d8),\n"
+				"\t\t.o_sync(w_s8%s)\n"
+				"\t\t// }}}\n"
+				"\t);\n\n",
+				bfpfx, bfpfx,
+				((dbg)&&(dbgstage==8))?", o_dbg":"");
+
+			est_w8stage(est, "stage_8", nbits+xtrapbits,
+				w8cw, obits+xtrapbits);
+			// }}}
+		} else {
+			bool		mpystage;
 
+			mpystage = mpy_hwunit(mpyplan, mpy_units,
+					lgtmp-((w8stage) ? 3 : 2));
+
+			if (mpystage)
+				fprintf(vmain, "\t// A hardware optimized FFT stage\n");
+			fprintf(vmain, "\twire\t\tw_s%d;\n",
+				tmp_size);
 			if (single_clock) {
 				// {{{
-				fprintf(vmain, "\tlaststage\t#(\n"
+				std::string	fmem;
+				int		lgfine = 0;
+
+				fprintf(vmain,"\twire\t[%d:0]\tw_d%d;\n",
+					2*(obits+xtrapbits)-1,
+					tmp_size);
+				if ((twidgen > (int)twidgens.size())
+						&&(lgtmp-1 >= 4)) {
+					// This stage generates its own
+					// twiddles
+					lgfine = twidgen_tables(coredir,
+						tmp_size, lgtmp-1,
+						nbits+xtracbits+xtrapbits,
+						inverse, cmem, fmem);
+					twidgens.push_back({ tmp_size,
+						lgtmp-1,
+						nbits+xtracbits+xtrapbits });
+				} else if (shared_rom) {
+					// The twiddles come from a twidrom
+					fprintf(vmain, "\twire\t[%d:0]\tw_ca%d;\n"
+						"\twire\t[%d:0]\tw_cc%d;\n",
+						lgtmp-2, tmp_size,
+						2*(nbits+xtracbits+xtrapbits)-1,
+						tmp_size);
+					twidusers.push_back({ tmp_size, lgtmp-1,
+						nbits+xtracbits+xtrapbits });
+				} else if (qtrwave) {
+					cmem = gen_qtrcoeff_fname(coredir.c_str(), tmp_size);
+					cmemfp = gen_coeff_open(cmem.c_str());
+					gen_qtrcoeffs(cmemfp, tmp_size,
+						nbits+xtracbits+xtrapbits);
+					cmem = gen_qtrcoeff_fname(EMPTYSTR, tmp_size);
+				} else {
+					cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 1, 0, inverse);
+					cmemfp = gen_coeff_open(cmem.c_str());
+					gen_coeffs(cmemfp, tmp_size,
+						nbits+xtracbits+xtrapbits, 1, 0, inverse);
+					cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 1, 0, inverse);
+				}
+
+				// Where this stage gets its inputs from
+				// {{{
+				char	isync[32], idata[32];
+				sprintf(isync, "w_%ss%d", bfpfx, tmp_size<<1);
+				sprintf(idata, "w_%sd%d", bfpfx, tmp_size<<1);
+				if ((variable_size)&&(tmp_size >= 16)) {
+					int	xtnd = nbits+xtrapbits-nbitsin;
+
+					// A 2^lgtmp point FFT starts here
+					fprintf(vmain, "\twire\t\tw_vs%d;\n"
+						"\twire\t[%d:0]\tw_vd%d;\n",
+						tmp_size,
+						2*(nbits+xtrapbits)-1, tmp_size);
+					fprintf(vmain, "\tassign\tw_vs%d = (r_lgsize == %d) ? %s%s : w_s%d;\n",
+						tmp_size, lgtmp,
+						(async_reset)?"":"!",
+						resetw.c_str(), tmp_size<<1);
+					if (xtnd > 0)
+						fprintf(vmain, "\tassign\tw_vd%d = (r_lgsize == %d)\n"
+							"\t\t\t? { {(%d){i_sample[%d]}}, i_sample[%d:%d],\n"
+							"\t\t\t\t{(%d){i_sample[%d]}}, i_sample[%d:0] }\n"
+							"\t\t\t: w_d%d;\n",
+							tmp_size, lgtmp,
+							xtnd, 2*nbitsin-1,
+							2*nbitsin-1, nbitsin,
+							xtnd, nbitsin-1, nbitsin-1,
+							tmp_size<<1);
+					else
+						fprintf(vmain, "\tassign\tw_vd%d = (r_lgsize == %d) ? i_sample : w_d%d;\n",
+							tmp_size, lgtmp,
+							tmp_size<<1);
+					sprintf(isync, "w_vs%d", tmp_size);
+					sprintf(idata, "w_vd%d", tmp_size);
+				}
+				// }}}
+
+				fprintf(vmain, "\tfftstage%s\t#(\n"
 					"\t\t// {{{\n"
 					"\t\t.IWIDTH(%d),\n"
+					"\t\t.CWIDTH(%d),\n"
 					"\t\t.OWIDTH(%d),\n"
-					"\t\t.SHIFT(%d)\n"
+					"\t\t.LGSPAN(%d),\n"
+					"\t\t.BFLYSHIFT(%d),\n"
+					"\t\t.OPT_HWMPY(%d),\n"
+					"\t\t.CKPCE(%d)",
+					((dbg)&&(dbgstage==tmp_size))?"_dbg":"",
+					nbits+xtrapbits,
+					nbits+xtracbits+xtrapbits,
+					obits+xtrapbits,
+					lgtmp-1, (dropbit)?0:0, (mpystage)?1:0,
+					ckpce);
+				if (qtrwave)
+					fprintf(vmain, ",\n\t\t.INVERSE(%d)",
+						(inverse)?1:0);
+				if (lgfine > 0)
+					fprintf(vmain, ",\n\t\t.OPT_TWIDGEN(1\'b1),\n"
+						"\t\t.LGFINE(%d)", lgfine);
+				if (!shared_rom)
+					fprintf(vmain, ",\n\t\t.COEFFILE(\"%s\")",
+						cmem.c_str());
+				if (lgfine > 0)
+					fprintf(vmain, ",\n\t\t.FINEFILE(\"%s\")",
+						fmem.c_str());
+				fprintf(vmain, "\n"
 					"\t\t// }}}\n"
-					"\t) stage_2(\n"
+					"\t) stage_%d(\n"
 					"\t\t// {{{\n"
 					"\t\t.i_clk(i_clk),\n"
 					"\t\t.%s(%s),\n"
 					"\t\t.i_ce(i_ce),\n",
-					nbits+xtrapbits, obits,(dropbit)?0:1,
-					resetw.c_str(), resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(w_s4),\n"
-						"\t\t.i_val(w_d4),\n"
-						"\t\t.o_val(w_d2),\n"
-						"\t\t.o_sync(w_s2)\n"
-						"\t\t// }}}\n"
-						"\t);\n");
+					tmp_size,
+					resetw.c_str(),
+					resetw.c_str());
+				if (shared_rom)
+					fprintf(vmain, "\t\t.o_caddr(w_ca%d),\n"
+						"\t\t.i_coef(w_cc%d),\n",
+						tmp_size, tmp_size);
+				fprintf(vmain, "\t\t.i_sync(%s),\n"
+					"\t\t.i_data(%s),\n"
+					"\t\t.o_data(w_d%d),\n"
+					"\t\t.o_sync(w_s%d%s)\n"
+					"\t\t// }}}\n"
+					"\t);\n",
+					isync, idata,
+					tmp_size, tmp_size,
+					((dbg)&&(dbgstage == tmp_size))
+						?", o_dbg":"");
 				// }}}
 			} else {
 				// {{{
-				fprintf(vmain, "\tlaststage\t#(\n"
+				fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os%d;\n\t// verilator lint_on  UNUSED\n",
+					tmp_size);
+				fprintf(vmain,"\twire\t[%d:0]\tw_e%d, w_o%d;\n",
+					2*(obits+xtrapbits)-1,
+					tmp_size, tmp_size);
+				cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 2, 0, inverse);
+				cmemfp = gen_coeff_open(cmem.c_str());
+				gen_coeffs(cmemfp, tmp_size,
+					nbits+xtracbits+xtrapbits, 2, 0, inverse);
+				cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 2, 0, inverse);
+				fprintf(vmain, "\tfftstage%s\t#(\n"
 					"\t\t// {{{\n"
 					"\t\t.IWIDTH(%d),\n"
+					"\t\t.CWIDTH(%d),\n"
 					"\t\t.OWIDTH(%d),\n"
-					"\t\t.SHIFT(%d)\n"
+					"\t\t.LGSPAN(%d),\n"
+					"\t\t.BFLYSHIFT(%d),\n"
+					"\t\t.OPT_HWMPY(%d),\n"
+					"\t\t.CKPCE(%d),\n"
+					"\t\t.COEFFILE(\"%s\")\n"
 					"\t\t// }}}\n"
-					"\t) stage_2(\n"
+					"\t) stage_e%d(\n"
 					"\t\t// {{{\n"
 					"\t\t.i_clk(i_clk),\n"
 					"\t\t.%s(%s),\n"
 					"\t\t.i_ce(i_ce),\n",
-					nbits+xtrapbits, obits,(dropbit)?0:1,
-					resetw.c_str(), resetw.c_str());
-				fprintf(vmain, "\t\t.i_sync(w_s4),\n"
-					"\t\t.i_left(w_e4), .i_right(w_o4),\n"
-					"\t\t.o_left(w_e2), .o_right(w_o2),\n"
-					"\t\t.o_sync(w_s2)\n"
+					((dbg)&&(dbgstage==tmp_size))?"_dbg":"",
+					nbits+xtrapbits,
+					nbits+xtracbits+xtrapbits,
+					obits+xtrapbits,
+					lgtmp-2, (dropbit)?0:0, (mpystage)?1:0,
+					ckpce,
+					cmem.c_str(), tmp_size,
+					resetw.c_str(),
+					resetw.c_str());
+				fprintf(vmain, "\t\t.i_sync(w_s%d),\n"
+					"\t\t.i_data(w_e%d),\n"
+					"\t\t.o_data(w_e%d),\n"
+					"\t\t.o_sync(w_s%d%s)\n"
+					"\t\t// }}}\n"
+					"\t);\n",
+					tmp_size<<1, tmp_size<<1,
+					tmp_size, tmp_size,
+					((dbg)&&(dbgstage == tmp_size))
+						?", o_dbg":"");
+				cmem = gen_coeff_fname(coredir.c_str(),
+					tmp_size, 2, 1, inverse);
+				cmemfp = gen_coeff_open(cmem.c_str());
+				gen_coeffs(cmemfp, tmp_size,
+					nbits+xtracbits+xtrapbits,
+					2, 1, inverse);
+				cmem = gen_coeff_fname(EMPTYSTR,
+					tmp_size, 2, 1, inverse);
+				fprintf(vmain, "\tfftstage\t#(\n"
+					"\t\t// {{{\n"
+					"\t\t.IWIDTH(%d),\n"
+					"\t\t.CWIDTH(%d),\n"
+					"\t\t.OWIDTH(%d),\n"
+					"\t\t.LGSPAN(%d),\n"
+					"\t\t.BFLYSHIFT(%d),\n"
+					"\t\t.OPT_HWMPY(%d),\n"
+					"\t\t.CKPCE(%d),\n"
+					"\t\t.COEFFILE(\"%s\")\n"
+					"\t\t// }}}\n"
+					"\n) \tstage_o%d(\n"
+					"\t\t// {{{\n"
+					"\t\t.i_clk(i_clk),\n"
+					"\t\t.%s(%s),\n"
+					"\t\t.i_ce(i_ce),\n",
+					nbits+xtrapbits,
+					nbits+xtracbits+xtrapbits,
+					obits+xtrapbits,
+					lgtmp-2, (dropbit)?0:0, (mpystage)?1:0,
+					ckpce, cmem.c_str(), tmp_size,
+					resetw.c_str(),
+					resetw.c_str());
+				fprintf(vmain, "\t\t.i_sync(w_s%d),\n"
+					"\t\t.i_data(w_o%d),\n"
+					"\t\t.o_data(w_o%d),\n"
+					"\t\t.o_sync(w_os%d)\n"
 					"\t\t// }}}\n"
-					"\t);\n");
+					"\t);\n",
+					tmp_size<<1, tmp_size<<1,
+					tmp_size, tmp_size);
 				// }}}
 			}
+			fprintf(vmain, "\n");
+
+			est_fftstage(est,
+				"stage_"+std::to_string(tmp_size),
+				(single_clock) ? 1 : 2,
+				nbits+xtrapbits,
+				nbits+xtracbits+xtrapbits,
+				obits+xtrapbits,
+				(single_clock) ? lgtmp-1 : lgtmp-2,
+				mpystage, ckpce, qtrwave, shared_rom,
+				(twidgens.size() > 0
+					&& twidgens.back().m_span == tmp_size)
+				? (lgtmp-1)/2 : 0);
+		}
+
+
+		dropbit ^= 1;
+		nbits = obits;
+		if (bfp) {
+			bfpscale_instance(vmain, est, tmp_size, tmp_size<<1,
+				obits+xtrapbits, lgsize, ewidth,
+				resetw);
+			fprintf(vmain, "\n");
+			nbits = obits-1;
+		}
+		tmp_size >>= 1; lgtmp--;
+	}
+
+	if ((shared_rom)&&(twidusers.size() > 0)) {
+		std::string	fname = coredir + "/twidrom.v";
+
+		twidrom_instances(vmain, est, coredir, twidusers,
+			ckpce, inverse);
+		wrerr |= build_twidrom(fname.c_str());
+		fprintf(vmain, "\n\n");
+	}
+	// }}}
+
+	return (wrerr) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::last_stages -- the quarter and last stages, of spans four and two
+// {{{
+int	FFTCORE::last_stages(void) {
+	// The Quarter stage : 90 degrees, adds and subtracts only
+	// {{{
+	if (tmp_size == 4) {
+		obits = nbits+(((bfp)||(!dropbit))?1:0);
+
+		if ((maxbitsout > 0)&&(obits > maxbitsout))
+			obits = maxbitsout;
+
+		fprintf(vmain, "\twire\t\tw_s4;\n");
+		if (single_clock) {
+			// {{{
+			fprintf(vmain, "\twire\t[%d:0]\tw_d4;\n",
+				2*(obits+xtrapbits)-1);
+			fprintf(vmain, "\tqtrstage%s\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.LGWIDTH(%d),\n"
+				"\t\t.INVERSE(%d),\n"
+				"\t\t.SHIFT(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_4(\n"
+					"\t\t// {{{\n"
+					"\t\t.i_clk(i_clk),\n"
+					"\t\t.%s(%s),\n"
+					"\t\t.i_ce(i_ce),\n",
+				((dbg)&&(dbgstage==4))?"_dbg":"",
+				nbits+xtrapbits, obits+xtrapbits, lgsize,
+				(inverse)?1:0, (dropbit)?0:0,
+				resetw.c_str(),
+				resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(w_%ss8),\n"
+				"\t\t.i_data(w_%sd8),\n"
+				"\t\t.o_data(w_d4),\n"
+				"\t\t.o_sync(w_s4%s)\n"
+				"\t\t// }}}\n"
+				"\t);\n",
+				bfpfx, bfpfx,
+				((dbg)&&(dbgstage==4))?", o_dbg":"");
+			// }}}
+		} else {
+			// {{{
+			fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os4;\n\t// verilator lint_on  UNUSED\n");
+			fprintf(vmain, "\twire\t[%d:0]\tw_e4, w_o4;\n", 2*(obits+xtrapbits)-1);
+			fprintf(vmain, "\tqtrstage%s\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.LGWIDTH(%d),\n"
+				"\t\t.ODD(0),\n"
+				"\t\t.INVERSE(%d),\n"
+				"\t\t.SHIFT(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_e4(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n",
+				((dbg)&&(dbgstage==4))?"_dbg":"",
+				nbits+xtrapbits, obits+xtrapbits, lgsize,
+				(inverse)?1:0, (dropbit)?0:0,
+				resetw.c_str(),
+				resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(w_s8),\n"
+				"\t\t.i_data(w_e8),\n"
+				"\t\t.o_data(w_e4),\n"
+				"\t\t.o_sync(w_s4%s)\n"
+				"\t\t// }}}\n"
+				"\t);\n",
+				((dbg)&&(dbgstage==4))?", o_dbg":"");
+			fprintf(vmain, "\tqtrstage\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.LGWIDTH(%d),\n"
+				"\t\t.ODD(1),\n"
+				"\t\t.INVERSE(%d),\n"
+				"\t\t.SHIFT(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_o4(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n",
+				nbits+xtrapbits, obits+xtrapbits, lgsize, (inverse)?1:0, (dropbit)?0:0,
+				resetw.c_str(),
+				resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(w_s8),\n"
+				"\t\t.i_data(w_o8),\n"
+				"\t\t.o_data(w_o4),\n"
+				"\t\t.o_sync(w_os4)\n"
+				"\t\t// }}}\n"
+				"\t);\n");
+			// }}}
+		}
+		est_qtrstage(est, "stage_4", nbits+xtrapbits,
+			obits+xtrapbits);
+		dropbit ^= 1;
+		nbits = obits;
+		if (bfp) {
+			bfpscale_instance(vmain, est, 4, 8,
+				obits+xtrapbits, lgsize, ewidth,
+				resetw);
+			nbits = obits-1;
+		}
+		tmp_size >>= 1; lgtmp--;
+	}
+	// }}}
+
+	// The last stage : adds and subtracts only
+	// {{{
+	{
+		obits = nbits+(((bfp)||(!dropbit))?1:0);
+		if (obits > nbitsout)
+			obits = nbitsout;
+		if ((maxbitsout>0)&&(obits > maxbitsout))
+			obits = maxbitsout;
+		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_s2;\n\t// verilator lint_on  UNUSED\n");
+		if (single_clock) {
+			fprintf(vmain, "\twire\t[%d:0]\tw_d2;\n",
+				2*obits-1);
+		} else {
+			fprintf(vmain, "\twire\t[%d:0]\tw_e2, w_o2;\n",
+				2*obits-1);
+		}
+		/*
+		if ((nbits+xtrapbits+1 == obits)&&(!dropbit))
+			printf("Warning: Less than optimal scaling\n");
+		*/
+
+		if (single_clock) {
+			// {{{
+			fprintf(vmain, "\tlaststage\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.SHIFT(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_2(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n",
+				nbits+xtrapbits, obits,(dropbit)?0:1,
+				resetw.c_str(), resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(w_%ss4),\n"
+					"\t\t.i_val(w_%sd4),\n"
+					"\t\t.o_val(w_d2),\n"
+					"\t\t.o_sync(w_s2)\n"
+					"\t\t// }}}\n"
+					"\t);\n", bfpfx, bfpfx);
+			// }}}
+		} else {
+			// {{{
+			fprintf(vmain, "\tlaststage\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.IWIDTH(%d),\n"
+				"\t\t.OWIDTH(%d),\n"
+				"\t\t.SHIFT(%d)\n"
+				"\t\t// }}}\n"
+				"\t) stage_2(\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n"
+				"\t\t.i_ce(i_ce),\n",
+				nbits+xtrapbits, obits,(dropbit)?0:1,
+				resetw.c_str(), resetw.c_str());
+			fprintf(vmain, "\t\t.i_sync(w_s4),\n"
+				"\t\t.i_left(w_e4), .i_right(w_o4),\n"
+				"\t\t.o_left(w_e2), .o_right(w_o2),\n"
+				"\t\t.o_sync(w_s2)\n"
+				"\t\t// }}}\n"
+				"\t);\n");
+			// }}}
+		}
+		est_laststage(est, "stage_2", nbits+xtrapbits, obits,
+			(dropbit)?0:1);
+
+		fprintf(vmain, "\n\n");
+		nbits = obits;
+	}
+	// }}}
+
+	if (bitreverse) {	// Prep for bit reversal
+		// {{{
+		fprintf(vmain, "\twire\tbr_start;\n");
+		fprintf(vmain, "\treg\tr_br_started;\n");
+		fprintf(vmain, "\tinitial\tr_br_started = 1\'b0;\n");
+		if (async_reset) {
+			fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
+			fprintf(vmain, "\tif (!i_areset_n)\n");
+		} else {
+			fprintf(vmain, "\talways @(posedge i_clk)\n");
+			fprintf(vmain, "\tif (i_reset)\n");
+		}
+		fprintf(vmain, "\t\tr_br_started <= 1\'b0;\n");
+		fprintf(vmain, "\telse if (i_ce)\n");
+		fprintf(vmain, "\t\tr_br_started <= r_br_started || w_s2;\n");
+		fprintf(vmain, "\tassign\tbr_start = r_br_started || w_s2;\n");
+		// }}}
+	}
+
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_real -- the post-processing stage of a real FFT (-r)
+// {{{
+// An N point real FFT is an N/2 point complex FFT, followed by this stage.
+// It also puts the outputs into their natural order.
+int	FFTCORE::pipe_real(void) {
+	// {{{
+	std::string	cmem;
+	FILE		*cmemfp;
+
+	fprintf(vmain, "\t// The real FFT post-processing stage also\n"
+		"\t// handles our bit reversal.\n");
+	cmem = gen_realcoeff_fname(coredir.c_str(), rfftsize);
+	cmemfp = gen_coeff_open(cmem.c_str());
+	gen_realcoeffs(cmemfp, rfftsize, nbitsout+xtracbits);
+	cmem = gen_realcoeff_fname(EMPTYSTR, rfftsize);
+	fprintf(vmain, "\trealstage\t#(\n"
+		"\t\t// {{{\n"
+		"\t\t.IWIDTH(%d),\n"
+		"\t\t.CWIDTH(%d),\n"
+		"\t\t.OWIDTH(OWIDTH),\n"
+		"\t\t.LGSIZE(%d),\n"
+		"\t\t.OPT_HWMPY(%d),\n"
+		"\t\t.CKPCE(%d),\n"
+		"\t\t.COEFFILE(\"%s\")\n"
+		"\t\t// }}}\n"
+		"\t) revstage (\n"
+		"\t\t// {{{\n"
+		"\t\t.i_clk(i_clk),\n"
+		"\t\t.%s(%s),\n", nbitsout, nbitsout+xtracbits,
+		lgsize, (rl_hwmpy)?1:0, ckpce, cmem.c_str(),
+		resetw.c_str(), resetw.c_str());
+	fprintf(vmain,
+		"\t\t.i_ce(i_ce & br_start),\n"
+		"\t\t.i_in(w_d2),\n"
+		"\t\t.o_out(br_result),\n"
+		"\t\t.o_sync(br_sync)\n"
+		"\t\t// }}}\n"
+		"\t);\n");
+	est_realstage(est, "revstage", nbitsout, nbitsout+xtracbits,
+		rlbitsout, lgsize, rl_hwmpy, ckpce);
+	// }}}
+
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::pipe_reorder -- the bit reversal stage, if any
+// {{{
+int	FFTCORE::pipe_reorder(void) {
+	if (bitreverse) {
+		if ((single_clock)&&(variable_size)) {
+			fprintf(vmain, "\tbitreverse\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.LGSIZE(%d), .WIDTH(%d), .LGLGSIZE(%d)\n"
+				"\t\t// }}}\n"
+				"\t) revstage (\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n", lgsize, nbitsout,
+				lgval(lgsize+1),
+				resetw.c_str(),
+				resetw.c_str());
+			fprintf(vmain,
+				"\t\t.i_ce(i_ce & br_start),\n"
+				"\t\t.i_lgsize(r_lgsize),\n"
+				"\t\t.i_in(w_d2),\n"
+				"\t\t.o_out(br_result),\n"
+				"\t\t.o_sync(br_sync)\n"
+				"\t\t// }}}\n"
+				"\t);\n");
+		} else if (nlanes > 2) {
+			fprintf(vmain, "\tbitreverse\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.LGSIZE(%d), .WIDTH(%d), .LGLANES(%d)\n"
+				"\t\t// }}}\n"
+				"\t) revstage (\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n", lgsize, nbitsout,
+				lgval(nlanes),
+				resetw.c_str(),
+				resetw.c_str());
+			fprintf(vmain,
+				"\t\t.i_ce(i_ce & br_start),\n"
+				"\t\t.i_in(w_d2),\n"
+				"\t\t.o_out(br_result),\n"
+				"\t\t.o_sync(br_sync)\n"
+				"\t\t// }}}\n"
+				"\t);\n");
+		} else if (single_clock) {
+			fprintf(vmain, "\tbitreverse\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.LGSIZE(%d), .WIDTH(%d)\n"
+				"\t\t// }}}\n"
+				"\t) revstage (\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n", lgsize, nbitsout,
+				resetw.c_str(),
+				resetw.c_str());
+			fprintf(vmain,
+				"\t\t.i_ce(i_ce & br_start),\n"
+				"\t\t.i_in(w_d2),\n"
+				"\t\t.o_out(br_result),\n"
+				"\t\t.o_sync(br_sync)\n"
+				"\t\t// }}}\n"
+				"\t);\n");
+		} else {
+			fprintf(vmain, "\tbitreverse\t#(\n"
+				"\t\t// {{{\n"
+				"\t\t.LGSIZE(%d),\n"
+				"\t\t.WIDTH(%d)\n"
+				"\t\t// }}}\n"
+				"\t) revstage (\n"
+				"\t\t// {{{\n"
+				"\t\t.i_clk(i_clk),\n"
+				"\t\t.%s(%s),\n", lgsize, nbitsout,
+				resetw.c_str(), resetw.c_str());
+			fprintf(vmain,
+				"\t\t.i_ce(i_ce & br_start),\n"
+				"\t\t.i_in_0(w_e2),\n"
+				"\t\t.i_in_1(w_o2),\n"
+				"\t\t.o_out_0(br_left),\n"
+				"\t\t.o_out_1(br_right),\n"
+				"\t\t.o_sync(br_sync)\n"
+				"\t\t// }}}\n"
+				"\t);\n");
+			// fprintf(vmain, "\t\t\t(i_ce & br_start), w_e2, w_o2,\n");
+			// fprintf(vmain, "\t\t\tbr_left, br_right, br_sync);\n");
+		}
+		est_bitreverse(est, lgsize, nbitsout, nlanes);
+	} else {
+		fprintf(vmain, "\t//\n"
+"\t// Since the bit-reversal stage isn\'t included, according to the current\n"
+"\t// settings, this will just be a stub instead of the actual bit-reversal\n"
+"\t// logic.\n"
+"\t//\n");
+		if (dit) {
+			// The decimation in time FFT ends with its widest stage
+			fprintf(vmain, "\tassign\tbr_result   = w_d%d;\n", fftsize);
+			fprintf(vmain, "\tassign\tbr_sync    = w_s%d;\n", fftsize);
+		} else {
+			if ((single_clock)||(nlanes > 2)) {
+				fprintf(vmain, "\tassign\tbr_result   = w_d2;\n");
+			} else {
+				fprintf(vmain, "\tassign\tbr_left  = w_e2;\n");
+				fprintf(vmain, "\tassign\tbr_right = w_o2;\n");
+			}
+			fprintf(vmain, "\tassign\tbr_sync    = w_s2;\n");
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::close_main -- register the outputs, and close fftmain.v
+// {{{
+int	FFTCORE::close_main(void) {
+	// Register the final outputs and we're done
+	// {{{
+	est_output(est);
+	fprintf(vmain,
+"\n\n"
+"\t// Last clock: Register our outputs, we\'re done.\n"
+"\tinitial\to_sync  = 1\'b0;\n");
+	if (async_reset)
+		fprintf(vmain,
+"\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	else {
+		fprintf(vmain,
+"\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	}
+
+	fprintf(vmain,
+"\t\to_sync  <= 1\'b0;\n"
+"\telse if (i_ce)\n"
+"\t\to_sync  <= br_sync;\n"
+"\n"
+"\talways @(posedge i_clk)\n"
+"\tif (i_ce)\n");
+	if ((single_clock)||(nlanes > 2)) {
+		fprintf(vmain, "\t\to_result  <= br_result;\n");
+	} else {
+		fprintf(vmain,
+"\tbegin\n"
+"\t\to_left  <= br_left;\n"
+"\t\to_right <= br_right;\n"
+"\tend\n");
+	}
+
+	if (bfp) {
+		// {{{
+		// Count frames out of the bit reversal stage, to look up the
+		// exponent of each from the last scaling stage
+		fprintf(vmain,
+"\n"
+"\t// o_exponent\n"
+"\t// {{{\n"
+"\t// Count the frames leaving the bit reversal stage, so as to look up\n"
+"\t// the exponent of each from the last block floating point stage\n"
+"\treg\t\tbr_wait;\n"
+"\treg\t[%d:0]\tbr_count;\n"
+"\twire\t[1:0]\tbr_frame;\n"
+"\n"
+"\tinitial\tbr_wait  = 1'b1;\n"
+"\tinitial\tbr_count = 0;\n", lgsize+1);
+		if (async_reset)
+			fprintf(vmain,
+"\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+		else
+			fprintf(vmain,
+"\talways @(posedge i_clk)\n\tif (i_reset)\n");
+		fprintf(vmain,
+"\tbegin\n"
+"\t\tbr_wait  <= 1'b1;\n"
+"\t\tbr_count <= 0;\n"
+"\tend else if ((i_ce)&&((!br_wait)||(br_sync)))\n"
+"\tbegin\n"
+"\t\tbr_wait  <= 1'b0;\n"
+"\t\tbr_count <= br_count + 1'b1;\n"
+"\tend\n"
+"\n"
+"\tassign\tbr_frame = br_count[%d:%d];\n"
+"\n"
+"\tinitial\to_exponent = 0;\n"
+"\talways @(posedge i_clk)\n"
+"\tif (i_ce)\n"
+"\t\to_exponent <= w_be4[br_frame*EWIDTH +: EWIDTH];\n"
+"\t// }}}\n", lgsize+1, lgsize);
+		// }}}
+	}
+
+	fprintf(vmain,
+"\n\n"
+"endmodule\n");
+	return fftsink_close(vmain);
+	// }}}
+}
+// }}}
+
+// FFTCORE::write_header -- the C header (-a) for a Verilator test bench
+// {{{
+int	FFTCORE::write_header(void) {
+	// Write a header file with our chosen parameters
+	// {{{
+	if (hdrname.length() > 0) {
+		FILE	*hdr = fftsink_open(hdrname.c_str());
+		if (hdr == NULL) {
+			fprintf(stderr, "ERROR: Cannot open %s to create header file\n", hdrname.c_str());
+			perror("O/S Err:");
+			return EXIT_FAILURE;
+		}
+
+		fprintf(hdr,
+SLASHLINE
+"//\n"
+"// Filename:\t%s\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:	This simple header file captures the internal constants\n"
+"//		within the FFT that were used to build it, for the purpose\n"
+"//	of making C++ integration (and test bench testing) simpler.  That is,\n"
+"//	should the FFT change size, this will note that size change and thus\n"
+"//	any test bench or other C++ program dependent upon either the size of\n"
+"//	the FFT, the number of bits in or out of it, etc., can pick up the\n"
+"//	changes in the defines found within this file.\n"
+"//\n",
+		hdrname.c_str(), prjname);
+		fprintf(hdr, "%s", creator);
+		fprintf(hdr, "//\n");
+		fprintf(hdr, "%s", cpyleft);
+		fprintf(hdr, "//\n"
+		"//\n"
+		"#ifndef %sFFTHDR_H\n"
+		"#define %sFFTHDR_H\n"
+		"\n"
+		"#define\t%sFFT_IWIDTH\t%d\n"
+		"#define\t%sFFT_OWIDTH\t%d\n"
+		"#define\t%sFFT_LGWIDTH\t%d\n"
+		"#define\t%sFFT_SIZE\t(1<<%sFFT_LGWIDTH)\n\n",
+			(inverse)?"I":"", (inverse)?"I":"",
+			(inverse)?"I":"", nbitsin,
+			(inverse)?"I":"", rlbitsout,
+			(inverse)?"I":"", lgsize,
+			(inverse)?"I":"", (inverse)?"I":"");
+		if (async_reset)
+			fprintf(hdr, "#define\tASYNC_RESETN\n");
+		else
+			fprintf(hdr, "// #define ASYNC_RESETN\n");
+		if (ckpce > 0)
+			fprintf(hdr, "#define\t%sFFT_CKPCE\t%d\t// Clocks per CE\n",
+				(inverse)?"I":"", ckpce);
+		else
+			fprintf(hdr, "// Two samples per i_ce\n");
+		if (dit)
+			fprintf(hdr, "#define\t%sFFT_DIT\t// Bit-reversed inputs\n",
+				(inverse)?"I":"");
+		else if (!bitreverse)
+			fprintf(hdr, "#define\t%sFFT_SKIPS_BIT_REVERSE\n",
+				(inverse)?"I":"");
+		if (variable_size)
+			fprintf(hdr, "#define\t%sFFT_VARIABLE_SIZE\n",
+				(inverse)?"I":"");
+		if (bfp) {
+			fprintf(hdr, "#define\t%sFFT_BFP\t// Block floating point\n",
+				(inverse)?"I":"");
+			fprintf(hdr, "#define\t%sFFT_EWIDTH\t%d\n",
+				(inverse)?"I":"", ewidth);
+		}
+		if (real_fft) {
+			fprintf(hdr, "#define\tRL%sFFT\n", (inverse)?"I":"");
+			fprintf(hdr, "#define\tRL%sFFT_SIZE\t(2*%sFFT_SIZE)\n\n",
+				(inverse)?"I":"", (inverse)?"I":"");
+		}
+		if (nlanes > 2)
+			fprintf(hdr, "#define\t%sFFT_LANES\t%d\t// Samples per clock\n\n",
+				(inverse)?"I":"", nlanes);
+		else if (!single_clock)
+			fprintf(hdr, "#define\tDBLCLK%sFFT\n\n", (inverse)?"I":"");
+		else
+			fprintf(hdr, "// #define\tDBLCLK%sFFT // this FFT takes one input sample per clock\n\n", (inverse)?"I":"");
+
+		// The estimated cost of the whole FFT, as reported by -E
+		{
+			STAGEEST	total = est_total(est);
+			const char	*pfx = (inverse) ? "I" : "";
+
+			fprintf(hdr, "// Estimated costs, see fftgen -E\n");
+			fprintf(hdr, "#define\t%sFFT_LATENCY\t%d\t// in i_ce's\n",
+				pfx, total.m_latency);
+			fprintf(hdr, "#define\t%sFFT_DSPS\t%d\n",
+				pfx, total.m_dsps);
+			fprintf(hdr, "#define\t%sFFT_MPYLUTS\t%d\n",
+				pfx, total.m_luts);
+			fprintf(hdr, "#define\t%sFFT_IMEMBITS\t%ld\n",
+				pfx, total.m_imem);
+			fprintf(hdr, "#define\t%sFFT_OMEMBITS\t%ld\n",
+				pfx, total.m_omem);
+			fprintf(hdr, "#define\t%sFFT_CMEMBITS\t%ld\n",
+				pfx, total.m_cmem);
+			fprintf(hdr, "#define\t%sFFT_SQNR\t%.1f\t// dB\n\n",
+				pfx, est_sqnr(total));
+		}
+
+		if (USE_OLD_MULTIPLY)
+			fprintf(hdr, "#define\tUSE_OLD_MULTIPLY\n\n");
+
+		fprintf(hdr, "// Parameters for testing the longbimpy\n");
+		fprintf(hdr, "#define\tTST_LONGBIMPY_AW\t%d\n", TST_LONGBIMPY_AW);
+		fprintf(hdr, "#define\tTST_LONGBIMPY_ROWS\t%d\n", mpyrows);
+		fprintf(hdr, "#define\tTST_LONGBIMPY_OUTREGS\t%d\n", mpyoutregs);
+#ifdef	TST_LONGBIMPY_BW
+		fprintf(hdr, "#define\tTST_LONGBIMPY_BW\t%d\n\n", TST_LONGBIMPY_BW);
+#else
+		fprintf(hdr, "#define\tTST_LONGBIMPY_BW\tTST_LONGBIMPY_AW\n\n");
+#endif
+
+		fprintf(hdr, "// Parameters for testing the shift add multiply\n");
+		fprintf(hdr, "#define\tTST_SHIFTADDMPY_AW\t%d\n", TST_SHIFTADDMPY_AW);
+#ifdef	TST_SHIFTADDMPY_BW
+		fprintf(hdr, "#define\tTST_SHIFTADDMPY_BW\t%d\n\n", TST_SHIFTADDMPY_BW);
+#else
+		fprintf(hdr, "#define\tTST_SHIFTADDMPY_BW\tTST_SHIFTADDMPY_AW\n\n");
+#endif
+
+#define	TST_SHIFTADDMPY_AW	16
+#define	TST_SHIFTADDMPY_BW	20	// Leave undefined to match AW
+		fprintf(hdr, "// Parameters for testing the butterfly\n");
+		fprintf(hdr, "#define\tTST_BUTTERFLY_IWIDTH\t%d\n", TST_BUTTERFLY_IWIDTH);
+		fprintf(hdr, "#define\tTST_BUTTERFLY_CWIDTH\t%d\n", TST_BUTTERFLY_CWIDTH);
+		fprintf(hdr, "#define\tTST_BUTTERFLY_OWIDTH\t%d\n", TST_BUTTERFLY_OWIDTH);
+		fprintf(hdr, "#define\tTST_BUTTERFLY_MPYDELAY\t%d\n\n",
+				bflydelay(TST_BUTTERFLY_IWIDTH,
+					TST_BUTTERFLY_CWIDTH-TST_BUTTERFLY_IWIDTH,
+					booth, mpyrows, mpyoutregs));
 
-			fprintf(vmain, "\n\n");
-			nbits = obits;
+		fprintf(hdr, "// Parameters for testing the quarter stage\n");
+		fprintf(hdr, "#define\tTST_QTRSTAGE_IWIDTH\t%d\n", TST_QTRSTAGE_IWIDTH);
+		fprintf(hdr, "#define\tTST_QTRSTAGE_LGWIDTH\t%d\n\n", TST_QTRSTAGE_LGWIDTH);
+
+		if (w8cw > 0) {
+			// The w8stage's constant multiplies are fixed by the
+			// core, and so its test must use the same CWIDTH
+			fprintf(hdr, "// Parameters for testing the w8stage\n");
+			fprintf(hdr, "#define\tTST_W8STAGE_IWIDTH\t%d\n", TST_W8STAGE_IWIDTH);
+			fprintf(hdr, "#define\tTST_W8STAGE_CWIDTH\t%d\n\n", w8cw);
 		}
-		// }}}
 
-		if (bitreverse) {	// Prep for bit reversal
-			// {{{
-			fprintf(vmain, "\twire\tbr_start;\n");
-			fprintf(vmain, "\treg\tr_br_started;\n");
-			fprintf(vmain, "\tinitial\tr_br_started = 1\'b0;\n");
-			if (async_reset) {
-				fprintf(vmain, "\talways @(posedge i_clk, negedge i_areset_n)\n");
-				fprintf(vmain, "\tif (!i_areset_n)\n");
-			} else {
-				fprintf(vmain, "\talways @(posedge i_clk)\n");
-				fprintf(vmain, "\tif (i_reset)\n");
-			}
-			fprintf(vmain, "\t\tr_br_started <= 1\'b0;\n");
-			fprintf(vmain, "\telse if (i_ce)\n");
-			fprintf(vmain, "\t\tr_br_started <= r_br_started || w_s2;\n");
-			fprintf(vmain, "\tassign\tbr_start = r_br_started || w_s2;\n");
-			// }}}
+		if (w8tcw > 0) {
+			// As with the w8stage, the w8twid's CWIDTH is fixed
+			fprintf(hdr, "// Parameters for testing the w8twid\n");
+			fprintf(hdr, "#define\tTST_W8TWID_CWIDTH\t%d\n\n", w8tcw);
 		}
-		// }}}
+
+		fprintf(hdr, "// Parameters for testing the double stage\n");
+		fprintf(hdr, "#define\tTST_DBLSTAGE_IWIDTH\t%d\n", TST_DBLSTAGE_IWIDTH);
+		fprintf(hdr, "#define\tTST_DBLSTAGE_SHIFT\t%d\n\n", TST_DBLSTAGE_SHIFT);
+
+		fprintf(hdr, "// Parameters for testing the bit reversal stage\n");
+		fprintf(hdr, "#define\tTST_DBLREVERSE_LGSIZE\t%d\n\n", TST_DBLREVERSE_LGSIZE);
+		fprintf(hdr, "\n" "#endif\n\n");
+		if (fftsink_close(hdr))
+			return EXIT_FAILURE;
 	}
+	// }}}
 
-	// Bit-reversal stage
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::report -- report the estimated cost of each stage (-E)
+// {{{
+void	FFTCORE::report(void) {
+	// Report the estimated cost of each stage
 	// {{{
-	fprintf(vmain, "\n");
-	fprintf(vmain, "\t// Now for the bit-reversal stage.\n");
-	if (bitreverse) {
-		if (single_clock) {
-			fprintf(vmain, "\tbitreverse\t#(\n"
-				"\t\t// {{{\n"
-				"\t\t.LGSIZE(%d), .WIDTH(%d)\n"
-				"\t\t// }}}\n"
-				"\t) revstage (\n"
-				"\t\t// {{{\n"
-				"\t\t.i_clk(i_clk),\n"
-				"\t\t.%s(%s),\n", lgsize, nbitsout,
-				resetw.c_str(),
-				resetw.c_str());
-			fprintf(vmain,
-				"\t\t.i_ce(i_ce & br_start),\n"
-				"\t\t.i_in(w_d2),\n"
-				"\t\t.o_out(br_result),\n"
-				"\t\t.o_sync(br_sync)\n"
-				"\t\t// }}}\n"
-				"\t);\n");
-		} else {
-			fprintf(vmain, "\tbitreverse\t#(\n"
-				"\t\t// {{{\n"
-				"\t\t.LGSIZE(%d),\n"
-				"\t\t.WIDTH(%d)\n"
-				"\t\t// }}}\n"
-				"\t) revstage (\n"
-				"\t\t// {{{\n"
-				"\t\t.i_clk(i_clk),\n"
-				"\t\t.%s(%s),\n", lgsize, nbitsout,
-				resetw.c_str(), resetw.c_str());
-			fprintf(vmain,
-				"\t\t.i_ce(i_ce & br_start),\n"
-				"\t\t.i_in_0(w_e2),\n"
-				"\t\t.i_in_1(w_o2),\n"
-				"\t\t.o_out_0(br_left),\n"
-				"\t\t.o_out_1(br_right),\n"
-				"\t\t.o_sync(br_sync)\n"
-				"\t\t// }}}\n"
-				"\t);\n");
-			// fprintf(vmain, "\t\t\t(i_ce & br_start), w_e2, w_o2,\n");
-			// fprintf(vmain, "\t\t\tbr_left, br_right, br_sync);\n");
-		}
-	} else {
-		fprintf(vmain, "\t//\n"
-"\t// Since the bit-reversal stage isn\'t included, according to the current\n"
-"\t// settings, this will just be a stub instead of the actual bit-reversal\n"
-"\t// logic.\n"
-"\t//\n");
-		if (single_clock) {
-			fprintf(vmain, "\tassign\tbr_result   = w_d2;\n");
-		} else {
-			fprintf(vmain, "\tassign\tbr_left  = w_e2;\n");
-			fprintf(vmain, "\tassign\tbr_right = w_o2;\n");
+	if (est_flag) {
+		printf("Estimated cost of this %d point %sFFT, by stage:\n",
+			(real_fft) ? rfftsize : fftsize, (inverse)?"i":"");
+		est_report(stdout, est, ckpce);
+
+		// Smaller variable sized FFTs skip the first stages, and need
+		// a shorter bit reversal
+		for(int lg=lgsize-1; (variable_size)&&(lg >= 4); lg--) {
+			int	span = 1<<lg, latency;
+
+			latency = span + 1	// The bit reversal stage
+				+ 1;		// The output register
+			for(unsigned k=0; k<est.size(); k++)
+				if ((est[k].m_span > 0)&&(est[k].m_span <= span))
+					latency += est[k].m_latency;
+			printf("A %d point FFT (i_lgsize = %d) has a latency of %d\n",
+				span, lg, latency);
 		}
-		fprintf(vmain, "\tassign\tbr_sync    = w_s2;\n");
 	}
 	// }}}
 
-	// Register the final outputs and we're done
+	// Report the error of any generated twiddle factors, vs a ROM
 	// {{{
-	fprintf(vmain,
-"\n\n"
-"\t// Last clock: Register our outputs, we\'re done.\n"
-"\tinitial\to_sync  = 1\'b0;\n");
-	if (async_reset)
-		fprintf(vmain,
-"\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
-	else {
-		fprintf(vmain,
-"\talways @(posedge i_clk)\n\tif (i_reset)\n");
+	if (((est_flag)||(verbose_flag))&&(twidgens.size() > 0)) {
+		printf("Twiddle factor error, in coefficient LSBs, of the ROM and of the generator:\n");
+		printf("%-12s %5s %6s %8s %8s %8s %8s\n",
+			"Stage", "CBits", "LGFINE",
+			"ROM-RMS", "ROM-Max", "Gen-RMS", "Gen-Max");
+		for(unsigned k=0; k<twidgens.size(); k++) {
+			const TWIDUSER	&st = twidgens[k];
+			double	romrms, rommax, genrms, genmax;
+
+			if (!twidgen_error(st.m_span, st.m_cwidth,
+					st.m_lgspan/2, inverse, &romrms,
+					&rommax, &genrms, &genmax))
+				continue;
+			printf("%-12s %5d %6d %8.3f %8.3f %8.3f %8.3f\n",
+				("stage_"+std::to_string(st.m_span)).c_str(),
+				st.m_cwidth, st.m_lgspan/2,
+				romrms, rommax, genrms, genmax);
+		}
 	}
+	// }}}
+}
+// }}}
 
-	fprintf(vmain,
-"\t\to_sync  <= 1\'b0;\n"
-"\telse if (i_ce)\n"
-"\t\to_sync  <= br_sync;\n"
-"\n"
-"\talways @(posedge i_clk)\n"
-"\tif (i_ce)\n");
-	if (single_clock) {
-		fprintf(vmain, "\t\to_result  <= br_result;\n");
-	} else {
-		fprintf(vmain,
-"\tbegin\n"
-"\t\to_left  <= br_left;\n"
-"\t\to_right <= br_right;\n"
-"\tend\n");
-	}
+// FFTCORE::build_modules -- every module fftmain.v instantiates
+// {{{
+int	FFTCORE::build_modules(void) {
+	// Nonzero if any file failed to be written
+	int	wrerr = 0;
 
-	fprintf(vmain,
-"\n\n"
-"endmodule\n");
-	fclose(vmain);
-	// }}}
-	// }}}
 	////////////////////////////////////////////////////////////////////////
 	//
 	// Build the component modules
@@ -2432,24 +4602,36 @@ SLASHLINE
 		// Butterfly
 		// {{{
 		fname = coredir + "/butterfly.v";
-		build_butterfly(fname.c_str(), xtracbits, rounding,
-			ckpce, async_reset);
+		wrerr |= build_butterfly(fname.c_str(), xtracbits, rounding,
+			ckpce, async_reset, booth, mpyrows, mpyoutregs,
+			twidbypass);
 		// }}}
 
 		// The hardware assisted butterfly
 		// {{{
 		fname = coredir + "/hwbfly.v";
-		build_hwbfly(fname.c_str(), xtracbits, rounding,
-			ckpce, async_reset);
+		wrerr |= build_hwbfly(fname.c_str(), xtracbits, rounding,
+			ckpce, async_reset, dsp_aw, dsp_bw, cmpy);
+		// }}}
+
+		// The tiled DSP multiply hwbfly uses, given a DSP size
+		// {{{
+		if (dsp_aw > 0) {
+			fname = coredir + "/dspmpy.v";
+			wrerr |= build_dspmpy(fname.c_str(), dsp_aw, dsp_bw);
+		}
 		// }}}
 
 		// The binary multiply the hardware assisted multiply depends on
 		// {{{
-		{
+		if (booth) {
+			fname = coredir + "/boothmpy.v";
+			wrerr |= build_boothmpy(fname.c_str());
+		} else {
 			fname = coredir + "/longbimpy.v";
-			build_longbimpy(fname.c_str());
+			wrerr |= build_longbimpy(fname.c_str(), mpyrows, mpyoutregs);
 			fname = coredir + "/bimpy.v";
-			build_bimpy(fname.c_str());
+			wrerr |= build_bimpy(fname.c_str());
 		}
 		// }}}
 
@@ -2458,47 +4640,90 @@ SLASHLINE
 		if ((dbg)&&(dbgstage == 4)) {
 			fname = coredir + "/qtrstage_dbg.v";
 			if (single_clock)
-				build_snglquarters(fname.c_str(), rounding,
+				wrerr |= build_snglquarters(fname.c_str(), rounding,
 					async_reset, true);
 			else
-				build_dblquarters(fname.c_str(), rounding,
+				wrerr |= build_dblquarters(fname.c_str(), rounding,
 					async_reset, true);
 		}
 		fname = coredir + "/qtrstage.v";
 		if (single_clock)
-			build_snglquarters(fname.c_str(), rounding,
+			wrerr |= build_snglquarters(fname.c_str(), rounding,
 					async_reset, false);
-		else
-			build_dblquarters(fname.c_str(), rounding,
+		else if (nlanes == 2)
+			wrerr |= build_dblquarters(fname.c_str(), rounding,
 					async_reset, false);
 		// }}}
 
+		// Eight point stage
+		// {{{
+		if (w8cw > 0) {
+			if ((dbg)&&(dbgstage == 8)) {
+				fname = coredir + "/w8stage_dbg.v";
+				wrerr |= build_w8stage(fname.c_str(), rounding, w8cw,
+					async_reset, true);
+			}
+			fname = coredir + "/w8stage.v";
+			wrerr |= build_w8stage(fname.c_str(), rounding, w8cw,
+				async_reset, false);
+		}
+		// }}}
+
 		// Last stage
 		// {{{
-		if (single_clock) {
+		if (nlanes > 2) {
+			// The lanestage and crossbfly modules take the
+			// place of the last stages, and were built above
+		} else if (single_clock) {
 			fname = coredir + "/laststage.v";
-			build_sngllast(fname.c_str(), async_reset);
+			wrerr |= build_sngllast(fname.c_str(), async_reset);
 		} else {
 			if ((dbg)&&(dbgstage == 2))
 				fname = coredir + "/laststage_dbg.v";
 			else
 				fname = coredir + "/laststage.v";
-			build_dblstage(fname.c_str(), rounding,
+			wrerr |= build_dblstage(fname.c_str(), rounding,
 				async_reset, (dbg)&&(dbgstage==2));
 		}
 		// }}}
 
+		// Block floating point scaling
+		// {{{
+		if (bfp) {
+			fname = coredir + "/bfpscale.v";
+			wrerr |= build_bfpscale(fname.c_str(), rounding, async_reset);
+		}
+		// }}}
+
+		// Real FFT post-processing
+		// {{{
+		if (real_fft) {
+			fname = coredir + "/realstage.v";
+			wrerr |= build_realstage(fname.c_str(), rounding, async_reset);
+		}
+		// }}}
+
 		// Bit reversal logic
 		// {{{
-		if (bitreverse) {
+		if ((bitreverse)&&(!real_fft)) {
 			fname = coredir + "/bitreverse.v";
 			if (single_clock)
-				build_snglbrev(fname.c_str(), async_reset);
+				wrerr |= build_snglbrev(fname.c_str(), async_reset,
+					variable_size);
+			else if (nlanes > 2)
+				wrerr |= build_multirev(fname.c_str(), lgval(nlanes),
+					async_reset);
 			else
-				build_dblreverse(fname.c_str(), async_reset);
+				wrerr |= build_dblreverse(fname.c_str(), async_reset);
 		}
 		// }}}
 
+		// Timing constraints
+		// {{{
+		if (single_clock)
+			wrerr |= build_constraints(coredir.c_str(), inverse, ckpce);
+		// }}}
+
 		// Rounding
 		// {{{
 		const	char	*rnd_string = "";
@@ -2510,16 +4735,490 @@ SLASHLINE
 				rnd_string = "/convround.v"; break;
 		} fname = coredir + rnd_string;
 		switch(rounding) {
-			case RND_TRUNCATE: build_truncator(fname.c_str()); break;
-			case RND_FROMZERO: build_roundfromzero(fname.c_str()); break;
-			case RND_HALFUP: build_roundhalfup(fname.c_str()); break;
+			case RND_TRUNCATE: wrerr |= build_truncator(fname.c_str()); break;
+			case RND_FROMZERO: wrerr |= build_roundfromzero(fname.c_str()); break;
+			case RND_HALFUP: wrerr |= build_roundhalfup(fname.c_str()); break;
 			default:
-				build_convround(fname.c_str()); break;
+				wrerr |= build_convround(fname.c_str()); break;
 		}
 		// }}}
 	}
 	// }}}
 
-	if (verbose_flag)
+	return (wrerr) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// }}}
+
+// FFTCORE::build -- build fftmain.v, the header, and every module
+// {{{
+int	FFTCORE::build(void) {
+	int	r;
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Build FFTMAIN
+	// {{{
+	if (open_main() != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+	main_header();
+
+	tmp_size = fftsize; lgtmp = lgsize;
+	est_input(est, nbitsin);
+	if (fftsize == 2) // Special case
+		r = pipe_two();
+	else if (dit) // Decimation in time, from bit-reversed inputs
+		r = pipe_dit();
+	else if (fftsize == 4) // Special case
+		r = pipe_four();
+	else if (nlanes > 2) // Several samples per clock
+		r = pipe_lanes();
+	else if ((r22)||(r23))
+		r = pipe_groups();
+	else
+		r = pipe_sdf();
+
+	// Bit-reversal stage
+	// {{{
+	if (r == EXIT_SUCCESS) {
+		fprintf(vmain, "\n");
+		fprintf(vmain, "\t// Now for the bit-reversal stage.\n");
+		if (real_fft)
+			r = pipe_real();
+		else
+			r = pipe_reorder();
+	}
+	// }}}
+
+	if (r != EXIT_SUCCESS) {
+		fftsink_discard(vmain);
+		return EXIT_FAILURE;
+	} if (close_main() != 0)
+		return EXIT_FAILURE;
+	// }}}
+
+	if (write_header() != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+	report();
+
+	return build_modules();
+}
+// }}}
+
+// fftgen_core
+// {{{
+// Builds the FFT cfg describes, sending every file to sink (or, if NULL, to
+// disk), and returns EXIT_SUCCESS or EXIT_FAILURE.  cachedir (if not empty)
+// is where to look for the core, and then keep it, when building to disk.
+// If total isn't NULL, it's set to the estimated cost of the whole FFT, as
+// -E would report it.
+static int	fftgen_core(const FFTGEN_CONFIG &cfg,
+			const std::string &cachedir, int dbgstage,
+			FFTSINK sink, void *sinkarg, STAGEEST *total) {
+	// Every file from here on goes to the sink, if there is one
+	FFTSINK_SCOPE	scope(sink, sinkarg);
+	FFTCORE		core(cfg, dbgstage);
+	// The key of this core in the cache (--cache)
+	std::string	cachekey = "";
+	bool		built;
+
+	if ((core.check_options() != EXIT_SUCCESS)
+			||(core.plan_stages() != EXIT_SUCCESS)
+			||(core.make_coredir() != EXIT_SUCCESS))
+		return EXIT_FAILURE;
+
+	// Look for this core in the cache
+	// {{{
+	// The cost estimates (-E) are only found by building the core, so
+	// such builds skip the cache.  So do builds into a sink.
+	fftsink_reset();
+	if ((cachedir.size() > 0)&&(!core.est_flag)&&(!fftsink_active())) {
+		cachekey = fftcache_key(cfg);
+		if (fftcache_fetch(cachedir, cachekey, core.coredir,
+				core.hdrname)) {
+			if (core.verbose_flag)
+				printf("Found in the cache, as %s/%s\n",
+					cachedir.c_str(), cachekey.c_str());
+			return EXIT_SUCCESS;
+		}
+	}
+	// }}}
+
+	// The coefficient files are generated together, on every core, once
+	// everything else has been built
+	gen_coeff_format(core.cmemfmt);
+	gen_coeff_batch(0);
+	built = (core.build() == EXIT_SUCCESS);
+
+	// Generate the coefficient files
+	// {{{
+	if ((!gen_coeff_flush())||(!built))
+		return EXIT_FAILURE;
+	if (core.verbose_flag) {
+		const COEFSTATS	&cs = gen_coeff_stats();
+
+		printf("Generated %d coefficient file%s, %ld coefficients (%ld bytes), in %.3f s on %d thread%s\n",
+			cs.m_files, (cs.m_files == 1) ? "" : "s",
+			cs.m_words, cs.m_bytes, cs.m_seconds,
+			cs.m_threads, (cs.m_threads == 1) ? "" : "s");
+	}
+	// }}}
+
+	// Report which files changed
+	// {{{
+	// Files whose contents haven't changed are never rewritten, so that
+	// any tools depending upon them won't see any change either
+	if ((core.verbose_flag)&&(!fftsink_active())) {
+		const std::vector<std::string>	&changed = fftsink_changed();
+
+		for(unsigned k=0; k<changed.size(); k++)
+			printf("Updated %s\n", changed[k].c_str());
+		printf("%d file%s changed\n", (int)changed.size(),
+			(changed.size() == 1) ? "" : "s");
+	}
+	// }}}
+
+	// Only a core whose every file was written gets this far, so only
+	// such cores are ever cached
+	if ((cachekey.size() > 0)&&(fftcache_store(cachedir, cachekey,
+				core.coredir, core.hdrname, fftsink_files()))) {
+		if (core.verbose_flag)
+			printf("Stored in the cache, as %s/%s\n",
+				cachedir.c_str(), cachekey.c_str());
+	}
+
+	if (total)
+		*total = est_total(core.est);
+
+	if (core.verbose_flag)
 		printf("All done -- success\n");
+
+	return EXIT_SUCCESS;
+}
+// }}}
+
+// fftgen_build -- build a core, handing each file to sink as it's finished
+// {{{
+// Files are named as fftgen would've named them, so most will be found
+// under cfg.m_coredir.  Returns EXIT_SUCCESS, or EXIT_FAILURE if the core
+// couldn't be built, in which case the reason will have been written to
+// stderr.
+int	fftgen_build(const FFTGEN_CONFIG &cfg, FFTSINK sink, void *arg) {
+	return fftgen_core(cfg, "", 128, sink, arg, NULL);
+}
+// }}}
+
+// fftgen_estimate -- the estimated cost of a core, without keeping any of it
+// {{{
+// The core is built, since that's how its costs are found, but every file is
+// thrown away as soon as it's finished.  Returns EXIT_SUCCESS, with total
+// set as -E would report it, or EXIT_FAILURE if the core couldn't be built.
+static	void	fftgen_discard(const char *fname, const char *data,
+			size_t len, void *arg) {
+	// Nothing to keep
+}
+
+int	fftgen_estimate(const FFTGEN_CONFIG &cfg, STAGEEST &total) {
+	return fftgen_core(cfg, "", 128, fftgen_discard, NULL, &total);
+}
+// }}}
+
+// fftgen_main
+// {{{
+// Parses the command line into an FFTGEN_CONFIG, and then builds the FFT it
+// describes.  This is all of fftgen, save that it returns rather than
+// exiting.
+int fftgen_main(int argc, char **argv) {
+	FFTGEN_CONFIG	cfg;
+	bool	explore_flag = false;
+	// Rates, and the SQNR we need, when exploring (--explore)
+	double	fs = 0.0, fclk = 0.0, min_sqnr = 0.0;
+	// Where to cache cores (--cache)
+	std::string	cachedir = "";
+	int	dbgstage = 128;
+
+	// Argument processing
+	// {{{
+	if (argc <= 1)
+		usage();
+
+	enum { OPT_EXPLORE = 256, OPT_FS, OPT_FCLK, OPT_SQNR, OPT_CACHE,
+		OPT_CMEM, OPT_HWMPY, OPT_DSP, OPT_SOFTMPY, OPT_CMPY,
+		OPT_MPYROWS, OPT_MPYOUTREGS, OPT_TWIDBYPASS, OPT_NOW8STAGE };
+	static const struct option	longopts[] = {
+		{ "explore", no_argument,       NULL, OPT_EXPLORE },
+		{ "fs",      required_argument, NULL, OPT_FS },
+		{ "fclk",    required_argument, NULL, OPT_FCLK },
+		{ "sqnr",    required_argument, NULL, OPT_SQNR },
+		{ "cache",   required_argument, NULL, OPT_CACHE },
+		{ "cmem",    required_argument, NULL, OPT_CMEM },
+		{ "hwmpy",   required_argument, NULL, OPT_HWMPY },
+		{ "dsp",     required_argument, NULL, OPT_DSP },
+		{ "softmpy", required_argument, NULL, OPT_SOFTMPY },
+		{ "cmpy",    required_argument, NULL, OPT_CMPY },
+		{ "mpyrows", required_argument, NULL, OPT_MPYROWS },
+		{ "mpyoutregs", required_argument, NULL, OPT_MPYOUTREGS },
+		{ "twidbypass", no_argument,    NULL, OPT_TWIDBYPASS },
+		{ "no-w8stage", no_argument,    NULL, OPT_NOW8STAGE },
+		{ NULL, 0, NULL, 0 }
+	};
+	// The (short) options given, so --explore knows which to hold fixed
+	std::string	given;
+
+	fftgen_defaults(cfg);
+	{ int c;
+	// Start over from the first argument, in case we've been called before
+	optind = 1;
+	while((c = getopt_long(argc, argv, "1248ABa:Cc:d:D:Ef:g:hik:m:n:p:qrR:sStx:vz", longopts, NULL)) != -1) {
+		if (c < 256)
+			given += (char)c;
+		switch(c) {
+		case '1':	cfg.m_nlanes = 1; break;
+		case '2':	cfg.m_nlanes = 2; break;
+		case '4':	cfg.m_nlanes = 4; break;
+		case '8':	cfg.m_nlanes = 8; break;
+		case 'A':	cfg.m_async_reset = true;	break;
+		case 'B':	cfg.m_bfp = true;		break;
+		case 'a':	cfg.m_hdrname = optarg;		break;
+		case 'c':	cfg.m_xtracbits = atoi(optarg);	break;
+		case 'd':	cfg.m_coredir = optarg;		break;
+		case 'D':	dbgstage = atoi(optarg);	break;
+		case 'E':	cfg.m_estimate = true;		break;
+		case 'f':	cfg.m_fftsize = atoi(optarg);	
+				{ int sln = strlen(optarg);
+				if (!isdigit(optarg[sln-1])){
+					switch(optarg[sln-1]) {
+					case 'k': case 'K':
+						cfg.m_fftsize <<= 10;
+						break;
+					case 'm': case 'M':
+						cfg.m_fftsize <<= 20;
+						break;
+					case 'g': case 'G':
+						cfg.m_fftsize <<= 30;
+						break;
+					default:
+						printf("ERR: Unknown FFT size, %s!\n", optarg);
+						return EXIT_FAILURE;
+					}
+				}} break;
+		case 'g':	cfg.m_twidgen = atoi(optarg);	break;
+		case 'h':	usage(); return EXIT_SUCCESS;
+		case 'i':	cfg.m_inverse = true;		break;
+		case 'k':	cfg.m_ckpce = atoi(optarg);
+				// After CKPCE=3, there's no advantage
+				// only bits lost, so keep CKPCE <=3 here
+				if (cfg.m_ckpce > 3)
+					cfg.m_ckpce = 3;
+				cfg.m_nlanes = 1;
+				break;
+		case 'm':	cfg.m_maxbitsout = atoi(optarg);	break;
+		case 'n':	cfg.m_nbitsin = atoi(optarg);	break;
+		case 'C':	cfg.m_shared_rom = true;	break;
+		case 'p':	cfg.m_nummpy = atoi(optarg);	break;
+		case 'q':	cfg.m_qtrwave = true;		break;
+		case 'r':	cfg.m_real = true;		break;
+		case 'R':
+			cfg.m_radix = atoi(optarg);
+			if ((strcmp(optarg, "2")!=0)&&(strcmp(optarg, "22")!=0)
+					&&(strcmp(optarg, "23")!=0)) {
+				fprintf(stderr, "ERR: Unknown radix, -R %s\n", optarg);
+				usage();
+				return EXIT_FAILURE;
+			} break;
+		case 'S':	cfg.m_bitreverse = true;	break;
+		case 's':	cfg.m_bitreverse = false;	break;
+		case 't':	cfg.m_dit = true;		break;
+		case 'x':	cfg.m_xtrapbits = atoi(optarg);	break;
+		case 'v':	cfg.m_verbose = true;		break;
+		case 'z':	cfg.m_variable_size = true;	break;
+		case OPT_EXPLORE:	explore_flag = true;	break;
+		case OPT_FS: case OPT_FCLK:
+			{ double rate = explore_rate(optarg);
+			if (rate <= 0.0) {
+				fprintf(stderr, "ERR: Unknown rate, %s\n", optarg);
+				return EXIT_FAILURE;
+			} if (c == OPT_FS)
+				fs = rate;
+			else
+				fclk = rate;
+			} break;
+		case OPT_SQNR:	min_sqnr = atof(optarg);	break;
+		case OPT_CACHE:	cachedir = std::string(optarg);	break;
+		case OPT_CMEM:
+			{ CMEM_FORMAT	fmt;
+			cfg.m_cmem = optarg;
+			if (!opt_cmem(cfg.m_cmem, fmt)) {
+				usage();
+				return EXIT_FAILURE;
+			}} break;
+		case OPT_HWMPY:	cfg.m_hwmpy = optarg;		break;
+		case OPT_DSP:
+			{ int	aw, bw;
+			cfg.m_dsp = optarg;
+			if (!opt_dsp(cfg.m_dsp, aw, bw)) {
+				usage();
+				return EXIT_FAILURE;
+			}} break;
+		case OPT_SOFTMPY:
+			{ bool	booth;
+			cfg.m_softmpy = optarg;
+			if (!opt_softmpy(cfg.m_softmpy, booth)) {
+				usage();
+				return EXIT_FAILURE;
+			}} break;
+		case OPT_CMPY:
+			{ int	cmpy;
+			cfg.m_cmpy = optarg;
+			if (!opt_cmpy(cfg.m_cmpy, cmpy)) {
+				usage();
+				return EXIT_FAILURE;
+			}} break;
+		case OPT_MPYROWS:
+			cfg.m_mpyrows = atoi(optarg);
+			if (cfg.m_mpyrows < 1) {
+				fprintf(stderr, "ERR: At least one row per register, --mpyrows %s\n", optarg);
+				usage();
+				return EXIT_FAILURE;
+			} break;
+		case OPT_MPYOUTREGS:
+			cfg.m_mpyoutregs = atoi(optarg);
+			if (cfg.m_mpyoutregs < 0) {
+				fprintf(stderr, "ERR: Negative output registers, --mpyoutregs %s\n", optarg);
+				usage();
+				return EXIT_FAILURE;
+			} break;
+		case OPT_TWIDBYPASS:
+			cfg.m_twidbypass = true;
+			break;
+		case OPT_NOW8STAGE:
+			cfg.m_w8stage = false;
+			break;
+		default:
+			printf("Unknown argument, -%c\n", c);
+			usage();
+			return EXIT_FAILURE;
+		}
+	}}
+	// }}}
+
+	// Explore the design space, rather than building a core
+	// {{{
+	if (explore_flag) {
+		EXPLORE	xcfg;
+		const bool	lanes_given = (given.find_first_of("1248k")
+						!= std::string::npos);
+
+		xcfg.m_fftsize   = cfg.m_fftsize;
+		xcfg.m_fs        = fs;
+		xcfg.m_fclk      = fclk;
+		xcfg.m_sqnr      = min_sqnr;
+		xcfg.m_nbitsin   = (given.find('n') != std::string::npos)
+						? cfg.m_nbitsin : -1;
+		xcfg.m_xtracbits = (given.find('c') != std::string::npos)
+						? cfg.m_xtracbits : -1;
+		xcfg.m_xtrapbits = (given.find('x') != std::string::npos)
+						? cfg.m_xtrapbits : -1;
+		xcfg.m_maxbitsout= (given.find('m') != std::string::npos)
+						? cfg.m_maxbitsout : -1;
+		xcfg.m_nummpy    = (given.find('p') != std::string::npos)
+						? cfg.m_nummpy : -1;
+		xcfg.m_nlanes    = (lanes_given) ? cfg.m_nlanes : -1;
+		xcfg.m_ckpce     = (lanes_given) ? cfg.m_ckpce : -1;
+		xcfg.m_verbose   = cfg.m_verbose;
+
+		// Everything else is passed on to each candidate as is
+		xcfg.m_base      = cfg;
+
+		return explore(xcfg);
+	}
+	// }}}
+
+	// Plan the clocks per sample from --fs and --fclk
+	// {{{
+	// Every clock a butterfly gets per sample is a multiply it doesn't
+	// need, so pick the most clocks per sample (-k) that still keep up,
+	// or else the fewest samples per clock (-2, -4, -8).  A -k, -1, -2,
+	// -4, or -8 given by hand is checked instead.  A real FFT (-r) takes
+	// two (real) samples each time it takes one.
+	if ((fs > 0.0)||(fclk > 0.0)) {
+		const bool	lanes_given = (given.find_first_of("1248k")
+						!= std::string::npos);
+		const int	fftsize = cfg.m_fftsize;
+		const double	persample = (cfg.m_real) ? 2.0 : 1.0;
+		const bool	single_only = fftgen_single_only(cfg);
+		int	nlanes = (cfg.m_nlanes > 1) ? cfg.m_nlanes : 1,
+			ckpce = cfg.m_ckpce;
+		double	ratio, rate;
+		int	pckpce = 1, planes = 1;
+
+		if ((fs <= 0.0)||(fclk <= 0.0)) {
+			fprintf(stderr, "ERR: Planning a core requires both --fs and --fclk\n");
+			return EXIT_FAILURE;
+		}
+
+		ratio = persample * fclk / fs;
+		if (ratio >= 1.0)
+			pckpce = (ratio >= 3.0) ? 3 : (ratio >= 2.0) ? 2 : 1;
+		else if (!single_only) for(int lanes=2; lanes <= 8; lanes *= 2) {
+			if ((lanes > 2)&&(fftsize < lanes*lanes))
+				break;
+			if (lanes * ratio >= 1.0) {
+				planes = lanes;
+				break;
+			}
+		}
+
+		if ((ratio < 1.0)&&(planes == 1)) {
+			if (single_only)
+				fprintf(stderr, "ERR: Keeping up with %.3g samples per second at a clock rate\n"
+				"of %.3g Hz requires more than a single clock FFT (opt -1), but the\n"
+				"options -r, -R, -z, -t, -B, -q, -C, and -g are only built for\n"
+				"single clock FFTs\n", fs, fclk);
+			else
+				fprintf(stderr, "ERR: No %d point FFT can keep up with %.3g samples per second\n"
+				"at a clock rate of %.3g Hz\n", fftsize, fs, fclk);
+			return EXIT_FAILURE;
+		}
+
+		if (!lanes_given) {
+			nlanes = planes;
+			ckpce  = pckpce;
+			cfg.m_nlanes = nlanes;
+			cfg.m_ckpce  = ckpce;
+		}
+
+		rate = persample * fclk * nlanes / ((ckpce > 1) ? ckpce : 1);
+		if (rate < fs) {
+			fprintf(stderr, "ERR: This core only keeps up with %.3g samples per second,\n"
+				"not --fs %.3g.  Try -%s%d\n", rate, fs,
+				(planes > 1) ? "" : "k ",
+				(planes > 1) ? planes : pckpce);
+			return EXIT_FAILURE;
+		}
+
+		if (cfg.m_verbose) {
+			printf("Planning for %.3g samples per second, at %.3g Hz, or %.2f clocks per %s\n",
+				fs, fclk, ratio, (cfg.m_real)
+				? "pair of (real) samples" : "sample");
+			if (nlanes > 1)
+				printf("  %s %d samples per clock (-%d)\n",
+					(lanes_given) ? "Given" : "Chose",
+					nlanes, nlanes);
+			else
+				printf("  %s one sample every %d clock%s (-k %d)\n",
+					(lanes_given) ? "Given" : "Chose",
+					(ckpce > 1) ? ckpce : 1,
+					(ckpce > 1) ? "s" : "",
+					(ckpce > 1) ? ckpce : 1);
+			if ((lanes_given)&&((nlanes > planes)
+					||((nlanes == 1)&&(ckpce < pckpce))))
+				printf("  NOTE: -%s%d would also keep up, with fewer multiplies\n",
+					(planes > 1) ? "" : "k ",
+					(planes > 1) ? planes : pckpce);
+		}
+	}
+	// }}}
+
+	return fftgen_core(cfg, cachedir, dbgstage, NULL, NULL, NULL);
 }
+// }}}
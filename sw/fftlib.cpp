@@ -62,10 +62,16 @@ long long llround(double d) {
 
 #include <string.h>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <math.h>
 // #include <ctype.h>
 #include <assert.h>
 
+#include "legal.h"
+#include "fftsink.h"
 #include "fftlib.h"
 
 
@@ -93,7 +99,11 @@ int	nextlg(int vl) {
 
 // bflydelay -- Clocks used in the butterfly
 // {{{
-int	bflydelay(int nbits, int xtra) {
+// The Booth multiply (booth) saves the two clocks the longbimpy spends
+// taking absolute values on the way in and restoring the sign on the way out.
+// The longbimpy otherwise takes one clock for every rows rows of its tableau,
+// plus oregs clocks following the final accumulate.
+int	bflydelay(int nbits, int xtra, bool booth, int rows, int oregs) {
 	int	cbits = nbits + xtra;
 	int	delay;
 
@@ -107,7 +117,12 @@ int	bflydelay(int nbits, int xtra) {
 		if (nb<na) {
 			int tmp = nb;
 			nb = na; na = tmp;
-		} delay = ((na)/2+(na&1)+2);
+		}
+
+		if (booth)
+			delay = (na)/2+(na&1);
+		else
+			delay = ((na)/2+(na&1)+rows-1)/rows + 2 + oregs;
 	}
 	return delay;
 }
@@ -115,13 +130,537 @@ int	bflydelay(int nbits, int xtra) {
 
 // lgdelay -- log of thebutterfly delay (i.e. bits needed to hold the value)
 // {{{
-int	lgdelay(int nbits, int xtra) {
+int	lgdelay(int nbits, int xtra, bool booth, int rows, int oregs) {
 	// The butterfly code needs to compare a valid address, of this
 	// many bits, with an address two greater.  This guarantees we
 	// have enough bits for that comparison.  We'll also end up with
 	// more storage space to look for these values, but without a
 	// redesign that's just what we'll deal with.
-	return lgval(bflydelay(nbits, xtra)+3);
+	return lgval(bflydelay(nbits, xtra, booth, rows, oregs)+3);
+}
+// }}}
+
+// COEFJOB -- the twiddle factors destined for one coefficient file
+// {{{
+// The coefficient files are by far the largest files fftgen writes: a
+// 2^20 point FFT needs over a million twiddle factors.  Rather than writing
+// these one fprintf at a time, each file's twiddle factors are described by
+// a COEFJOB, and then generated in large chunks, formatted by hand, and
+// written with a single fwrite per chunk.  The chunks are independent, and
+// so they may be generated on several cores at once.
+//
+typedef	enum	{
+	CJ_COEFFS,	// gen_coeffs
+	CJ_QTRWAVE,	// gen_qtrcoeffs
+	CJ_STRIDE,	// gen_stridecoeffs
+	CJ_TWIDDLES,	// gen_twiddles
+	CJ_REAL		// gen_realcoeffs
+} COEFKIND;
+
+typedef	struct	COEFJOB_S {
+	FILE		*m_fp;
+	COEFKIND	m_kind;
+	int		m_stage, m_cbits, m_count,
+			m_nwide, m_offset,	// CJ_COEFFS
+			m_stride,		// CJ_STRIDE
+			m_group;		// CJ_TWIDDLES
+	bool		m_inv;
+} COEFJOB;
+
+// Twiddle factors per chunk
+static	const	int	COEF_CHUNK = 8192;
+
+// While a batch is open, jobs are queued here until gen_coeff_flush()
+static	bool			g_coef_batch = false;
+static	int			g_coef_threads = 0;
+static	std::vector<COEFJOB>	g_coef_jobs;
+static	COEFSTATS		g_coef_stats;
+static	CMEM_FORMAT		g_cmem_format = CMEM_HEX;
+// The tables destined for coefrom.vh, when g_cmem_format == CMEM_ROM
+typedef	struct	{
+	std::string	m_dir, m_name, m_words;
+	int		m_width;
+} COEFROM;
+static	std::vector<COEFROM>	g_coef_roms;
+// Set by any table that couldn't be written, until gen_coeff_flush()
+static	bool			g_coef_failed = false;
+// }}}
+
+// coef_check -- can a table of cbits bit coefficients be written to cmem?
+// {{{
+// If not, the failure is remembered, and returned by the next
+// gen_coeff_flush(), rather than ending the program here.
+static	bool	coef_check(FILE *cmem, int cbits) {
+	if (NULL == cmem) {
+		// gen_coeff_open() has already said why
+		g_coef_failed = true;
+		return false;
+	} if ((unsigned long)cbits >= 8*sizeof(long long)) {
+		fprintf(stderr, "ERROR: CMEM coefficient precision requested (%d / coefficient) overflows long long data type\n", cbits);
+		g_coef_failed = true;
+		fftsink_discard(cmem);
+		return false;
+	}
+
+	return true;
+}
+// }}}
+
+// coef_angle -- the angle, W, of the i'th twiddle factor of a job
+// {{{
+static	double	coef_angle(const COEFJOB &job, int i) {
+	const	int	stage  = job.m_stage, stride = job.m_stride;
+	const	bool	inv = job.m_inv;
+
+	switch(job.m_kind) {
+	case CJ_COEFFS: {
+		int k = job.m_nwide*i+job.m_offset;
+		return ((inv)?1:-1)*2.0*M_PI*k/(double)(stage);
+		}
+	case CJ_QTRWAVE:
+		return 2.0*M_PI*i/(double)(stage);
+	case CJ_STRIDE:
+		return ((inv)?1:-1)*2.0*M_PI*stride*i/(double)(stage);
+	case CJ_TWIDDLES: {
+		int	group = job.m_group, q = stage >> group;
+		int	blk = i / q, rev = 0;
+
+		for(int b=0; b<group; b++)
+			if (blk & (1<<b))
+				rev |= 1<<(group-1-b);
+
+		return ((inv)?1:-1)*2.0*M_PI*(double)((i % q) * rev)
+					/ (double)(stage);
+		}
+	default: // case CJ_REAL:
+		return -2.0*M_PI*i/(double)(stage) - M_PI/2.0;
+	}
+}
+// }}}
+
+// coef_hex -- write ndigits hex digits of {hi, lo}, and a newline, to p
+// {{{
+static	inline	char	*coef_hex(char *p, unsigned long long hi,
+			unsigned long long lo, int ndigits) {
+	static	const	char	hexdigits[] = "0123456789abcdef";
+
+	for(int d=ndigits-1; d>=0; d--) {
+		unsigned	nibble;
+
+		if (d < 16)
+			nibble = (unsigned)(lo >> (4*d)) & 0x0f;
+		else
+			nibble = (unsigned)(hi >> (4*(d-16))) & 0x0f;
+		*p++ = hexdigits[nibble];
+	} *p++ = '\n';
+
+	return p;
+}
+// }}}
+
+// coef_chunk -- the text of twiddle factors i0 ... i1-1 of a job
+// {{{
+// The real portion of each coefficient is written to the upper cbits bits,
+// the imaginary portion to the lower cbits bits, both scaled by 2^(cbits-2).
+// Quarter wave tables are the exception, holding only the (positive) cosine
+// in cbits-1 bits.
+//
+static	void	coef_chunk(const COEFJOB &job, int i0, int i1,
+			std::string &out) {
+	typedef	unsigned long long	ull;
+	const	int	cbits = job.m_cbits;
+	const	int	ndigits = (job.m_kind == CJ_QTRWAVE)
+				? (cbits-1+3)/4 : (cbits*2+3)/4;
+	const	ull	mask = ~(-1ll << cbits);
+	char		*buf, *p;
+
+	buf = new char[(size_t)(i1-i0) * (ndigits+1)];
+	p = buf;
+	for(int i=i0; i<i1; i++) {
+		double	W = coef_angle(job, i);
+		ull	uic, uis;
+
+		if (job.m_kind == CJ_QTRWAVE) {
+			uic = (ull)llround((1ll<<(cbits-2)) * cos(W));
+			p = coef_hex(p, 0, uic, ndigits);
+			continue;
+		}
+
+		uic = (ull)llround((1ll<<(cbits-2)) * cos(W)) & mask;
+		uis = (ull)llround((1ll<<(cbits-2)) * sin(W)) & mask;
+
+		// cbits < 64, so {uic, uis} always fits in two long longs
+		if (2*cbits <= 8*(int)sizeof(long long))
+			p = coef_hex(p, 0, (uic << cbits) | uis, ndigits);
+		else
+			p = coef_hex(p, uic >> (8*sizeof(long long) - cbits),
+				(uic << cbits) | uis, ndigits);
+	}
+
+	out.assign(buf, p-buf);
+	delete[] buf;
+}
+// }}}
+
+// coef_vendor -- write a table's words to a vendor MIF or COE file
+// {{{
+// Quartus' memory initialization files (MIF), and Vivado's coefficient files
+// (COE), hold the same words as the hex file, and sit right next to it.
+//
+static	void	coef_vendor(const char *hexname, const COEFJOB &job,
+			int width, const std::string &words) {
+	std::string	fname = hexname;
+	const bool	mif = (g_cmem_format == CMEM_MIF);
+	size_t		pos = 0, eol;
+	FILE		*fp;
+
+	if ((fname.size() > 4)&&(fname.substr(fname.size()-4) == ".hex"))
+		fname.resize(fname.size()-4);
+	fname += (mif) ? ".mif" : ".coe";
+
+	fp = gen_coeff_open(fname.c_str());
+	if (NULL == fp) {
+		g_coef_failed = true;
+		return;
+	}
+
+	if (mif) {
+		fprintf(fp, "-- Twiddle factors, as found in %s\n", hexname);
+		fprintf(fp, "WIDTH=%d;\nDEPTH=%d;\n\n", width, job.m_count);
+		fprintf(fp, "ADDRESS_RADIX=UNS;\nDATA_RADIX=HEX;\n\n");
+		fprintf(fp, "CONTENT BEGIN\n");
+	} else {
+		fprintf(fp, "; Twiddle factors, as found in %s\n", hexname);
+		fprintf(fp, "; %d words of %d bits each\n", job.m_count, width);
+		fprintf(fp, "memory_initialization_radix=16;\n");
+		fprintf(fp, "memory_initialization_vector=\n");
+	}
+
+	for(int addr=0; pos < words.size(); addr++) {
+		eol = words.find('\n', pos);
+		if (eol == std::string::npos)
+			eol = words.size();
+		if (mif)
+			fprintf(fp, "\t%d\t:\t%.*s;\n", addr,
+				(int)(eol-pos), words.data()+pos);
+		else
+			fprintf(fp, "%.*s%c\n", (int)(eol-pos),
+				words.data()+pos,
+				(eol+1 < words.size()) ? ',' : ';');
+		pos = eol+1;
+	}
+
+	if (mif)
+		fprintf(fp, "END;\n");
+	if (fftsink_close(fp))
+		g_coef_failed = true;
+}
+// }}}
+
+// coef_write -- deliver one job's words, in the current CMEM_FORMAT
+// {{{
+static	void	coef_write(const COEFJOB &job, std::string &words) {
+	const char	*fname = fftsink_name(job.m_fp);
+	const int	width = (job.m_kind == CJ_QTRWAVE)
+				? job.m_cbits-1 : 2*job.m_cbits;
+
+	if ((g_cmem_format == CMEM_ROM)&&(fname != NULL)) {
+		// Hold on to the table until gen_coeff_flush() writes
+		// coefrom.vh, and forget the hex file
+		COEFROM		rom;
+		const char	*slash = strrchr(fname, '/');
+
+		if (slash) {
+			rom.m_dir  = std::string(fname, slash-fname+1);
+			rom.m_name = slash+1;
+		} else
+			rom.m_name = fname;
+		rom.m_width = width;
+		rom.m_words.swap(words);
+		g_coef_roms.push_back(rom);
+
+		fftsink_discard(job.m_fp);
+		return;
+	}
+
+	if ((fname != NULL)&&((g_cmem_format == CMEM_MIF)
+				||(g_cmem_format == CMEM_COE)))
+		coef_vendor(fname, job, width, words);
+
+	fwrite(words.data(), 1, words.size(), job.m_fp);
+	if (fftsink_close(job.m_fp))
+		g_coef_failed = true;
+}
+// }}}
+
+// coef_romfile -- write every table held so far into coefrom.vh
+// {{{
+static	void	coef_romfile(void) {
+	std::string	fname;
+	unsigned	width = 1, namelen = 1;
+	FILE		*fp;
+
+	if (g_coef_roms.size() == 0)
+		return;
+
+	for(unsigned k=0; k<g_coef_roms.size(); k++) {
+		if ((unsigned)g_coef_roms[k].m_width > width)
+			width = g_coef_roms[k].m_width;
+		if (g_coef_roms[k].m_name.size() > namelen)
+			namelen = g_coef_roms[k].m_name.size();
+	}
+
+	fname = g_coef_roms[0].m_dir + "coefrom.vh";
+	fp = gen_coeff_open(fname.c_str());
+	if (NULL == fp) {
+		g_coef_failed = true;
+		return;
+	}
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tcoefrom.vh\n"
+"// {{{\n" // "}}}"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThe twiddle factor tables of this core, compiled into the\n"
+"//		RTL rather than read from files by $readmemh.  Each module\n"
+"//	needing a table includes this file, and then initializes its table\n"
+"//	from coefrom(COEFFILE, k).  COEFFILE is the name of the hex file the\n"
+"//	table would otherwise have been read from.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n");
+
+	fprintf(fp,
+	"\t// coefrom(fname, addr)\n"
+	"\t// {{{\n"
+	"\tfunction\t[%d:0]\tcoefrom(input [%d:0] fname,\n"
+	"\t\t\t\tinput integer addr);\n"
+	"\tbegin\n"
+	"\t\tcoefrom = 0;\n"
+	"\t\tcase(fname)\n", width-1, 8*namelen-1);
+
+	for(unsigned k=0; k<g_coef_roms.size(); k++) {
+		const COEFROM	&rom = g_coef_roms[k];
+		size_t		pos = 0, eol;
+
+		fprintf(fp, "\t\t\"%s\": case(addr)\n", rom.m_name.c_str());
+		for(int addr=0; pos < rom.m_words.size(); addr++) {
+			eol = rom.m_words.find('\n', pos);
+			if (eol == std::string::npos)
+				eol = rom.m_words.size();
+			fprintf(fp, "\t\t\t%d: coefrom = %d\'h%.*s;\n",
+				addr, width, (int)(eol-pos),
+				rom.m_words.data()+pos);
+			pos = eol+1;
+		}
+		fprintf(fp, "\t\t\tdefault: coefrom = 0;\n\t\t\tendcase\n");
+	}
+
+	fprintf(fp,
+	"\t\tdefault: coefrom = 0;\n"
+	"\t\tendcase\n"
+	"\tend\n"
+	"\tendfunction\n"
+	"\t// }}}\n");
+	if (fftsink_close(fp))
+		g_coef_failed = true;
+}
+// }}}
+
+// coef_run -- generate, write, and close the files of a list of jobs
+// {{{
+static	void	coef_run(std::vector<COEFJOB> &jobs) {
+	typedef	struct	{ int m_job, m_first, m_last; } CHUNK;
+	std::vector<CHUNK>		chunks;
+	std::vector<std::string>	text;
+	std::atomic<unsigned>		next(0);
+	std::chrono::steady_clock::time_point	start;
+	unsigned			nthreads;
+
+	if (jobs.size() == 0)
+		return;
+	start = std::chrono::steady_clock::now();
+
+	// Split every job into chunks
+	// {{{
+	for(unsigned j=0; j<jobs.size(); j++) {
+		for(int i=0; i<jobs[j].m_count; i+= COEF_CHUNK) {
+			CHUNK	c;
+
+			c.m_job   = j;
+			c.m_first = i;
+			c.m_last  = (i + COEF_CHUNK < jobs[j].m_count)
+					? i + COEF_CHUNK : jobs[j].m_count;
+			chunks.push_back(c);
+		}
+	} text.resize(chunks.size());
+	// }}}
+
+	// Generate the chunks, on as many threads as we have
+	// {{{
+	auto	worker = [&]() {
+		unsigned	k;
+
+		while((k = next++) < chunks.size())
+			coef_chunk(jobs[chunks[k].m_job], chunks[k].m_first,
+				chunks[k].m_last, text[k]);
+	};
+
+	nthreads = (g_coef_threads > 0) ? (unsigned)g_coef_threads
+			: std::thread::hardware_concurrency();
+	if (nthreads > chunks.size())
+		nthreads = chunks.size();
+	if (nthreads <= 1) {
+		nthreads = 1;
+		worker();
+	} else {
+		std::vector<std::thread>	pool;
+
+		for(unsigned t=0; t<nthreads; t++)
+			pool.push_back(std::thread(worker));
+		for(unsigned t=0; t<nthreads; t++)
+			pool[t].join();
+	}
+	// }}}
+
+	// Write them out, in order
+	// {{{
+	for(unsigned k=0, j=0; j<jobs.size(); j++) {
+		std::string	words;
+
+		for(; (k<chunks.size())&&(chunks[k].m_job == (int)j); k++) {
+			words += text[k];
+			std::string().swap(text[k]);
+		}
+
+		g_coef_stats.m_files++;
+		g_coef_stats.m_words += jobs[j].m_count;
+		g_coef_stats.m_bytes += words.size();
+		coef_write(jobs[j], words);
+	}
+	// }}}
+
+	g_coef_stats.m_seconds += std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+	if ((int)nthreads > g_coef_stats.m_threads)
+		g_coef_stats.m_threads = nthreads;
+	jobs.clear();
+}
+// }}}
+
+// coef_job -- a COEFJOB, with everything kind specific set to zero
+// {{{
+static	COEFJOB	coef_job(FILE *fp, COEFKIND kind, int stage, int cbits,
+			int count, bool inv) {
+	COEFJOB	job;
+
+	memset(&job, 0, sizeof(job));
+	job.m_fp    = fp;
+	job.m_kind  = kind;
+	job.m_stage = stage;
+	job.m_cbits = cbits;
+	job.m_count = count;
+	job.m_inv   = inv;
+	return job;
+}
+// }}}
+
+// coef_queue -- generate a job's coefficients, now or at the next flush
+// {{{
+static	void	coef_queue(const COEFJOB &job) {
+	g_coef_jobs.push_back(job);
+	if (!g_coef_batch)
+		coef_run(g_coef_jobs);
+}
+// }}}
+
+// gen_coeff_batch -- defer coefficient generation until gen_coeff_flush()
+// {{{
+// Every coefficient file begun after this call is held open, and then
+// generated all at once, on up to nthreads threads (or one per core, if
+// nthreads is zero), by gen_coeff_flush().  This also resets the statistics
+// returned by gen_coeff_stats().
+//
+void	gen_coeff_batch(int nthreads) {
+	if (g_coef_jobs.size() > 0)
+		coef_run(g_coef_jobs);
+	g_coef_batch   = true;
+	g_coef_threads = nthreads;
+	memset(&g_coef_stats, 0, sizeof(g_coef_stats));
+	g_coef_roms.clear();
+}
+// }}}
+
+// gen_coeff_flush -- generate, write, and close every pending coefficient file
+// {{{
+// When generating ROMs (CMEM_ROM), this is also when coefrom.vh is written.
+// Returns false if any table, since the last flush, couldn't be written.
+//
+bool	gen_coeff_flush(void) {
+	bool	ok;
+
+	coef_run(g_coef_jobs);
+	coef_romfile();
+	g_coef_roms.clear();
+	g_coef_batch = false;
+
+	ok = !g_coef_failed;
+	g_coef_failed = false;
+	return ok;
+}
+// }}}
+
+// gen_coeff_format -- choose how the tables are delivered to the RTL
+// {{{
+void	gen_coeff_format(CMEM_FORMAT fmt) {
+	g_cmem_format = fmt;
+}
+// }}}
+
+// gen_cmem_rom -- declare coefrom(), if the tables are compiled in
+// {{{
+// Called once within any module (or generate block) that then initializes
+// a table with gen_cmem_init().
+//
+void	gen_cmem_rom(FILE *fp, const char *indent) {
+	if (g_cmem_format == CMEM_ROM)
+		fprintf(fp, "%s`include \"coefrom.vh\"\n", indent);
+}
+// }}}
+
+// gen_cmem_init -- initialize a table, mem, of 2^lgdepth words
+// {{{
+// The table is either read from the file named by the parameter fparam, or
+// (CMEM_ROM) copied from coefrom(), using that same name as a key.
+//
+void	gen_cmem_init(FILE *fp, const char *indent, const char *mem,
+			const char *fparam, const char *lgdepth) {
+	if (g_cmem_format != CMEM_ROM) {
+		fprintf(fp, "%sinitial\t$readmemh(%s,%s);\n", indent,
+			fparam, mem);
+		return;
+	}
+
+	fprintf(fp,
+		"%sinteger\t%s_k;\n"
+		"%s// Verilator lint_off WIDTH\n"
+		"%sinitial for(%s_k=0; %s_k<(1<<%s); %s_k=%s_k+1)\n"
+		"%s\t%s[%s_k] = coefrom(%s, %s_k);\n"
+		"%s// Verilator lint_on  WIDTH\n",
+		indent, mem, indent,
+		indent, mem, mem, lgdepth, mem, mem,
+		indent, mem, mem, fparam, mem,
+		indent);
+}
+// }}}
+
+// gen_coeff_stats -- files, words, and time spent since gen_coeff_batch()
+// {{{
+const COEFSTATS	&gen_coeff_stats(void) {
+	return g_coef_stats;
 }
 // }}}
 
@@ -129,32 +668,32 @@ int	lgdelay(int nbits, int xtra) {
 // {{{
 void	gen_coeffs(FILE *cmem, int stage, int cbits,
 			int nwide, int offset, bool inv) {
-	unsigned long	ucbits = (unsigned long)cbits;
 	//
 	// For an FFT stage of 2^n elements, we need 2^(n-1) butterfly
 	// coefficients, sometimes called twiddle factors.  Stage captures the
 	// width of the FFT at this point.  If this is a 2x at a time FFT,
-	// nwide will be equal to 2, and offset will be one or two.
+	// nwide will be equal to 2, and offset will be one or two.  If this
+	// is a P samples per clock FFT, nwide will be P and offset the lane.
 	//
 	// assert(nwide > 0);
 	// assert(offset < nwide);
 	// assert(stage / nwide >  1);
 	// assert(stage % nwide == 0);
 	// printf("GEN-COEFFS(): stage =%4d, bits =%2d, nwide = %d, offset = %d, nverse = %d\n", stage, cbits, nwide, offset, inv);
-	if (ucbits >= 8*sizeof(long long)) {
-		fprintf(stderr, "ERROR: CMEM coefficient precision requested (%d / coefficient) overflows long long data type\n", cbits);
-		exit(EXIT_FAILURE);
-	}
+	if (!coef_check(cmem, cbits))
+		return;
 
 	fprintf(cmem, "// Coefficient memory\n");
 	fprintf(cmem, "// ----------------------------------------------\n");
 	fprintf(cmem, "//   Stage:               %3d\n", stage);
 	fprintf(cmem, "//   Bits per coefficient:%3d\n", cbits);
 	fprintf(cmem, "//   NWide:               %3d%s\n", nwide,
-			(nwide == 2) ? " Double-wide FFT, two samples per clock"
+			(nwide > 2) ? " Multi-lane FFT, one lane per sample per clock"
+			: (nwide == 2) ? " Double-wide FFT, two samples per clock"
 			:" Normal FFT, one sample per cycle");
 	fprintf(cmem, "//   Offset:              %3d%s\n", offset,
 			(nwide < 2) ? " (Ignored)"
+			: (nwide > 2) ? " (Lane number)"
 			: (offset == 0) ? " (Even coefficients)"
 			: " (Odd coefficients");
 	fprintf(cmem, "//   Inv:               %s\n",
@@ -165,65 +704,253 @@ void	gen_coeffs(FILE *cmem, int stage, int cbits,
 	fprintf(cmem, "// of the coefficient is in the upper %d bits, whereas\n", cbits);
 	fprintf(cmem, "// the lower %d bits contain the imaginary portion\n", cbits);
 	fprintf(cmem, "//\n//\n");
-	int	ncoeffs = stage/nwide/2;
-	for(int i=0; i<ncoeffs; i++) {
-		int k = nwide*i+offset;
-		double	W = ((inv)?1:-1)*2.0*M_PI*k/(double)(stage);
-		double	c, s;
-		typedef	long long		ll;
-		typedef	unsigned long long	ull;
-		ll	ic, is;
-		ull	vl, uic, uis;
-
-		c = cos(W); s = sin(W);
-		ic = (long long)llround((1ll<<(cbits-2)) * c);
-		is = (long long)llround((1ll<<(cbits-2)) * s);
-
-		if (ucbits != 8*sizeof(long long)) {
-			uic = ic & (~(-1ll << ucbits));
-			uis = is & (~(-1ll << ucbits));
-		} else {
-			uic = ic;
-			uis = is;
-		}
+	COEFJOB	job = coef_job(cmem, CJ_COEFFS, stage, cbits,
+				stage/nwide/2, inv);
+	job.m_nwide  = nwide;
+	job.m_offset = offset;
+	coef_queue(job);
+}
+// }}}
 
-		if (2*ucbits <= 8 * sizeof(long long)) {
-			vl = uic << ucbits;
-			vl |= uis;
-			fprintf(cmem, "%0*llx\n", ((cbits*2+3)/4), vl);
-		} else if (ucbits == 8 * sizeof(long long)) {
-			// Each coefficient perfectly fits into a long long.
-			fprintf(cmem, "%0*llx\n", ((cbits+3)/4), uic);
-			fprintf(cmem, "%0*llx\n", ((cbits+3)/4), uis);
-		} else {
-			unsigned long long	hi, lo;
-			unsigned sright;
-
-			// The "lo" number must always have 8*sizeof(long long)
-			// bits in it.  That means that the "hi" number must
-			// have (cbits * 2) - (8*sizeof(long long)) valid bits
-			// in it.  Since we're in this branch of the "if", we
-			// know that there's a non-zero number of bits in hi.
-			// Further, we know that this non-zero number is more
-			// than zero, and less than 8*sizeof(long long).
-			// Therefore, hi must contain a *part* of ic and not
-			// all of it, whereas lo must contain the last part of
-			// ic.
-
-			vl = (ic & (~(-1ll << (ucbits))));
-			sright = (8*sizeof(long long)) - ucbits;
-			hi = vl >> sright;
-			fprintf(cmem, "%0*llx",
-				(int)(((2*cbits-8*sizeof(long long))+3)/4), hi);
-
-			lo = uis;
-			vl <<= cbits;
-			lo  |= vl;
-
-			fprintf(cmem, "%0*llx\n", (int)(8*sizeof(long long)/4), lo);
+// gen_qtrcoeffs -- a quarter wave table of twiddle factors
+// {{{
+// A stage of "stage" points uses the twiddle factors W_stage^k, for k = 0 ...
+// stage/2-1.  These are all determined by the first quarter wave of a cosine,
+//
+//	cos(2 pi j/stage), j = 0 ... stage/4-1,
+//
+// which is all that gets written here.  The stage then rebuilds
+// W_stage^(stage/4 * q + j) from this table, as either
+// ( cos(j), -/+ sin(j)) for q = 0, or (-sin(j), -/+ cos(j)) for q = 1,
+// where sin(j) is read from cos(stage/4-j).  Since every value is positive,
+// and no greater than 2^(cbits-2), only cbits-1 bits are needed per entry.
+// The table is the same for both the forward and inverse FFT.
+//
+void	gen_qtrcoeffs(FILE *cmem, int stage, int cbits) {
+	if (!coef_check(cmem, cbits))
+		return;
+
+	fprintf(cmem, "// Quarter wave coefficient memory\n");
+	fprintf(cmem, "// ----------------------------------------------\n");
+	fprintf(cmem, "//   Stage:               %3d\n", stage);
+	fprintf(cmem, "//   Bits per coefficient:%3d\n", cbits);
+	fprintf(cmem, "//\n//\n");
+	fprintf(cmem, "// Each line contains the (unsigned) %d bit cosine of\n", cbits-1);
+	fprintf(cmem, "// 2 pi j / %d, for j = 0 ... %d\n", stage, stage/4-1);
+	fprintf(cmem, "//\n//\n");
+	coef_queue(coef_job(cmem, CJ_QTRWAVE, stage, cbits, stage/4, false));
+}
+// }}}
+
+// gen_stridecoeffs -- every stride'th twiddle factor of a stage
+// {{{
+// Writes the count twiddle factors W_stage^(stride*i), i = 0 ... count-1, in
+// the same format as gen_coeffs.  An on the fly twiddle generator (-g) keeps
+// two such tables, a coarse one with a stride of 2^LGFINE and a fine one with
+// a stride of one, and builds every other twiddle factor from their product.
+//
+void	gen_stridecoeffs(FILE *cmem, int stage, int cbits,
+			int stride, int count, bool inv) {
+	if (!coef_check(cmem, cbits))
+		return;
+
+	fprintf(cmem, "// Twiddle generator coefficient memory\n");
+	fprintf(cmem, "// ----------------------------------------------\n");
+	fprintf(cmem, "//   Stage:               %3d\n", stage);
+	fprintf(cmem, "//   Bits per coefficient:%3d\n", cbits);
+	fprintf(cmem, "//   Stride:              %3d\n", stride);
+	fprintf(cmem, "//   Inv:               %s\n",
+			(inv) ? " True -- FFT is inverted"
+			: "False -- This is a forward FFT");
+	fprintf(cmem, "//\n//\n");
+	fprintf(cmem, "// Each line contains a coefficient.  The real portion\n");
+	fprintf(cmem, "// of the coefficient is in the upper %d bits, whereas\n", cbits);
+	fprintf(cmem, "// the lower %d bits contain the imaginary portion\n", cbits);
+	fprintf(cmem, "//\n//\n");
+	COEFJOB	job = coef_job(cmem, CJ_STRIDE, stage, cbits, count, inv);
+	job.m_stride = stride;
+	coef_queue(job);
+}
+// }}}
+
+// gen_coeff_value -- a single twiddle factor, W_stage^k, as integers
+// {{{
+// Returns the real and imaginary parts of the same twiddle factor that
+// gen_coeffs would place in a coefficient file, scaled by 2^(cbits-2).  This
+// is used by those stages whose twiddle factor is a constant parameter.
+//
+void	gen_coeff_value(int stage, int k, int cbits, bool inv,
+			long long *re, long long *im) {
+	double	W = ((inv)?1:-1)*2.0*M_PI*k/(double)(stage);
+
+	*re = (long long)llround((1ll<<(cbits-2)) * cos(W));
+	*im = (long long)llround((1ll<<(cbits-2)) * sin(W));
+}
+// }}}
+
+// gen_csd_mpy -- a constant multiply, as a sum of shifts
+// {{{
+// Returns the Verilog expression multiplying var by the constant k, written
+// from the canonical signed digits of k, most significant first, three terms
+// to a line.  If digits is given, it's set to a description of those digits,
+// such as "2^8 - 2^6 + 2^1", suitable for a comment.  The expression is
+// only as wide as var, so var needs to be wide enough for the product.
+//
+std::string	gen_csd_mpy(long long k, const char *var, std::string *digits) {
+	std::vector<int>	kshift, ksign;
+	std::string		result, kdigits;
+	long long		c = k;
+
+	for(int s=0; c != 0; s++, c >>= 1) {
+		if (c & 1) {
+			// A run of ones becomes a single subtract, followed
+			// by a single add
+			int	d = ((c & 3) == 3) ? -1 : 1;
+
+			kshift.push_back(s);
+			ksign.push_back(d);
+			c -= d;
 		}
-		//
-	} fclose(cmem);
+	}
+
+	for(int t=(int)kshift.size()-1; t >= 0; t--) {
+		const bool	first = (t == (int)kshift.size()-1);
+		std::string	op = (ksign[t] < 0) ? ((first) ? "-" : " - ")
+					: ((first) ? "" : " + ");
+		std::string	sh = (kshift[t] == 0) ? ""
+					: (" <<< " + std::to_string(kshift[t]));
+
+		kdigits += op + "2^" + std::to_string(kshift[t]);
+		// Three terms to a line
+		if ((!first)&&(((int)kshift.size()-1-t) % 3 == 0))
+			op = "\n\t\t\t" + op.substr(1);
+		result += op + "(" + var + sh + ")";
+	}
+
+	if (digits)
+		*digits = kdigits;
+	return result;
+}
+// }}}
+
+// twidgen_error -- twiddle factor error, of a ROM and of a twiddle generator
+// {{{
+// Compares the twiddle factors of a stage, as read from a ROM and as built
+// by the fftstage's twiddle generator, against their ideal values.  The
+// generator multiplies a coarse table entry, W^(k & ~(2^lgfine-1)), by a
+// fine table entry, W^(k & (2^lgfine-1)), both of cbits+2 bits, and then
+// rounds the product back to cbits bits.  This models that arithmetic bit for
+// bit.  Errors are the magnitude of the complex error, in units of the
+// coefficient's LSB.  Returns false if cbits is too wide to model.
+//
+bool	twidgen_error(int stage, int cbits, int lgfine, bool inv,
+			double *romrms, double *rommax,
+			double *genrms, double *genmax) {
+	const int	gbits = cbits+2, shift = 2*gbits-cbits-2;
+	const int	span = stage/2, fmask = (1<<lgfine)-1;
+	double		romsq = 0.0, gensq = 0.0;
+
+	if (2*gbits >= 8*(int)sizeof(long long)) {
+		fprintf(stderr, "ERROR: Twiddle generator precision requested (%d / coefficient) overflows long long data type\n", gbits);
+		return false;
+	}
+
+	*rommax = *genmax = 0.0;
+	for(int k=0; k<span; k++) {
+		double		W = ((inv)?1:-1)*2.0*M_PI*k/(double)(stage);
+		double		ir = (1ll<<(cbits-2)) * cos(W),
+				ii = (1ll<<(cbits-2)) * sin(W), err;
+		long long	rr, ri, cr, ci, fr, fi, sr, si;
+
+		// The ROM path
+		gen_coeff_value(stage, k, cbits, inv, &rr, &ri);
+		err = sqrt((rr-ir)*(rr-ir) + (ri-ii)*(ri-ii));
+		romsq += err * err;
+		if (err > *rommax)
+			*rommax = err;
+
+		// The generator path
+		gen_coeff_value(stage, k & ~fmask, gbits, inv, &cr, &ci);
+		gen_coeff_value(stage, k &  fmask, gbits, inv, &fr, &fi);
+		sr = cr * fr - ci * fi + (1ll << (shift-1));
+		si = cr * fi + ci * fr + (1ll << (shift-1));
+		sr >>= shift;
+		si >>= shift;
+		err = sqrt((sr-ir)*(sr-ir) + (si-ii)*(si-ii));
+		gensq += err * err;
+		if (err > *genmax)
+			*genmax = err;
+	}
+
+	*romrms = sqrt(romsq / span);
+	*genrms = sqrt(gensq / span);
+	return true;
+}
+// }}}
+
+// gen_twiddles -- twiddle factors following a group of radix-2 stages
+// {{{
+// A radix-2^G group of stages, spanning "span" points, only applies trivial
+// (or, for G=3, constant) rotations within the group.  The rest of the twiddles are deferred, and
+// applied all at once to every element following the group.  For element
+// i of the span, with q = span >> G, the deferred twiddle is
+//
+//	W_span^{(i % q) * bitrev_G(i / q)}
+//
+// So, for G=2 (radix-2^2), the four quarters of the span are multiplied
+// by W^0, W^{2m}, W^m, and W^{3m} respectively.  G=3 (radix-2^3) does the
+// same for eighths, W^0, W^{4m}, W^{2m}, W^{6m}, W^m, and so on.  For G=1, the second half
+// of the span is multiplied by W^m, as a decimation in time FFT requires
+// before each of its butterflies.
+//
+void	gen_twiddles(FILE *cmem, int span, int cbits, int group, bool inv) {
+	if (!coef_check(cmem, cbits))
+		return;
+
+	fprintf(cmem, "// Coefficient memory\n");
+	fprintf(cmem, "// ----------------------------------------------\n");
+	fprintf(cmem, "//   Span:                %3d\n", span);
+	fprintf(cmem, "//   Bits per coefficient:%3d\n", cbits);
+	fprintf(cmem, "//   Radix:               2^%d\n", group);
+	fprintf(cmem, "//   Inv:               %s\n",
+			(inv) ? " True -- FFT is inverted"
+			: "False -- This is a forward FFT");
+	fprintf(cmem, "//\n//\n");
+	fprintf(cmem, "// Each line contains a coefficient.  The real portion\n");
+	fprintf(cmem, "// of the coefficient is in the upper %d bits, whereas\n", cbits);
+	fprintf(cmem, "// the lower %d bits contain the imaginary portion\n", cbits);
+	fprintf(cmem, "//\n//\n");
+	COEFJOB	job = coef_job(cmem, CJ_TWIDDLES, span, cbits, span, inv);
+	job.m_group = group;
+	coef_queue(job);
+}
+// }}}
+
+// gen_realcoeffs -- coefficients for the real FFT post-processing stage
+// {{{
+// An N point real FFT is computed as an N/2 point complex FFT, Z[k], of the
+// even samples (real) and odd samples (imaginary).  The result is then
+// recovered from
+//
+//	X[k] = 1/2 [(Z[k] + Z*[N/2-k]) + (-j W_N^k) (Z[k] - Z*[N/2-k])]
+//
+// The butterfly produces both terms at once, given the coefficients
+// -j W_N^k, k = 0 ... N/2-1, which are generated here.
+//
+void	gen_realcoeffs(FILE *cmem, int rsize, int cbits) {
+	if (!coef_check(cmem, cbits))
+		return;
+
+	fprintf(cmem, "// Coefficient memory\n");
+	fprintf(cmem, "// ----------------------------------------------\n");
+	fprintf(cmem, "//   Real FFT size:       %3d\n", rsize);
+	fprintf(cmem, "//   Bits per coefficient:%3d\n", cbits);
+	fprintf(cmem, "//\n//\n");
+	fprintf(cmem, "// Each line contains a coefficient.  The real portion\n");
+	fprintf(cmem, "// of the coefficient is in the upper %d bits, whereas\n", cbits);
+	fprintf(cmem, "// the lower %d bits contain the imaginary portion\n", cbits);
+	fprintf(cmem, "//\n//\n");
+	coef_queue(coef_job(cmem, CJ_REAL, rsize, cbits, rsize/2, false));
 }
 // }}}
 
@@ -234,10 +961,19 @@ std::string	gen_coeff_fname(const char *coredir,
 	std::string	result;
 	char	*memfile;
 
-	assert((nwide == 1)||(nwide == 2));
+	assert((nwide == 1)||(nwide == 2)||(nwide == 4)||(nwide == 8));
 
 	memfile = new char[strlen(coredir)+3+10+strlen(".hex")+64];
-	if (nwide == 2) {
+	if (nwide > 2) {
+		// One file per lane: cmem_w<lanes>_<lane>_<span>.hex
+		if (coredir[0] == '\0') {
+			sprintf(memfile, "%scmem_w%d_%d_%d.hex",
+				(inv)?"i":"", nwide, offset, stage);
+		} else {
+			sprintf(memfile, "%s/%scmem_w%d_%d_%d.hex",
+				coredir, (inv)?"i":"", nwide, offset, stage);
+		}
+	} else if (nwide == 2) {
 		if (coredir[0] == '\0') {
 			sprintf(memfile, "%scmem_%c%d.hex",
 				(inv)?"i":"", (offset==1)?'o':'e', stage*nwide);
@@ -259,17 +995,98 @@ std::string	gen_coeff_fname(const char *coredir,
 }
 // }}}
 
+// gen_twiddle_fname -- the hex file name for a stage group's twiddles
+// {{{
+std::string	gen_twiddle_fname(const char *coredir,
+			int span, int group, bool inv) {
+	std::string	result;
+	char	*memfile;
+
+	memfile = new char[strlen(coredir)+3+10+strlen(".hex")+64];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "%scmem_r%d_%d.hex",
+			(inv)?"i":"", 1<<group, span);
+	else
+		sprintf(memfile, "%s/%scmem_r%d_%d.hex",
+			coredir, (inv)?"i":"", 1<<group, span);
+
+	result = std::string(memfile);
+	delete[] memfile;
+	return	result;
+}
+// }}}
+
+// gen_qtrcoeff_fname -- the hex file name for a quarter wave table
+// {{{
+std::string	gen_qtrcoeff_fname(const char *coredir, int stage) {
+	std::string	result;
+	char	*memfile;
+
+	memfile = new char[strlen(coredir)+3+10+strlen(".hex")+64];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "cmem_q%d.hex", stage);
+	else
+		sprintf(memfile, "%s/cmem_q%d.hex", coredir, stage);
+
+	result = std::string(memfile);
+	delete[] memfile;
+	return	result;
+}
+// }}}
+
+// gen_twidgen_fname -- the hex file names for a twiddle generator's tables
+// {{{
+std::string	gen_twidgen_fname(const char *coredir, int stage,
+			bool coarse, bool inv) {
+	std::string	result;
+	char	*memfile;
+
+	memfile = new char[strlen(coredir)+3+10+strlen(".hex")+64];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "%scmem_%c%d.hex",
+			(inv)?"i":"", (coarse)?'c':'f', stage);
+	else
+		sprintf(memfile, "%s/%scmem_%c%d.hex",
+			coredir, (inv)?"i":"", (coarse)?'c':'f', stage);
+
+	result = std::string(memfile);
+	delete[] memfile;
+	return	result;
+}
+// }}}
+
+// gen_realcoeff_fname -- the hex file name for the real FFT coefficients
+// {{{
+std::string	gen_realcoeff_fname(const char *coredir, int rsize) {
+	std::string	result;
+	char	*memfile;
+
+	memfile = new char[strlen(coredir)+3+10+strlen(".hex")+64];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "cmem_rl%d.hex", rsize);
+	else
+		sprintf(memfile, "%s/cmem_rl%d.hex", coredir, rsize);
+
+	result = std::string(memfile);
+	delete[] memfile;
+	return	result;
+}
+// }}}
+
 // gen_coeff_open
 // {{{
+// Returns NULL if the file can't be opened.  Any gen_*coeffs() or
+// gen_twiddles() call given that NULL then fails the next gen_coeff_flush().
+//
 FILE	*gen_coeff_open(const char *fname) {
 	FILE	*cmem;
 
-	cmem = fopen(fname, "w");
+	cmem = fftsink_open(fname);
 	if (NULL == cmem) {
 		fprintf(stderr, "Could not open FFT coefficient file "
 				"\'%s\' for writing\n", fname);
 		perror("Err from O/S:");
-		exit(EXIT_FAILURE);
+		return NULL;
 	}
 
 	return cmem;
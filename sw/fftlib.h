@@ -41,16 +41,63 @@
 
 #define	USE_OLD_MULTIPLY	false
 
+// CMEM_FORMAT -- how the twiddle factor tables reach the RTL
+// {{{
+typedef	enum	{
+	CMEM_HEX,	// Hex files, read by $readmemh
+	CMEM_MIF,	// Hex files, plus Quartus MIF files
+	CMEM_COE,	// Hex files, plus Vivado COE files
+	CMEM_ROM	// Compiled in, from coefrom.vh
+} CMEM_FORMAT;
+// }}}
+
+// COEFSTATS -- what it took to generate the coefficient files
+// {{{
+typedef	struct	COEFSTATS_S {
+	int	m_files, m_threads;
+	long	m_words, m_bytes;
+	double	m_seconds;		// Wall clock time
+} COEFSTATS;
+// }}}
+
 extern	int	lgval(int vl);
 extern	int	nextlg(int vl);
-extern	int	bflydelay(int nbits, int xtra);
-extern	int	lgdelay(int nbits, int xtra);
+extern	int	bflydelay(int nbits, int xtra, bool booth = false,
+			int rows = 1, int oregs = 0);
+extern	int	lgdelay(int nbits, int xtra, bool booth = false,
+			int rows = 1, int oregs = 0);
 extern	void	gen_coeffs(FILE *cmem, int stage, int cbits,
 			int nwide, int offset, bool inv);
 extern	std::string	gen_coeff_fname(const char *coredir,
 			int stage, int nwide, int offset, bool inv);
+extern	void	gen_coeff_value(int stage, int k, int cbits, bool inv,
+			long long *re, long long *im);
+extern	void	gen_twiddles(FILE *cmem, int span, int cbits,
+			int group, bool inv);
+extern	std::string	gen_twiddle_fname(const char *coredir,
+			int span, int group, bool inv);
+extern	void	gen_qtrcoeffs(FILE *cmem, int stage, int cbits);
+extern	std::string	gen_qtrcoeff_fname(const char *coredir, int stage);
+extern	void	gen_stridecoeffs(FILE *cmem, int stage, int cbits,
+			int stride, int count, bool inv);
+extern	std::string	gen_twidgen_fname(const char *coredir, int stage,
+			bool coarse, bool inv);
+extern	std::string	gen_csd_mpy(long long k, const char *var,
+			std::string *digits = NULL);
+extern	bool	twidgen_error(int stage, int cbits, int lgfine, bool inv,
+			double *romrms, double *rommax,
+			double *genrms, double *genmax);
+extern	void	gen_realcoeffs(FILE *cmem, int rsize, int cbits);
+extern	std::string	gen_realcoeff_fname(const char *coredir, int rsize);
 extern	FILE	*gen_coeff_open(const char *fname);
 extern	void	gen_coeff_file(const char *coredir, const char *fname,
 			int stage, int cbits, int nwide, int offset, bool inv);
+extern	void	gen_coeff_batch(int nthreads);
+extern	bool	gen_coeff_flush(void);
+extern	const COEFSTATS	&gen_coeff_stats(void);
+extern	void	gen_coeff_format(CMEM_FORMAT fmt);
+extern	void	gen_cmem_rom(FILE *fp, const char *indent);
+extern	void	gen_cmem_init(FILE *fp, const char *indent, const char *mem,
+			const char *fparam, const char *lgdepth);
 
 #endif	// FFTLIB_H
@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftsink.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Directs the files fftgen generates either to the file system,
+//		or to a caller supplied sink.  See fftsink.h.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef	_MSC_VER
+#include <io.h>
+#define	unlink	_unlink
+#else
+#include <unistd.h>
+#endif
+#include <string>
+#include <vector>
+
+#include "fftsink.h"
+
+// SINKFILE -- a file being written to memory, until it is closed
+// {{{
+typedef	struct	{
+	FILE		*m_fp;
+	std::string	m_fname;
+	char		*m_buf;
+	size_t		m_len;
+	// True if this file is headed for the disk, rather than a sink
+	bool		m_disk;
+} SINKFILE;
+// }}}
+
+static	FFTSINK			g_sink = NULL;
+static	void			*g_sinkarg = NULL;
+static	std::vector<SINKFILE *>	g_open;
+// Every file opened since the last fftsink_reset, and those of them that
+// were written to disk because they changed
+static	std::vector<std::string>	g_files, g_changed;
+
+// FFTSINK_SCOPE -- direct files to sink, or (if NULL) to disk, for a while
+// {{{
+FFTSINK_SCOPE::FFTSINK_SCOPE(FFTSINK sink, void *arg) {
+	m_prev    = g_sink;
+	m_prevarg = g_sinkarg;
+	g_sink    = sink;
+	g_sinkarg = arg;
+}
+
+FFTSINK_SCOPE::~FFTSINK_SCOPE(void) {
+	g_sink    = m_prev;
+	g_sinkarg = m_prevarg;
+}
+// }}}
+
+// fftsink_active -- true if files are going to a sink rather than to disk
+// {{{
+bool	fftsink_active(void) {
+	return (g_sink != NULL);
+}
+// }}}
+
+// fftsink_reset -- forget which files have been generated so far
+// {{{
+void	fftsink_reset(void) {
+	g_files.clear();
+	g_changed.clear();
+}
+// }}}
+
+// fftsink_files -- the name of every file opened since fftsink_reset
+// {{{
+const std::vector<std::string>	&fftsink_files(void) {
+	return g_files;
+}
+// }}}
+
+// fftsink_changed -- those files written since fftsink_reset that changed
+// {{{
+// Files whose new contents matched what was already on disk are left alone,
+// timestamp and all, and so aren't listed here.
+const std::vector<std::string>	&fftsink_changed(void) {
+	return g_changed;
+}
+// }}}
+
+// update_file -- write a file to disk, but only if its contents changed
+// {{{
+// Returns zero on success (whether or not the file was written), or EOF
+// if the file could not be written.
+static	int	update_file(const std::string &fname, const char *data,
+			size_t len) {
+	FILE	*fp;
+	bool	wrote;
+
+	// Compare against the existing file, if any
+	// {{{
+	if (NULL != (fp = fopen(fname.c_str(), "r"))) {
+		char	buf[16384];
+		size_t	pos = 0, ln;
+		bool	same = true;
+
+		while((same)&&((ln = fread(buf, 1, sizeof(buf), fp)) > 0)) {
+			if ((pos + ln > len)||(memcmp(buf, data+pos, ln) != 0))
+				same = false;
+			pos += ln;
+		} fclose(fp);
+
+		if ((same)&&(pos == len))
+			return 0;
+	}
+	// }}}
+
+	// Remove the old file, rather than overwriting it, lest it be a hard
+	// link into the cache (see fftcache.cpp)
+	unlink(fname.c_str());
+	fp = fopen(fname.c_str(), "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n",
+			fname.c_str());
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	wrote = (len == 0)||(fwrite(data, 1, len, fp) == len);
+	if ((fclose(fp) != 0)||(!wrote)) {
+		fprintf(stderr, "Could not write '%s'\n", fname.c_str());
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	for(unsigned k=0; k<g_changed.size(); k++)
+		if (g_changed[k] == fname)
+			return 0;
+	g_changed.push_back(fname);
+	return 0;
+}
+// }}}
+
+// fftsink_open -- open a generated file for writing
+// {{{
+// Returns NULL on failure, just like fopen.  Files are always built in
+// memory first.  Those headed for the disk are only written there, when
+// closed, if their contents have changed.
+FILE	*fftsink_open(const char *fname) {
+	SINKFILE	*sf;
+
+	g_files.push_back(std::string(fname));
+
+	sf = new SINKFILE;
+	sf->m_fname = fname;
+	sf->m_buf   = NULL;
+	sf->m_len   = 0;
+	sf->m_disk  = (g_sink == NULL);
+#ifdef	_WIN32
+	// There's no open_memstream here, so use an anonymous temporary file
+	// instead, and read it back when it's closed
+	sf->m_fp = tmpfile();
+#else
+	sf->m_fp = open_memstream(&sf->m_buf, &sf->m_len);
+#endif
+	if (NULL == sf->m_fp) {
+		delete sf;
+		return NULL;
+	}
+
+	g_open.push_back(sf);
+	return sf->m_fp;
+}
+// }}}
+
+// fftsink_close -- close a generated file, and send it where it's going
+// {{{
+int	fftsink_close(FILE *fp) {
+	SINKFILE	*sf = NULL;
+	int		r;
+
+	for(unsigned k=0; k<g_open.size(); k++) {
+		if (g_open[k]->m_fp == fp) {
+			sf = g_open[k];
+			g_open.erase(g_open.begin()+k);
+			break;
+		}
+	}
+
+	if (NULL == sf)
+		return fclose(fp);
+
+#ifdef	_WIN32
+	{
+		long	ln;
+
+		fflush(fp);
+		ln = ftell(fp);
+		sf->m_len = (ln > 0) ? (size_t)ln : 0;
+		sf->m_buf = (char *)malloc(sf->m_len+1);
+		rewind(fp);
+		sf->m_len = fread(sf->m_buf, 1, sf->m_len, fp);
+	}
+#endif
+	r = fclose(fp);
+
+	if (sf->m_disk) {
+		if ((r == 0)&&(update_file(sf->m_fname, sf->m_buf, sf->m_len)))
+			r = EOF;
+	} else if (g_sink)
+		// (The sink may have been removed since this file was opened)
+		g_sink(sf->m_fname.c_str(), sf->m_buf, sf->m_len, g_sinkarg);
+	free(sf->m_buf);
+	delete sf;
+	return r;
+}
+// }}}
+
+// fftsink_discard -- close a generated file, and throw it away
+// {{{
+// The file is neither written nor sent to the sink, and is forgotten by
+// fftsink_files(), as though it had never been opened.
+void	fftsink_discard(FILE *fp) {
+	for(unsigned k=0; k<g_open.size(); k++) {
+		SINKFILE	*sf = g_open[k];
+
+		if (sf->m_fp != fp)
+			continue;
+
+		g_open.erase(g_open.begin()+k);
+		fclose(fp);
+		for(unsigned f=g_files.size(); f>0; f--) {
+			if (g_files[f-1] == sf->m_fname) {
+				g_files.erase(g_files.begin()+f-1);
+				break;
+			}
+		}
+
+		free(sf->m_buf);
+		delete sf;
+		return;
+	}
+
+	fclose(fp);
+}
+// }}}
+
+// fftsink_name -- the name a generated file was opened with, or NULL
+// {{{
+const char	*fftsink_name(FILE *fp) {
+	for(unsigned k=0; k<g_open.size(); k++)
+		if (g_open[k]->m_fp == fp)
+			return g_open[k]->m_fname.c_str();
+	return NULL;
+}
+// }}}
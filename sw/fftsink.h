@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftsink.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Every file fftgen generates is opened with fftsink_open, and
+//		closed with fftsink_close.  Files are built in memory.  When
+//	closed, each is either written to disk--but only if it differs from
+//	the file already there, so that unchanged files keep their
+//	timestamps--or, if a sink has been given, handed to the sink.  The
+//	sink is what allows libfftgen to generate a core without touching the
+//	file system.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	FFTSINK_H
+#define	FFTSINK_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// FFTSINK -- called with the name and full contents of each generated file
+typedef	void	(*FFTSINK)(const char *fname, const char *data, size_t len,
+			void *arg);
+
+// FFTSINK_SCOPE -- send every file opened during one build to a sink
+// {{{
+// Files go to the sink given (or, if NULL, to disk) from the construction
+// of this scope until its destruction, when the previous destination is
+// restored.  Each build opens its own scope, around just that build.  As
+// with the rest of fftgen, this isn't thread safe: only one build at a time.
+class	FFTSINK_SCOPE {
+	FFTSINK	m_prev;
+	void	*m_prevarg;
+public:
+	FFTSINK_SCOPE(FFTSINK sink, void *arg);
+	~FFTSINK_SCOPE(void);
+};
+// }}}
+
+extern	bool	fftsink_active(void);
+extern	FILE	*fftsink_open(const char *fname);
+extern	int	fftsink_close(FILE *fp);
+extern	void	fftsink_discard(FILE *fp);
+extern	const char	*fftsink_name(FILE *fp);
+extern	void	fftsink_reset(void);
+extern	const std::vector<std::string>	&fftsink_files(void);
+extern	const std::vector<std::string>	&fftsink_changed(void);
+
+#endif	// FFTSINK_H
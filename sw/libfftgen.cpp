@@ -0,0 +1,237 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	libfftgen.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Supports building an FFT core from an FFTGEN_CONFIG, rather
+//		than from a command line: the default configuration, the
+//	command line equivalent to any configuration, and a build into memory.
+//	The build itself, fftgen_build(), sits next to fftgen_main() in
+//	fftgen.cpp, since both share everything after the options are
+//	parsed.  See libfftgen.h.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "defaults.h"
+#include "fftsink.h"
+#include "libfftgen.h"
+
+// fftgen_defaults -- the configuration fftgen would use if given nothing
+// {{{
+void	fftgen_defaults(FFTGEN_CONFIG &cfg) {
+	cfg.m_fftsize    = -1;
+	cfg.m_nbitsin    = DEF_NBITSIN;
+	cfg.m_xtracbits  = DEF_XTRACBITS;
+	cfg.m_xtrapbits  = DEF_XTRAPBITS;
+	cfg.m_maxbitsout = -1;
+	cfg.m_nummpy     = DEF_NMPY;
+	cfg.m_nlanes     = 0;
+	cfg.m_ckpce      = 0;
+	cfg.m_radix      = 2;
+	cfg.m_twidgen    = 0;
+	cfg.m_mpyrows    = 1;
+	cfg.m_mpyoutregs = 0;
+
+	cfg.m_inverse    = false;
+	cfg.m_real       = false;
+	cfg.m_bitreverse = true;
+	cfg.m_dit        = false;
+	cfg.m_bfp        = false;
+	cfg.m_async_reset= false;
+	cfg.m_variable_size = false;
+	cfg.m_qtrwave    = false;
+	cfg.m_shared_rom = false;
+	cfg.m_verbose    = false;
+	cfg.m_estimate   = false;
+	cfg.m_twidbypass = false;
+	cfg.m_w8stage    = true;
+
+	cfg.m_coredir    = DEF_COREDIR;
+	cfg.m_hdrname    = "";
+	cfg.m_cmem       = "hex";
+	cfg.m_dsp        = "";
+	cfg.m_hwmpy      = "";
+	cfg.m_softmpy    = "bimpy";
+	cfg.m_cmpy       = "auto";
+}
+// }}}
+
+// fftgen_single_only -- true if cfg can only be built as a single clock FFT
+// {{{
+// That is, if it asks for any of -r, -R 22 or 23, -z, -t, -B, -q, -C, or -g.
+bool	fftgen_single_only(const FFTGEN_CONFIG &cfg) {
+	return (cfg.m_real)||(cfg.m_radix != 2)||(cfg.m_variable_size)
+		||(cfg.m_dit)||(cfg.m_bfp)||(cfg.m_qtrwave)
+		||(cfg.m_shared_rom)||(cfg.m_twidgen > 0);
+}
+// }}}
+
+// fftgen_args -- the fftgen command line describing cfg
+// {{{
+// The first argument is the program name, just as fftgen_main expects.
+// Given to fftgen_main, these build the same core fftgen_build(cfg) does.
+std::vector<std::string>	fftgen_args(const FFTGEN_CONFIG &cfg) {
+	std::vector<std::string>	args;
+
+	args.push_back("fftgen");
+	// -k comes first, since it also selects a single clock FFT, which
+	// any number of lanes given after it then overrides
+	if (cfg.m_ckpce > 0) {
+		args.push_back("-k");
+		args.push_back(std::to_string(cfg.m_ckpce));
+	}
+	if (cfg.m_nlanes > 0)
+		args.push_back("-" + std::to_string(cfg.m_nlanes));
+
+	args.push_back("-f");	args.push_back(std::to_string(cfg.m_fftsize));
+	args.push_back("-n");	args.push_back(std::to_string(cfg.m_nbitsin));
+	args.push_back("-c");	args.push_back(std::to_string(cfg.m_xtracbits));
+	args.push_back("-x");	args.push_back(std::to_string(cfg.m_xtrapbits));
+	if (cfg.m_maxbitsout > 0) {
+		args.push_back("-m");
+		args.push_back(std::to_string(cfg.m_maxbitsout));
+	}
+	args.push_back("-p");	args.push_back(std::to_string(cfg.m_nummpy));
+	args.push_back("-R");	args.push_back(std::to_string(cfg.m_radix));
+	if (cfg.m_twidgen > 0) {
+		args.push_back("-g");
+		args.push_back(std::to_string(cfg.m_twidgen));
+	}
+
+	if (cfg.m_inverse)	args.push_back("-i");
+	if (cfg.m_real)		args.push_back("-r");
+	args.push_back((cfg.m_bitreverse) ? "-S" : "-s");
+	if (cfg.m_dit)		args.push_back("-t");
+	if (cfg.m_bfp)		args.push_back("-B");
+	if (cfg.m_async_reset)	args.push_back("-A");
+	if (cfg.m_variable_size)args.push_back("-z");
+	if (cfg.m_qtrwave)	args.push_back("-q");
+	if (cfg.m_shared_rom)	args.push_back("-C");
+	if (cfg.m_verbose)	args.push_back("-v");
+	if (cfg.m_estimate)	args.push_back("-E");
+
+	if ((cfg.m_cmem.size() > 0)&&(cfg.m_cmem != "hex")) {
+		args.push_back("--cmem");
+		args.push_back(cfg.m_cmem);
+	}
+	if (cfg.m_dsp.size() > 0) {
+		args.push_back("--dsp");
+		args.push_back(cfg.m_dsp);
+	}
+	if (cfg.m_hwmpy.size() > 0) {
+		args.push_back("--hwmpy");
+		args.push_back(cfg.m_hwmpy);
+	}
+	if ((cfg.m_softmpy.size() > 0)&&(cfg.m_softmpy != "bimpy")) {
+		args.push_back("--softmpy");
+		args.push_back(cfg.m_softmpy);
+	}
+	if ((cfg.m_cmpy.size() > 0)&&(cfg.m_cmpy != "auto")) {
+		args.push_back("--cmpy");
+		args.push_back(cfg.m_cmpy);
+	}
+	if (cfg.m_mpyrows > 1) {
+		args.push_back("--mpyrows");
+		args.push_back(std::to_string(cfg.m_mpyrows));
+	}
+	if (cfg.m_mpyoutregs > 0) {
+		args.push_back("--mpyoutregs");
+		args.push_back(std::to_string(cfg.m_mpyoutregs));
+	}
+	if (cfg.m_twidbypass)	args.push_back("--twidbypass");
+	if (!cfg.m_w8stage)	args.push_back("--no-w8stage");
+
+	args.push_back("-d");	args.push_back(cfg.m_coredir);
+	if (cfg.m_hdrname.size() > 0) {
+		args.push_back("-a");
+		args.push_back(cfg.m_hdrname);
+	}
+
+	return args;
+}
+// }}}
+
+// fftgen_canonical -- cfg, with every option that needn't differ made equal
+// {{{
+// Those options with no effect upon the files built (-v), or with more than
+// one way of asking for the same thing, are set to just one of them.  Any
+// two configurations building the same core then give the same fftgen_args().
+FFTGEN_CONFIG	fftgen_canonical(const FFTGEN_CONFIG &cfg) {
+	FFTGEN_CONFIG	ncfg = cfg;
+
+	ncfg.m_verbose = false;
+	if (ncfg.m_nlanes < 1)
+		ncfg.m_nlanes = 1;
+	if (ncfg.m_ckpce < 1)
+		ncfg.m_ckpce = 1;
+	return ncfg;
+}
+// }}}
+
+// fftgen_cmdline -- the canonical fftgen command line building cfg
+// {{{
+// This is the command line fftmain.v quotes.  It's the same however the core
+// was asked for, so the files built don't change with the order of the
+// options, or with any option (-v, --cache) that doesn't change the core.
+std::string	fftgen_cmdline(const FFTGEN_CONFIG &cfg) {
+	std::vector<std::string>	args = fftgen_args(fftgen_canonical(cfg));
+	std::string	cmdline = args[0];
+
+	for(unsigned k=1; k<args.size(); k++)
+		cmdline += " " + args[k];
+	return cmdline;
+}
+// }}}
+
+// fftgen_build -- build a core into memory
+// {{{
+// On return, files maps the name of every file generated to its contents.
+static	void	fftgen_tomap(const char *fname, const char *data, size_t len,
+			void *arg) {
+	std::map<std::string, std::string> *files
+			= (std::map<std::string, std::string> *)arg;
+
+	(*files)[std::string(fname)] = std::string(data, len);
+}
+
+int	fftgen_build(const FFTGEN_CONFIG &cfg,
+			std::map<std::string, std::string> &files) {
+	return fftgen_build(cfg, fftgen_tomap, &files);
+}
+// }}}
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	libfftgen.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	The library interface to fftgen.  Rather than spawning fftgen
+//		for every core, a program may link against libfftgen.a,
+//	describe the core it wants in an FFTGEN_CONFIG, and have it built
+//	either into memory or into a sink of its own, without ever touching
+//	the file system.
+//
+//	Cores are built one at a time: these calls are not thread safe.
+//	They do, however, generate coefficient files on several threads of
+//	their own, so programs using this library must link with -pthread.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	LIBFFTGEN_H
+#define	LIBFFTGEN_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "fftsink.h"
+#include "estimate.h"
+
+// FFTGEN_CONFIG -- everything describing a core to be built
+// {{{
+// Each field matches one of fftgen's command line options.  Set them from
+// fftgen_defaults(), and then change only those you care about.
+typedef	struct	FFTGEN_CONFIG_S {
+	int		m_fftsize,	// -f, required
+			m_nbitsin,	// -n
+			m_xtracbits,	// -c
+			m_xtrapbits,	// -x
+			m_maxbitsout,	// -m, or -1 for no maximum
+			m_nummpy,	// -p
+			m_nlanes,	// -1, -2, -4, or -8, or 0 for the default
+			m_ckpce,	// -k, or 0 for the default (single clock)
+			m_radix,	// -R: 2, 22, or 23
+			m_twidgen,	// -g
+			m_mpyrows,	// --mpyrows, at least one
+			m_mpyoutregs;	// --mpyoutregs
+	bool		m_inverse,	// -i
+			m_real,		// -r
+			m_bitreverse,	// -S, or (if false) -s
+			m_dit,		// -t
+			m_bfp,		// -B
+			m_async_reset,	// -A
+			m_variable_size,// -z
+			m_qtrwave,	// -q
+			m_shared_rom,	// -C
+			m_verbose,	// -v, reports to stdout
+			m_estimate,	// -E, reports to stdout
+			m_twidbypass,	// --twidbypass
+			m_w8stage;	// Unless --no-w8stage
+	std::string	m_coredir,	// -d
+			m_hdrname,	// -a, or empty for no header
+			m_cmem,		// --cmem: hex, mif, coe, or rom
+			m_dsp,		// --dsp, such as 18x25, or empty
+			m_hwmpy,	// --hwmpy, or empty to follow -p
+			m_softmpy,	// --softmpy: bimpy or booth
+			m_cmpy;		// --cmpy: 3, 4, or auto
+} FFTGEN_CONFIG;
+// }}}
+
+extern	void	fftgen_defaults(FFTGEN_CONFIG &cfg);
+extern	bool	fftgen_single_only(const FFTGEN_CONFIG &cfg);
+extern	std::vector<std::string>	fftgen_args(const FFTGEN_CONFIG &cfg);
+extern	FFTGEN_CONFIG	fftgen_canonical(const FFTGEN_CONFIG &cfg);
+extern	std::string	fftgen_cmdline(const FFTGEN_CONFIG &cfg);
+extern	int	fftgen_main(int argc, char **argv);
+extern	int	fftgen_build(const FFTGEN_CONFIG &cfg, FFTSINK sink, void *arg);
+extern	int	fftgen_build(const FFTGEN_CONFIG &cfg,
+			std::map<std::string, std::string> &files);
+extern	int	fftgen_estimate(const FFTGEN_CONFIG &cfg, STAGEEST &total);
+
+#endif	// LIBFFTGEN_H
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	mpyalloc.cpp
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Decides which of the multiplying stages of an FFT get hardware
+//		multiplies (DSPs).  Every multiplying stage can be built
+//	either way: with DSPs, or with shift-add multiplies costing LUTs.
+//	Given a budget of DSPs (-p), the stages are chosen to save as many
+//	LUTs as possible, using the same estimates as -E.  As the widths grow
+//	through the pipeline, this usually means the last stages, but not
+//	always: once DSPs are tiled (--dsp), a stage whose multiplies just
+//	spill into a second DSP may no longer be worth it.
+//
+//	The choice can also be made by hand (--hwmpy), naming each stage
+//	that is to get hardware multiplies.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "estimate.h"
+#include "mpyalloc.h"
+
+// mpy_unit -- add a multiplying stage to the plan
+// {{{
+// The stage uses nbfly butterflies, each taking iw bits in and multiplying
+// by cw bit coefficients, at ckpce clocks per CE.  In LUTs, each butterfly
+// uses bfly_mpys() multiplies of (cw+1) bits by (iw+2).  In DSPs, it uses
+// those of its hwbfly, in either the three or four multiply form.  The tiles
+// recorded are those of its widest multiply.  It starts out without hardware
+// multiplies.
+void	mpy_unit(MPYPLAN &plan, const std::string &name, int nbfly,
+		int iw, int cw, int ckpce) {
+	MPYUNIT	unit;
+
+	unit.m_name  = name;
+	unit.m_fourmpy = cmpy_four(iw, cw, ckpce);
+	if (unit.m_fourmpy)
+		mpy_tiles(cw, iw+1, &unit.m_na, &unit.m_nb,
+					&unit.m_ta, &unit.m_tb);
+	else
+		mpy_tiles(cw+1, iw+2, &unit.m_na, &unit.m_nb,
+					&unit.m_ta, &unit.m_tb);
+	unit.m_dsps  = nbfly * bfly_dsps(iw, cw, ckpce);
+	unit.m_luts  = nbfly * bfly_mpys(ckpce) * mpy_luts(cw+1, iw+2);
+	unit.m_hwmpy = false;
+	plan.push_back(unit);
+}
+// }}}
+
+// mpy_allocate -- give hardware multiplies to the stages saving the most LUTs
+// {{{
+// This is a knapsack problem, small enough to solve exactly: best[b] is the
+// most LUTs that can be saved with b DSPs, using only the stages considered so
+// far.  Stages are considered in pipeline order, and a stage saving as many
+// LUTs as some earlier one is preferred, so that any tie goes to the stages
+// at the end of the pipeline.
+void	mpy_allocate(MPYPLAN &plan, int budget) {
+	const unsigned	nunits = plan.size();
+	int	total = 0;
+
+	for(unsigned k=0; k<nunits; k++) {
+		plan[k].m_hwmpy = false;
+		total += plan[k].m_dsps;
+	}
+
+	if (budget > total)
+		budget = total;
+	if (budget <= 0)
+		return;
+
+	std::vector<long>	best(budget+1, 0);
+	std::vector<std::vector<bool> >	take(nunits,
+					std::vector<bool>(budget+1, false));
+
+	for(unsigned k=0; k<nunits; k++) {
+		const int	cost = plan[k].m_dsps;
+
+		for(int b=budget; b >= cost; b--) {
+			long	with = best[b-cost] + plan[k].m_luts;
+
+			if (with >= best[b]) {
+				best[b] = with;
+				take[k][b] = true;
+			}
+		}
+	}
+
+	// Walk back through the stages, to find which were taken
+	for(int k=nunits-1, b=budget; k >= 0; k--) {
+		if (take[k][b]) {
+			plan[k].m_hwmpy = true;
+			b -= plan[k].m_dsps;
+		}
+	}
+}
+// }}}
+
+// mpy_override -- give hardware multiplies to those stages listed, and no more
+// {{{
+// The list is separated by commas, and names each stage as -E does, with or
+// without its stage_ prefix.  "none" gives no stage hardware multiplies.
+bool	mpy_override(MPYPLAN &plan, const char *list) {
+	std::string	str = list;
+	size_t		pos = 0;
+
+	for(unsigned k=0; k<plan.size(); k++)
+		plan[k].m_hwmpy = false;
+
+	if (str == "none")
+		return true;
+
+	while(pos <= str.size()) {
+		size_t		comma = str.find(',', pos);
+		std::string	name;
+		bool		found = false;
+
+		if (comma == std::string::npos)
+			comma = str.size();
+		name = str.substr(pos, comma-pos);
+		pos = comma+1;
+
+		for(unsigned k=0; k<plan.size(); k++) {
+			if ((plan[k].m_name == name)
+				||(plan[k].m_name == "stage_" + name)) {
+				plan[k].m_hwmpy = true;
+				found = true;
+			}
+		}
+
+		if (!found) {
+			fprintf(stderr, "ERR: No multiplying stage named \'%s\', --hwmpy %s\n", name.c_str(), list);
+			fprintf(stderr, "ERR: This FFT's multiplying stages are:");
+			for(unsigned k=0; k<plan.size(); k++)
+				fprintf(stderr, " %s", plan[k].m_name.c_str());
+			fprintf(stderr, "\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+// }}}
+
+// mpy_dsps_used -- the DSPs used by all of the stages given hardware multiplies
+// {{{
+int	mpy_dsps_used(const MPYPLAN &plan) {
+	int	used = 0;
+
+	for(unsigned k=0; k<plan.size(); k++)
+		if (plan[k].m_hwmpy)
+			used += plan[k].m_dsps;
+	return used;
+}
+// }}}
+
+// mpy_report -- describe each multiplying stage, and how it was built
+// {{{
+// Multiplies too wide for a single DSP also get the tiles they're cut into,
+// and stages given DSPs say if their complex products take four multiplies.
+void	mpy_report(FILE *fp, const MPYPLAN &plan) {
+	for(unsigned k=0; k<plan.size(); k++) {
+		fprintf(fp, "    %-12s %4d DSP%s or %6d LUTs: %s",
+			plan[k].m_name.c_str(), plan[k].m_dsps,
+			(plan[k].m_dsps == 1) ? " " : "s", plan[k].m_luts,
+			(plan[k].m_hwmpy) ? "DSPs" : "LUTs");
+		if (plan[k].m_na * plan[k].m_nb > 1)
+			fprintf(fp, ", %dx%d tiles of %dx%d per multiply",
+				plan[k].m_na, plan[k].m_nb,
+				plan[k].m_ta, plan[k].m_tb);
+		if ((plan[k].m_hwmpy)&&(plan[k].m_fourmpy))
+			fprintf(fp, ", four multiplies per complex product");
+		fprintf(fp, "\n");
+	}
+}
+// }}}
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	mpyalloc.h
+// {{{
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Decides which of the multiplying stages of an FFT get hardware
+//		multiplies (DSPs), and which are left to build their
+//	multiplies from LUTs.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2015-2024, Gisselquist Technology, LLC
+// {{{
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	GPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#ifndef	MPYALLOC_H
+#define	MPYALLOC_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// MPYUNIT -- a stage that can use hardware multiplies, or not
+// {{{
+typedef	struct	MPYUNIT_S {
+	std::string	m_name;		// As named by -E, such as stage_1024
+	int		m_dsps,		// DSPs used, given hardware multiplies
+			m_luts,		// LUTs used, if not
+			m_na, m_nb,	// DSP tiles per multiply, m_na x m_nb,
+			m_ta, m_tb;	// ... each of m_ta x m_tb bits
+	bool		m_fourmpy,	// Four multiplies per complex product
+			m_hwmpy;	// True if given hardware multiplies
+} MPYUNIT;
+// }}}
+
+// The multiplying stages of an FFT, in pipeline order
+typedef	std::vector<MPYUNIT>	MPYPLAN;
+
+extern	void	mpy_unit(MPYPLAN &plan, const std::string &name, int nbfly,
+			int iw, int cw, int ckpce);
+extern	void	mpy_allocate(MPYPLAN &plan, int budget);
+extern	bool	mpy_override(MPYPLAN &plan, const char *list);
+extern	int	mpy_dsps_used(const MPYPLAN &plan);
+extern	void	mpy_report(FILE *fp, const MPYPLAN &plan);
+
+#endif	// MPYALLOC_H
@@ -49,19 +49,20 @@
 #include <assert.h>
 
 #include "legal.h"
+#include "fftsink.h"
 #include "rounding.h"
 
 #define	SLASHLINE "////////////////////////////////////////////////////////////////////////////////\n"
 
 // build_truncator
 // {{{
-void	build_truncator(const char *fname) {
+int	build_truncator(const char *fname) {
 	printf("TRUNCATING!\n");
-	FILE	*fp = fopen(fname, "w");
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -102,17 +103,18 @@ SLASHLINE
 		"\t\t\to_val <= i_val[(IWID-1-SHIFT):(IWID-SHIFT-OWID)];\n"
 "\n"
 "endmodule\n");
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_roundhalfup
 // {{{
-void	build_roundhalfup(const char *fname) {
-	FILE	*fp = fopen(fname, "w");
+int	build_roundhalfup(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -176,17 +178,18 @@ SLASHLINE
 	"\tendgenerate\n"
 "\n"
 "endmodule\n");
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_roundfromzero
 // {{{
-void	build_roundfromzero(const char *fname) {
-	FILE	*fp = fopen(fname, "w");
+int	build_roundfromzero(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -300,17 +303,18 @@ SLASHLINE
 	"\tendgenerate\n"
 "\n"
 "endmodule\n");
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_convround
 // {{{
-void	build_convround(const char *fname) {
-	FILE	*fp = fopen(fname, "w");
+int	build_convround(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -426,6 +430,7 @@ SLASHLINE
 "\tendgenerate\n"
 "\n"
 "endmodule\n");
+	return fftsink_close(fp);
 }
 // }}}
 
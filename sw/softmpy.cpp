@@ -58,16 +58,17 @@
 
 #include "defaults.h"
 #include "legal.h"
+#include "fftsink.h"
 #include "softmpy.h"
 
 // build_multiply
 // {{{
-void	build_multiply(const char *fname) {
-	FILE	*fp = fopen(fname, "w");
+int	build_multiply(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -165,18 +166,18 @@ SLASHLINE
 "\n"
 "endmodule\n");
 
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_bimpy -- the binary sub-multiply (everything else is addition)
 // {{{
-void	build_bimpy(const char *fname) {
-	FILE	*fp = fopen(fname, "w");
+int	build_bimpy(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -302,18 +303,18 @@ SLASHLINE
 "// }}}\n"
 "endmodule\n");
 
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
 
 // build_longbimpy
 // {{{
-void	build_longbimpy(const char *fname) {
-	FILE	*fp = fopen(fname, "w");
+int	build_longbimpy(const char *fname, int rows, int outregs) {
+	FILE	*fp = fftsink_open(fname);
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
-		return;
+		return EOF;
 	}
 
 	fprintf(fp,
@@ -351,16 +352,24 @@ SLASHLINE
 #endif
 
 	fprintf(fp, ",	// The width of i_b, can be anything\n"
+	"\t\t// ROWS is the number of rows of the tableau added together\n"
+	"\t\t// between registers.  More rows take fewer clocks, at a lower\n"
+	"\t\t// clock speed.  OUTREGS more registers follow the final\n"
+	"\t\t// accumulate, for the synthesizer to retime into it.\n"
+	"\t\tparameter	ROWS=%d, OUTREGS=%d,\n"
 			"\t\t\t// The following three parameters should not be changed\n"
 			"\t\t\t// by any implementation, but are based upon hardware\n"
 			"\t\t\t// and the above values:\n"
-			"\t\t\t// OW=IAW+IBW;	// The output width\n");
+			"\t\t\t// OW=IAW+IBW;	// The output width\n",
+			rows, outregs);
 	fprintf(fp,
 	"\t\tlocalparam	AW = (IAW<IBW) ? IAW : IBW,\n"
 			"\t\t\t\tBW = (IAW<IBW) ? IBW : IAW,\n"
 			"\t\t\t\tIW=(AW+1)&(-2),	// Internal width of A\n"
 			"\t\t\t\tLUTB=2,	// How many bits to mpy at once\n"
-			"\t\t\t\tTLEN=(AW+(LUTB-1))/LUTB // Rows in our tableau\n"
+			"\t\t\t\tTLEN=(AW+(LUTB-1))/LUTB, // Rows in our tableau\n"
+			"\t\t\t\tNSTG=(TLEN+ROWS-1)/ROWS, // Clocks to accumulate\n"
+			"\t\t\t\tNDLY=NSTG+OUTREGS // Clocks from u_a to w_r\n"
 	"\t\t// }}}\n"
 	"\t) (\n"
 	"\t\t// {{{\n"
@@ -398,12 +407,12 @@ SLASHLINE
 "\n"
 	"\treg\t[(IW-1-2*(LUTB)):0]\tr_a[0:(TLEN-3)];\n"
 	"\treg\t[(BW-1):0]\t\tr_b[0:(TLEN-3)];\n"
-	"\treg\t[(TLEN-1):0]\t\tr_s;\n"
+	"\treg\t[(NDLY-1):0]\t\tr_s;\n"
 	"\treg\t[(IW+BW-1):0]\t\tacc[0:(TLEN-2)];\n"
 	"\tgenvar k;\n"
 "\n"
 	"\twire	[(BW+LUTB-1):0]	pr_a, pr_b;\n"
-	"\twire	[(IW+BW-1):0]	w_r;\n"
+	"\twire	[(IW+BW-1):0]	w_acc, w_sum, w_r;\n"
 	"\t// }}}\n");
 
 	fprintf(fp,
@@ -448,108 +457,212 @@ SLASHLINE
 	"\tend\n"
 	"\t// }}}\n"
 "\n"
-	"\t//\n"
-	"\t// Second step: First two 2xN products.\n"
-	"\t//\n"
-	"\t// Since we have no tableau of additions (yet), we can do both\n"
-	"\t// of the first two rows at the same time and add them together.\n"
-	"\t// For the next round, we'll then have a previous sum to accumulate\n"
-	"\t// with new and subsequent product, and so only do one product at\n"
-	"\t// a time can follow this--but the first clock can do two at a time.\n"
-	"\tbimpy\t#(\n"
-	"\t\t.BW(BW)\n"
-	"\t) lmpy_0(\n"
-	"\t\t// {{{\n"
-	"\t\t.i_clk(i_clk),.i_reset(1\'b0),.i_ce(i_ce),\n"
-	"\t\t.i_a(u_a[(  LUTB-1):   0]),\n"
-	"\t\t.i_b(u_b),\n"
-	"\t\t.o_r(pr_a)\n"
-	"\t\t// }}}\n"
-	"\t);\n"
-	"\tbimpy\t#(\n"
-	"\t\t.BW(BW)\n"
-	"\t) lmpy_1(\n"
+	"\t// r_s\n"
+	"\t// {{{\n"
+	"\t// The sign of the product, delayed to match the accumulate\n"
+	"\tinitial r_s = 0;\n"
+	"\tgenerate if (NDLY > 1)\n"
+	"\tbegin : SGN_DELAY\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tr_s <= { r_s[(NDLY-2):0], sgn };\n"
+	"\tend else begin : SGN_ONE\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tr_s <= sgn;\n"
+	"\tend endgenerate\n"
+	"\t// }}}\n"
+"\n"
+	"\tgenerate if (ROWS <= 1)\n"
+	"\tbegin : ONE_ROW\n"
 	"\t\t// {{{\n"
-	"\t\t.i_clk(i_clk),.i_reset(1\'b0),.i_ce(i_ce),\n"
-	"\t\t.i_a(u_a[(2*LUTB-1):LUTB]),\n"
-	"\t\t.i_b(u_b),\n"
-	"\t\t.o_r(pr_b)\n"
-	"\t\t// }}}\n"
-	"\t);\n"
+	"\t\t//\n"
+	"\t\t// Second step: First two 2xN products.\n"
+	"\t\t//\n"
+	"\t\t// Since we have no tableau of additions (yet), we can do both\n"
+	"\t\t// of the first two rows at the same time and add them together.\n"
+	"\t\t// For the next round, we'll then have a previous sum to\n"
+	"\t\t// accumulate with new and subsequent product, and so only do\n"
+	"\t\t// one product at a time can follow this--but the first clock\n"
+	"\t\t// can do two at a time.\n"
+	"\t\tbimpy\t#(\n"
+	"\t\t\t.BW(BW)\n"
+	"\t\t) lmpy_0(\n"
+	"\t\t\t// {{{\n"
+	"\t\t\t.i_clk(i_clk),.i_reset(1\'b0),.i_ce(i_ce),\n"
+	"\t\t\t.i_a(u_a[(  LUTB-1):   0]),\n"
+	"\t\t\t.i_b(u_b),\n"
+	"\t\t\t.o_r(pr_a)\n"
+	"\t\t\t// }}}\n"
+	"\t\t);\n"
+	"\t\tbimpy\t#(\n"
+	"\t\t\t.BW(BW)\n"
+	"\t\t) lmpy_1(\n"
+	"\t\t\t// {{{\n"
+	"\t\t\t.i_clk(i_clk),.i_reset(1\'b0),.i_ce(i_ce),\n"
+	"\t\t\t.i_a(u_a[(2*LUTB-1):LUTB]),\n"
+	"\t\t\t.i_b(u_b),\n"
+	"\t\t\t.o_r(pr_b)\n"
+	"\t\t\t// }}}\n"
+	"\t\t);\n"
 	"\n"
-	"\t// r_s, r_a[0], r_b[0]\n"
-	"\t// {{{\n"
-	"\tinitial r_s    = 0;\n"
-	"\tinitial r_a[0] = 0;\n"
-	"\tinitial r_b[0] = 0;\n"
-	"\talways @(posedge i_clk)\n"
-	"\tif (i_ce)\n"
-	"\tbegin\n"
-		"\t\tr_a[0] <= u_a[(IW-1):(2*LUTB)];\n"
-		"\t\tr_b[0] <= u_b;\n"
-		"\t\tr_s <= { r_s[(TLEN-2):0], sgn };\n"
-	"\tend\n\t// }}}\n"
+	"\t\t// r_a[0], r_b[0]\n"
+	"\t\t// {{{\n"
+	"\t\tinitial r_a[0] = 0;\n"
+	"\t\tinitial r_b[0] = 0;\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (i_ce)\n"
+	"\t\tbegin\n"
+		"\t\t\tr_a[0] <= u_a[(IW-1):(2*LUTB)];\n"
+		"\t\t\tr_b[0] <= u_b;\n"
+	"\t\tend\n\t\t// }}}\n"
 	"\n"
-	"\t// acc[0]\n"
-	"\t// {{{\n"
-	"\tinitial acc[0] = 0;\n"
-	"\talways @(posedge i_clk) // One clk after p[0],p[1] become valid\n"
-	"\tif (i_ce)\n"
-	"\t\tacc[0] <= { {(IW-LUTB){1\'b0}}, pr_a}\n"
-		"\t\t  +{ {(IW-(2*LUTB)){1\'b0}}, pr_b, {(LUTB){1\'b0}} };\n"
-	"\t// }}}\n"
+	"\t\t// acc[0]\n"
+	"\t\t// {{{\n"
+	"\t\tinitial acc[0] = 0;\n"
+	"\t\talways @(posedge i_clk) // One clk after p[0],p[1] become valid\n"
+	"\t\tif (i_ce)\n"
+	"\t\t\tacc[0] <= { {(IW-LUTB){1\'b0}}, pr_a}\n"
+		"\t\t\t  +{ {(IW-(2*LUTB)){1\'b0}}, pr_b, {(LUTB){1\'b0}} };\n"
+	"\t\t// }}}\n"
 "\n"
-	"\t// r_a[TLEN-3:1], r_b[TLEN-3:1]\n"
-	"\t// {{{\n"
-	"\tgenerate begin : COPY\n"
-	"\t// Keep track of intermediate values, before multiplying them\n"
-	"\tif (TLEN > 3) begin : FOR\n"
-	"\tfor(k=0; k<TLEN-3; k=k+1)\n"
-	"\tbegin : GENCOPIES\n"
+	"\t\t// r_a[TLEN-3:1], r_b[TLEN-3:1]\n"
+	"\t\t// {{{\n"
+	"\t\t// Keep track of intermediate values, before multiplying them\n"
+	"\t\tif (TLEN > 3) begin : COPY\n"
+	"\t\tfor(k=0; k<TLEN-3; k=k+1)\n"
+	"\t\tbegin : GENCOPIES\n"
 		"\n"
-		"\t\tinitial r_a[k+1] = 0;\n"
-		"\t\tinitial r_b[k+1] = 0;\n"
-		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (i_ce)\n"
-		"\t\tbegin\n"
-			"\t\t\tr_a[k+1] <= { {(LUTB){1\'b0}},\n"
-				"\t\t\t\tr_a[k][(IW-1-(2*LUTB)):LUTB] };\n"
-			"\t\t\tr_b[k+1] <= r_b[k];\n"
-			"\t\tend\n"
-	"\tend end end endgenerate\n"
-	"\t// }}}\n"
+		"\t\t\tinitial r_a[k+1] = 0;\n"
+		"\t\t\tinitial r_b[k+1] = 0;\n"
+		"\t\t\talways @(posedge i_clk)\n"
+		"\t\t\tif (i_ce)\n"
+		"\t\t\tbegin\n"
+			"\t\t\t\tr_a[k+1] <= { {(LUTB){1\'b0}},\n"
+				"\t\t\t\t\tr_a[k][(IW-1-(2*LUTB)):LUTB] };\n"
+			"\t\t\t\tr_b[k+1] <= r_b[k];\n"
+			"\t\t\tend\n"
+	"\t\tend end\n"
+	"\t\t// }}}\n"
 "\n"
-	"\t// acc[TLEN-2:1]\n"
-	"\t// {{{\n"
-	"\tgenerate begin : STAGES\n"
-	"\t// The actual multiply and accumulate stage\n"
-	"\tif (TLEN > 2) begin : FOR\n"
-	"\tfor(k=0; k<TLEN-2; k=k+1)\n"
-	"\tbegin : GENSTAGES\n"
-		"\t\twire\t[(BW+LUTB-1):0] genp;\n"
+	"\t\t// acc[TLEN-2:1]\n"
+	"\t\t// {{{\n"
+	"\t\t// The actual multiply and accumulate stage\n"
+	"\t\tif (TLEN > 2) begin : STAGES\n"
+	"\t\tfor(k=0; k<TLEN-2; k=k+1)\n"
+	"\t\tbegin : GENSTAGES\n"
+		"\t\t\twire\t[(BW+LUTB-1):0] genp;\n"
 		"\n"
-		"\t\t// First, the multiply: 2-bits times BW bits\n"
-		"\t\tbimpy #(\n"
-		"\t\t\t.BW(BW)\n"
-		"\t\t) genmpy(\n"
+		"\t\t\t// First, the multiply: 2-bits times BW bits\n"
+		"\t\t\tbimpy #(\n"
+		"\t\t\t\t.BW(BW)\n"
+		"\t\t\t) genmpy(\n"
+		"\t\t\t\t// {{{\n"
+		"\t\t\t\t.i_clk(i_clk),.i_reset(1\'b0),.i_ce(i_ce),\n"
+		"\t\t\t\t.i_a(r_a[k][(LUTB-1):0]),\n"
+		"\t\t\t\t.i_b(r_b[k]),\n"
+		"\t\t\t\t.o_r(genp)\n"
+		"\t\t\t\t// }}}\n"
+		"\t\t\t);\n"
+"\n"
+		"\t\t\t// Then the accumulate step -- on the next clock\n"
+		"\t\t\tinitial acc[k+1] = 0;\n"
+		"\t\t\talways @(posedge i_clk)\n"
+		"\t\t\tif (i_ce)\n"
+			"\t\t\t\tacc[k+1] <= acc[k] + {{(IW-LUTB*(k+3)){1\'b0}},\n"
+				"\t\t\t\t\tgenp, {(LUTB*(k+2)){1\'b0}} };\n"
+	"\t\tend end\n"
+	"\t\t// }}}\n"
+"\n"
+	"\t\tassign\tw_acc = acc[TLEN-2];\n"
+	"\t\t// }}}\n"
+	"\tend else begin : MULTI_ROW\n"
+	"\t\t// {{{\n"
+	"\t\t// Add ROWS rows of the tableau together on each clock, rather\n"
+	"\t\t// than one.  Each row is two bits of A times all of B, shifted\n"
+	"\t\t// into place, just as the bimpy would produce it.\n"
+	"\t\treg\t[(IW-1):0]\tm_a\t[0:(NSTG-1)];\n"
+	"\t\treg\t[(BW-1):0]\tm_b\t[0:(NSTG-1)];\n"
+	"\t\treg\t[(IW+BW-1):0]\tm_acc\t[0:(NSTG-1)];\n"
+"\n"
+	"\t\tfor(k=0; k<NSTG; k=k+1)\n"
+	"\t\tbegin : GENSTAGES\n"
 		"\t\t\t// {{{\n"
-		"\t\t\t.i_clk(i_clk),.i_reset(1\'b0),.i_ce(i_ce),\n"
-		"\t\t\t.i_a(r_a[k][(LUTB-1):0]),\n"
-		"\t\t\t.i_b(r_b[k]),\n"
-		"\t\t\t.o_r(genp)\n"
+		"\t\t\tlocalparam\tLAST = ((k+1)*ROWS < TLEN) ? (k+1)*ROWS : TLEN;\n"
+		"\t\t\twire\t[(IW-1):0]\ts_a;\n"
+		"\t\t\twire\t[(BW-1):0]\ts_b;\n"
+		"\t\t\twire\t[(IW+BW-1):0]\ts_acc;\n"
+		"\t\t\treg\t[(BW+LUTB-1):0]\ts_p;\n"
+		"\t\t\treg\t[(IW+BW-1):0]\ts_rows;\n"
+		"\t\t\tinteger\t\t\tj;\n"
+"\n"
+		"\t\t\tif (k == 0)\n"
+		"\t\t\tbegin : FIRST\n"
+			"\t\t\t\tassign\ts_a   = u_a;\n"
+			"\t\t\t\tassign\ts_b   = u_b;\n"
+			"\t\t\t\tassign\ts_acc = 0;\n"
+		"\t\t\tend else begin : NEXT\n"
+			"\t\t\t\tassign\ts_a   = m_a[k-1];\n"
+			"\t\t\t\tassign\ts_b   = m_b[k-1];\n"
+			"\t\t\t\tassign\ts_acc = m_acc[k-1];\n"
+		"\t\t\tend\n"
+"\n"
+		"\t\t\t// The rows k*ROWS through LAST-1 of the tableau\n"
+		"\t\t\talways @(*)\n"
+		"\t\t\tbegin\n"
+			"\t\t\t\ts_rows = 0;\n"
+			"\t\t\t\tfor(j=k*ROWS; j<LAST; j=j+1)\n"
+			"\t\t\t\tbegin\n"
+				"\t\t\t\t\ts_p = ((s_a[LUTB*j+1]) ? { s_b, 1\'b0 } : {(BW+1){1\'b0}})\n"
+				"\t\t\t\t\t\t+ ((s_a[LUTB*j]) ? { 1\'b0, s_b } : {(BW+1){1\'b0}});\n"
+				"\t\t\t\t\ts_rows = s_rows\n"
+				"\t\t\t\t\t\t+ ({ {(IW-LUTB){1\'b0}}, s_p } << (LUTB*j));\n"
+			"\t\t\t\tend\n"
+		"\t\t\tend\n"
+"\n"
+		"\t\t\tinitial m_a[k]   = 0;\n"
+		"\t\t\tinitial m_b[k]   = 0;\n"
+		"\t\t\tinitial m_acc[k] = 0;\n"
+		"\t\t\talways @(posedge i_clk)\n"
+		"\t\t\tif (i_ce)\n"
+		"\t\t\tbegin\n"
+			"\t\t\t\tm_a[k]   <= s_a;\n"
+			"\t\t\t\tm_b[k]   <= s_b;\n"
+			"\t\t\t\tm_acc[k] <= s_acc + s_rows;\n"
+		"\t\t\tend\n"
 		"\t\t\t// }}}\n"
-		"\t\t);\n"
+	"\t\tend\n"
+"\n"
+	"\t\tassign\tw_acc = m_acc[NSTG-1];\n"
+	"\t\t// }}}\n"
+	"\tend endgenerate\n"
+"\n"
+	"\t// w_sum: the accumulator, after OUTREGS more registers\n"
+	"\t// {{{\n"
+	"\tgenerate if (OUTREGS > 0)\n"
+	"\tbegin : OUTPUT_REGS\n"
+		"\t\treg\t[(IW+BW-1):0]\tr_out\t[0:(OUTREGS-1)];\n"
 "\n"
-		"\t\t// Then the accumulate step -- on the next clock\n"
-		"\t\tinitial acc[k+1] = 0;\n"
+		"\t\tinitial r_out[0] = 0;\n"
 		"\t\talways @(posedge i_clk)\n"
 		"\t\tif (i_ce)\n"
-			"\t\t\tacc[k+1] <= acc[k] + {{(IW-LUTB*(k+3)){1\'b0}},\n"
-				"\t\t\t\tgenp, {(LUTB*(k+2)){1\'b0}} };\n"
-	"\tend end end endgenerate\n"
+			"\t\t\tr_out[0] <= w_acc;\n"
+"\n"
+		"\t\tfor(k=1; k<OUTREGS; k=k+1)\n"
+		"\t\tbegin : OUTREG\n"
+			"\t\t\tinitial r_out[k] = 0;\n"
+			"\t\t\talways @(posedge i_clk)\n"
+			"\t\t\tif (i_ce)\n"
+				"\t\t\t\tr_out[k] <= r_out[k-1];\n"
+		"\t\tend\n"
+"\n"
+		"\t\tassign\tw_sum = r_out[OUTREGS-1];\n"
+	"\tend else begin : NO_OUTPUT_REGS\n"
+		"\t\tassign\tw_sum = w_acc;\n"
+	"\tend endgenerate\n"
 	"\t// }}}\n"
 "\n"
-	"\tassign\tw_r = (r_s[TLEN-1]) ? (-acc[TLEN-2]) : acc[TLEN-2];\n"
+	"\tassign\tw_r = (r_s[NDLY-1]) ? (-w_sum) : w_sum;\n"
 	"\n"
 	"\t// o_r\n"
 	"\t// {{{\n"
@@ -607,9 +720,9 @@ SLASHLINE
 
 	// Now for properties specific to this core
 		fprintf(fp,
-	"\treg	[AW-1:0]	f_past_a	[0:TLEN];\n"
-	"\treg	[BW-1:0]	f_past_b	[0:TLEN];\n"
-	"\treg	[TLEN+1:0]	f_sgn_a, f_sgn_b;\n"
+	"\treg	[AW-1:0]	f_past_a	[0:NDLY];\n"
+	"\treg	[BW-1:0]	f_past_b	[0:NDLY];\n"
+	"\treg	[NDLY+1:0]	f_sgn_a, f_sgn_b;\n"
 "\n");
 
 		fprintf(fp,
@@ -628,7 +741,7 @@ SLASHLINE
 "\n");
 
 		fprintf(fp,
-	"\tgenerate for(k=0; k<TLEN; k=k+1)\n"
+	"\tgenerate for(k=0; k<NDLY; k=k+1)\n"
 	"\tbegin : F_PAST\n"
 		"\t\tinitial\tf_past_a[k+1] = 0;\n"
 		"\t\tinitial\tf_past_b[k+1] = 0;\n"
@@ -650,8 +763,8 @@ SLASHLINE
 	"\talways @(posedge i_clk)\n"
 	"\tif (i_ce)\n"
 	"\tbegin\n"
-		"\t\tf_sgn_a[TLEN+1] <= f_sgn_a[TLEN];\n"
-		"\t\tf_sgn_b[TLEN+1] <= f_sgn_b[TLEN];\n"
+		"\t\tf_sgn_a[NDLY+1] <= f_sgn_a[NDLY];\n"
+		"\t\tf_sgn_b[NDLY+1] <= f_sgn_b[NDLY];\n"
 	"\tend\n"
 "\n");
 
@@ -659,8 +772,8 @@ SLASHLINE
 	"\talways @(posedge i_clk)\n"
 	"\tbegin\n"
 		"\t\tassert(sgn == (f_sgn_a[0] ^ f_sgn_b[0]));\n"
-		"\t\tassert(r_s[TLEN-1:0] == (f_sgn_a[TLEN:1] ^ f_sgn_b[TLEN:1]));\n"
-		"\t\tassert(r_s[TLEN-1:0] == (f_sgn_a[TLEN:1] ^ f_sgn_b[TLEN:1]));\n"
+		"\t\tassert(r_s[NDLY-1:0] == (f_sgn_a[NDLY:1] ^ f_sgn_b[NDLY:1]));\n"
+		"\t\tassert(r_s[NDLY-1:0] == (f_sgn_a[NDLY:1] ^ f_sgn_b[NDLY:1]));\n"
 	"\tend\n"
 "\n");
 
@@ -685,7 +798,7 @@ SLASHLINE
 		fprintf(fp,
 	"\tgenerate begin : F_ASSERT_ZERO\n"
 	"\t// Keep track of intermediate values, before multiplying them\n"
-	"\tif (TLEN > 3) begin : FOR\n"
+	"\tif ((ROWS <= 1)&&(TLEN > 3)) begin : FOR\n"
 	"\tfor(k=0; k<TLEN-3; k=k+1)\n"
 	"\tbegin : ASSERT_GENCOPY\n"
 		"\t\talways @(posedge i_clk)\n"
@@ -704,7 +817,7 @@ SLASHLINE
 		fprintf(fp,
 	"\tgenerate begin : F_ACC\n"
 	"\t// The actual multiply and accumulate stage\n"
-	"\tif (TLEN > 2) begin : FOR\n"
+	"\tif ((ROWS <= 1)&&(TLEN > 2)) begin : FOR\n"
 	"\tfor(k=0; k<TLEN-2; k=k+1)\n"
 	"\tbegin : ASSERT_GENSTAGE\n"
 		"\t\talways @(posedge i_clk)\n"
@@ -727,35 +840,35 @@ SLASHLINE
 "\n");
 
 		fprintf(fp,
-	"\twire	[AW-1:0]\tf_past_a_neg = - f_past_a[TLEN];\n"
-	"\twire	[BW-1:0]\tf_past_b_neg = - f_past_b[TLEN];\n"
+	"\twire	[AW-1:0]\tf_past_a_neg = - f_past_a[NDLY];\n"
+	"\twire	[BW-1:0]\tf_past_b_neg = - f_past_b[NDLY];\n"
 "\n"
-	"\twire	[AW-1:0]\tf_past_a_pos = f_past_a[TLEN][AW-1]\n"
-				"\t\t\t\t\t? f_past_a_neg : f_past_a[TLEN];\n"
-	"\twire	[BW-1:0]\tf_past_b_pos = f_past_b[TLEN][BW-1]\n"
-				"\t\t\t\t\t? f_past_b_neg : f_past_b[TLEN];\n\n");
+	"\twire	[AW-1:0]\tf_past_a_pos = f_past_a[NDLY][AW-1]\n"
+				"\t\t\t\t\t? f_past_a_neg : f_past_a[NDLY];\n"
+	"\twire	[BW-1:0]\tf_past_b_pos = f_past_b[NDLY][BW-1]\n"
+				"\t\t\t\t\t? f_past_b_neg : f_past_b[NDLY];\n\n");
 
 		fprintf(fp,
 	"\talways @(posedge i_clk)\n"
 	"\tif ((f_past_valid)&&($past(i_ce)))\n"
 	"\tbegin\n"
-		"\t\tif ((f_past_a[TLEN]==0)||(f_past_b[TLEN]==0))\n"
+		"\t\tif ((f_past_a[NDLY]==0)||(f_past_b[NDLY]==0))\n"
 		"\t\tbegin\n"
 			"\t\t\t`ASSERT(o_r == 0);\n"
-		"\t\tend else if (f_past_a[TLEN]==1)\n"
+		"\t\tend else if (f_past_a[NDLY]==1)\n"
 		"\t\tbegin\n"
-			"\t\t\tif ((f_sgn_a[TLEN+1]^f_sgn_b[TLEN+1])==0)\n"
+			"\t\t\tif ((f_sgn_a[NDLY+1]^f_sgn_b[NDLY+1])==0)\n"
 			"\t\t\tbegin\n"
 				"\t\t\t\t`ASSERT(o_r[BW-1:0] == f_past_b_pos[BW-1:0]);\n"
 				"\t\t\t\t`ASSERT(o_r[AW+BW-1:BW] == 0);\n"
-			"\t\t\tend else begin // if (f_sgn_b[TLEN+1]) begin\n"
+			"\t\t\tend else begin // if (f_sgn_b[NDLY+1]) begin\n"
 				"\t\t\t\t`ASSERT(o_r[BW-1:0] == f_past_b_neg);\n"
 				"\t\t\t\t`ASSERT(o_r[AW+BW-1:BW]\n"
 					"\t\t\t\t\t== {(AW){f_past_b_neg[BW-1]}});\n"
 			"\t\t\tend\n"
-		"\t\tend else if (f_past_b[TLEN]==1)\n"
+		"\t\tend else if (f_past_b[NDLY]==1)\n"
 		"\t\tbegin\n"
-			"\t\t\tif ((f_sgn_a[TLEN+1] ^ f_sgn_b[TLEN+1])==0)\n"
+			"\t\t\tif ((f_sgn_a[NDLY+1] ^ f_sgn_b[NDLY+1])==0)\n"
 			"\t\t\tbegin\n"
 				"\t\t\t\t`ASSERT(o_r[AW-1:0] == f_past_a_pos[AW-1:0]);\n"
 				"\t\t\t\t`ASSERT(o_r[AW+BW-1:AW] == 0);\n"
@@ -768,9 +881,9 @@ SLASHLINE
 			"\t\t\t`ASSERT(o_r != 0);\n"
 			"\t\t\tif (!o_r[AW+BW-1:0])\n"
 			"\t\t\tbegin\n"
-				"\t\t\t\t`ASSERT((o_r[AW-1:0] != f_past_a[TLEN][AW-1:0])\n"
+				"\t\t\t\t`ASSERT((o_r[AW-1:0] != f_past_a[NDLY][AW-1:0])\n"
 					"\t\t\t\t\t||(o_r[AW+BW-1:AW]!=0));\n"
-				"\t\t\t\t`ASSERT((o_r[BW-1:0] != f_past_b[TLEN][BW-1:0])\n"
+				"\t\t\t\t`ASSERT((o_r[BW-1:0] != f_past_b[NDLY][BW-1:0])\n"
 					"\t\t\t\t\t||(o_r[AW+BW-1:BW]!=0));\n"
 			"\t\t\tend else begin\n"
 				"\t\t\t\t`ASSERT((o_r[AW-1:0] != f_past_a_neg[AW-1:0])\n"
@@ -786,15 +899,15 @@ SLASHLINE
 	"\tgenerate begin : F_ABS\n"
 	"\tif (IAW <= IBW)\n"
 	"\tbegin : NO_PARAM_CHANGE_II\n"
-		"\t\tassign f_past_a_unsorted = (!f_sgn_a[TLEN+1])\n"
-				"\t\t\t\t\t? f_past_a[TLEN] : f_past_a_neg;\n"
-		"\t\tassign f_past_b_unsorted = (!f_sgn_b[TLEN+1])\n"
-				"\t\t\t\t\t? f_past_b[TLEN] : f_past_b_neg;\n"
+		"\t\tassign f_past_a_unsorted = (!f_sgn_a[NDLY+1])\n"
+				"\t\t\t\t\t? f_past_a[NDLY] : f_past_a_neg;\n"
+		"\t\tassign f_past_b_unsorted = (!f_sgn_b[NDLY+1])\n"
+				"\t\t\t\t\t? f_past_b[NDLY] : f_past_b_neg;\n"
 	"\tend else begin : SWAP_PARAMETERS_II\n"
-		"\t\tassign f_past_a_unsorted = (!f_sgn_b[TLEN+1])\n"
-				"\t\t\t\t\t? f_past_b[TLEN] : f_past_b_neg;\n"
-		"\t\tassign f_past_b_unsorted = (!f_sgn_a[TLEN+1])\n"
-				"\t\t\t\t\t? f_past_a[TLEN] : f_past_a_neg;\n"
+		"\t\tassign f_past_a_unsorted = (!f_sgn_b[NDLY+1])\n"
+				"\t\t\t\t\t? f_past_b[NDLY] : f_past_b_neg;\n"
+		"\t\tassign f_past_b_unsorted = (!f_sgn_a[NDLY+1])\n"
+				"\t\t\t\t\t? f_past_a[NDLY] : f_past_a_neg;\n"
 	"\tend end endgenerate\n");
 
 		fprintf(fp,
@@ -828,7 +941,7 @@ SLASHLINE
 	"\t// our internal values.  ASSERT therefore that we never get out\n"
 	"\t// of bounds\n"
 	"\tgenerate begin : F_PAST_ZERO\n"
-	"\tfor(k=0; k<TLEN; k=k+1)\n"
+	"\tfor(k=0; k<NDLY; k=k+1)\n"
 	"\tbegin : F\n"
 		"\t\talways @(*)\n"
 		"\t\tbegin\n"
@@ -837,14 +950,16 @@ SLASHLINE
 		"\t\tend\n"
 	"\tend end endgenerate\n"
 "\n"
-	"\tgenerate begin : F_ACC_ZERO\n"
+	"\tgenerate if (ROWS <= 1)\n"
+	"\tbegin : F_ACC_ZERO\n"
 	"\tfor(k=0; k<TLEN-1; k=k+1)\n"
 	"\tbegin : F\n"
 		"\t\talways @(*)\n"
 			"\t\t\tassert(acc[k][IW+BW-1:6] == 0);\n"
 	"\tend end endgenerate\n"
 "\n"
-	"\tgenerate begin : F_RBZ\n"
+	"\tgenerate if (ROWS <= 1)\n"
+	"\tbegin : F_RBZ\n"
 	"\tfor(k=0; k<TLEN-2; k=k+1)\n"
 	"\tbegin : F\n"
 		"\t\talways @(*)\n"
@@ -862,7 +977,282 @@ SLASHLINE
 "// }}}\n"
 "endmodule\n");
 
-	fclose(fp);
+	return fftsink_close(fp);
 }
 // }}}
 
+
+// build_boothmpy
+// {{{
+int	build_boothmpy(const char *fname) {
+	FILE	*fp = fftsink_open(fname);
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return EOF;
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename: 	%s\n"
+"// {{{\n" // "}}}"
+"// Project:	%s\n"
+"//\n"
+"// Purpose:	A portable shift and add multiply, using a modified (radix-4)\n"
+"//	Booth encoding of the smaller input.  Each clock retires two bits\n"
+"//	of A by adding one of 0, +/-B, or +/-2B into a running accumulator.\n"
+"//	Since these rows are all signed, there's no need to take absolute\n"
+"//	values on the way in or to negate the result on the way out, and\n"
+"//	so this multiply takes two clocks less than the longbimpy, and\n"
+"//	uses only one carry chain per row.\n"
+"//\n"
+"//	Ports, parameters, and results match those of the longbimpy.\n"
+"//	The product is available (AW+1)/2 clocks after the inputs.\n"
+"//\n"
+"//	For minimal processing delay, make the first parameter the one with\n"
+"//	the least bits, so that AWIDTH <= BWIDTH.\n"
+"//\n"
+"//\n%s"
+"//\n", fname, prjname, creator);
+
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+	fprintf(fp,
+"module	boothmpy #(\n");
+
+	fprintf(fp, "\t\t// {{{\n"
+	"\t\tparameter	IAW=%d,	// The width of i_a, min width is 5\n"
+			"\t\t\t\tIBW=", TST_LONGBIMPY_AW);
+#ifdef	TST_LONGBIMPY_BW
+	fprintf(fp, "%d", TST_LONGBIMPY_BW);
+#else
+	fprintf(fp, "IAW");
+#endif
+
+	fprintf(fp, ",	// The width of i_b, can be anything\n"
+			"\t\t\t// The following parameters should not be changed\n"
+			"\t\t\t// by any implementation, but are based upon the\n"
+			"\t\t\t// above values:\n"
+			"\t\t\t// OW=IAW+IBW;	// The output width\n");
+	fprintf(fp,
+	"\t\tlocalparam	AW = (IAW<IBW) ? IAW : IBW,\n"
+			"\t\t\t\tBW = (IAW<IBW) ? IBW : IAW,\n"
+			"\t\t\t\tTLEN=(AW+1)/2,	// Booth digits, one per clock\n"
+			"\t\t\t\tIW=2*TLEN	// Internal width of A\n"
+	"\t\t// }}}\n"
+	"\t) (\n"
+	"\t\t// {{{\n"
+	"\t\tinput\twire\t\t\ti_clk, i_ce,\n"
+	"\t\tinput\twire\t[(IAW-1):0]\ti_a_unsorted,\n"
+	"\t\tinput\twire\t[(IBW-1):0]\ti_b_unsorted,\n"
+	"\t\toutput\twire\t[(AW+BW-1):0]\to_r\n"
+"\n");
+	if (formal_property_flag) fprintf(fp,
+"`ifdef	FORMAL\n"
+	"\t\t, output\twire\t[(IAW-1):0]\tf_past_a_unsorted,\n"
+	"\t\toutput\twire\t[(IBW-1):0]\tf_past_b_unsorted\n"
+"`endif\n");
+
+	fprintf(fp, "\t\t// }}}\n\t);\n"
+	"\t// Local declarations\n"
+	"\t// {{{\n"
+	"\t// Swap parameter order, so that AW <= BW -- for performance\n"
+	"\t// reasons\n"
+	"\twire	[AW-1:0]	i_a;\n"
+	"\twire	[BW-1:0]	i_b;\n"
+	"\tgenerate begin : PARAM_CHECK\n"
+	"\tif (IAW <= IBW)\n"
+	"\tbegin : NO_PARAM_CHANGE_I\n"
+	"\t\tassign i_a = i_a_unsorted;\n"
+	"\t\tassign i_b = i_b_unsorted;\n"
+	"\tend else begin : SWAP_PARAMETERS_I\n"
+	"\t\tassign i_a = i_b_unsorted;\n"
+	"\t\tassign i_b = i_a_unsorted;\n"
+	"\tend end endgenerate\n"
+"\n"
+	"\twire\t[IW:0]\t\t\tw_a;\n"
+	"\treg\t[IW:0]\t\t\tr_a\t[0:(TLEN-2)];\n"
+	"\treg\t[(BW-1):0]\t\tr_b\t[0:(TLEN-2)];\n"
+	"\treg\t[(AW+BW-1):0]\t\tacc\t[0:(TLEN-1)];\n"
+	"\twire\t[(BW+1):0]\t\tpp_0;\n"
+	"\tgenvar k;\n"
+	"\t// }}}\n");
+
+	fprintf(fp,
+"\n"
+	"\t// booth_pp\n"
+	"\t// {{{\n"
+	"\t// Booth encode three bits of A, overlapping by one, into a row of\n"
+	"\t// 0, +/-B, or +/-2B.  Negative rows are returned as their one's\n"
+	"\t// complement, and booth_neg() then returns the one that's left\n"
+	"\t// to be added in.\n"
+	"\tfunction [(BW+1):0] booth_pp(input [2:0] sel, input [(BW-1):0] b);\n"
+	"\tbegin\n"
+	"\t\tcase(sel)\n"
+	"\t\t3\'b001, 3\'b010: booth_pp =  { {(2){b[BW-1]}}, b };\n"
+	"\t\t3\'b011:         booth_pp =  { b[BW-1], b, 1\'b0 };\n"
+	"\t\t3\'b100:         booth_pp = ~{ b[BW-1], b, 1\'b0 };\n"
+	"\t\t3\'b101, 3\'b110: booth_pp = ~{ {(2){b[BW-1]}}, b };\n"
+	"\t\tdefault:        booth_pp = 0;\n"
+	"\t\tendcase\n"
+	"\tend endfunction\n"
+"\n"
+	"\tfunction booth_neg(input [2:0] sel);\n"
+	"\t\tbooth_neg = sel[2] && !(&sel[1:0]);\n"
+	"\tendfunction\n"
+	"\t// }}}\n"
+"\n"
+	"\t// w_a: A, sign extended to IW bits, with a zero below bit zero\n"
+	"\t// {{{\n"
+	"\tgenerate begin : EXTEND_A\n"
+	"\tif (IW > AW)\n"
+	"\tbegin : ADD_BIT_TO_A\n"
+		"\t\tassign\tw_a = { i_a[AW-1], i_a, 1\'b0 };\n"
+	"\tend else begin : KEEP_A\n"
+		"\t\tassign\tw_a = { i_a, 1\'b0 };\n"
+	"\tend end endgenerate\n"
+	"\t// }}}\n"
+"\n");
+
+	fprintf(fp,
+	"\t// r_a[0], r_b[0], acc[0]\n"
+	"\t// {{{\n"
+	"\t// The first row needs no accumulator, so we can start on the\n"
+	"\t// first clock.\n"
+	"\tassign\tpp_0 = booth_pp(w_a[2:0], i_b);\n"
+"\n"
+	"\tinitial r_a[0] = 0;\n"
+	"\tinitial r_b[0] = 0;\n"
+	"\tinitial acc[0] = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tr_a[0] <= { 2\'b00, w_a[IW:2] };\n"
+		"\t\tr_b[0] <= i_b;\n"
+		"\t\tacc[0] <= { {(AW-2){pp_0[BW+1]}}, pp_0 }\n"
+			"\t\t\t\t+ { {(AW+BW-1){1\'b0}}, booth_neg(w_a[2:0]) };\n"
+	"\tend\n"
+	"\t// }}}\n"
+"\n"
+	"\t// r_a[TLEN-2:1], r_b[TLEN-2:1]\n"
+	"\t// {{{\n"
+	"\tgenerate begin : COPY\n"
+	"\t// Keep track of the bits of A and B we haven't used yet\n"
+	"\tif (TLEN > 2) begin : FOR\n"
+	"\tfor(k=1; k<TLEN-1; k=k+1)\n"
+	"\tbegin : GENCOPIES\n"
+		"\n"
+		"\t\tinitial r_a[k] = 0;\n"
+		"\t\tinitial r_b[k] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\tr_a[k] <= { 2\'b00, r_a[k-1][IW:2] };\n"
+			"\t\t\tr_b[k] <= r_b[k-1];\n"
+		"\t\tend\n"
+	"\tend end end endgenerate\n"
+	"\t// }}}\n"
+"\n"
+	"\t// acc[TLEN-1:1]\n"
+	"\t// {{{\n"
+	"\tgenerate begin : STAGES\n"
+	"\t// Each row adds one more Booth digit into the top of the\n"
+	"\t// accumulator.  The bits below it are already final, and just\n"
+	"\t// get copied along.\n"
+	"\tfor(k=1; k<TLEN; k=k+1)\n"
+	"\tbegin : GENSTAGES\n"
+		"\t\twire\t[(BW+1):0]\t\tpp;\n"
+		"\t\twire\t[(AW+BW-1):0]\t\tsxpp;\n"
+		"\t\twire\t[(AW+BW-1-2*k):0]\tsum;\n"
+"\n"
+		"\t\tassign\tpp   = booth_pp(r_a[k-1][2:0], r_b[k-1]);\n"
+		"\t\tassign\tsxpp = { {(AW-2){pp[BW+1]}}, pp };\n"
+		"\t\tassign\tsum  = acc[k-1][(AW+BW-1):(2*k)]\n"
+			"\t\t\t\t+ sxpp[(AW+BW-1-2*k):0]\n"
+			"\t\t\t\t+ { {(AW+BW-1-2*k){1\'b0}},\n"
+				"\t\t\t\t\tbooth_neg(r_a[k-1][2:0]) };\n"
+"\n"
+		"\t\tinitial acc[k] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+			"\t\t\tacc[k] <= { sum, acc[k-1][(2*k-1):0] };\n"
+	"\tend end endgenerate\n"
+	"\t// }}}\n"
+"\n"
+	"\tassign\to_r = acc[TLEN-1];\n"
+"\n");
+
+	fprintf(fp,
+	"\t// Make Verilator happy\n"
+	"\t// {{{\n"
+	"\t// verilator lint_off UNUSED\n"
+	"\twire\tunused;\n"
+	"\tassign\tunused = &{ 1\'b0, r_a[TLEN-2][IW:3] };\n"
+	"\t// verilator lint_on UNUSED\n"
+	"\t// }}}\n");
+
+	// The formal property section
+	fprintf(fp,
+SLASHLINE
+SLASHLINE
+SLASHLINE
+"//\n"
+"// Formal property section\n"
+"// {{{\n"
+SLASHLINE
+SLASHLINE
+SLASHLINE
+"`ifdef	FORMAL\n");
+
+	if (formal_property_flag) {
+		fprintf(fp,
+"`define\tASSERT	assert\n"
+"\n"
+	"\treg	[IAW-1:0]	f_past_a	[0:TLEN-1];\n"
+	"\treg	[IBW-1:0]	f_past_b	[0:TLEN-1];\n"
+	"\twire	[AW+BW-1:0]	f_product;\n"
+"\n"
+	"\tinitial\tf_past_a[0] = 0;\n"
+	"\tinitial\tf_past_b[0] = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tf_past_a[0] <= i_a_unsorted;\n"
+		"\t\tf_past_b[0] <= i_b_unsorted;\n"
+	"\tend\n"
+"\n"
+	"\tgenerate for(k=1; k<TLEN; k=k+1)\n"
+	"\tbegin : F_PAST\n"
+		"\t\tinitial\tf_past_a[k] = 0;\n"
+		"\t\tinitial\tf_past_b[k] = 0;\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\tf_past_a[k] <= f_past_a[k-1];\n"
+			"\t\t\tf_past_b[k] <= f_past_b[k-1];\n"
+		"\t\tend\n"
+	"\tend endgenerate\n"
+"\n"
+	"\tassign\tf_past_a_unsorted = f_past_a[TLEN-1];\n"
+	"\tassign\tf_past_b_unsorted = f_past_b[TLEN-1];\n"
+"\n"
+	"\tassign\tf_product = $signed(f_past_a_unsorted)\n"
+				"\t\t\t\t* $signed(f_past_b_unsorted);\n"
+"\n"
+"`ifdef	BOOTHMPY\n"
+	"\talways @(*)\n"
+		"\t\t`ASSERT(o_r == f_product);\n"
+"`endif\t// BOOTHMPY\n");
+	} else {
+		fprintf(fp, "// Formal property generation was not been enabled\n");
+	}
+
+	fprintf(fp,
+"`endif\t// FORMAL\n"
+"// }}}\n"
+"endmodule\n");
+
+	return fftsink_close(fp);
+}
+// }}}
@@ -41,8 +41,9 @@
 #ifndef	SOFTMPY_H
 #define	SOFTMPY_H
 
-extern	void	build_multiply(const char *fname);
-extern	void	build_bimpy(const char *fname);
-extern	void	build_longbimpy(const char *fname);
+extern	int	build_multiply(const char *fname);
+extern	int	build_bimpy(const char *fname);
+extern	int	build_longbimpy(const char *fname, int rows=1, int outregs=0);
+extern	int	build_boothmpy(const char *fname);
 
 #endif	// SOFTMPY_H